@@ -0,0 +1,454 @@
+/*------------------------------------------------------
+**
+** File:      async_writer.c
+** Author:    Eric Lu
+** Created:   2026-10-19
+**
+** Copyright ©2012 Toronto Transit Commission
+**
+**
+** Function Description
+** -----------------------------------------------------
+**
+** background output file writer. completed run profiles are formatted in
+** memory by the calculating thread and handed over through a bounded queue
+** to a dedicated I/O thread, which creates and writes the files.
+**
+** -----------------------------------------------------
+** Revision History
+**
+** 19 OCT 2026: Rev 1.0 - erilu
+**                      - Initial Design
+**
+** Inputs:
+** Formatted run profile buffers and their output file paths
+**
+** Outputs:
+** Run Profile Files
+**
+** ----------------------------------------------------
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <fcntl.h>
+#ifndef _WIN32
+#   include <unistd.h>
+#else
+#   include <io.h>
+#endif
+#include "errorhandler.h"
+#include "common_util.h"
+#include "async_writer.h"
+
+/*
+** Structures
+** -----------------------------------------------------
+*/
+
+/* one file waiting to be written */
+typedef struct write_job_t
+{
+  char path[STR_MAX];
+  char *data;
+  size_t len;
+} writeJob;
+
+struct async_writer_t
+{
+  /* ring buffer of pending jobs */
+  writeJob *jobs;
+  int depth;
+  int head;
+  int count;
+  /* job currently being written by the I/O thread */
+  writeJob in_flight;
+  bool b_in_flight;
+
+  bool b_sync;
+  bool b_stop;
+
+  /* files written, flushed to disk one by one when closed */
+  char **sync_paths;
+  int sync_cnt;
+  int sync_cap;
+
+  /* first failure reported by the I/O thread */
+  int err;
+  int err_errno;
+  char err_path[STR_MAX];
+
+  pthread_t thread;
+  pthread_mutex_t lock;
+  pthread_cond_t not_empty;
+  pthread_cond_t not_full;
+};
+
+/*
+** Source Code
+** -----------------------------------------------------
+*/
+
+/** @brief  create the file and write the job content
+ *  @param  *job  job to write
+ *  @return 0
+ *          err_file_not_accessible
+ */
+static int
+write_job_to_file(writeJob *job)
+{
+  FILE *fp_out = NULL;
+  int err = 0;
+
+  fp_out = fopen(job->path, "w");
+  if (NULL == fp_out)
+  {
+    return throw_err(err_file_not_accessible);
+  }
+  if (job->len != fwrite(job->data, 1, job->len, fp_out))
+  {
+    err = throw_err(err_file_not_accessible);
+  }
+  if (0 != fclose(fp_out))
+  {
+    err = throw_err(err_file_not_accessible);
+  }
+  return err;
+}
+
+/** @brief  flush a written file to disk
+ *  @param  *path  output file path
+ *  @return 0
+ *          err_file_not_accessible
+ */
+static int
+sync_file(const char *path)
+{
+  int fd = -1;
+  int err = 0;
+
+#ifndef _WIN32
+  fd = open(path, O_WRONLY);
+  if (fd < 0)
+  {
+    return throw_err(err_file_not_accessible);
+  }
+  if (0 != fsync(fd))
+  {
+    err = throw_err(err_file_not_accessible);
+  }
+  close(fd);
+#else
+  fd = _open(path, _O_WRONLY);
+  if (fd < 0)
+  {
+    return throw_err(err_file_not_accessible);
+  }
+  if (0 != _commit(fd))
+  {
+    err = throw_err(err_file_not_accessible);
+  }
+  _close(fd);
+#endif
+  return err;
+}
+
+/** @brief  remember a written file for the flush on close
+ *  @param  *writer  writer
+ *  @param  *path    output file path
+ *  @return true     file is remembered
+ *          false    out of memory
+ */
+static bool
+sync_path_add(asyncWriter *writer, const char *path)
+{
+  char **paths = NULL;
+  int cap = 0;
+
+  if (writer->sync_cnt == writer->sync_cap)
+  {
+    cap = (0 == writer->sync_cap) ? 256 : (writer->sync_cap * 2);
+    paths = (char **) realloc(writer->sync_paths, cap * sizeof(char *));
+    if (NULL == paths)
+    {
+      return false;
+    }
+    writer->sync_paths = paths;
+    writer->sync_cap = cap;
+  }
+  writer->sync_paths[writer->sync_cnt] = (char *) malloc(strlen(path) + 1);
+  if (NULL == writer->sync_paths[writer->sync_cnt])
+  {
+    return false;
+  }
+  strcpy(writer->sync_paths[writer->sync_cnt], path);
+  writer->sync_cnt++;
+  return true;
+}
+
+/** @brief  I/O thread, pop jobs from the queue and write them until stopped
+ *  @param  *arg  writer
+ *  @return NULL
+ */
+static void *
+async_writer_main(void *arg)
+{
+  asyncWriter *writer = (asyncWriter *) arg;
+  int err = 0;
+
+  pthread_mutex_lock(&writer->lock);
+  while (true)
+  {
+    while ((0 == writer->count) && !(writer->b_stop))
+    {
+      pthread_cond_wait(&writer->not_empty, &writer->lock);
+    }
+    if (0 == writer->count)
+    {
+      /* stopped and drained */
+      break;
+    }
+    /* take the oldest job, keep it visible as in flight */
+    writer->in_flight = writer->jobs[writer->head];
+    writer->b_in_flight = true;
+    writer->head = (writer->head + 1) % writer->depth;
+    writer->count--;
+    pthread_cond_signal(&writer->not_full);
+    pthread_mutex_unlock(&writer->lock);
+
+    err = write_job_to_file(&writer->in_flight);
+    if ((0 == err) && (writer->b_sync) && !sync_path_add(writer, writer->in_flight.path))
+    {
+      /* cannot defer it, flush this one now */
+      err = sync_file(writer->in_flight.path);
+    }
+
+    pthread_mutex_lock(&writer->lock);
+    if ((err < 0) && (0 == writer->err))
+    {
+      writer->err = err;
+      writer->err_errno = errno;
+      strcpy(writer->err_path, writer->in_flight.path);
+    }
+    free(writer->in_flight.data);
+    writer->in_flight.data = NULL;
+    writer->b_in_flight = false;
+  }
+  pthread_mutex_unlock(&writer->lock);
+
+  return NULL;
+}
+
+/** @brief  create the writer queue and start the I/O thread
+ *  @param  queue_depth  number of pending files before submit blocks
+ *  @param  b_sync       flush the written files to disk when closed
+ *  @return NULL         writer cannot be created
+ *          pointer to the new writer
+ */
+asyncWriter *
+async_writer_create(int queue_depth, bool b_sync)
+{
+  asyncWriter *writer = NULL;
+
+  if (queue_depth <= 0)
+  {
+    queue_depth = ASYNC_WRITER_DEFAULT_DEPTH;
+  }
+  if (queue_depth > ASYNC_WRITER_MAX_DEPTH)
+  {
+    queue_depth = ASYNC_WRITER_MAX_DEPTH;
+  }
+
+  writer = (asyncWriter *) calloc(1, sizeof(asyncWriter));
+  if (NULL == writer)
+  {
+    return NULL;
+  }
+  writer->jobs = (writeJob *) calloc(queue_depth, sizeof(writeJob));
+  if (NULL == writer->jobs)
+  {
+    free(writer);
+    return NULL;
+  }
+  writer->depth = queue_depth;
+  writer->b_sync = b_sync;
+
+  pthread_mutex_init(&writer->lock, NULL);
+  pthread_cond_init(&writer->not_empty, NULL);
+  pthread_cond_init(&writer->not_full, NULL);
+
+  if (0 != pthread_create(&writer->thread, NULL, async_writer_main, writer))
+  {
+    pthread_cond_destroy(&writer->not_full);
+    pthread_cond_destroy(&writer->not_empty);
+    pthread_mutex_destroy(&writer->lock);
+    free(writer->jobs);
+    free(writer);
+    return NULL;
+  }
+
+  return writer;
+}
+
+/** @brief  queue a formatted file for writing, blocks while the queue is
+ *          full. the writer takes ownership of the buffer content.
+ *  @param  *writer  writer created by async_writer_create
+ *  @param  *path    output file path
+ *  @param  *buf     formatted file content, reset on return
+ *  @return 0
+ *          err_null_string
+ *          err_insufficient_buffer_size
+ *          err_file_not_accessible     an earlier write has failed
+ */
+int
+async_writer_submit(asyncWriter *writer, const char *path, strBuffer *buf)
+{
+  writeJob *job = NULL;
+  int err = 0;
+
+  if ((NULL == writer) || (NULL == path) || (NULL == buf))
+  {
+    return throw_err(err_null_string);
+  }
+  if (strlen(path) >= STR_MAX)
+  {
+    return throw_err(err_insufficient_buffer_size);
+  }
+
+  pthread_mutex_lock(&writer->lock);
+  while (writer->count == writer->depth)
+  {
+    pthread_cond_wait(&writer->not_full, &writer->lock);
+  }
+  if (writer->err < 0)
+  {
+    /* stop feeding the queue once the output is known to be broken */
+    err = writer->err;
+  }
+  else
+  {
+    job = &writer->jobs[(writer->head + writer->count) % writer->depth];
+    strcpy(job->path, path);
+    job->data = buf->data;
+    job->len = buf->len;
+    writer->count++;
+    pthread_cond_signal(&writer->not_empty);
+  }
+  pthread_mutex_unlock(&writer->lock);
+
+  if (0 == err)
+  {
+    /* buffer memory now belongs to the job */
+    buf->data = NULL;
+    buf->len = 0;
+    buf->cap = 0;
+  }
+  return err;
+}
+
+/** @brief  check if a file is queued or being written but not yet on disk
+ *  @param  *writer  writer created by async_writer_create
+ *  @param  *path    output file path
+ *  @return true     file is pending
+ *          false    file is not known to the writer
+ */
+bool
+async_writer_is_pending(asyncWriter *writer, const char *path)
+{
+  bool b_pending = false;
+  int i = 0;
+
+  if ((NULL == writer) || (NULL == path))
+  {
+    return false;
+  }
+
+  pthread_mutex_lock(&writer->lock);
+  if ((writer->b_in_flight) && (0 == strcmp(writer->in_flight.path, path)))
+  {
+    b_pending = true;
+  }
+  for (i = 0; (i < writer->count) && !(b_pending); i++)
+  {
+    if (0 == strcmp(writer->jobs[(writer->head + i) % writer->depth].path, path))
+    {
+      b_pending = true;
+    }
+  }
+  pthread_mutex_unlock(&writer->lock);
+
+  return b_pending;
+}
+
+/** @brief  drain the queue, stop the I/O thread, sync if requested and
+ *          release the writer
+ *  @param  *writer  writer created by async_writer_create
+ *  @return 0
+ *          err_file_not_accessible     at least one file was not written
+ *                                      or flushed to disk
+ */
+int
+async_writer_close(asyncWriter *writer)
+{
+  int err = 0;
+  int i = 0;
+
+  if (NULL == writer)
+  {
+    return 0;
+  }
+
+  pthread_mutex_lock(&writer->lock);
+  writer->b_stop = true;
+  pthread_cond_signal(&writer->not_empty);
+  pthread_mutex_unlock(&writer->lock);
+  pthread_join(writer->thread, NULL);
+
+  err = writer->err;
+  if (err < 0)
+  {
+    fprintf
+    (
+      stdout,
+      "[%6s][%d][%s][%s][%s]\n",
+      "ERROR",
+      writer->err_errno,
+      "Output File Cannot Be Created!",
+      get_err_description(err),
+      writer->err_path
+    );
+  }
+
+  /* flush the files of this export once the queue has drained, instead of
+  ** one by one while writing */
+  for (i = 0; i < writer->sync_cnt; i++)
+  {
+    if ((sync_file(writer->sync_paths[i]) < 0) && (0 == err))
+    {
+      err = throw_err(err_file_not_accessible);
+      fprintf
+      (
+        stdout,
+        "[%6s][%d][%s][%s][%s]\n",
+        "ERROR",
+        errno,
+        "Output File Cannot Be Flushed!",
+        get_err_description(err),
+        writer->sync_paths[i]
+      );
+    }
+    free(writer->sync_paths[i]);
+  }
+  free(writer->sync_paths);
+
+  pthread_cond_destroy(&writer->not_full);
+  pthread_cond_destroy(&writer->not_empty);
+  pthread_mutex_destroy(&writer->lock);
+  free(writer->jobs);
+  free(writer);
+
+  return err;
+}
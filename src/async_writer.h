@@ -0,0 +1,103 @@
+/*------------------------------------------------------
+**
+** File:      async_writer.h
+** Author:    Eric Lu
+** Created:   2026-10-19
+**
+** Copyright ©2012 Toronto Transit Commission
+**
+**
+** Function Description
+** -----------------------------------------------------
+**
+** background output file writer. completed run profiles are formatted in
+** memory by the calculating thread and handed over through a bounded queue
+** to a dedicated I/O thread, which creates and writes the files.
+**
+** -----------------------------------------------------
+** Revision History
+**
+** 19 OCT 2026: Rev 1.0 - erilu
+**                      - Initial Design
+**
+** Inputs:
+** Formatted run profile buffers and their output file paths
+**
+** Outputs:
+** Run Profile Files
+**
+** ----------------------------------------------------
+*/
+
+#ifndef ATC_SPEED_PROFILE_ASYNC_WRITER_H
+#define ATC_SPEED_PROFILE_ASYNC_WRITER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "common_util.h"
+
+/*
+** Constants
+** -----------------------------------------------------
+*/
+
+/* default number of run profiles waiting to be written */
+#define ASYNC_WRITER_DEFAULT_DEPTH   16
+/* maximum number of run profiles waiting to be written */
+#define ASYNC_WRITER_MAX_DEPTH       4096
+
+/*
+** Structures
+** -----------------------------------------------------
+*/
+
+/* background writer, opaque to the callers */
+typedef struct async_writer_t asyncWriter;
+
+/*
+** Function Prototypes
+** -----------------------------------------------------
+*/
+
+/** @brief  create the writer queue and start the I/O thread
+ *  @param  queue_depth  number of pending files before submit blocks
+ *  @param  b_sync       flush the written files to disk when closed
+ *  @return NULL         writer cannot be created
+ *          pointer to the new writer
+ */
+asyncWriter *
+async_writer_create(int queue_depth, bool b_sync);
+
+/** @brief  queue a formatted file for writing, blocks while the queue is
+ *          full. the writer takes ownership of the buffer content.
+ *  @param  *writer  writer created by async_writer_create
+ *  @param  *path    output file path
+ *  @param  *buf     formatted file content, reset on return
+ *  @return 0
+ *          err_null_string
+ *          err_insufficient_buffer_size
+ *          err_file_not_accessible     an earlier write has failed
+ */
+int
+async_writer_submit(asyncWriter *writer, const char *path, strBuffer *buf);
+
+/** @brief  check if a file is queued or being written but not yet on disk
+ *  @param  *writer  writer created by async_writer_create
+ *  @param  *path    output file path
+ *  @return true     file is pending
+ *          false    file is not known to the writer
+ */
+bool
+async_writer_is_pending(asyncWriter *writer, const char *path);
+
+/** @brief  drain the queue, stop the I/O thread, sync if requested and
+ *          release the writer
+ *  @param  *writer  writer created by async_writer_create
+ *  @return 0
+ *          err_file_not_accessible     at least one file was not written
+ *                                      or flushed to disk
+ */
+int
+async_writer_close(asyncWriter *writer);
+
+#endif
@@ -0,0 +1,452 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+# ifdef _WIN32
+#   include <direct.h>
+# endif
+#include "atc_speed_profile_tool.h"
+#include "log.h"
+#include "profiler.h"
+#include "bench_util.h"
+#include "datagen.h"
+
+/*
+** Constants
+** -----------------------------------------------------
+*/
+
+/* generated workload files, written to the working directory */
+#define BENCH_LUT_FILE            "bench_atc_block_lut.csv"
+#define BENCH_DATA_FILE           "bench_traindata.csv"
+/* default repetitions per dataset size */
+#define BENCH_DEFAULT_REPS        5
+/* maximum number of dataset sizes on the command line */
+#define BENCH_MAX_SIZES           16
+/* stations on the generated line */
+#define BENCH_STATION_CNT         20
+/* rows one generated train produces in a typical service day */
+#define BENCH_ROWS_PER_TRAIN      21600
+
+/* benchmarked stages, in execution order */
+enum bench_stage
+{
+  k_bench_read_lut_file = 0,
+  k_bench_read_input_file,
+  k_bench_sort_input_data_list,
+  k_bench_expand_data_list_use_lut,
+  k_bench_calculate_output_data_list,
+  k_bench_export_run_profile_file,
+
+  /* number of stages */
+  k_bench_stage_cnt
+};
+
+static const char *k_bench_stage_names[k_bench_stage_cnt] =
+{
+  "read_lut_file",
+  "read_input_file",
+  "sort_input_data_list",
+  "expand_data_list_use_lut",
+  "calculate_output_data_list",
+  "export_run_profile_file"
+};
+
+/* error the tool reports for each kind of malformed row */
+static const int k_bench_malformed_errs[k_malformed_cnt] =
+{
+  err_file_format_not_valid,
+  err_date_not_valid,
+  err_cc_not_valid,
+  err_motion_not_valid,
+  err_speed_not_valid
+};
+
+/*
+** Source Code
+** -----------------------------------------------------
+*/
+
+/** @brief  generate the lookup table and exactly the requested number of
+ *          train data rows, the network and seed are the same for every
+ *          size so results stay comparable between builds
+ *  @param  rows            number of data rows to write
+ *  @param  malformed_rate  probability of a malformed row
+ *  @param  *malformed      malformed rows written per kind
+ *  @return 0
+ *          err_file_not_accessible
+ *          err_maximum_number_exceeded  too many rows for one service day
+ */
+static int
+write_bench_workload(uint64_t rows, double malformed_rate, uint64_t *malformed)
+{
+  dataGenConfig cfg;
+  dataGenNetwork *net = NULL;
+  uint64_t rows_written = 0;
+  uint64_t trains = rows / BENCH_ROWS_PER_TRAIN;
+  int err = 0;
+
+  datagen_config_init(&cfg);
+  cfg.station_cnt = BENCH_STATION_CNT;
+  cfg.train_cnt = (int) ((trains < 10) ? 10 : (trains > DATAGEN_MAX_TRAIN_CNT) ? DATAGEN_MAX_TRAIN_CNT : trains);
+  cfg.hours = 24;
+  cfg.max_rows = rows;
+  cfg.malformed_rate = malformed_rate;
+  memset(malformed, 0, k_malformed_cnt * sizeof(uint64_t));
+
+  if (NULL == (net = datagen_network_create(&cfg)))
+  {
+    return throw_err(err_maximum_number_exceeded);
+  }
+  err = datagen_write_lut(net, BENCH_LUT_FILE);
+  if (err >= 0)
+  {
+    err = datagen_write_traindata(net, 0, BENCH_DATA_FILE, &rows_written, malformed);
+  }
+  if ((err >= 0) && (rows_written < rows))
+  {
+    err = throw_err(err_maximum_number_exceeded);
+  }
+  datagen_network_free(net);
+  return err;
+}
+
+/** @brief  delete the run profile files produced from the benchmark data
+ *          and the manifest export appends to, so every repetition
+ *          exports into the same empty location
+ *  @return number of files removed
+ */
+static int
+remove_bench_run_profiles()
+{
+  char str_dir[STR_MAX] = "";
+  char str_file[STR_MAX] = "";
+  char *p_name = NULL;
+  size_t len_name = 0;
+  size_t len_suffix = strlen(BENCH_DATA_FILE);
+  DIR *dir = NULL;
+  struct dirent *entry = NULL;
+  int cnt = 0;
+
+#ifdef _WIN32
+  /* run profile path is a directory */
+  snprintf(str_dir, STR_MAX, "%s", RUN_PROFILE_PATH);
+  str_dir[strlen(str_dir) - 1] = '\0';
+#else
+  /* run profile path is a file name prefix in the working directory */
+  strcpy(str_dir, ".");
+#endif
+  if (NULL == (dir = opendir(str_dir)))
+  {
+    return 0;
+  }
+  while (NULL != (entry = readdir(dir)))
+  {
+#ifdef _WIN32
+    snprintf(str_file, STR_MAX, "%s%s", RUN_PROFILE_PATH, entry->d_name);
+#else
+    snprintf(str_file, STR_MAX, "%s", entry->d_name);
+#endif
+    p_name = str_file;
+    len_name = strlen(p_name);
+    if ((0 == strncmp(p_name, RUN_PROFILE_PATH RUN_PROFILE_PREFIX,
+                      strlen(RUN_PROFILE_PATH RUN_PROFILE_PREFIX))) &&
+        (len_name > len_suffix) &&
+        (0 == strcmp(p_name + len_name - len_suffix, BENCH_DATA_FILE)) &&
+        (0 == remove(p_name)))
+    {
+      cnt++;
+    }
+  }
+  closedir(dir);
+  if (0 == remove(RUN_PROFILE_PATH RUN_PROFILE_MANIFEST))
+  {
+    cnt++;
+  }
+  return cnt;
+}
+
+/** @brief  compare the errors reported for the benchmark data with the
+ *          malformed rows the generator wrote
+ *  @param  *malformed  malformed rows written per kind
+ *  @return 0
+ *          err_file_format_not_valid  counts differ
+ */
+static int
+check_bench_error_counts(const uint64_t *malformed)
+{
+  uint64_t reported = 0;
+  int err = 0;
+  int kind = 0;
+
+  for (kind = 0; kind < k_malformed_cnt; kind++)
+  {
+    reported = err_report_total(k_bench_malformed_errs[kind]);
+    if (reported != malformed[kind])
+    {
+      fprintf
+      (
+        stdout,
+        "[%6s][%s][%s][%llu][%llu]\n",
+        "ERROR",
+        "Reported Error Count Does Not Match!",
+        get_err_description(k_bench_malformed_errs[kind]),
+        (unsigned long long) reported,
+        (unsigned long long) malformed[kind]
+      );
+      err = throw_err(err_file_format_not_valid);
+    }
+  }
+  return err;
+}
+
+/** @brief  run every stage once on fresh lists and record the elapsed
+ *          time of each stage, then check the reported data errors
+ *  @param  *results    one result per stage
+ *  @param  *malformed  malformed rows written per kind
+ *  @return 0
+ *          negative error of the first failing stage
+ *          err_file_format_not_valid  reported errors differ from the data
+ */
+static int
+run_bench_pipeline(benchResult *results, const uint64_t *malformed)
+{
+  toolStats stats;
+  double t_start = 0;
+  int err = 0;
+  int stage = 0;
+
+  init_lut_data_list();
+  init_input_data_list();
+  init_output_data_list();
+
+  for (stage = 0; (stage < k_bench_stage_cnt) && (err >= 0); stage++)
+  {
+    /* memory of this stage only, not the process high-water mark */
+    reset_list_memory_high_water();
+    t_start = profile_wall_time();
+    switch (stage)
+    {
+      case k_bench_read_lut_file:
+        err = read_lut_file(BENCH_LUT_FILE);
+        break;
+      case k_bench_read_input_file:
+        err = read_input_file(BENCH_DATA_FILE);
+        break;
+      case k_bench_sort_input_data_list:
+        err = sort_input_data_list();
+        break;
+      case k_bench_expand_data_list_use_lut:
+        err = expand_data_list_use_lut();
+        break;
+      case k_bench_calculate_output_data_list:
+        err = calculate_output_data_list();
+        break;
+      case k_bench_export_run_profile_file:
+        err = export_run_profile_file();
+        break;
+      default:
+        break;
+    }
+    if (err >= 0)
+    {
+      bench_result_add(&results[stage], profile_wall_time() - t_start);
+      get_tool_stats(&stats);
+      bench_result_add_memory(&results[stage], stats.list_bytes_high_water);
+    }
+    else
+    {
+      fprintf
+      (
+        stdout,
+        "[%6s][%s][%s][%s]\n",
+        "ERROR",
+        "Benchmark Stage Failed!",
+        k_bench_stage_names[stage],
+        get_err_description(err)
+      );
+    }
+  }
+
+  if (err >= 0)
+  {
+    err = check_bench_error_counts(malformed);
+  }
+
+  log_flush();
+  free_lut_data_list();
+  free_input_data_list();
+  free_output_data_list();
+  err_report_reset();
+  remove_bench_run_profiles();
+
+  return err;
+}
+
+/** @brief  display benchmark usage
+ *  @return none
+ */
+static void
+display_bench_usage(char **argv)
+{
+  printf("USAGE: %s [OPTION]...\n", strip_path(argv[0]));
+  printf("time each processing stage on a generated workload\n");
+  printf("\n");
+  printf("OPTIONS:\n");
+  printf("  %-20s %s\n", "--rows N", "dataset size in rows, repeat for several sizes");
+  printf("  %-20s %s\n", "--reps N", "repetitions per dataset size (default 5)");
+  printf("  %-20s %s\n", "--csv FILE", "write results as csv");
+  printf("  %-20s %s\n", "--baseline FILE", "fail when results regress against a csv baseline");
+  printf("  %-20s %s\n", "--tolerance PCT", "allowed throughput drop (default 10)");
+  printf("  %-20s %s\n", "--mem-tolerance PCT", "allowed peak list memory growth (default 10)");
+  printf("  %-20s %s\n", "--malformed-rate P", "probability of a malformed row, checks the reported errors");
+  printf("\n");
+}
+
+/*
+** Main Program Code
+*/
+int
+main(int argc, char *argv[])
+{
+  uint64_t sizes[BENCH_MAX_SIZES] = {0};
+  int size_cnt = 0;
+  int reps = BENCH_DEFAULT_REPS;
+  char *str_csv_file = NULL;
+  char *str_baseline_file = NULL;
+  double tolerance_pct = BENCH_DEFAULT_TOLERANCE;
+  double mem_tolerance_pct = BENCH_DEFAULT_MEM_TOLERANCE;
+  double malformed_rate = 0;
+  uint64_t malformed[k_malformed_cnt] = {0};
+  int regress_cnt = 0;
+
+  static benchResult results[BENCH_MAX_RESULTS];
+  int result_cnt = 0;
+  char str_name[STR_LONG] = "";
+
+  int err = 0;
+  int i = 0;
+  int j = 0;
+  int stage = 0;
+
+  for (i = 1; i < argc; i++)
+  {
+    if ((0 == strcmp(argv[i], "--rows")) && (i + 1 < argc) &&
+        (size_cnt < BENCH_MAX_SIZES))
+    {
+      sizes[size_cnt] = strtoull(argv[++i], NULL, 10);
+      if (sizes[size_cnt] > 0)
+      {
+        size_cnt++;
+      }
+    }
+    else if ((0 == strcmp(argv[i], "--reps")) && (i + 1 < argc))
+    {
+      reps = atoi(argv[++i]);
+    }
+    else if ((0 == strcmp(argv[i], "--csv")) && (i + 1 < argc))
+    {
+      str_csv_file = argv[++i];
+    }
+    else if ((0 == strcmp(argv[i], "--baseline")) && (i + 1 < argc))
+    {
+      str_baseline_file = argv[++i];
+    }
+    else if ((0 == strcmp(argv[i], "--tolerance")) && (i + 1 < argc))
+    {
+      tolerance_pct = atof(argv[++i]);
+    }
+    else if ((0 == strcmp(argv[i], "--mem-tolerance")) && (i + 1 < argc))
+    {
+      mem_tolerance_pct = atof(argv[++i]);
+    }
+    else if ((0 == strcmp(argv[i], "--malformed-rate")) && (i + 1 < argc))
+    {
+      malformed_rate = atof(argv[++i]);
+    }
+    else
+    {
+      display_bench_usage(argv);
+      return EXIT_FAILURE;
+    }
+  }
+  if ((reps <= 0) || (reps > BENCH_MAX_SAMPLES))
+  {
+    fprintf(stdout, "[%6s][%s%d]\n", "ERROR", "Repetitions Must Be 1 To ", BENCH_MAX_SAMPLES);
+    return EXIT_FAILURE;
+  }
+  if (0 == size_cnt)
+  {
+    sizes[size_cnt++] = 10000;
+    sizes[size_cnt++] = 100000;
+  }
+
+  /* per row diagnostics are not part of the measurement */
+  log_set_level(LOG_FATAL);
+  set_async_export(0, false);
+#ifdef _WIN32
+  _mkdir("run_profiles");
+#endif
+
+  remove_bench_run_profiles();
+
+  for (i = 0; (i < size_cnt) && (err >= 0); i++)
+  {
+    fprintf(stdout, "[%6s][%s][%llu]\n", "INFO", "Benchmark Dataset Rows", (unsigned long long) sizes[i]);
+    if ((err = write_bench_workload(sizes[i], malformed_rate, malformed)) < 0)
+    {
+      fprintf(stdout, "[%6s][%s][%s]\n", "ERROR", "Benchmark Workload Cannot Be Created!", get_err_description(err));
+      break;
+    }
+    for (stage = 0; stage < k_bench_stage_cnt; stage++)
+    {
+      snprintf(str_name, STR_LONG, "%s/%llu", k_bench_stage_names[stage], (unsigned long long) sizes[i]);
+      /* the lookup table does not grow with the dataset */
+      bench_result_init
+      (
+        &results[result_cnt + stage],
+        str_name,
+        (k_bench_read_lut_file == stage) ? 4 * BENCH_STATION_CNT - 2 : sizes[i]
+      );
+    }
+    for (j = 0; (j < reps) && (err >= 0); j++)
+    {
+      err = run_bench_pipeline(&results[result_cnt], malformed);
+    }
+    for (stage = 0; stage < k_bench_stage_cnt; stage++)
+    {
+      bench_result_finish(&results[result_cnt + stage]);
+    }
+    result_cnt += k_bench_stage_cnt;
+  }
+
+  bench_print_header(stdout);
+  for (i = 0; i < result_cnt; i++)
+  {
+    bench_print_result(stdout, &results[i]);
+  }
+  if ((NULL != str_csv_file) && (bench_write_csv(str_csv_file, results, result_cnt) < 0))
+  {
+    fprintf(stdout, "[%6s][%s][%s]\n", "ERROR", "Benchmark Result File Cannot Be Created!", str_csv_file);
+    err = throw_err(err_file_not_accessible);
+  }
+  if ((NULL != str_baseline_file) && (err >= 0))
+  {
+    regress_cnt = bench_check_baseline(stdout, str_baseline_file, results, result_cnt,
+                                       tolerance_pct, mem_tolerance_pct);
+    if (regress_cnt < 0)
+    {
+      fprintf(stdout, "[%6s][%s][%s]\n", "ERROR", "Benchmark Baseline Cannot Be Read!", str_baseline_file);
+      err = regress_cnt;
+    }
+    else if (regress_cnt > 0)
+    {
+      fprintf(stdout, "[%6s][%s][%d]\n", "ERROR", "Benchmarks Regressed", regress_cnt);
+      err = throw_err(err_file_format_not_valid);
+    }
+  }
+
+  remove(BENCH_LUT_FILE);
+  remove(BENCH_DATA_FILE);
+  return (err < 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
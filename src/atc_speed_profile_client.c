@@ -0,0 +1,246 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "atc_speed_profile_tool.h"
+#include "server.h"
+
+/* reply fields of a job status, after JOB */
+static const char *k_job_field_names[] =
+{
+  "Job",
+  "State",
+  "Error",
+  "Rows Read",
+  "Rows Calculated",
+  "Files Written",
+  "Bytes Written",
+  "Queued s",
+  "Run s"
+};
+
+/** @brief  display client usage
+ *  @return none
+ */
+static void
+display_client_usage(char **argv)
+{
+  printf("USAGE: %s [OPTION]... [FILE]...\n", strip_path(argv[0]));
+  printf("submit train data files to a resident job server started with --serve\n");
+  printf("\n");
+  printf("OPTIONS:\n");
+  printf("  %-22s %s\n", "--socket PATH", "server socket (default " SERVER_DEFAULT_SOCKET ")");
+  printf("  %-22s %s\n", "--out DIR", "run profile folder (default " RUN_PROFILE_PATH ")");
+  printf("  %-22s %s\n", "--fsync", "flush each run profile to disk before closing");
+  printf("  %-22s %s\n", "--async-export", "export in the background");
+  printf("  %-22s %s\n", "--no-wait", "return once the job is queued");
+  printf("  %-22s %s\n", "--status ID", "print the status of a job");
+  printf("  %-22s %s\n", "--wait ID", "wait for a job and print its status");
+  printf("  %-22s %s\n", "--shutdown", "stop the server once its queued jobs are done");
+  printf("\n");
+}
+
+/** @brief  append a field to a request line
+ *  @param  *str_request  request line
+ *  @param  size          size of str_request
+ *  @param  *str_field    field
+ *  @return 0
+ *          err_insufficient_buffer_size
+ */
+static int
+append_field(char *str_request, size_t size, const char *str_field)
+{
+  size_t len = strlen(str_request);
+
+  if ((size_t) snprintf(str_request + len, size - len, "%c%s",
+                        SERVER_FIELD_DELIM, str_field) >= size - len)
+  {
+    return throw_err(err_insufficient_buffer_size);
+  }
+  return 0;
+}
+
+/** @brief  print a reply, one labelled line per job status field
+ *  @param  *str_reply  reply line, modified
+ *  @return true        job done or request accepted
+ *          false       job failed or request rejected
+ */
+static bool
+print_reply(char *str_reply)
+{
+  char *p_field = cstrtok(str_reply, SERVER_FIELD_DELIM);
+  bool b_ok = true;
+  int i = 0;
+
+  if (0 == strcmp(p_field, "OK"))
+  {
+    p_field = cstrtok(NULL, SERVER_FIELD_DELIM);
+    fprintf(stdout, "[%6s][%s][%s]\n", "INFO", "Request Accepted", (NULL != p_field) ? p_field : "");
+  }
+  else if (0 == strcmp(p_field, "JOB"))
+  {
+    for (i = 0; (i < (int) (sizeof(k_job_field_names) / sizeof(k_job_field_names[0]))) &&
+                (NULL != (p_field = cstrtok(NULL, SERVER_FIELD_DELIM))); i++)
+    {
+      fprintf(stdout, "[%6s][%s][%s]\n", "INFO", k_job_field_names[i], p_field);
+      if ((1 == i) && (0 != strcmp(p_field, "DONE")))
+      {
+        b_ok = false;
+      }
+    }
+  }
+  else
+  {
+    p_field = cstrtok(NULL, SERVER_FIELD_DELIM);
+    fprintf(stdout, "[%6s][%s][%s]\n", "ERROR", "Request Rejected", (NULL != p_field) ? p_field : "");
+    b_ok = false;
+  }
+  return b_ok;
+}
+
+/** @brief  send a request and print its reply
+ *  @param  *str_socket   socket path
+ *  @param  *str_request  request line
+ *  @param  *str_reply    reply output
+ *  @param  size          size of str_reply
+ *  @return true          request answered and successful
+ *          false         server not reachable or request failed
+ */
+static bool
+send_request(const char *str_socket, const char *str_request, char *str_reply, size_t size)
+{
+  int err = server_request(str_socket, str_request, str_reply, size);
+
+  if (err < 0)
+  {
+    fprintf(stdout, "[%6s][%s][%s][%s]\n", "ERROR", "Server Not Reachable!", get_err_description(err), str_socket);
+    return false;
+  }
+  return print_reply(str_reply);
+}
+
+/*
+** Main Program Code
+*/
+int
+main(int argc, char *argv[])
+{
+  const char *str_socket = SERVER_DEFAULT_SOCKET;
+  const char *str_out_dir = "";
+  const char *str_job_id = NULL;
+  const char *str_cmd = "SUBMIT";
+  char str_path[PATH_MAX] = "";
+  char str_reply[STR_EXTRA] = "";
+  char str_id[STR_MAX] = "";
+  char *str_request = NULL;
+  bool b_fsync = false;
+  bool b_async_export = false;
+  bool b_wait = true;
+  bool b_ok = true;
+  int file_cnt = 0;
+  int err = 0;
+  int i = 0;
+
+  if (NULL == (str_request = malloc(SERVER_LINE_MAX)))
+  {
+    fprintf(stdout, "[%6s][%s]\n", "ERROR", "Not Enough Memory!");
+    return EXIT_FAILURE;
+  }
+  for (i = 1; i < argc; i++)
+  {
+    if (0 == strcmp(argv[i], "--fsync"))
+    {
+      b_fsync = true;
+    }
+    else if (0 == strcmp(argv[i], "--async-export"))
+    {
+      b_async_export = true;
+    }
+    else if (0 == strcmp(argv[i], "--no-wait"))
+    {
+      b_wait = false;
+    }
+    else if (0 == strcmp(argv[i], "--shutdown"))
+    {
+      str_cmd = "SHUTDOWN";
+    }
+    else if (i + 1 >= argc)
+    {
+      break;
+    }
+    else if (0 == strcmp(argv[i], "--socket"))
+    {
+      str_socket = argv[++i];
+    }
+    else if (0 == strcmp(argv[i], "--out"))
+    {
+      str_out_dir = argv[++i];
+    }
+    else if (0 == strcmp(argv[i], "--status"))
+    {
+      str_cmd = "STATUS";
+      str_job_id = argv[++i];
+    }
+    else if (0 == strcmp(argv[i], "--wait"))
+    {
+      str_cmd = "WAIT";
+      str_job_id = argv[++i];
+    }
+    else
+    {
+      break;
+    }
+  }
+
+  /* the server resolves paths from its own working directory */
+  snprintf(str_request, SERVER_LINE_MAX, "%s", str_cmd);
+  if (NULL != str_job_id)
+  {
+    err = append_field(str_request, SERVER_LINE_MAX, str_job_id);
+  }
+  else if (0 == strcmp(str_cmd, "SUBMIT"))
+  {
+    if (('\0' != str_out_dir[0]) && (NULL != realpath(str_out_dir, str_path)))
+    {
+      str_out_dir = str_path;
+    }
+    err = append_field(str_request, SERVER_LINE_MAX, str_out_dir);
+    if ((err >= 0) && b_fsync)
+    {
+      err = append_field(str_request, SERVER_LINE_MAX, "--fsync");
+    }
+    if ((err >= 0) && b_async_export)
+    {
+      err = append_field(str_request, SERVER_LINE_MAX, "--async-export");
+    }
+    for (; (i < argc) && (err >= 0); i++, file_cnt++)
+    {
+      if (NULL == realpath(argv[i], str_path))
+      {
+        fprintf(stdout, "[%6s][%s][%s]\n", "ERROR", "Data File Not Accessible!", argv[i]);
+        free(str_request);
+        return EXIT_FAILURE;
+      }
+      err = append_field(str_request, SERVER_LINE_MAX, str_path);
+    }
+  }
+  if ((err < 0) || (i < argc) ||
+      ((0 == strcmp(str_cmd, "SUBMIT")) && (0 == file_cnt)))
+  {
+    display_client_usage(argv);
+    free(str_request);
+    return EXIT_FAILURE;
+  }
+
+  b_ok = send_request(str_socket, str_request, str_reply, STR_EXTRA);
+  if (b_ok && b_wait && (0 == strcmp(str_cmd, "SUBMIT")))
+  {
+    /* OK <job id> */
+    strcpy(str_id, str_reply + strlen(str_reply) + 1);
+    snprintf(str_request, SERVER_LINE_MAX, "WAIT%c%s", SERVER_FIELD_DELIM, str_id);
+    b_ok = send_request(str_socket, str_request, str_reply, STR_EXTRA);
+  }
+
+  free(str_request);
+  return b_ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,151 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "atc_speed_profile_tool.h"
+#include "datagen.h"
+
+/** @brief  display generator usage
+ *  @return none
+ */
+static void
+display_datagen_usage(char **argv)
+{
+  printf("USAGE: %s [OPTION]...\n", strip_path(argv[0]));
+  printf("generate a block lookup table and train data for scale testing\n");
+  printf("\n");
+  printf("OPTIONS:\n");
+  printf("  %-22s %s\n", "--stations N", "stations on the line (default 20)");
+  printf("  %-22s %s\n", "--between N", "blocks between two stations (default 1)");
+  printf("  %-22s %s\n", "--trains N", "trains in service, 1 to 999 (default 20)");
+  printf("  %-22s %s\n", "--hours T", "service hours per day (default 18)");
+  printf("  %-22s %s\n", "--days N", "daily train data files (default 1)");
+  printf("  %-22s %s\n", "--period S", "seconds between samples (default 3)");
+  printf("  %-22s %s\n", "--seed N", "random seed (default 20190329)");
+  printf("  %-22s %s\n", "--skip-stop-rate P", "probability of running through a station");
+  printf("  %-22s %s\n", "--gap-rate P", "probability of a data gap per sample");
+  printf("  %-22s %s\n", "--malformed-rate P", "probability of a malformed row per sample");
+  printf("  %-22s %s\n", "--max-rows N", "maximum rows per daily file");
+  printf("  %-22s %s\n", "--lut FILE", "lookup table file (default " BLOCK_LUT_FILE ")");
+  printf("  %-22s %s\n", "--out DIR", "train data directory (default .)");
+  printf("\n");
+}
+
+/*
+** Main Program Code
+*/
+int
+main(int argc, char *argv[])
+{
+  dataGenConfig cfg;
+  dataGenNetwork *net = NULL;
+  const char *str_lut_file = BLOCK_LUT_FILE;
+  const char *str_out_dir = ".";
+  char str_name[STR_MAX] = "";
+  char str_file[STR_MAX] = "";
+  uint64_t rows = 0;
+  uint64_t rows_total = 0;
+  int err = 0;
+  int i = 0;
+
+  datagen_config_init(&cfg);
+  for (i = 1; i < argc; i++)
+  {
+    if (i + 1 >= argc)
+    {
+      display_datagen_usage(argv);
+      return EXIT_FAILURE;
+    }
+    if (0 == strcmp(argv[i], "--stations"))
+    {
+      cfg.station_cnt = atoi(argv[++i]);
+    }
+    else if (0 == strcmp(argv[i], "--between"))
+    {
+      cfg.between_cnt = atoi(argv[++i]);
+    }
+    else if (0 == strcmp(argv[i], "--trains"))
+    {
+      cfg.train_cnt = atoi(argv[++i]);
+    }
+    else if (0 == strcmp(argv[i], "--hours"))
+    {
+      cfg.hours = atof(argv[++i]);
+    }
+    else if (0 == strcmp(argv[i], "--days"))
+    {
+      cfg.day_cnt = atoi(argv[++i]);
+    }
+    else if (0 == strcmp(argv[i], "--period"))
+    {
+      cfg.sample_period_s = atoi(argv[++i]);
+    }
+    else if (0 == strcmp(argv[i], "--seed"))
+    {
+      cfg.seed = strtoull(argv[++i], NULL, 10);
+    }
+    else if (0 == strcmp(argv[i], "--skip-stop-rate"))
+    {
+      cfg.skip_stop_rate = atof(argv[++i]);
+    }
+    else if (0 == strcmp(argv[i], "--gap-rate"))
+    {
+      cfg.gap_rate = atof(argv[++i]);
+    }
+    else if (0 == strcmp(argv[i], "--malformed-rate"))
+    {
+      cfg.malformed_rate = atof(argv[++i]);
+    }
+    else if (0 == strcmp(argv[i], "--max-rows"))
+    {
+      cfg.max_rows = strtoull(argv[++i], NULL, 10);
+    }
+    else if (0 == strcmp(argv[i], "--lut"))
+    {
+      str_lut_file = argv[++i];
+    }
+    else if (0 == strcmp(argv[i], "--out"))
+    {
+      str_out_dir = argv[++i];
+    }
+    else
+    {
+      display_datagen_usage(argv);
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (NULL == (net = datagen_network_create(&cfg)))
+  {
+    fprintf(stdout, "[%6s][%s]\n", "ERROR", "Generator Configuration Not Valid!");
+    display_datagen_usage(argv);
+    return EXIT_FAILURE;
+  }
+
+  if ((err = datagen_write_lut(net, str_lut_file)) < 0)
+  {
+    fprintf(stdout, "[%6s][%s][%s]\n", "ERROR", "Lookup Table Cannot Be Created!", str_lut_file);
+  }
+  else
+  {
+    fprintf(stdout, "[%6s][%s][%s]\n", "INFO", "Lookup Table Generated", str_lut_file);
+  }
+
+  for (i = 0; (i < cfg.day_cnt) && (err >= 0); i++)
+  {
+    datagen_traindata_name(net, i, str_name, STR_MAX);
+    snprintf(str_file, STR_MAX, "%s%s%s", str_out_dir, PATH_DELIM, str_name);
+    if ((err = datagen_write_traindata(net, i, str_file, &rows, NULL)) < 0)
+    {
+      fprintf(stdout, "[%6s][%s][%s]\n", "ERROR", "Train Data Cannot Be Created!", str_file);
+    }
+    else
+    {
+      fprintf(stdout, "[%6s][%s][%s][%llu]\n", "INFO", "Train Data Generated", str_file, (unsigned long long) rows);
+      rows_total += rows;
+    }
+  }
+  fprintf(stdout, "[%6s][%s][%llu]\n", "INFO", "Total Rows", (unsigned long long) rows_total);
+
+  datagen_network_free(net);
+  return (err < 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
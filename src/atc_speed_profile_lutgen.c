@@ -0,0 +1,102 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "atc_speed_profile_tool.h"
+#include "log.h"
+#include "lut_embed.h"
+
+/** @brief  display generator usage
+ *  @return none
+ */
+static void
+display_lutgen_usage(char **argv)
+{
+  printf("USAGE: %s [OPTION]...\n", strip_path(argv[0]));
+  printf("generate C source of a lookup table, built into the tool with -DATC_EMBEDDED_LUT\n");
+  printf("\n");
+  printf("OPTIONS:\n");
+  printf("  %-22s %s\n", "--lut FILE", "lookup table file (default " BLOCK_LUT_FILE ")");
+  printf("  %-22s %s\n", "--out FILE", "generated source (default " LUT_EMBED_SOURCE_FILE ")");
+  printf("\n");
+}
+
+/*
+** Main Program Code
+*/
+int
+main(int argc, char *argv[])
+{
+  const char *str_lut_file = BLOCK_LUT_FILE;
+  const char *str_out_file = LUT_EMBED_SOURCE_FILE;
+  char str_lut_path[STR_MAX] = "";
+  atcContext *ctx = NULL;
+  toolStats stats = {0};
+  FILE *fp = NULL;
+  int err = 0;
+  int i = 0;
+
+  for (i = 1; i < argc; i++)
+  {
+    if (i + 1 >= argc)
+    {
+      display_lutgen_usage(argv);
+      return EXIT_FAILURE;
+    }
+    if (0 == strcmp(argv[i], "--lut"))
+    {
+      str_lut_file = argv[++i];
+    }
+    else if (0 == strcmp(argv[i], "--out"))
+    {
+      str_out_file = argv[++i];
+    }
+    else
+    {
+      display_lutgen_usage(argv);
+      return EXIT_FAILURE;
+    }
+  }
+  if (strlen(str_lut_file) >= STR_MAX)
+  {
+    fprintf(stdout, "[%6s][%s]\n", "ERROR", "Lookup Table File Name Too Long!");
+    return EXIT_FAILURE;
+  }
+  strcpy(str_lut_path, str_lut_file);
+  log_set_level(LOG_INFO);
+
+  if (NULL == (ctx = atc_context_create()))
+  {
+    fprintf(stdout, "[%6s][%s]\n", "ERROR", "Not Enough Memory!");
+    return EXIT_FAILURE;
+  }
+  if ((err = atc_read_lut_file(ctx, str_lut_path)) < 0)
+  {
+    fprintf(stdout, "[%6s][%s][%s][%s]\n", "ERROR", "Lookup Table Import Failed!", get_err_description(err), str_lut_file);
+  }
+  else if (NULL == (fp = fopen(str_out_file, "w")))
+  {
+    fprintf(stdout, "[%6s][%s][%s]\n", "ERROR", "Generated Source Cannot Be Created!", str_out_file);
+    err = throw_err(err_file_not_accessible);
+  }
+  else
+  {
+    err = atc_write_embedded_lut(ctx, str_lut_file, fp);
+    if ((0 != fclose(fp)) && (err >= 0))
+    {
+      err = throw_err(err_file_not_accessible);
+    }
+    if (err < 0)
+    {
+      fprintf(stdout, "[%6s][%s][%s][%s]\n", "ERROR", "Generated Source Not Written!", get_err_description(err), str_out_file);
+      remove(str_out_file);
+    }
+    else
+    {
+      atc_get_tool_stats(ctx, &stats);
+      fprintf(stdout, "[%6s][%s][%s][%llu]\n", "INFO", "Lookup Table Generated", str_out_file, (unsigned long long) stats.lut_cnt);
+    }
+  }
+
+  atc_context_free(ctx);
+  return (err < 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
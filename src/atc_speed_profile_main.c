@@ -3,164 +3,312 @@
 # else
 #   include <windows.h> 
 # endif 
+#include <signal.h>
 #include "atc_speed_profile_tool.h"
+#include "async_writer.h"
+#include "log.h"
+#include "profiler.h"
+#include "server.h"
+#include "watch.h"
 
-/* 
-** Main Program Code
-*/
-int 
-main(int argc, char *argv[])
+/* wait of one watch poll, the stop request is checked in between, ms */
+#define WATCH_POLL_MS 1000
+/* maximum number of train data files followed at once */
+#define FOLLOW_MAX_FILE 16
+
+/* train data file followed by its own context */
+typedef struct follow_file_t
 {
-  int len_data_file_name = 0; 
-  char str_data_file[STR_MAX] = "";
-  char str_input_file_list[FILE_LIST_MAX_LENGTH][STR_MAX] = {""};
+  char path[STR_MAX];
+  atcContext *ctx;
+  /* file size at the last poll, -1 before the first */
+  long long last_size;
+  /* time of the last update, the least recent is closed for a new file */
+  double last_update_s;
+} followFile;
 
-  int err = 0; 
-  bool b_enabled = true;
+/* list heap high-water mark of each stage, indexed by enum profile_stage */
+static uint64_t stage_list_bytes[k_stage_cnt] = {0};
+static bool b_stage_run[k_stage_cnt] = {false};
+/* set by SIGINT or SIGTERM to leave the resident mode */
+static volatile sig_atomic_t b_watch_stop = 0;
+/* files followed in the follow mode */
+static followFile follow_files[FOLLOW_MAX_FILE];
+/* block run time csv each job adds to, NULL keeps no statistics */
+static const char *str_block_stats_file = NULL;
+/* input rows kept by each job, [time_from, time_to), -1 for no bound */
+static time_t time_from = -1;
+static time_t time_to = -1;
+static bool b_time_ordered = false;
+/* trains and departing stations kept by each job, all when none given */
+static bool b_cc_kept[CC_ID_MAX + 1] = {false};
+static const char *str_station_filter[STATION_FILTER_MAX] = {NULL};
+static int station_filter_cnt = 0;
+static const char *str_platform_filter = NULL;
 
+/** @brief  set the time window, train and station filters of a job
+ *  @param  *ctx  context
+ *  @return none
+ */
+static void
+set_job_filters(atcContext *ctx)
+{
   int i = 0;
-  int input_file_cnt = 0;
 
-  /* display usage */
-  display_usage(argv);
+  atc_set_time_window(ctx, time_from, time_to, b_time_ordered);
+  for (i = 1; i <= CC_ID_MAX; i++)
+  {
+    if (b_cc_kept[i])
+    {
+      atc_add_cc_filter(ctx, i);
+    }
+  }
+  for (i = 0; i < station_filter_cnt; i++)
+  {
+    atc_add_station_filter(ctx, str_station_filter[i], str_platform_filter);
+  }
+}
 
-  /* check command line format */
-  if (argc > FILE_LIST_MAX_LENGTH)
+/** @brief  open a stage, taking the processing counters and restarting
+ *          the list heap high-water mark
+ *  @param  *ctx         context
+ *  @param  stage        enum profile_stage
+ *  @param  *stats_prev  processing counters output
+ *  @return none
+ */
+static void
+stage_begin(atcContext *ctx, int stage, toolStats *stats_prev)
+{
+  atc_get_tool_stats(ctx, stats_prev);
+  atc_reset_list_memory_high_water(ctx);
+  profile_stage_begin(stage);
+}
+
+/** @brief  close a stage, recording its list heap high-water mark and,
+ *          when profiled, deriving its row and byte counts from the 
+ *          processing counters taken when the stage began
+ *  @param  *ctx         context
+ *  @param  stage        enum profile_stage
+ *  @param  *stats_prev  processing counters at the start of the stage
+ *  @return none
+ */
+static void
+stage_end(atcContext *ctx, int stage, const toolStats *stats_prev)
+{
+  toolStats stats = {0};
+
+  atc_get_tool_stats(ctx, &stats);
+  b_stage_run[stage] = true;
+  if (stats.list_bytes_high_water > stage_list_bytes[stage])
   {
-    fprintf
-    (
-      stdout, 
-      "[%6s][%s]\n", 
-      "ERROR", 
-      "Command Line Arguments Too Many!"
-    );
-    fprintf
-    (
-      stdout, 
-      "[%6s][%s%d]\n", 
-      "ERROR", 
-      "Maximum number of input files is ",
-      FILE_LIST_MAX_LENGTH
-    );
-    return EXIT_FAILURE;
+    stage_list_bytes[stage] = stats.list_bytes_high_water;
   }
-  else if (argc < 2)
+  if (!profile_is_enabled())
   {
-    fprintf
-    (
-      stdout, 
-      "[%6s][%s]\n", 
-      "ERROR", 
-      "CSV Data File Not Defined!"
-    );
-    return EXIT_FAILURE;
+    return;
   }
-  else
+  switch (stage)
   {
-    for (i = 1; i < argc; i++)
-    {
-      if (NULL == argv[i])
-      {
-        fprintf
-        (
-          stdout, 
-          "[%6s][%s]\n", 
-          "ERROR", 
-          "CSV Data File Not Defined!"
-        );
-        return EXIT_FAILURE;
-      }
-      else if (strlen(argv[i]) >= STR_MAX)
-      {
-        fprintf
-        (
-          stdout, 
-          "[%6s][%s]\n", 
-          "ERROR", 
-          "CSV Data File Name Too Long!"
-        );
-        return EXIT_FAILURE;
-      }
-      strcpy(str_data_file, argv[i]);
-
-      /* check extension is csv */
-      if 
+    case k_stage_lut_import:
+      profile_stage_end
       (
-        ((len_data_file_name = strlen(str_data_file)) <= 4) ||
-        (strcmp(str_data_file+(len_data_file_name-4), ".csv") != 0)
-      )
-      {
-        fprintf
-        (
-          stdout, 
-          "[%6s][%s]\n", 
-          "ERROR", 
-          "Data File Must Be CSV!"
-        );
-        return EXIT_FAILURE;
-      }
-      else
-      {
-        strcpy(str_input_file_list[input_file_cnt], argv[i]);
-        input_file_cnt++;
-      }
-    }    
+        stage, 
+        stats.lut_lines_read - stats_prev->lut_lines_read,
+        stats.lut_cnt - stats_prev->lut_cnt,
+        stats.lut_bytes_read - stats_prev->lut_bytes_read,
+        0
+      );
+      break;
+    case k_stage_data_import:
+      profile_stage_end
+      (
+        stage, 
+        stats.input_lines_read - stats_prev->input_lines_read,
+        stats.input_cnt - stats_prev->input_cnt,
+        stats.input_bytes_read - stats_prev->input_bytes_read,
+        0
+      );
+      break;
+    case k_stage_sort:
+      profile_stage_end(stage, stats.input_cnt, stats.input_cnt, 0, 0);
+      break;
+    case k_stage_preprocess:
+      profile_stage_end
+      (
+        stage, 
+        stats.input_cnt, 
+        stats.input_expanded - stats_prev->input_expanded,
+        0,
+        0
+      );
+      break;
+    case k_stage_calculate:
+      profile_stage_end
+      (
+        stage, 
+        stats.input_cnt, 
+        stats.output_cnt - stats_prev->output_cnt,
+        0,
+        0
+      );
+      break;
+    case k_stage_export:
+      profile_stage_end
+      (
+        stage, 
+        stats.output_cnt, 
+        stats.files_written - stats_prev->files_written,
+        0,
+        stats.bytes_written - stats_prev->bytes_written
+      );
+      break;
+    default:
+      break;
   }
+}
 
-  if (input_file_cnt < 1 || input_file_cnt > FILE_LIST_MAX_LENGTH)
+/** @brief  format bytes per input row, "-" when there are no rows to
+ *          divide by
+ *  @param  *buf   destination buffer
+ *  @param  size   destination buffer size in bytes
+ *  @param  bytes  heap bytes
+ *  @param  rows   input rows read, 0 if none or not related to the rows
+ *  @return buf
+ */
+static char *
+format_bytes_per_row(char *buf, size_t size, uint64_t bytes, uint64_t rows)
+{
+  if (0 == rows)
   {
-    fprintf
-    (
-      stdout, 
-      "[%6s][%s]\n", 
-      "ERROR", 
-      "No Valid Input Files!"
-    );
-    return EXIT_FAILURE;
+    snprintf(buf, size, "%s", "-");
   }
-  
-  init_lut_data_list();
-  init_input_data_list();
-  init_output_data_list(); 
+  else
+  {
+    snprintf(buf, size, "%.0f", (double) bytes / rows);
+  }
+  return buf;
+}
+
+/** @brief  print heap bytes held by each list and the high-water mark
+ *          of each stage, bytes per row are per input row read by the 
+ *          context. the lookup table does not grow with the rows, and a
+ *          context without rows, such as the lookup table context of the
+ *          resident modes, has no bytes per row
+ *  @param  *ctx  context
+ *  @param  *fp   output stream
+ *  @return none
+ */
+static void
+print_memory_summary(atcContext *ctx, FILE *fp)
+{
+  static const char *list_names[k_list_cnt] = {"lut", "input", "output"};
+  toolStats stats = {0};
+  listMemory mem = {0};
+  char str_per_row[STR_SHORT] = "";
+  uint64_t peak_total = 0;
+  uint64_t rows = 0;
+  int i = 0;
+
+  atc_get_tool_stats(ctx, &stats);
+  rows = stats.input_lines_read;
 
-  /* read lookup file */
+  fprintf(fp, "[%6s][%s]\n", "INFO", "Memory Summary");
   fprintf
   (
-    stdout, 
-    "[%6s][%s][%s]\n", 
+    fp, 
+    "[%6s][%-11s][%12s][%12s][%10s][%10s][%14s][%14s][%10s]\n", 
     "INFO", 
-    "Import Configuration Files...", 
-    BLOCK_LUT_FILE
+    "LIST", 
+    "ELEMENTS", 
+    "PEAK_ELEM", 
+    "ELEMENT_B", 
+    "NODE_B", 
+    "BYTES", 
+    "PEAK_BYTES", 
+    "BYTES/ROW"
   );
-  err = read_lut_file(BLOCK_LUT_FILE);
-  if (err < 0)
+  for (i = 0; i < k_list_cnt; i++)
   {
+    atc_get_list_memory(ctx, i, &mem);
+    peak_total += mem.peak_bytes;
     fprintf
     (
-      stdout, 
-      "[%6s][%s][%s][%s]\n", 
+      fp, 
+      "[%6s][%-11s][%12" PRIu64 "][%12" PRIu64 "][%10" PRIu64 "][%10" PRIu64 "][%14" PRIu64 "][%14" PRIu64 "][%10s]\n", 
       "INFO", 
-      "Configuration Files Import Failed!", 
-      get_err_description(err), 
-      BLOCK_LUT_FILE
+      list_names[i], 
+      mem.cnt, 
+      mem.peak_cnt, 
+      mem.element_size, 
+      mem.node_size, 
+      mem.bytes, 
+      mem.peak_bytes, 
+      format_bytes_per_row(str_per_row, STR_SHORT, mem.peak_bytes, (k_list_lut == i) ? 0 : rows)
     );
-    b_enabled = false;
   }
-  else
+  fprintf
+  (
+    fp, 
+    "[%6s][%-11s][%12s][%12s][%10s][%10s][%14" PRIu64 "][%14" PRIu64 "][%10s]\n", 
+    "INFO", 
+    "total", 
+    "", 
+    "", 
+    "", 
+    "", 
+    stats.list_bytes, 
+    peak_total, 
+    format_bytes_per_row(str_per_row, STR_SHORT, peak_total, rows)
+  );
+
+  fprintf
+  (
+    fp, 
+    "[%6s][%-11s][%14s][%10s]\n", 
+    "INFO", 
+    "STAGE", 
+    "HIGH_WATER_B", 
+    "BYTES/ROW"
+  );
+  for (i = 0; i < k_stage_cnt; i++)
   {
+    if (!b_stage_run[i])
+    {
+      continue;
+    }
     fprintf
     (
-      stdout, 
-      "[%6s][%s]\n", 
+      fp, 
+      "[%6s][%-11s][%14" PRIu64 "][%10s]\n", 
       "INFO", 
-      "Configuration Files Imported Successfully!" 
+      profile_stage_name(i), 
+      stage_list_bytes[i], 
+      format_bytes_per_row(str_per_row, STR_SHORT, stage_list_bytes[i], (k_stage_lut_import == i) ? 0 : rows)
     );
   }
+}
+
+/** @brief  process train data files of one job with a lookup table already
+ *          loaded: import, sort, preprocess, calculate and export
+ *  @param  *ctx                  context
+ *  @param  str_input_file_list   train data file paths
+ *  @param  input_file_cnt        number of train data files
+ *  @return true                  all stages succeeded
+ *          false                 a stage failed, later stages are skipped
+ */
+static bool
+run_job(atcContext *ctx, char str_input_file_list[][STR_MAX], int input_file_cnt)
+{
+  char *str_data_file = NULL;
+  toolStats stats_prev = {0};
+  bool b_enabled = true;
+  int err = 0;
+  int i = 0;
 
   /* read input data file */
   for (i = 0; i < input_file_cnt; i++)
   {
-    strcpy(str_data_file, str_input_file_list[i]);
+    str_data_file = str_input_file_list[i];
     if (b_enabled)
     {
       fprintf
@@ -171,7 +319,10 @@ main(int argc, char *argv[])
         "Import Data Files...", 
         str_data_file
       );
-      err = read_input_file(str_data_file);
+      stage_begin(ctx, k_stage_data_import, &stats_prev);
+      err = atc_read_input_file(ctx, str_data_file);
+      stage_end(ctx, k_stage_data_import, &stats_prev);
+      log_flush();
       if (err < 0)
       {
         fprintf
@@ -198,6 +349,35 @@ main(int argc, char *argv[])
     }
   }
 
+  /* no complete line added to a followed file yet */
+  if (b_enabled && (atc_follow_offset(ctx) >= 0))
+  {
+    atc_get_tool_stats(ctx, &stats_prev);
+    if (0 == stats_prev.input_cnt)
+    {
+      return true;
+    }
+  }
+
+  /* every row may be outside the time window */
+  if (b_enabled && ((time_from >= 0) || (time_to >= 0)))
+  {
+    atc_get_tool_stats(ctx, &stats_prev);
+    fprintf
+    (
+      stdout,
+      "[%6s][%s][%llu]\n",
+      "INFO",
+      "Rows Read Outside Time Window",
+      (unsigned long long) stats_prev.input_filtered
+    );
+    if (0 == stats_prev.input_cnt)
+    {
+      fprintf(stdout, "[%6s][%s]\n", "INFO", "No Data Within Time Window!");
+      return true;
+    }
+  }
+
   /* sort the input data list */
   if (b_enabled)
   {
@@ -208,7 +388,10 @@ main(int argc, char *argv[])
       "INFO", 
       "Sort Input Data..."
     );    
-    err = sort_input_data_list();
+    stage_begin(ctx, k_stage_sort, &stats_prev);
+    err = atc_sort_input_data_list(ctx);
+    stage_end(ctx, k_stage_sort, &stats_prev);
+    log_flush();
     if (err < 0)
     {
       fprintf
@@ -243,7 +426,10 @@ main(int argc, char *argv[])
       "INFO", 
       "Preprocess Input Data..."
     );
-    err = expand_data_list_use_lut();
+    stage_begin(ctx, k_stage_preprocess, &stats_prev);
+    err = atc_expand_data_list_use_lut(ctx);
+    stage_end(ctx, k_stage_preprocess, &stats_prev);
+    log_flush();
     if (err < 0)
     {
       fprintf
@@ -278,7 +464,10 @@ main(int argc, char *argv[])
       "INFO", 
       "Calculate Speed Profiles..."
     );
-    err = calculate_output_data_list();
+    stage_begin(ctx, k_stage_calculate, &stats_prev);
+    err = atc_calculate_output_data_list(ctx);
+    stage_end(ctx, k_stage_calculate, &stats_prev);
+    log_flush();
     if (err < 0)
     {
       fprintf
@@ -303,6 +492,41 @@ main(int argc, char *argv[])
     }
   } 
 
+  /* block run times, a failure leaves the run profiles to export */
+  if (b_enabled && (NULL != str_block_stats_file))
+  {
+    fprintf
+    (
+      stdout, 
+      "[%6s][%s]\n", 
+      "INFO", 
+      "Aggregate Block Run Times..."
+    );
+    err = atc_update_block_stats(ctx, str_block_stats_file);
+    if (err < 0)
+    {
+      fprintf
+      (
+        stdout, 
+        "[%6s][%s][%s][%s]\n", 
+        "INFO", 
+        "Block Run Times Not Saved!", 
+        get_err_description(err),
+        str_block_stats_file
+      );
+    }
+    else
+    {
+      fprintf
+      (
+        stdout, 
+        "[%6s][%s]\n", 
+        "INFO", 
+        "Block Run Times Saved Successfully!" 
+      );
+    }
+  }
+
   /* output to several csv file, one file per start-stop per train */
   if (b_enabled)
   {
@@ -313,7 +537,10 @@ main(int argc, char *argv[])
       "INFO", 
       "Export Speed Profiles..." 
     );
-    err = export_run_profile_file();
+    stage_begin(ctx, k_stage_export, &stats_prev);
+    err = atc_export_run_profile_file(ctx);
+    stage_end(ctx, k_stage_export, &stats_prev);
+    log_flush();
     if (err < 0)
     {
       fprintf
@@ -336,13 +563,1000 @@ main(int argc, char *argv[])
         "Speed Profiles Exported Successfully!" 
       );
     }
-  }  
-  
+  }
+
+  return b_enabled;
+}
+
+/** @brief  request the resident mode to stop after the current file
+ *  @param  sig  signal number
+ *  @return none
+ */
+static void
+watch_stop_handler(int sig)
+{
+  (void) sig;
+  b_watch_stop = 1;
+}
+
+/** @brief  pause the polling loop
+ *  @param  ms  milliseconds
+ *  @return none
+ */
+static void
+sleep_ms(int ms)
+{
+#ifdef _WIN32
+  Sleep(ms);
+#else
+  usleep((useconds_t) ms * 1000);
+#endif
+}
+
+/** @brief  create the context of one job sharing the loaded lookup table
+ *  @param  *ctx                context holding the lookup table
+ *  @param  async_queue_depth   background export queue depth
+ *  @param  b_fsync             flush run profiles to disk after export
+ *  @return NULL                not enough memory
+ *          new context
+ */
+static atcContext *
+create_job(atcContext *ctx, int async_queue_depth, bool b_fsync)
+{
+  atcContext *job = NULL;
+
+  if ((NULL == (job = atc_context_create())) || 
+      (atc_context_share_lut(job, ctx) < 0))
+  {
+    fprintf
+    (
+      stdout, 
+      "[%6s][%s]\n", 
+      "ERROR", 
+      "Not Enough Memory!"
+    );
+    atc_context_free(job);
+    return NULL;
+  }
+  atc_set_async_export(job, async_queue_depth, b_fsync);
+  set_job_filters(job);
+  return job;
+}
+
+/** @brief  export the runs still held back for a followed file and stop
+ *          following it
+ *  @param  *p_file  followed file
+ *  @return none
+ */
+static void
+follow_close(followFile *p_file)
+{
+  toolStats stats_prev = {0};
+  int err = 0;
+
+  fprintf
+  (
+    stdout, 
+    "[%6s][%s][%s]\n", 
+    "INFO", 
+    "Close Followed File...", 
+    p_file->path
+  );
+  atc_follow_close_runs(p_file->ctx);
+  stage_begin(p_file->ctx, k_stage_export, &stats_prev);
+  err = atc_export_run_profile_file(p_file->ctx);
+  stage_end(p_file->ctx, k_stage_export, &stats_prev);
+  log_flush();
+  if (err < 0)
+  {
+    fprintf
+    (
+      stdout, 
+      "[%6s][%s][%s]\n", 
+      "INFO", 
+      "Speed Profiles Export Failed!", 
+      get_err_description(err) 
+    );
+  }
+  atc_context_free(p_file->ctx);
+  memset(p_file, 0, sizeof(followFile));
+}
+
+/** @brief  find the context following a file, starting to follow it if
+ *          needed. when FOLLOW_MAX_FILE files are followed already, the
+ *          one not updated for the longest time is closed first.
+ *  @param  *ctx                context holding the lookup table
+ *  @param  *str_file           train data file path
+ *  @param  async_queue_depth   background export queue depth
+ *  @param  b_fsync             flush run profiles to disk after export
+ *  @return NULL                not enough memory
+ *          followed file
+ */
+static followFile *
+follow_get(atcContext *ctx, const char *str_file, int async_queue_depth, bool b_fsync)
+{
+  followFile *p_file = NULL;
+  int i = 0;
+
+  for (i = 0; i < FOLLOW_MAX_FILE; i++)
+  {
+    if ((NULL != follow_files[i].ctx) && (0 == strcmp(follow_files[i].path, str_file)))
+    {
+      return &follow_files[i];
+    }
+  }
+  for (i = 0; i < FOLLOW_MAX_FILE; i++)
+  {
+    if ((NULL == p_file) || 
+        (NULL == follow_files[i].ctx) || 
+        ((NULL != p_file->ctx) && (follow_files[i].last_update_s < p_file->last_update_s)))
+    {
+      p_file = &follow_files[i];
+    }
+  }
+  if (NULL != p_file->ctx)
+  {
+    follow_close(p_file);
+  }
+  if (NULL == (p_file->ctx = create_job(ctx, async_queue_depth, b_fsync)))
+  {
+    return NULL;
+  }
+  if (atc_follow_enable(p_file->ctx) < 0)
+  {
+    atc_context_free(p_file->ctx);
+    p_file->ctx = NULL;
+    return NULL;
+  }
+  strcpy(p_file->path, str_file);
+  p_file->last_size = -1;
+  return p_file;
+}
+
+/** @brief  process the lines added to a followed file since its last 
+ *          update, only completed runs are exported
+ *  @param  *p_file  followed file
+ *  @return none
+ */
+static void
+follow_update(followFile *p_file)
+{
+  p_file->last_update_s = profile_wall_time();
+  run_job(p_file->ctx, &p_file->path, 1);
+  err_report_print(stdout);
+  err_report_reset();
+  fflush(stdout);
+}
+
+/** @brief  close every followed file
+ *  @return none
+ */
+static void
+follow_close_all()
+{
+  int i = 0;
+
+  for (i = 0; i < FOLLOW_MAX_FILE; i++)
+  {
+    if (NULL != follow_files[i].ctx)
+    {
+      follow_close(&follow_files[i]);
+    }
+  }
+}
+
+/** @brief  follow the train data files given on the command line, polling
+ *          their size, until SIGINT or SIGTERM
+ *  @param  *ctx                  context holding the lookup table
+ *  @param  str_input_file_list   train data file paths
+ *  @param  input_file_cnt        number of train data files
+ *  @param  async_queue_depth     background export queue depth
+ *  @param  b_fsync               flush run profiles to disk after export
+ *  @return none
+ */
+static void
+follow_listed_files(atcContext *ctx, char str_input_file_list[][STR_MAX], 
+                    int input_file_cnt, int async_queue_depth, bool b_fsync)
+{
+  followFile *p_file = NULL;
+  struct stat st;
+  int i = 0;
+
+  if (input_file_cnt > FOLLOW_MAX_FILE)
+  {
+    fprintf
+    (
+      stdout, 
+      "[%6s][%s%d]\n", 
+      "ERROR", 
+      "Maximum number of followed files is ",
+      FOLLOW_MAX_FILE
+    );
+    return;
+  }
+  signal(SIGINT, watch_stop_handler);
+  signal(SIGTERM, watch_stop_handler);
+  while (!b_watch_stop)
+  {
+    for (i = 0; (i < input_file_cnt) && !b_watch_stop; i++)
+    {
+      if ((0 != stat(str_input_file_list[i], &st)) ||
+          (NULL == (p_file = follow_get(ctx, str_input_file_list[i], async_queue_depth, b_fsync))) ||
+          (p_file->last_size == (long long) st.st_size))
+      {
+        continue;
+      }
+      p_file->last_size = (long long) st.st_size;
+      follow_update(p_file);
+    }
+    sleep_ms(WATCH_POLL_MS);
+  }
+  signal(SIGINT, SIG_DFL);
+  signal(SIGTERM, SIG_DFL);
+  follow_close_all();
+}
+
+/** @brief  resident mode, process each train data file landing in a 
+ *          directory until SIGINT or SIGTERM. each file is its own job
+ *          sharing the loaded lookup table, when following a file keeps
+ *          its job and every write processes the lines added.
+ *  @param  *ctx                context holding the lookup table
+ *  @param  *str_dir            directory to watch
+ *  @param  b_follow            follow growing files
+ *  @param  async_queue_depth   background export queue depth of each job
+ *  @param  b_fsync             flush run profiles to disk after export
+ *  @return none
+ */
+static void
+watch_dir(atcContext *ctx, const char *str_dir, bool b_follow, 
+          int async_queue_depth, bool b_fsync)
+{
+  char str_file_list[1][STR_MAX] = {""};
+  watchDir *watch = NULL;
+  atcContext *job = NULL;
+  followFile *p_file = NULL;
+  int err = 0;
+
+  if (NULL == (watch = watch_open(str_dir, b_follow)))
+  {
+    fprintf
+    (
+      stdout, 
+      "[%6s][%s][%s]\n", 
+      "ERROR", 
+      WATCH_SUPPORTED ? "Watch Directory Cannot Be Opened!" : "Watch Mode Not Supported!", 
+      str_dir
+    );
+    return;
+  }
+  signal(SIGINT, watch_stop_handler);
+  signal(SIGTERM, watch_stop_handler);
+  fprintf
+  (
+    stdout, 
+    "[%6s][%s][%s]\n", 
+    "INFO", 
+    "Watching For Train Data Files...", 
+    str_dir
+  );
+  fflush(stdout);
+
+  while (!b_watch_stop)
+  {
+    err = watch_next(watch, str_file_list[0], STR_MAX, WATCH_POLL_MS);
+    if (err < 0)
+    {
+      fprintf
+      (
+        stdout, 
+        "[%6s][%s][%s][%s]\n", 
+        "ERROR", 
+        "Watch Directory Failed!", 
+        get_err_description(err), 
+        str_dir
+      );
+      break;
+    }
+    if (0 == err)
+    {
+      continue;
+    }
+    if (b_follow)
+    {
+      if (NULL == (p_file = follow_get(ctx, str_file_list[0], async_queue_depth, b_fsync)))
+      {
+        break;
+      }
+      follow_update(p_file);
+      continue;
+    }
+    if (NULL == (job = create_job(ctx, async_queue_depth, b_fsync)))
+    {
+      break;
+    }
+    run_job(job, str_file_list, 1);
+    err_report_print(stdout);
+    err_report_reset();
+    atc_context_free(job);
+    fflush(stdout);
+  }
+
+  signal(SIGINT, SIG_DFL);
+  signal(SIGTERM, SIG_DFL);
+  follow_close_all();
+  watch_close(watch);
+}
+
+/** @brief  resident job server, run the jobs submitted over a local socket
+ *          until SHUTDOWN, SIGINT or SIGTERM. each job is its own context
+ *          sharing the loaded lookup table.
+ *  @param  *ctx                context holding the lookup table
+ *  @param  *str_socket         socket path
+ *  @param  worker_cnt          jobs run at once
+ *  @param  async_queue_depth   background export queue depth of each job
+ *  @return none
+ */
+static void
+serve_jobs(atcContext *ctx, const char *str_socket, int worker_cnt,
+           int async_queue_depth)
+{
+  int err = 0;
+
+  signal(SIGINT, watch_stop_handler);
+  signal(SIGTERM, watch_stop_handler);
+  fprintf
+  (
+    stdout,
+    "[%6s][%s][%s][%d]\n",
+    "INFO",
+    "Serving Jobs...",
+    str_socket,
+    worker_cnt
+  );
+  fflush(stdout);
+
+  err = server_run(ctx, str_socket, worker_cnt, async_queue_depth, &b_watch_stop);
+  if (err < 0)
+  {
+    fprintf
+    (
+      stdout,
+      "[%6s][%s][%s][%s]\n",
+      "ERROR",
+      SERVER_SUPPORTED ? "Server Socket Cannot Be Opened!" : "Serve Mode Not Supported!",
+      get_err_description(err),
+      str_socket
+    );
+  }
+
+  signal(SIGINT, SIG_DFL);
+  signal(SIGTERM, SIG_DFL);
+}
+
+/* 
+** Main Program Code
+*/
+int 
+main(int argc, char *argv[])
+{
+  int len_data_file_name = 0; 
+  char str_data_file[STR_MAX] = "";
+  char str_err[STR_MAX] = "";
+  char str_input_file_list[FILE_LIST_MAX_LENGTH][STR_MAX] = {""};
+
+  int err = 0; 
+  bool b_enabled = true;
+
+  int i = 0;
+  int input_file_cnt = 0;
+  /* background export queue depth, 0 - export synchronously */
+  int async_queue_depth = 0;
+  bool b_fsync = false;
+  /* runtime log filtering and sinks */
+  int log_level = LOG_INFO;
+  long log_buffer_size = LOG_BUFFER_DEFAULT;
+  FILE *fp_log = NULL;
+  /* per stage timing report, optional json copy */
+  bool b_profile = false;
+  char *str_profile_json = NULL;
+  /* resident mode directory, NULL processes the listed files and exits */
+  char *str_watch_dir = NULL;
+  /* process only the lines added to growing files */
+  bool b_follow = false;
+  /* job server socket, NULL runs no server */
+  char *str_serve_socket = NULL;
+  int server_worker_cnt = SERVER_DEFAULT_WORKERS;
+  /* map the compiled lookup table image instead of parsing the csv */
+  bool b_lut_cache = true;
+  bool b_lut_verify = false;
+  /* lookup table csv, the table built into the binary is used unless one
+  ** is given on the command line */
+  char str_lut_file[STR_MAX] = BLOCK_LUT_FILE;
+  bool b_lut_file = false;
+  bool b_embedded_lut = false;
+  bool b_lut_ready = false;
+  /* --cc list parsing */
+  char *p_cc = NULL;
+  char *p_end = NULL;
+  long cc_id = 0;
+  toolStats stats_prev = {0};
+  atcContext *ctx = NULL;
+
+  /* display usage */
+  display_usage(argv);
+
+  /* check command line format */
+  if (argc > FILE_LIST_MAX_LENGTH)
+  {
+    fprintf
+    (
+      stdout, 
+      "[%6s][%s]\n", 
+      "ERROR", 
+      "Command Line Arguments Too Many!"
+    );
+    fprintf
+    (
+      stdout, 
+      "[%6s][%s%d]\n", 
+      "ERROR", 
+      "Maximum number of input files is ",
+      FILE_LIST_MAX_LENGTH
+    );
+    return EXIT_FAILURE;
+  }
+  else if (argc < 2)
+  {
+    fprintf
+    (
+      stdout, 
+      "[%6s][%s]\n", 
+      "ERROR", 
+      "CSV Data File Not Defined!"
+    );
+    return EXIT_FAILURE;
+  }
+  else
+  {
+    for (i = 1; i < argc; i++)
+    {
+      if (NULL == argv[i])
+      {
+        fprintf
+        (
+          stdout, 
+          "[%6s][%s]\n", 
+          "ERROR", 
+          "CSV Data File Not Defined!"
+        );
+        return EXIT_FAILURE;
+      }
+      else if (strlen(argv[i]) >= STR_MAX)
+      {
+        fprintf
+        (
+          stdout, 
+          "[%6s][%s]\n", 
+          "ERROR", 
+          "CSV Data File Name Too Long!"
+        );
+        return EXIT_FAILURE;
+      }
+      /* command line options */
+      if (0 == strcmp(argv[i], "--async-export"))
+      {
+        /* background export with the default queue depth */
+        if (async_queue_depth <= 0)
+        {
+          async_queue_depth = ASYNC_WRITER_DEFAULT_DEPTH;
+        }
+        continue;
+      }
+      else if (0 == strcmp(argv[i], "--queue-depth"))
+      {
+        if ((i + 1 >= argc) || ((async_queue_depth = atoi(argv[i + 1])) <= 0))
+        {
+          fprintf
+          (
+            stdout, 
+            "[%6s][%s]\n", 
+            "ERROR", 
+            "Queue Depth Must Be A Positive Number!"
+          );
+          return EXIT_FAILURE;
+        }
+        i++;
+        continue;
+      }
+      else if (0 == strcmp(argv[i], "--fsync"))
+      {
+        b_fsync = true;
+        continue;
+      }
+      else if (0 == strcmp(argv[i], "--log-level"))
+      {
+        if ((i + 1 >= argc) || 
+            ((log_level = log_level_from_string(argv[i + 1])) < 0))
+        {
+          fprintf
+          (
+            stdout, 
+            "[%6s][%s]\n", 
+            "ERROR", 
+            "Log Level Must Be TRACE, DEBUG, INFO, WARN, ERROR or FATAL!"
+          );
+          return EXIT_FAILURE;
+        }
+        i++;
+        continue;
+      }
+      else if (0 == strcmp(argv[i], "--log-buffer"))
+      {
+        if ((i + 1 >= argc) || ((log_buffer_size = atol(argv[i + 1])) < 0))
+        {
+          fprintf
+          (
+            stdout, 
+            "[%6s][%s]\n", 
+            "ERROR", 
+            "Log Buffer Size Must Not Be Negative!"
+          );
+          return EXIT_FAILURE;
+        }
+        i++;
+        continue;
+      }
+      else if (0 == strcmp(argv[i], "--log-file"))
+      {
+        if ((i + 1 >= argc) || (NULL != fp_log) ||
+            (NULL == (fp_log = fopen(argv[i + 1], "a"))))
+        {
+          fprintf
+          (
+            stdout, 
+            "[%6s][%s]\n", 
+            "ERROR", 
+            "Log File Cannot Be Opened!"
+          );
+          return EXIT_FAILURE;
+        }
+        i++;
+        continue;
+      }
+      else if (0 == strcmp(argv[i], "--profile"))
+      {
+        b_profile = true;
+        continue;
+      }
+      else if (0 == strcmp(argv[i], "--profile-json"))
+      {
+        if (i + 1 >= argc)
+        {
+          fprintf
+          (
+            stdout, 
+            "[%6s][%s]\n", 
+            "ERROR", 
+            "Profile Json File Not Defined!"
+          );
+          return EXIT_FAILURE;
+        }
+        b_profile = true;
+        str_profile_json = argv[i + 1];
+        i++;
+        continue;
+      }
+      else if (0 == strcmp(argv[i], "--follow"))
+      {
+        b_follow = true;
+        continue;
+      }
+      else if (0 == strcmp(argv[i], "--watch"))
+      {
+        if (i + 1 >= argc)
+        {
+          fprintf
+          (
+            stdout, 
+            "[%6s][%s]\n", 
+            "ERROR", 
+            "Watch Directory Not Defined!"
+          );
+          return EXIT_FAILURE;
+        }
+        str_watch_dir = argv[i + 1];
+        i++;
+        continue;
+      }
+      else if (0 == strcmp(argv[i], "--lut"))
+      {
+        if (i + 1 >= argc)
+        {
+          fprintf
+          (
+            stdout, 
+            "[%6s][%s]\n", 
+            "ERROR", 
+            "Lookup Table File Not Defined!"
+          );
+          return EXIT_FAILURE;
+        }
+        strcpy(str_lut_file, argv[i + 1]);
+        b_lut_file = true;
+        i++;
+        continue;
+      }
+      else if (0 == strcmp(argv[i], "--no-lut-cache"))
+      {
+        b_lut_cache = false;
+        continue;
+      }
+      else if (0 == strcmp(argv[i], "--lut-verify"))
+      {
+        b_lut_verify = true;
+        continue;
+      }
+      else if (0 == strcmp(argv[i], "--block-stats"))
+      {
+        if (i + 1 >= argc)
+        {
+          fprintf
+          (
+            stdout, 
+            "[%6s][%s]\n", 
+            "ERROR", 
+            "Block Run Time File Not Defined!"
+          );
+          return EXIT_FAILURE;
+        }
+        str_block_stats_file = argv[i + 1];
+        i++;
+        continue;
+      }
+      else if ((0 == strcmp(argv[i], "--from")) || (0 == strcmp(argv[i], "--to")))
+      {
+        if ((i + 1 >= argc) || (str_to_seconds(argv[i + 1]) < 0))
+        {
+          fprintf
+          (
+            stdout, 
+            "[%6s][%s]\n", 
+            "ERROR", 
+            "Time Window Not Valid, Expected YYYY/MM/DD HH:MM:SS!"
+          );
+          return EXIT_FAILURE;
+        }
+        if (0 == strcmp(argv[i], "--from"))
+        {
+          time_from = str_to_seconds(argv[i + 1]);
+        }
+        else
+        {
+          time_to = str_to_seconds(argv[i + 1]);
+        }
+        i++;
+        continue;
+      }
+      else if (0 == strcmp(argv[i], "--time-ordered"))
+      {
+        b_time_ordered = true;
+        continue;
+      }
+      else if (0 == strcmp(argv[i], "--cc"))
+      {
+        /* comma separated cc numbers */
+        for (p_cc = (i + 1 < argc) ? argv[i + 1] : ""; ; p_cc = p_end + 1)
+        {
+          cc_id = strtol(p_cc, &p_end, 10);
+          if ((p_end == p_cc) || (cc_id <= 0) || (cc_id > CC_ID_MAX) ||
+              ((',' != *p_end) && ('\0' != *p_end)))
+          {
+            fprintf
+            (
+              stdout, 
+              "[%6s][%s]\n", 
+              "ERROR", 
+              "CC Numbers Not Valid!"
+            );
+            return EXIT_FAILURE;
+          }
+          b_cc_kept[cc_id] = true;
+          if ('\0' == *p_end)
+          {
+            break;
+          }
+        }
+        i++;
+        continue;
+      }
+      else if (0 == strcmp(argv[i], "--station"))
+      {
+        if ((i + 1 >= argc) || ('\0' == argv[i + 1][0]) || 
+            (strlen(argv[i + 1]) >= STR_MIN) || 
+            (station_filter_cnt >= STATION_FILTER_MAX))
+        {
+          fprintf
+          (
+            stdout, 
+            "[%6s][%s]\n", 
+            "ERROR", 
+            "Station Code Not Valid!"
+          );
+          return EXIT_FAILURE;
+        }
+        str_station_filter[station_filter_cnt++] = argv[i + 1];
+        i++;
+        continue;
+      }
+      else if (0 == strcmp(argv[i], "--platform"))
+      {
+        if ((i + 1 >= argc) || (strlen(argv[i + 1]) >= STR_MIN))
+        {
+          fprintf
+          (
+            stdout, 
+            "[%6s][%s]\n", 
+            "ERROR", 
+            "Platform Not Valid!"
+          );
+          return EXIT_FAILURE;
+        }
+        str_platform_filter = argv[i + 1];
+        i++;
+        continue;
+      }
+      else if (0 == strcmp(argv[i], "--serve"))
+      {
+        if (i + 1 >= argc)
+        {
+          fprintf
+          (
+            stdout, 
+            "[%6s][%s]\n", 
+            "ERROR", 
+            "Server Socket Not Defined!"
+          );
+          return EXIT_FAILURE;
+        }
+        str_serve_socket = argv[i + 1];
+        i++;
+        continue;
+      }
+      else if (0 == strcmp(argv[i], "--workers"))
+      {
+        if ((i + 1 >= argc) || 
+            ((server_worker_cnt = atoi(argv[i + 1])) < 1) ||
+            (server_worker_cnt > SERVER_MAX_WORKERS))
+        {
+          fprintf
+          (
+            stdout, 
+            "[%6s][%s%d!]\n", 
+            "ERROR", 
+            "Workers Must Be Between 1 And ",
+            SERVER_MAX_WORKERS
+          );
+          return EXIT_FAILURE;
+        }
+        i++;
+        continue;
+      }
+      strcpy(str_data_file, argv[i]);
+
+      /* check extension is csv */
+      if 
+      (
+        ((len_data_file_name = strlen(str_data_file)) <= 4) ||
+        (strcmp(str_data_file+(len_data_file_name-4), ".csv") != 0)
+      )
+      {
+        fprintf
+        (
+          stdout, 
+          "[%6s][%s]\n", 
+          "ERROR", 
+          "Data File Must Be CSV!"
+        );
+        return EXIT_FAILURE;
+      }
+      else
+      {
+        strcpy(str_input_file_list[input_file_cnt], argv[i]);
+        input_file_cnt++;
+      }
+    }    
+  }
+
+  if ((input_file_cnt < 1 && NULL == str_watch_dir && NULL == str_serve_socket) || 
+      input_file_cnt > FILE_LIST_MAX_LENGTH)
+  {
+    fprintf
+    (
+      stdout, 
+      "[%6s][%s]\n", 
+      "ERROR", 
+      "No Valid Input Files!"
+    );
+    return EXIT_FAILURE;
+  }
+  if (b_follow && (input_file_cnt > 0) && (NULL != str_watch_dir))
+  {
+    fprintf
+    (
+      stdout, 
+      "[%6s][%s]\n", 
+      "ERROR", 
+      "Follow Either Data Files Or A Watch Directory!"
+    );
+    return EXIT_FAILURE;
+  }
+  if ((NULL != str_block_stats_file) && b_follow)
+  {
+    /* runs still open would be counted again by the next update */
+    fprintf
+    (
+      stdout, 
+      "[%6s][%s]\n", 
+      "ERROR", 
+      "Block Run Times Cannot Be Combined With Follow!"
+    );
+    return EXIT_FAILURE;
+  }
+  if ((NULL != str_platform_filter) && (0 == station_filter_cnt))
+  {
+    fprintf
+    (
+      stdout, 
+      "[%6s][%s]\n", 
+      "ERROR", 
+      "Platform Requires A Station!"
+    );
+    return EXIT_FAILURE;
+  }
+  if ((NULL != str_serve_socket) && ((NULL != str_watch_dir) || b_follow))
+  {
+    fprintf
+    (
+      stdout, 
+      "[%6s][%s]\n", 
+      "ERROR", 
+      "Serve Cannot Be Combined With Watch Or Follow!"
+    );
+    return EXIT_FAILURE;
+  }
+  
+  /* one analysis job */
+  if (NULL == (ctx = atc_context_create()))
+  {
+    fprintf
+    (
+      stdout, 
+      "[%6s][%s]\n", 
+      "ERROR", 
+      "Not Enough Memory!"
+    );
+    return EXIT_FAILURE;
+  }
+  atc_set_async_export(ctx, async_queue_depth, b_fsync);
+  atc_set_lut_cache(ctx, b_lut_cache, b_lut_verify);
+  set_job_filters(ctx);
+
+  /* per row diagnostics are filtered and buffered by the logger */
+  log_set_lock(log_lock_mutex);
+  log_set_level(log_level);
+  log_set_fp(fp_log);
+  if (log_set_buffer((size_t) log_buffer_size) < 0)
+  {
+    log_set_buffer(0);
+  }
+  profile_enable(b_profile);
+
+  /* read lookup file, or take the one built into the binary */
+  b_embedded_lut = !b_lut_file && (NULL != atc_embedded_lut_source());
+  if (b_embedded_lut)
+  {
+    strcpy(str_lut_file, atc_embedded_lut_source());
+  }
+  fprintf
+  (
+    stdout, 
+    "[%6s][%s][%s]\n", 
+    "INFO", 
+    b_embedded_lut ? "Import Embedded Configuration..." : "Import Configuration Files...", 
+    str_lut_file
+  );
+  stage_begin(ctx, k_stage_lut_import, &stats_prev);
+  if (b_embedded_lut)
+  {
+    err = atc_load_embedded_lut(ctx);
+  }
+  else
+  {
+    err = atc_read_lut_file(ctx, str_lut_file);
+  }
+  stage_end(ctx, k_stage_lut_import, &stats_prev);
+  log_flush();
+  if (err < 0)
+  {
+    fprintf
+    (
+      stdout, 
+      "[%6s][%s][%s][%s]\n", 
+      "INFO", 
+      "Configuration Files Import Failed!", 
+      get_err_description(err), 
+      str_lut_file
+    );
+    log_debug("%s", err_last_format(str_err, sizeof(str_err)));
+    b_enabled = false;
+  }
+  else
+  {
+    fprintf
+    (
+      stdout, 
+      "[%6s][%s]\n", 
+      "INFO", 
+      "Configuration Files Imported Successfully!" 
+    );
+    b_lut_ready = true;
+  }
+
+  /* one job over the files given on the command line */
+  if (b_enabled && (input_file_cnt > 0) && !b_follow)
+  {
+    b_enabled = run_job(ctx, str_input_file_list, input_file_cnt);
+  }
+
+  /* resident modes, the lookup table stays loaded between files */
+  if (b_lut_ready && (NULL != str_watch_dir))
+  {
+    watch_dir(ctx, str_watch_dir, b_follow, async_queue_depth, b_fsync);
+  }
+  else if (b_lut_ready && b_follow)
+  {
+    follow_listed_files(ctx, str_input_file_list, input_file_cnt, async_queue_depth, b_fsync);
+  }
+  else if (b_lut_ready && (NULL != str_serve_socket))
+  {
+    serve_jobs(ctx, str_serve_socket, server_worker_cnt, async_queue_depth);
+  }
+
+  /* data quality summary, counts and first records per file and error */
+  err_report_print(stdout);
+  err_report_reset();
+
+  /* list heap usage, for sizing the machine to the data processed */
+  print_memory_summary(ctx, stdout);
+
+  /* per stage timing and throughput */
+  if (b_profile)
+  {
+    profile_print(stdout);
+    if ((NULL != str_profile_json) && (profile_write_json(str_profile_json) < 0))
+    {
+      fprintf
+      (
+        stdout, 
+        "[%6s][%s][%s]\n", 
+        "ERROR", 
+        "Profile Json File Cannot Be Created!", 
+        str_profile_json
+      );
+    }
+  }
+
+  /* release the log sinks */
+  log_set_buffer(0);
+  log_set_fp(NULL);
+  if (NULL != fp_log)
+  {
+    fclose(fp_log);
+  }
+
   /* list clean up */
-  free_lut_data_list();
-  free_input_data_list();
-  free_output_data_list();
+  atc_context_free(ctx);
   /* wait several seconds before exit */
-  Sleep(10);
+  sleep_ms(10);
   return EXIT_SUCCESS;
 }
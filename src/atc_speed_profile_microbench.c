@@ -0,0 +1,398 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "atc_speed_profile_tool.h"
+#include "profiler.h"
+#include "bench_util.h"
+
+/*
+** Constants
+** -----------------------------------------------------
+*/
+
+/* default operations timed per repetition */
+#define MICRO_DEFAULT_ITERS       200000
+/* default repetitions per benchmark */
+#define MICRO_DEFAULT_REPS        7
+/* lines per corpus, operations cycle through the corpus */
+#define MICRO_CORPUS_CNT          64
+
+/* train data header, parsed once so parse_input_data knows the columns */
+static const char *k_micro_header = "TIME,LOCATION,BLOCK,RUN NUMBER,DIRECTION,DESTINATION CODE,ORIGINATION CODE,SCHEDULE CLASS,CC ID,CURRENT DRIVING MODE,SELECTED DRIVING MODE,TALKATIVE,MOTION,SKIP STOP,DOORS OPEN,DOOR FAULT,ALARM,EMERGENCY BRAKE,SPEED";
+
+/* invalid samples, cycled to fill the invalid corpora */
+static const char *k_bad_times[] =
+{
+  "", "1018/08/27 20:00:00", "2018/00/27 20:00:00", "2018/13/27 20:00:00",
+  "2018/08/00 20:00:00", "2018/08/40 20:00:00", "2018/08/27 25:00:00",
+  "2018/08/27 20:70:00", "2018/08/27 20:00:60", "27/08/2018 20:00"
+};
+static const char *k_bad_data_lines[] =
+{
+  "H011,L,H,K,R,9,A,A,1,1,0,0,0,0,0,55",
+  "2019/13/32 25:61:61,X,IVB_12,K1,R,K,H,R,28,A,A,1,0,0,0,0,0,0,0",
+  "2019/03/29 07:00:00,X,IVB_12,K1,R,K,H,R,-20,A,A,1,0,0,0,0,0,0,0",
+  "2019/03/29 07:00:00,X,IVB_12,K1,R,K,H,R,1200,A,A,1,0,0,0,0,0,0,0",
+  "2019/03/29 07:00:00,X,IVB_12,K1,R,K,H,R,28,A,A,1,12,0,0,0,0,0,0",
+  "2019/03/29 07:00:00,X,IVB_12,K1,R,K,H,R,28,A,A,1,X,0,0,0,0,0,0",
+  "2019/03/29 07:00:00,X,IVB_12,K1",
+  "garbage without delimiters"
+};
+static const char *k_bad_lut_lines[] =
+{
+  "1,Sheppard West Portal,IVB_443,L,N,,,WIL,200.5,Wilson,Sheppard West Portal",
+  "1,Sheppard West Portal,IVB_443,L,N,22,,WIL,200.5,Wilson,Sheppard West Portal",
+  "1,Sheppard West Portal,IVB_443,L,N,2,12,WIL,200.5,Wilson,Sheppard West Portal",
+  "1,Sheppard West Portal,,L,N,2,,WIL,200.5,Wilson,Sheppard West Portal",
+  "1,Sheppard West Portal,IVB443,L,N,2,,WIL,200.5,Wilson,Sheppard West Portal",
+  "1,Sheppard West Portal,IVB_yui,L,N,2,,WIL,200.5,Wilson,Sheppard West Portal",
+  "1,Sheppard West Portal,IVB_443,L9,N,2,,WIL,200.5,Wilson,Sheppard West Portal",
+  "1,Sheppard West Portal,IVB_443,3,N,2,,WIL,200.5,Wilson,Sheppard West Portal"
+};
+
+/* corpora a benchmark can draw its lines from */
+enum micro_corpus
+{
+  k_corpus_time_valid = 0,
+  k_corpus_time_invalid,
+  k_corpus_data_valid,
+  k_corpus_data_invalid,
+  k_corpus_lut_valid,
+  k_corpus_lut_invalid,
+  k_corpus_padded,
+
+  k_corpus_cnt
+};
+
+/*
+** Structures
+** -----------------------------------------------------
+*/
+
+/* one primitive applied to one line, returns a value kept alive by the
+   caller so the call cannot be optimized away */
+typedef long (*microFn)(char *line);
+
+/* benchmark case */
+typedef struct micro_case_t
+{
+  const char *name;
+  microFn fn;
+  int corpus;
+} microCase;
+
+/*
+** Variables
+** -----------------------------------------------------
+*/
+
+static char corpora[k_corpus_cnt][MICRO_CORPUS_CNT][STR_MAX];
+/* results of the timed calls end up here */
+static volatile long micro_sink = 0;
+
+/*
+** Source Code
+** -----------------------------------------------------
+*/
+
+/* the primitives, each on a private copy of the corpus line since the
+   tokenizers write into their input */
+
+static long
+micro_copy_line(char *line)
+{
+  return line[0];
+}
+
+static long
+micro_str_to_seconds(char *line)
+{
+  return (long) str_to_seconds(line);
+}
+
+static long
+micro_cstrtok(char *line)
+{
+  long cnt = 0;
+  char *token = cstrtok(line, ',');
+
+  while (NULL != token)
+  {
+    cnt++;
+    token = cstrtok(NULL, ',');
+  }
+  return cnt;
+}
+
+static long
+micro_trim(char *line)
+{
+  return (long) (trim(line) - line);
+}
+
+static long
+micro_is_header(char *line)
+{
+  return is_header(line, k_header_num_digit);
+}
+
+static long
+micro_is_csv_line(char *line)
+{
+  return is_csv_line(line, k_input_csv_num_col);
+}
+
+static long
+micro_parse_input_data(char *line)
+{
+  static inputData data;
+
+  return parse_input_data(&data, line, "microbench.csv");
+}
+
+static long
+micro_parse_lut_data(char *line)
+{
+  static lutData data;
+
+  return parse_lut_data(&data, line);
+}
+
+/* benchmark table, the copy_line case is the cost included in all others */
+static const microCase k_micro_cases[] =
+{
+  {"copy_line/data",            micro_copy_line,        k_corpus_data_valid},
+  {"str_to_seconds/valid",      micro_str_to_seconds,   k_corpus_time_valid},
+  {"str_to_seconds/invalid",    micro_str_to_seconds,   k_corpus_time_invalid},
+  {"cstrtok/valid",             micro_cstrtok,          k_corpus_data_valid},
+  {"cstrtok/invalid",           micro_cstrtok,          k_corpus_data_invalid},
+  {"trim/padded",               micro_trim,             k_corpus_padded},
+  {"is_header/valid",           micro_is_header,        k_corpus_data_valid},
+  {"is_header/invalid",         micro_is_header,        k_corpus_data_invalid},
+  {"is_csv_line/valid",         micro_is_csv_line,      k_corpus_data_valid},
+  {"is_csv_line/invalid",       micro_is_csv_line,      k_corpus_data_invalid},
+  {"parse_input_data/valid",    micro_parse_input_data, k_corpus_data_valid},
+  {"parse_input_data/invalid",  micro_parse_input_data, k_corpus_data_invalid},
+  {"parse_lut_data/valid",      micro_parse_lut_data,   k_corpus_lut_valid},
+  {"parse_lut_data/invalid",    micro_parse_lut_data,   k_corpus_lut_invalid}
+};
+
+/** @brief  fill the corpora with varied valid lines and cycled invalid
+ *          samples, deterministic across runs
+ *  @return none
+ */
+static void
+build_corpora()
+{
+  int i = 0;
+  int sec = 0;
+
+  for (i = 0; i < MICRO_CORPUS_CNT; i++)
+  {
+    sec = i * 37;
+    snprintf(corpora[k_corpus_time_valid][i], STR_MAX, "2019/03/%02d %02d:%02d:%02d",
+             1 + i % 28, 5 + (sec / 3600) % 19, (sec / 60) % 60, sec % 60);
+    snprintf(corpora[k_corpus_time_invalid][i], STR_MAX, "%s",
+             k_bad_times[i % (sizeof(k_bad_times) / sizeof(k_bad_times[0]))]);
+    snprintf(corpora[k_corpus_data_valid][i], STR_MAX,
+             "%.*s,X,IVB_%d,K%d,%s,K,H,R,%d,A,A,1,%d,0,%d,0,0,0,%d",
+             STR_SHORT, corpora[k_corpus_time_valid][i], 10 + 2 * i, 1 + i % 99,
+             (i % 2) ? "L" : "R", 1 + (i * 7) % 999, (i % 4) ? 1 : 0,
+             (i % 4) ? 0 : 1, (i % 4) * 20);
+    snprintf(corpora[k_corpus_data_invalid][i], STR_MAX, "%s",
+             k_bad_data_lines[i % (sizeof(k_bad_data_lines) / sizeof(k_bad_data_lines[0]))]);
+    snprintf(corpora[k_corpus_lut_valid][i], STR_MAX,
+             "%d,Station %02d,IVB_%d,%s,%s,%d,%s,S%02d,%d.0,Station %02d,Station %02d",
+             i + 1, i / 2, 10 + 2 * i, (i % 2) ? "L" : "R", (i % 2) ? "S" : "N",
+             1 + i % 2, (i % 4 < 2) ? "N" : "", i / 2, 150 + i * 10, i / 2, i / 2 + 1);
+    snprintf(corpora[k_corpus_lut_invalid][i], STR_MAX, "%s",
+             k_bad_lut_lines[i % (sizeof(k_bad_lut_lines) / sizeof(k_bad_lut_lines[0]))]);
+    snprintf(corpora[k_corpus_padded][i], STR_MAX, "%*sIVB_%d%*s", i % 8, "", i, i % 5, "");
+  }
+}
+
+/** @brief  time one case, iters calls per repetition after warm-up
+ *  @param  *result  result, rows is the number of calls per repetition
+ *  @param  *mc      benchmark case
+ *  @param  iters    calls per repetition
+ *  @param  reps     repetitions
+ *  @param  warmup   untimed calls before the first repetition
+ *  @return none
+ */
+static void
+run_micro_case(benchResult *result, const microCase *mc, long iters, int reps, long warmup)
+{
+  char line[STR_MAX] = "";
+  double t_start = 0;
+  long sink = 0;
+  long i = 0;
+  int r = 0;
+  int n = 0;
+
+  bench_result_init(result, mc->name, (uint64_t) iters);
+  for (i = 0; i < warmup; i++)
+  {
+    strcpy(line, corpora[mc->corpus][n]);
+    sink += mc->fn(line);
+    n = (n + 1) % MICRO_CORPUS_CNT;
+  }
+  for (r = 0; r < reps; r++)
+  {
+    t_start = profile_wall_time();
+    for (i = 0; i < iters; i++)
+    {
+      strcpy(line, corpora[mc->corpus][n]);
+      sink += mc->fn(line);
+      n = (n + 1) % MICRO_CORPUS_CNT;
+    }
+    bench_result_add(result, profile_wall_time() - t_start);
+  }
+  bench_result_finish(result);
+  micro_sink += sink;
+}
+
+/** @brief  display micro benchmark usage
+ *  @return none
+ */
+static void
+display_micro_usage(char **argv)
+{
+  printf("USAGE: %s [OPTION]...\n", strip_path(argv[0]));
+  printf("time the per row parsing primitives in ns per call\n");
+  printf("\n");
+  printf("OPTIONS:\n");
+  printf("  %-20s %s\n", "--iters N", "calls per repetition (default 200000)");
+  printf("  %-20s %s\n", "--reps N", "repetitions (default 7)");
+  printf("  %-20s %s\n", "--warmup N", "untimed calls first (default iters / 10)");
+  printf("  %-20s %s\n", "--filter TEXT", "only benchmarks whose name contains TEXT");
+  printf("  %-20s %s\n", "--csv FILE", "write results as csv");
+  printf("  %-20s %s\n", "--baseline FILE", "fail when results regress against a csv baseline");
+  printf("  %-20s %s\n", "--tolerance PCT", "allowed throughput drop (default 10)");
+  printf("\n");
+}
+
+/*
+** Main Program Code
+*/
+int
+main(int argc, char *argv[])
+{
+  static benchResult results[BENCH_MAX_RESULTS];
+  char str_header[STR_MAX] = "";
+  const char *str_filter = NULL;
+  char *str_csv_file = NULL;
+  char *str_baseline_file = NULL;
+  double tolerance_pct = BENCH_DEFAULT_TOLERANCE;
+  int regress_cnt = 0;
+  long iters = MICRO_DEFAULT_ITERS;
+  long warmup = -1;
+  int reps = MICRO_DEFAULT_REPS;
+  int case_cnt = sizeof(k_micro_cases) / sizeof(k_micro_cases[0]);
+  int result_cnt = 0;
+  int err = 0;
+  int i = 0;
+
+  for (i = 1; i < argc; i++)
+  {
+    if ((0 == strcmp(argv[i], "--iters")) && (i + 1 < argc))
+    {
+      iters = atol(argv[++i]);
+    }
+    else if ((0 == strcmp(argv[i], "--reps")) && (i + 1 < argc))
+    {
+      reps = atoi(argv[++i]);
+    }
+    else if ((0 == strcmp(argv[i], "--warmup")) && (i + 1 < argc))
+    {
+      warmup = atol(argv[++i]);
+    }
+    else if ((0 == strcmp(argv[i], "--filter")) && (i + 1 < argc))
+    {
+      str_filter = argv[++i];
+    }
+    else if ((0 == strcmp(argv[i], "--csv")) && (i + 1 < argc))
+    {
+      str_csv_file = argv[++i];
+    }
+    else if ((0 == strcmp(argv[i], "--baseline")) && (i + 1 < argc))
+    {
+      str_baseline_file = argv[++i];
+    }
+    else if ((0 == strcmp(argv[i], "--tolerance")) && (i + 1 < argc))
+    {
+      tolerance_pct = atof(argv[++i]);
+    }
+    else
+    {
+      display_micro_usage(argv);
+      return EXIT_FAILURE;
+    }
+  }
+  if ((iters <= 0) || (reps <= 0) || (reps > BENCH_MAX_SAMPLES))
+  {
+    display_micro_usage(argv);
+    return EXIT_FAILURE;
+  }
+  if (warmup < 0)
+  {
+    warmup = iters / 10;
+  }
+
+  build_corpora();
+  strcpy(str_header, k_micro_header);
+  if ((err = parse_input_header(str_header)) < 0)
+  {
+    fprintf(stdout, "[%6s][%s][%s]\n", "ERROR", "Header Not Parsed!", get_err_description(err));
+    return EXIT_FAILURE;
+  }
+
+  fprintf
+  (
+    stdout,
+    "[%6s][%-28s][%10s][%5s][%12s][%12s][%14s]\n",
+    "INFO", "BENCHMARK", "ITERS", "REPS", "MEDIAN_NS/OP", "P95_NS/OP", "OPS/S"
+  );
+  for (i = 0; i < case_cnt; i++)
+  {
+    if ((NULL != str_filter) && (NULL == strstr(k_micro_cases[i].name, str_filter)))
+    {
+      continue;
+    }
+    run_micro_case(&results[result_cnt], &k_micro_cases[i], iters, reps, warmup);
+    fprintf
+    (
+      stdout,
+      "[%6s][%-28s][%10ld][%5d][%12.1f][%12.1f][%14.0f]\n",
+      "INFO",
+      results[result_cnt].name,
+      iters,
+      reps,
+      results[result_cnt].median_s * 1e9 / iters,
+      results[result_cnt].p95_s * 1e9 / iters,
+      results[result_cnt].rows_per_s
+    );
+    result_cnt++;
+  }
+
+  if ((NULL != str_csv_file) && (bench_write_csv(str_csv_file, results, result_cnt) < 0))
+  {
+    fprintf(stdout, "[%6s][%s][%s]\n", "ERROR", "Benchmark Result File Cannot Be Created!", str_csv_file);
+    return EXIT_FAILURE;
+  }
+  if (NULL != str_baseline_file)
+  {
+    regress_cnt = bench_check_baseline(stdout, str_baseline_file, results, result_cnt,
+                                       tolerance_pct, BENCH_DEFAULT_MEM_TOLERANCE);
+    if (regress_cnt < 0)
+    {
+      fprintf(stdout, "[%6s][%s][%s]\n", "ERROR", "Benchmark Baseline Cannot Be Read!", str_baseline_file);
+      return EXIT_FAILURE;
+    }
+    if (regress_cnt > 0)
+    {
+      fprintf(stdout, "[%6s][%s][%d]\n", "ERROR", "Benchmarks Regressed", regress_cnt);
+      return EXIT_FAILURE;
+    }
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,363 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <inttypes.h>
+#include "atc_speed_profile_tool.h"
+#include "profiler.h"
+#include "run_index.h"
+
+/* run query, fields not given are not compared */
+typedef struct run_query_t
+{
+  runIndexRecord key;
+  /* leading key fields given, enum run_index_key */
+  int key_fields;
+  bool b_platform;
+  bool b_cc;
+  int64_t from;
+  int64_t to;
+  /* time of day window in minutes, not used when negative */
+  int daily_from;
+  int daily_to;
+} runQuery;
+
+/** @brief  display query usage
+ *  @return none
+ */
+static void
+display_query_usage(char **argv)
+{
+  printf("USAGE: %s [OPTION]... [DIR]\n", strip_path(argv[0]));
+  printf("find exported runs in the manifest of a run profile folder (default " RUN_PROFILE_PATH ")\n");
+  printf("\n");
+  printf("OPTIONS:\n");
+  printf("  %-22s %s\n", "--station CODE", "departing station code, e.g. SCW");
+  printf("  %-22s %s\n", "--platform P", "departing platform, e.g. N");
+  printf("  %-22s %s\n", "--cc N", "train cc id");
+  printf("  %-22s %s\n", "--from DATE", "runs starting at or after \"YYYY/MM/DD HH:MM:SS\"");
+  printf("  %-22s %s\n", "--to DATE", "runs starting before \"YYYY/MM/DD HH:MM:SS\"");
+  printf("  %-22s %s\n", "--daily HH:MM-HH:MM", "runs starting within a time of day window");
+  printf("  %-22s %s\n", "--rows", "print the run profile rows of the runs found");
+  printf("  %-22s %s\n", "--rebuild", "rebuild the run index");
+  printf("\n");
+}
+
+/** @brief  parse a time of day window
+ *  @param  *str_window  "HH:MM-HH:MM", the end is excluded and may be
+ *                       before the start to cross midnight
+ *  @param  *query       query output
+ *  @return true   window valid
+ *          false  window not valid
+ */
+static bool
+parse_daily_window(const char *str_window, runQuery *query)
+{
+  int hh[2] = {0};
+  int mm[2] = {0};
+  char c = '\0';
+
+  if ((4 != sscanf(str_window, "%d:%d-%d:%d%c", &hh[0], &mm[0], &hh[1], &mm[1], &c)) ||
+      (hh[0] < 0) || (hh[0] > 24) || (mm[0] < 0) || (mm[0] > 59) ||
+      (hh[1] < 0) || (hh[1] > 24) || (mm[1] < 0) || (mm[1] > 59))
+  {
+    return false;
+  }
+  query->daily_from = 60 * hh[0] + mm[0];
+  query->daily_to = 60 * hh[1] + mm[1];
+  return true;
+}
+
+/** @brief  check a run against the query
+ *  @param  *rec    run
+ *  @param  *query  query
+ *  @return true    run matches
+ *          false   run does not match
+ */
+static bool
+match_run(const runIndexRecord *rec, const runQuery *query)
+{
+  struct tm tm_start;
+  time_t start = (time_t) rec->start_time;
+  int minute = 0;
+
+  if (((query->key_fields >= k_key_station) &&
+       (0 != strcmp(rec->str_station_code, query->key.str_station_code))) ||
+      (query->b_platform && (0 != strcmp(rec->str_platform, query->key.str_platform))) ||
+      (query->b_cc && (rec->cc_id != query->key.cc_id)) ||
+      (rec->start_time < query->from) || (rec->start_time >= query->to))
+  {
+    return false;
+  }
+  if (query->daily_from < 0)
+  {
+    return true;
+  }
+#ifdef _WIN32
+  if (0 != localtime_s(&tm_start, &start))
+#else
+  if (NULL == localtime_r(&start, &tm_start))
+#endif
+  {
+    return false;
+  }
+  minute = 60 * tm_start.tm_hour + tm_start.tm_min;
+  if (query->daily_from <= query->daily_to)
+  {
+    return (minute >= query->daily_from) && (minute < query->daily_to);
+  }
+  return (minute >= query->daily_from) || (minute < query->daily_to);
+}
+
+/** @brief  print the rows of a run profile, each prefixed with its run id
+ *  @param  *str_dir     run profile folder
+ *  @param  *str_run_id  run id
+ *  @param  *b_header    true until the header is printed
+ *  @return 0
+ *          err_insufficient_buffer_size
+ *          err_file_not_accessible
+ */
+static int
+print_run_rows(const char *str_dir, const char *str_run_id, bool *b_header)
+{
+  char str_file[STR_MAX] = "";
+  char str_line[STR_EXTRA] = "";
+  FILE *fp = NULL;
+  bool b_first = true;
+
+  if ((size_t) snprintf(str_file, STR_MAX, "%s%s.csv", str_dir, str_run_id) >= STR_MAX)
+  {
+    return throw_err(err_insufficient_buffer_size);
+  }
+  if (NULL == (fp = fopen(str_file, "r")))
+  {
+    return throw_err(err_file_not_accessible);
+  }
+  while (NULL != fgets(str_line, STR_EXTRA, fp))
+  {
+    str_line[strcspn(str_line, "\r\n")] = '\0';
+    if (b_first)
+    {
+      b_first = false;
+      if (*b_header)
+      {
+        fprintf(stdout, "Run_ID,%s\n", str_line);
+        *b_header = false;
+      }
+      continue;
+    }
+    fprintf(stdout, "%s,%s\n", str_run_id, str_line);
+  }
+  fclose(fp);
+  return 0;
+}
+
+/*
+** Main Program Code
+*/
+int
+main(int argc, char *argv[])
+{
+  const char *str_from = NULL;
+  const char *str_to = NULL;
+  const runIndexRecord *p_records = NULL;
+  char str_dir[STR_MAX] = RUN_PROFILE_PATH;
+  char str_manifest[STR_MAX] = "";
+  char str_header[STR_EXTRA] = "";
+  char str_line[STR_EXTRA] = "";
+  char str_run_id[STR_MAX] = "";
+  runIndex *idx = NULL;
+  runQuery query;
+  FILE *fp = NULL;
+  double t_start = profile_wall_time();
+  size_t match_cnt = 0;
+  size_t cnt = 0;
+  size_t len = 0;
+  size_t i = 0;
+  bool b_rows = false;
+  bool b_rebuild = false;
+  bool b_header = true;
+  int err = 0;
+
+  memset(&query, 0, sizeof(query));
+  query.key.cc_id = -1;
+  query.from = INT64_MIN;
+  query.to = INT64_MAX;
+  query.daily_from = -1;
+  for (i = 1; i < (size_t) argc; i++)
+  {
+    if (0 == strcmp(argv[i], "--rows"))
+    {
+      b_rows = true;
+    }
+    else if (0 == strcmp(argv[i], "--rebuild"))
+    {
+      b_rebuild = true;
+    }
+    else if ('-' != argv[i][0])
+    {
+      if (strlen(argv[i]) + 2 > STR_MAX)
+      {
+        fprintf(stderr, "[%6s][%s]\n", "ERROR", "Folder Name Too Long!");
+        return EXIT_FAILURE;
+      }
+      strcpy(str_dir, argv[i]);
+    }
+    else if (i + 1 >= (size_t) argc)
+    {
+      display_query_usage(argv);
+      return EXIT_FAILURE;
+    }
+    else if ((0 == strcmp(argv[i], "--station")) &&
+             (strlen(argv[i + 1]) < sizeof(query.key.str_station_code)))
+    {
+      strcpy(query.key.str_station_code, argv[++i]);
+      query.key_fields = k_key_station;
+    }
+    else if ((0 == strcmp(argv[i], "--platform")) &&
+             (strlen(argv[i + 1]) < sizeof(query.key.str_platform)))
+    {
+      strcpy(query.key.str_platform, argv[++i]);
+      query.b_platform = true;
+    }
+    else if (0 == strcmp(argv[i], "--cc"))
+    {
+      query.key.cc_id = atoi(argv[++i]);
+      query.b_cc = true;
+    }
+    else if (0 == strcmp(argv[i], "--from"))
+    {
+      str_from = argv[++i];
+    }
+    else if (0 == strcmp(argv[i], "--to"))
+    {
+      str_to = argv[++i];
+    }
+    else if ((0 == strcmp(argv[i], "--daily")) && parse_daily_window(argv[i + 1], &query))
+    {
+      i++;
+    }
+    else
+    {
+      display_query_usage(argv);
+      return EXIT_FAILURE;
+    }
+  }
+  if (((NULL != str_from) && ((query.from = (int64_t) str_to_seconds(str_from)) < 0)) ||
+      ((NULL != str_to) && ((query.to = (int64_t) str_to_seconds(str_to)) < 0)))
+  {
+    fprintf(stderr, "[%6s][%s]\n", "ERROR", "Date Not Valid, Expected YYYY/MM/DD HH:MM:SS!");
+    return EXIT_FAILURE;
+  }
+  /* the key is used as far as its leading fields are given */
+  if ((query.key_fields == k_key_station) && query.b_platform)
+  {
+    query.key_fields = k_key_platform;
+    if (query.b_cc)
+    {
+      query.key_fields = k_key_cc;
+    }
+  }
+  len = strlen(str_dir);
+  if ((len > 0) && ('/' != str_dir[len - 1]) && ('\\' != str_dir[len - 1]))
+  {
+    strcat(str_dir, PATH_DELIM);
+  }
+  if ((size_t) snprintf(str_manifest, STR_MAX, "%s%s", str_dir, RUN_PROFILE_MANIFEST) >= STR_MAX)
+  {
+    fprintf(stderr, "[%6s][%s]\n", "ERROR", "Folder Name Too Long!");
+    return EXIT_FAILURE;
+  }
+
+  /* the index is rebuilt once runs are appended to the manifest */
+  if (b_rebuild || (NULL == (idx = run_index_open(str_manifest))))
+  {
+    if ((err = run_index_build(str_manifest)) < 0)
+    {
+      fprintf(stderr, "[%6s][%s][%s][%s]\n", "ERROR", "Run Index Not Built!", get_err_description(err), str_manifest);
+      return EXIT_FAILURE;
+    }
+    if (NULL == (idx = run_index_open(str_manifest)))
+    {
+      fprintf(stderr, "[%6s][%s][%s]\n", "ERROR", "Run Index Cannot Be Read!", str_manifest);
+      return EXIT_FAILURE;
+    }
+    fprintf(stderr, "[%6s][%s][%s]\n", "INFO", "Run Index Built", str_manifest);
+  }
+  if ((NULL == (fp = fopen(str_manifest, "rb"))) ||
+      (NULL == fgets(str_header, STR_EXTRA, fp)))
+  {
+    fprintf(stderr, "[%6s][%s][%s]\n", "ERROR", "Manifest Cannot Be Read!", str_manifest);
+    if (NULL != fp)
+    {
+      fclose(fp);
+    }
+    run_index_close(idx);
+    return EXIT_FAILURE;
+  }
+  str_header[strcspn(str_header, "\r\n")] = '\0';
+
+  p_records = run_index_records(idx, &cnt);
+  if (query.key_fields == k_key_cc)
+  {
+    /* one train from one platform, its runs are in start time order */
+    query.key.start_time = query.from;
+    i = run_index_lower_bound(idx, &query.key, k_key_start_time);
+  }
+  else
+  {
+    i = run_index_lower_bound(idx, &query.key, query.key_fields);
+  }
+  for (; (i < cnt) && (err >= 0); i++)
+  {
+    if ((0 != run_index_compare(&p_records[i], &query.key, query.key_fields)) ||
+        ((query.key_fields == k_key_cc) && (p_records[i].start_time >= query.to)))
+    {
+      break;
+    }
+    if (!match_run(&p_records[i], &query))
+    {
+      continue;
+    }
+    if ((0 != fseek(fp, (long) p_records[i].manifest_offset, SEEK_SET)) ||
+        (NULL == fgets(str_line, STR_EXTRA, fp)))
+    {
+      err = throw_err(err_file_not_accessible);
+      break;
+    }
+    str_line[strcspn(str_line, "\r\n")] = '\0';
+    match_cnt++;
+    if (!b_rows)
+    {
+      if (b_header)
+      {
+        fprintf(stdout, "%s\n", str_header);
+        b_header = false;
+      }
+      fprintf(stdout, "%s\n", str_line);
+      continue;
+    }
+    /* run id is the first field */
+    len = strcspn(str_line, ",");
+    snprintf(str_run_id, STR_MAX, "%.*s", (int) len, str_line);
+    if ((err = print_run_rows(str_dir, str_run_id, &b_header)) < 0)
+    {
+      fprintf(stderr, "[%6s][%s][%s][%s]\n", "ERROR", "Run Profile Cannot Be Read!", get_err_description(err), str_run_id);
+    }
+  }
+  fclose(fp);
+  run_index_close(idx);
+
+  fprintf
+  (
+    stderr,
+    "[%6s][%s][%zu of %zu][%.3f ms]\n",
+    "INFO",
+    "Runs Found",
+    match_cnt,
+    cnt,
+    1000.0 * (profile_wall_time() - t_start)
+  );
+  return (err < 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
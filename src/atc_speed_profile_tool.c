@@ -28,6 +28,7 @@
 ** Outputs:
 ** Run Profile Files:
 ** run_profiles\*.csv
+** run_profiles\run_profile_manifest.csv
 **
 ** ----------------------------------------------------
 */
@@ -40,10 +41,24 @@
 #include <time.h>
 #include <sys/stat.h>
 #include <inttypes.h>
+#include <math.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#ifndef _WIN32
+#   include <unistd.h>
+#else
+#   include <io.h>
+#endif
 #include "simclist.h"
 #include "errorhandler.h"
 #include "common_util.h"
+#include "async_writer.h"
+#include "log.h"
 #include "atc_speed_profile_tool.h"
+#include "lut_cache.h"
+#include "lut_embed.h"
+#include "block_stats.h"
 
 /*
 ** Type Definitions
@@ -62,6 +77,18 @@
 ** -----------------------------------------------------
 */
 
+/* run profile being exported, becomes a manifest row once written */
+typedef struct run_manifest_t
+{
+  char str_output_file[STR_MAX];
+  /* run counter in the file name */
+  int file_cnt;
+  /* first and last rows of the run, in the output list */
+  const outputData *p_first;
+  const outputData *p_last;
+  unsigned int row_cnt;
+  double max_speed_km_h;
+} runManifest;
 
 /*
 ** Variables
@@ -69,19 +96,127 @@
 */
 
 
-/* system operation errno */
-extern int errno;
-/* linked list to store input data */
-static list_t input_data_list;
-static uint64_t input_list_id = 0;
-/* linked list to store output data */
-static list_t output_data_list;
-static uint64_t output_list_id = 0;
-/* linked list to store lut data */
-static list_t lut_data_list;
-static uint64_t lut_list_id = 0;
-/* unique run profile count */
-static uint64_t run_cnt = 0;
+/* lookup table, loaded once and shared by reference between contexts */
+struct atc_lut_t
+{
+  /* linked list to store lut data */
+  list_t lut_data_list;
+  uint64_t lut_list_id;
+  /* list elements in list order, lets the lookups of several jobs 
+  ** read the table at once without the list iterator */
+  lutData **p_index;
+  unsigned int index_cnt;
+  unsigned int index_size;
+  /* positions in p_index sorted by block then position, the first entry
+  ** of a block is the one a walk in list order would match */
+  unsigned int *p_block_index;
+  /* compiled image the records were mapped from, NULL if parsed */
+  lutCache *p_cache;
+  /* table compiled into the binary, its perfect hash serves the lookups
+  ** until a record is added */
+  const lutEmbedded *p_embedded;
+  /* heap usage of the table */
+  listMemory memory;
+  /* contexts using the table */
+  int ref_cnt;
+};
+
+/* run segmentation state of one train, carried from row to row */
+typedef struct run_state_t
+{
+  /* previous row of the train, NULL before its first row */
+  const inputData *p_prev;
+  /* copy of the previous row once the input list is released */
+  inputData prev;
+  time_t time_origin;
+  time_t travel_time_origin;
+  uint8_t cur_run_cnt;
+  /* output id of the first row of the open run */
+  uint64_t run_first_id;
+  double accum_displacement_m;
+  double accum_travelled_m;
+  bool b_departure_complete;
+  bool b_arrival_complete;
+  bool b_run_complete;
+  bool b_run_interrupted;
+  bool b_stopped;
+  bool b_departed;
+  /* the open run departs from a station requested, see 
+  ** atc_add_station_filter */
+  bool b_run_kept;
+  char str_departure_block[STR_SHORT];
+  char str_arrival_block[STR_SHORT];
+} runState;
+
+/* follow mode, a growing input file read in increments */
+typedef struct follow_state_t
+{
+  /* bytes of the file consumed, complete lines only */
+  long offset;
+  /* state of each train, indexed by cc number, NULL until seen */
+  runState *p_run_state[CC_ID_MAX + 1];
+} followState;
+
+/* state of one analysis job */
+struct atc_context_t
+{
+  /* linked list to store input data */
+  list_t input_data_list;
+  uint64_t input_list_id;
+  /* linked list to store output data */
+  list_t output_data_list;
+  uint64_t output_list_id;
+  /* lookup table, may be shared with other contexts */
+  atcLut *p_lut;
+  /* unique run profile count */
+  uint64_t run_cnt;
+  /* input data header column index of the file being read */
+  inputHeader input_header;
+  /* background writer queue depth, 0 - export synchronously */
+  int async_export_depth;
+  /* flush file system buffers once the export is complete */
+  bool b_async_export_sync;
+  /* background writer used by the export in progress */
+  asyncWriter *p_async_writer;
+  /* processing counters reported by atc_get_tool_stats */
+  toolStats tool_stats;
+  /* heap usage of the input and output lists, indexed by enum tool_list,
+  ** the lookup table keeps its own */
+  listMemory list_memory[k_list_cnt];
+  /* follow mode state, NULL when each file is read once */
+  followState *p_follow;
+  /* run profile folder with its trailing delimiter, empty for the
+  ** default RUN_PROFILE_PATH */
+  char str_output_path[STR_MAX];
+  /* load the lookup table from its compiled image, rebuilt if stale */
+  bool b_lut_cache;
+  /* hash the lookup table csv before trusting its compiled image */
+  bool b_lut_verify;
+  /* input rows kept, [time_from, time_to), a bound is not used when
+  ** negative */
+  bool b_time_window;
+  time_t time_from;
+  time_t time_to;
+  /* input files are in time order, see atc_set_time_window */
+  bool b_time_ordered;
+  /* trains kept, indexed by cc number, all when no train is added */
+  bool b_cc_filter;
+  bool b_cc_kept[CC_ID_MAX + 1];
+  /* departing stations and platforms of the runs kept, all when none is
+  ** added. an empty platform matches any */
+  int station_filter_cnt;
+  char str_station_filter[STATION_FILTER_MAX][STR_MIN];
+  char str_platform_filter[STATION_FILTER_MAX][STR_MIN];
+};
+
+/* context behind the single job functions */
+static atcLut default_lut;
+static atcContext default_context;
+static bool b_default_context_ready = false;
+/* guards the reference counts of shared lookup tables */
+static pthread_mutex_t lut_ref_lock = PTHREAD_MUTEX_INITIALIZER;
+/* serializes appends of concurrent jobs to a manifest */
+static pthread_mutex_t manifest_lock = PTHREAD_MUTEX_INITIALIZER;
 
 /*
 ** Function Prototypes
@@ -129,6 +264,21 @@ output_data_comparator(const void *a, const void *b)
   return strcmp(A->sorting_str, B->sorting_str);
 }
 
+/* comparator used to sort the output list when following */
+/* rows of a train in the order they were calculated */
+static int 
+output_data_follow_comparator(const void *a, const void *b) 
+{
+  const outputData *A = (outputData *) a;
+  const outputData *B = (outputData *) b;
+
+  if (A->cc_id != B->cc_id)
+  {
+    return (A->cc_id < B->cc_id) ? -1 : 1;
+  }
+  return (A->id < B->id) ? -1 : (A->id > B->id);
+}
+
 /* meter function required for the list_append function */
 /* return size of the outputData structure */
 size_t 
@@ -157,92 +307,307 @@ lut_data_meter(const void *el)
   return sizeof(lutData);
 }
 
-/** @brief  add input data structure to the static input data list
+/** @brief  heap bytes taken by one allocation, the request plus a 
+ *          size_t header rounded up to twice the pointer size with a 
+ *          minimum of four words, as laid out by dlmalloc derived heaps
+ *  @param  size  requested bytes
+ *  @return bytes taken from the heap
+ */
+static uint64_t
+heap_block_size(size_t size)
+{
+  const size_t align = 2 * sizeof(void *);
+  size_t block = size + sizeof(size_t);
+
+  block = (block + align - 1) & ~(align - 1);
+  return (block < 4 * sizeof(size_t)) ? 4 * sizeof(size_t) : block;
+}
+
+/** @brief  heap usage record of a list of a context
+ *  @param  *ctx  context
+ *  @param  list  enum tool_list
+ *  @return heap usage record, the lookup table keeps its own
+ */
+static listMemory *
+context_list_memory(atcContext *ctx, int list)
+{
+  return (k_list_lut == list) ? &ctx->p_lut->memory : &ctx->list_memory[list];
+}
+
+/** @brief  start the heap accounting of a list, the list owns a copy of
+ *          each element and one node per element
+ *  @param  *ctx          context
+ *  @param  list          enum tool_list
+ *  @param  element_size  element structure size
+ *  @return none
+ */
+static void
+init_list_memory(atcContext *ctx, int list, size_t element_size)
+{
+  listMemory *mem = context_list_memory(ctx, list);
+
+  ctx->tool_stats.list_bytes -= mem->bytes;
+  memset(mem, 0, sizeof(listMemory));
+  mem->element_size = element_size;
+  mem->node_size = heap_block_size(element_size) + 
+                   heap_block_size(sizeof(struct list_entry_s));
+}
+
+/** @brief  account one element appended to a list
+ *  @param  *ctx  context
+ *  @param  list  enum tool_list
+ *  @return none
+ */
+static void
+add_list_memory(atcContext *ctx, int list)
+{
+  listMemory *mem = context_list_memory(ctx, list);
+
+  mem->cnt++;
+  mem->bytes += mem->node_size;
+  if (mem->cnt > mem->peak_cnt)
+  {
+    mem->peak_cnt = mem->cnt;
+    mem->peak_bytes = mem->bytes;
+  }
+  ctx->tool_stats.list_bytes += mem->node_size;
+  if (ctx->tool_stats.list_bytes > ctx->tool_stats.list_bytes_high_water)
+  {
+    ctx->tool_stats.list_bytes_high_water = ctx->tool_stats.list_bytes;
+  }
+}
+
+/** @brief  account all elements of a list released
+ *  @param  *ctx  context
+ *  @param  list  enum tool_list
+ *  @return none
+ */
+static void
+clear_list_memory(atcContext *ctx, int list)
+{
+  listMemory *mem = context_list_memory(ctx, list);
+
+  ctx->tool_stats.list_bytes -= mem->bytes;
+  mem->cnt = 0;
+  mem->bytes = 0;
+}
+
+/** @brief  add input data structure to the input data list of a context
+ *  @param  *ctx   context
  *  @param  *data  pointer to the new input data structure 
  *  @return err_list_append_failed
  *      
  */
-int 
-add_to_input_data_list(inputData *data) 
+static int
+atc_add_to_input_data_list(atcContext *ctx, inputData *data) 
 {
   
-  if (1 != list_append(&input_data_list, data)) 
+  if (1 != list_append(&ctx->input_data_list, data)) 
   {
       return throw_err(err_list_append_failed);
   }  
+  add_list_memory(ctx, k_list_input);
 
   return 0;
 }
 
-/** @brief  add output data structure to the static output data list
+/** @brief  add output data structure to the output data list of a context
+ *  @param  *ctx   context
  *  @param  *data  pointer to the new output data structure 
  *  @return err_list_append_failed
  *      
  */
-int 
-add_to_output_data_list(outputData *data) 
+static int
+atc_add_to_output_data_list(atcContext *ctx, outputData *data) 
 {
   
-  if (1 != list_append(&output_data_list, data)) 
+  if (1 != list_append(&ctx->output_data_list, data)) 
   {
       return throw_err(err_list_append_failed);
   }  
+  add_list_memory(ctx, k_list_output);
 
   return 0;
 }
 
-/** @brief  add lookup table data structure to the static lut data list
+/** @brief  add lookup table data structure to the lut data list of a 
+ *          context and to the lookup index
+ *  @param  *ctx   context
  *  @param  *data  pointer to the new lut data structure 
  *  @return err_list_append_failed
+ *          err_maximum_number_exceeded
  *      
  */
-int 
-add_to_lut_data_list(lutData *data) 
+static int
+atc_add_to_lut_data_list(atcContext *ctx, lutData *data) 
 {
-  
-  if (1 != list_append(&lut_data_list, data)) 
+  atcLut *p_lut = ctx->p_lut;
+  lutData **p_index = NULL;
+  unsigned int *p_block_index = NULL;
+  unsigned int index_size = 0;
+  unsigned int pos = 0;
+
+  if (p_lut->index_cnt == p_lut->index_size)
+  {
+    index_size = (p_lut->index_size > 0) ? 2 * p_lut->index_size : 64;
+    p_index = (lutData **) realloc(p_lut->p_index, index_size * sizeof(lutData *));
+    if (NULL == p_index)
+    {
+      return throw_err(err_maximum_number_exceeded);
+    }
+    p_lut->p_index = p_index;
+    p_block_index = (unsigned int *) realloc(p_lut->p_block_index, index_size * sizeof(unsigned int));
+    if (NULL == p_block_index)
+    {
+      return throw_err(err_maximum_number_exceeded);
+    }
+    p_lut->p_block_index = p_block_index;
+    p_lut->index_size = index_size;
+  }
+  if (1 != list_append(&p_lut->lut_data_list, data)) 
   {
       return throw_err(err_list_append_failed);
   }  
+  /* the list keeps its own copy, the last element is reached from the tail */
+  p_lut->p_index[p_lut->index_cnt] = 
+    (lutData *) list_get_at(&p_lut->lut_data_list, list_size(&p_lut->lut_data_list) - 1);
+  /* keep the block index sorted, after the entries of the same block */
+  pos = p_lut->index_cnt;
+  while ((pos > 0) &&
+         (strcmp(p_lut->p_index[p_lut->p_block_index[pos - 1]]->str_block, data->str_block) > 0))
+  {
+    p_lut->p_block_index[pos] = p_lut->p_block_index[pos - 1];
+    pos--;
+  }
+  p_lut->p_block_index[pos] = p_lut->index_cnt++;
+  p_lut->p_embedded = NULL;
+  add_list_memory(ctx, k_list_lut);
 
   return 0;
 }
 
 /** @brief  convert inputHeader and format into string 
+ *  @param  *ctx  context
  *  @param  *data  inputData to be converted 
  *  @return NULL      input is not valid
  *          converted static string             
  */
-char *
-input_header_to_string()
+static char *
+atc_input_header_to_string(atcContext *ctx)
 {
   strcpy(str_static_data, "");
   snprintf(str_static_data, 
           STR_EXTRA, 
           "[                 col_time][%d]\n[             col_location][%d]\n[                col_block][%d]\n[           col_run_number][%d]\n[            col_direction][%d]\n[     col_destination_code][%d]\n[     col_origination_code][%d]\n[       col_schedule_class][%d]\n[                col_cc_id][%d]\n[ col_current_driving_mode][%d]\n[col_selected_driving_mode][%d]\n[            col_talkative][%d]\n[               col_motion][%d]\n[            col_skip_stop][%d]\n[           col_doors_open][%d]\n[           col_door_fault][%d]\n[                col_alarm][%d]\n[      col_emergency_brake][%d]\n[                col_speed][%d]", 
-          input_header.col_time,
-          input_header.col_location,
-          input_header.col_block,
-          input_header.col_run_number,
-          input_header.col_direction,
-          input_header.col_destination_code,
-          input_header.col_origination_code,
-          input_header.col_schedule_class,
-          input_header.col_cc_id,
-          input_header.col_current_driving_mode,
-          input_header.col_selected_driving_mode,
-          input_header.col_talkative,
-          input_header.col_motion,
-          input_header.col_skip_stop,
-          input_header.col_doors_open,
-          input_header.col_door_fault,
-          input_header.col_alarm,
-          input_header.col_emergency_brake,
-          input_header.col_speed);
+          ctx->input_header.col_time,
+          ctx->input_header.col_location,
+          ctx->input_header.col_block,
+          ctx->input_header.col_run_number,
+          ctx->input_header.col_direction,
+          ctx->input_header.col_destination_code,
+          ctx->input_header.col_origination_code,
+          ctx->input_header.col_schedule_class,
+          ctx->input_header.col_cc_id,
+          ctx->input_header.col_current_driving_mode,
+          ctx->input_header.col_selected_driving_mode,
+          ctx->input_header.col_talkative,
+          ctx->input_header.col_motion,
+          ctx->input_header.col_skip_stop,
+          ctx->input_header.col_doors_open,
+          ctx->input_header.col_door_fault,
+          ctx->input_header.col_alarm,
+          ctx->input_header.col_emergency_brake,
+          ctx->input_header.col_speed);
 
   return str_static_data;
 }
 
+/** @brief  format inputData as a csv record into a caller supplied buffer
+ *      in a single pass, the output is truncated if the buffer is too small
+ *  @param  *buf   destination buffer 
+ *  @param  size   destination buffer size in bytes
+ *  @param  *data  inputData to be converted 
+ *  @return number of characters needed, excluding the null terminator
+ *             
+ */
+size_t
+input_data_format(char *buf, size_t size, const inputData *data)
+{
+  strCursor cur;
+
+  str_cursor_init(&cur, buf, size);
+  if (NULL == data)
+  {
+    return 0;
+  }
+
+  str_cursor_printf(&cur, "%010" PRIu64 ",", data->id);
+  str_cursor_puts(&cur, data->sorting_str);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->input_data_file);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_timestamp);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_time);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_location);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_block);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_run_number);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_direction);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_destination_code);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_origination_code);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_schedule_class);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_cc_id);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_current_driving_mode);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_selected_driving_mode);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_talkative);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_motion);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_skip_stop);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_doors_open);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_door_fault);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_alarm);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_emergency_brake);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_speed);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_from_station);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_to_station);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_direction_code);
+  str_cursor_putc(&cur, ',');
+  str_cursor_printf(&cur, "%010ld,%03d,%d,% .1f,", 
+                    data->timestamp, 
+                    data->cc_id, 
+                    data->direction,
+                    data->signed_measured_speed_km_h);
+  str_cursor_puts(&cur, data->str_station_code);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_platform);
+  str_cursor_putc(&cur, ',');
+  str_cursor_printf(&cur, "%d,%d", 
+                    data->is_platform, 
+                    data->is_motion);
+
+  return cur.len;
+}
+
 /** @brief  convert inputData and format into string 
  *  @param  *data  inputData to be converted 
  *  @return NULL      input is not valid
@@ -252,168 +617,66 @@ input_header_to_string()
 char *
 input_data_to_string(inputData *data)
 {
-  char tmp[STR_EXTRA] = "";
   if (NULL == data)
   {
     return NULL;
   }
-  
-  snprintf(tmp, STR_EXTRA, "%010" PRIu64 ",", data->id);
-  strcpy(str_static_data, tmp);
-  if (NULL != data->sorting_str)
-  {    
-    strcat(str_static_data, data->sorting_str);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->input_data_file)
-  {    
-    strcat(str_static_data, data->input_data_file);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_timestamp)
-  {    
-    strcat(str_static_data, data->str_timestamp);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_time)
-  {    
-    strcat(str_static_data, data->str_time);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_location)
-  {    
-    strcat(str_static_data, data->str_location);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_block)
-  {    
-    strcat(str_static_data, data->str_block);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_run_number)
-  {    
-    strcat(str_static_data, data->str_run_number);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_direction)
-  {    
-    strcat(str_static_data, data->str_direction);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_destination_code)
-  {    
-    strcat(str_static_data, data->str_destination_code);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_origination_code)
-  {    
-    strcat(str_static_data, data->str_origination_code);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_schedule_class)
-  {    
-    strcat(str_static_data, data->str_schedule_class);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_cc_id)
-  {    
-    strcat(str_static_data, data->str_cc_id);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_current_driving_mode)
-  {    
-    strcat(str_static_data, data->str_current_driving_mode);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_selected_driving_mode)
-  {    
-    strcat(str_static_data, data->str_selected_driving_mode);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_talkative)
-  {    
-    strcat(str_static_data, data->str_talkative);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_motion)
-  {    
-    strcat(str_static_data, data->str_motion);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_skip_stop)
-  {    
-    strcat(str_static_data, data->str_skip_stop);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_doors_open)
-  {    
-    strcat(str_static_data, data->str_doors_open);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_door_fault)
-  {    
-    strcat(str_static_data, data->str_door_fault);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_alarm)
-  {    
-    strcat(str_static_data, data->str_alarm);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_emergency_brake)
-  {    
-    strcat(str_static_data, data->str_emergency_brake);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_speed)
-  {    
-    strcat(str_static_data, data->str_speed);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_from_station)
-  {    
-    strcat(str_static_data, data->str_from_station);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_to_station)
-  {    
-    strcat(str_static_data, data->str_to_station);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_direction_code)
-  {    
-    strcat(str_static_data, data->str_direction_code);
-  }
-  strcat(str_static_data, ",");
-
-  snprintf(tmp, STR_EXTRA, "%010ld,%03d,%d,", 
-           data->timestamp, 
-           data->cc_id, 
-           data->direction);
-  strcat(str_static_data, tmp);
-  snprintf(tmp, STR_EXTRA, "% .1f,", 
-           data->signed_measured_speed_km_h);
-  strcat(str_static_data, tmp);
-
-  if (NULL != data->str_station_code)
-  {    
-    strcat(str_static_data, data->str_station_code);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_platform)
-  {    
-    strcat(str_static_data, data->str_platform);
-  }
-  strcat(str_static_data, ",");
-
-  snprintf(tmp, STR_EXTRA, "%d,%d", 
-           data->is_platform, 
-           data->is_motion);
-  strcat(str_static_data, tmp);
-
+  input_data_format(str_static_data, STR_EXTRA, data);
   return str_static_data;
 }
 
+/** @brief  format lutData as a csv record into a caller supplied buffer
+ *      in a single pass, the output is truncated if the buffer is too small
+ *  @param  *buf   destination buffer 
+ *  @param  size   destination buffer size in bytes
+ *  @param  *data  lutData to be converted 
+ *  @return number of characters needed, excluding the null terminator
+ *             
+ */
+size_t
+lut_data_format(char *buf, size_t size, const lutData *data)
+{
+  strCursor cur;
+
+  str_cursor_init(&cur, buf, size);
+  if (NULL == data)
+  {
+    return 0;
+  }
+
+  str_cursor_printf(&cur, "%010" PRIu64 ",", data->id);
+  str_cursor_puts(&cur, data->sorting_str);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_id);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_location);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_block);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_direction);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_direction_code);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_direction_num);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_platform);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_station_code);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_block_length);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_from_station);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_to_station);
+  str_cursor_putc(&cur, ',');
+  str_cursor_printf(&cur, "%d,%f,%d", 
+                    data->direction,
+                    data->block_length,
+                    data->is_platform);
+
+  return cur.len;
+}
+
 /** @brief  convert lutData and format into string 
  *  @param  *data  lutData to be converted 
  *  @return NULL      input is not valid
@@ -423,82 +686,81 @@ input_data_to_string(inputData *data)
 char *
 lut_data_to_string(lutData *data)
 {
-  char tmp[STR_EXTRA] = "";
   if (NULL == data)
   {
     return NULL;
   }
+  lut_data_format(str_static_data, STR_EXTRA, data);
+  return str_static_data;
+}
 
-  snprintf(tmp, STR_EXTRA, "%010" PRIu64 ",", data->id);
-  strcpy(str_static_data, tmp);
-  if (NULL != data->sorting_str)
-  {    
-    strcat(str_static_data, data->sorting_str);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_id)
-  {    
-    strcat(str_static_data, data->str_id);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_location)
-  {    
-    strcat(str_static_data, data->str_location);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_block)
-  {    
-    strcat(str_static_data, data->str_block);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_direction)
-  {    
-    strcat(str_static_data, data->str_direction);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_direction_code)
-  {    
-    strcat(str_static_data, data->str_direction_code);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_direction_num)
-  {    
-    strcat(str_static_data, data->str_direction_num);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_platform)
-  {    
-    strcat(str_static_data, data->str_platform);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_station_code)
-  {    
-    strcat(str_static_data, data->str_station_code);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_block_length)
-  {    
-    strcat(str_static_data, data->str_block_length);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_from_station)
-  {    
-    strcat(str_static_data, data->str_from_station);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_to_station)
-  {    
-    strcat(str_static_data, data->str_to_station);
-  }
-  strcat(str_static_data, ",");
-
-  snprintf(tmp, STR_EXTRA, "%d,%f,%d", 
-           data->direction,
-           data->block_length,
-           data->is_platform);
-  strcat(str_static_data, tmp);
+/** @brief  format outputData as a csv record into a caller supplied buffer
+ *      in a single pass, the output is truncated if the buffer is too small
+ *  @param  *buf   destination buffer 
+ *  @param  size   destination buffer size in bytes
+ *  @param  *data  outputData to be converted 
+ *  @return number of characters needed, excluding the null terminator
+ *             
+ */
+size_t
+output_data_format(char *buf, size_t size, const outputData *data)
+{
+  strCursor cur;
 
-  return str_static_data;
+  str_cursor_init(&cur, buf, size);
+  if (NULL == data)
+  {
+    return 0;
+  }
+
+  str_cursor_printf(&cur, "%010" PRIu64 ",", data->id);
+  str_cursor_puts(&cur, data->sorting_str);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->input_data_file);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->output_data_file);
+  str_cursor_putc(&cur, ',');
+  str_cursor_printf(&cur, "%010" PRIu64 ",", data->input_data_id);
+  str_cursor_puts(&cur, data->str_timestamp);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_cc_id);
+  str_cursor_putc(&cur, ',');
+  str_cursor_printf(&cur, "%f,", data->log_time_s);
+  str_cursor_puts(&cur, data->segment_id);
+  str_cursor_putc(&cur, ',');
+  str_cursor_printf(&cur, "%f,%f,%f,%f,%f,%d,%d,", 
+                    data->distance_travelled_0_m,
+                    data->distance_travelled_1_m,
+                    data->accum_distance_travelled_ft,
+                    data->permitted_speed_km_h,
+                    data->measured_speed_km_h,
+                    data->current_tag_id,
+                    data->ti_tag);
+  str_cursor_puts(&cur, data->signal_name);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->signal_name_graphing);
+  str_cursor_putc(&cur, ',');
+  str_cursor_printf(&cur, "%f,%f,", 
+                    data->civil_speed_km_h, 
+                    data->travel_time_s);
+  str_cursor_puts(&cur, data->str_from_station);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_to_station);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_direction_code);
+  str_cursor_putc(&cur, ',');
+  str_cursor_printf(&cur, "%010ld,%03d,", 
+                    data->timestamp, 
+                    data->cc_id);
+  str_cursor_puts(&cur, data->str_station_code);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_platform);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_direction_num);
+  str_cursor_putc(&cur, ',');
+  str_cursor_printf(&cur, "%02d", data->run_cnt);
+
+  return cur.len;
 }
 
 /** @brief  convert outputData and format into string 
@@ -510,200 +772,67 @@ lut_data_to_string(lutData *data)
 char *
 output_data_to_string(outputData *data)
 {
-  char tmp[STR_EXTRA] = "";
   if (NULL == data)
   {
     return NULL;
   }
-
-  snprintf(tmp, STR_EXTRA, "%010" PRIu64 ",", data->id);
-  strcpy(str_static_data, tmp);
-  if (NULL != data->sorting_str)
-  {    
-    strcat(str_static_data, data->sorting_str);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->input_data_file)
-  {    
-    strcat(str_static_data, data->input_data_file);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->output_data_file)
-  {    
-    strcat(str_static_data, data->output_data_file);
-  }
-  strcat(str_static_data, ",");
-
-  snprintf(tmp, STR_EXTRA, "%010" PRIu64 ",", data->input_data_id);
-  strcat(str_static_data, tmp);
-  
-  if (NULL != data->str_timestamp)
-  {    
-    strcat(str_static_data, data->str_timestamp);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_cc_id)
-  {    
-    strcat(str_static_data, data->str_cc_id);
-  }
-  strcat(str_static_data, ",");
-
-  snprintf(tmp, STR_EXTRA, "%f,", data->log_time_s);
-  strcat(str_static_data, tmp);
-
-  if (NULL != data->segment_id)
-  {    
-    strcat(str_static_data, data->segment_id);
-  }
-  strcat(str_static_data, ",");
-
-  snprintf(tmp, STR_EXTRA, "%f,%f,%f,%f,%f,%d,%d,", 
-           data->distance_travelled_0_m,
-           data->distance_travelled_1_m,
-           data->accum_distance_travelled_ft,
-           data->permitted_speed_km_h,
-           data->measured_speed_km_h,
-           data->current_tag_id,
-           data->ti_tag);
-  strcat(str_static_data, tmp);
-
-  if (NULL != data->signal_name)
-  {    
-    strcat(str_static_data, data->signal_name);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->signal_name_graphing)
-  {    
-    strcat(str_static_data, data->signal_name_graphing);
-  }
-  strcat(str_static_data, ",");
-
-  snprintf(tmp, STR_EXTRA, "%f,%f,", 
-           data->civil_speed_km_h, 
-           data->travel_time_s);
-  strcat(str_static_data, tmp);
-
-  if (NULL != data->str_from_station)
-  {    
-    strcat(str_static_data, data->str_from_station);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_to_station)
-  {    
-    strcat(str_static_data, data->str_to_station);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_direction_code)
-  {    
-    strcat(str_static_data, data->str_direction_code);
-  }
-  strcat(str_static_data, ",");
-
-  snprintf(tmp, STR_EXTRA, "%010ld,%03d,", 
-           data->timestamp, 
-           data->cc_id);
-  strcat(str_static_data, tmp);
-
-  if (NULL != data->str_station_code)
-  {    
-    strcat(str_static_data, data->str_station_code);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_platform)
-  {    
-    strcat(str_static_data, data->str_platform);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_direction_num)
-  {    
-    strcat(str_static_data, data->str_direction_num);
-  }
-  strcat(str_static_data, ",");
-
-  snprintf(tmp, STR_EXTRA, "%02d", data->run_cnt);
-  strcat(str_static_data, tmp);
-
+  output_data_format(str_static_data, STR_EXTRA, data);
   return str_static_data;
 }
 
 /** @brief  print block look up table on the screen
- *  @param  none
+ *  @param  *ctx  context
  *  @return errorCode
  *             
  */
-int 
-display_lut_data_list()
+static int
+atc_display_lut_data_list(atcContext *ctx)
 {
-  int err = 0;
-  lutData *p_data = NULL;
-  bool b_enabled = true;
+  const atcLut *p_lut = ctx->p_lut;
+  char str_record[STR_EXTRA] = "";
+  unsigned int i = 0;
 
-  /* print all lut data */  
-  if ( list_empty(&lut_data_list) )
+  /* print all lut data, in list order through the index so a table 
+  ** mapped from its compiled image is printed as well */
+  if (0 == p_lut->index_cnt)
   {
     return throw_err(err_lut_is_empty);    
   }
-  else
+  for (i = 0; i < p_lut->index_cnt; i++)
   {
-    /* iteration start */
-    /* check err, 0 - not able to start iteration; 1 - ok to iterate */
-    if (1 != list_iterator_start(&lut_data_list))
-    {
-      /* iteration not able to start */
-      return throw_err(err_list_iteration_failed);
-    }
-    else 
+    if (NULL == p_lut->p_index[i])
     {
-      while (list_iterator_hasnext(&lut_data_list) && (b_enabled)) 
-      { 
-        /* check for next element */
-        p_data = (lutData *)list_iterator_next(&lut_data_list);
-        if (NULL == p_data)
-        {
-          /* error on retrieving element from list */
-          err = throw_err(err_list_retrieval_failed);
-          b_enabled = false;
-        }
-        else
-        {
-          fprintf
-          (
-            stdout, 
-            "[%6s][%6s][%s]\n", 
-            "TRACE", 
-            "LUT", 
-            lut_data_to_string(p_data)
-          );
-        }
-      }
-
-      if (1 != list_iterator_stop(&lut_data_list))
-      {
-        /* iteration not able to stop */
-        return throw_err(err_list_stop_failed);
-      }
-      else
-      {
-        return err;
-      }
+      /* error on retrieving element from list */
+      return throw_err(err_list_retrieval_failed);
     }
+    lut_data_format(str_record, STR_EXTRA, p_lut->p_index[i]);
+    fprintf
+    (
+      stdout, 
+      "[%6s][%6s][%s]\n", 
+      "TRACE", 
+      "LUT", 
+      str_record
+    );
   }
+  return 0;
 }
 
 /** @brief  print input data list on the screen
- *  @param  none
+ *  @param  *ctx  context
  *  @return none
  *             
  */
-int 
-display_input_data_list()
+static int
+atc_display_input_data_list(atcContext *ctx)
 {
   int err = 0;
   inputData *p_data = NULL;
   bool b_enabled = true;
+  char str_record[STR_EXTRA] = "";
 
   /* print all input data */ 
-  if ( list_empty(&input_data_list) )
+  if ( list_empty(&ctx->input_data_list) )
   {
     return throw_err(err_list_is_empty);
   }
@@ -711,17 +840,17 @@ display_input_data_list()
   {
     /* iteration start */
     /* check err, 0 - not able to start iteration; 1 - ok to iterate */
-    if (1 != list_iterator_start(&input_data_list))
+    if (1 != list_iterator_start(&ctx->input_data_list))
     {
       /* iteration not able to start */
       return throw_err(err_list_iteration_failed);
     }
     else 
     {
-      while (list_iterator_hasnext(&input_data_list) && (b_enabled)) 
+      while (list_iterator_hasnext(&ctx->input_data_list) && (b_enabled)) 
       { 
         /* check for next element */
-        p_data = (inputData *)list_iterator_next(&input_data_list);
+        p_data = (inputData *)list_iterator_next(&ctx->input_data_list);
         if (NULL == p_data)
         {
           /* error on retrieving element from list */
@@ -730,17 +859,18 @@ display_input_data_list()
         }
         else
         {
+          input_data_format(str_record, STR_EXTRA, p_data);
           fprintf
           (
             stdout, 
             "[%6s][%6s][%s]\n", 
             "TRACE", 
             "INPUT", 
-            input_data_to_string(p_data)
+            str_record
           );
         }
       }
-      if (1 != list_iterator_stop(&input_data_list))
+      if (1 != list_iterator_stop(&ctx->input_data_list))
       {
         /* iteration not able to stop */
         return throw_err(err_list_stop_failed);
@@ -754,20 +884,21 @@ display_input_data_list()
 }
 
 /** @brief  print output data list on the screen
- *  @param  none
+ *  @param  *ctx  context
  *  @return none
  *             
  */
-int 
-display_output_data_list()
+static int
+atc_display_output_data_list(atcContext *ctx)
 {
   int err = 0;
   outputData *p_data = NULL;
   bool b_enabled = true;
+  char str_record[STR_EXTRA] = "";
 
   /* print output data list */
   
-  if ( list_empty(&output_data_list) )
+  if ( list_empty(&ctx->output_data_list) )
   {
     return throw_err(err_list_is_empty);
   }
@@ -775,17 +906,17 @@ display_output_data_list()
   {
     /* iteration start */
     /* check err, 0 - not able to start iteration; 1 - ok to iterate */
-    if (1 != list_iterator_start(&output_data_list))
+    if (1 != list_iterator_start(&ctx->output_data_list))
     {
       /* iteration not able to start */
       return throw_err(err_list_iteration_failed);
     }
     else 
     {
-      while (list_iterator_hasnext(&output_data_list) && (b_enabled)) 
+      while (list_iterator_hasnext(&ctx->output_data_list) && (b_enabled)) 
       { 
         /* check for next element */
-        p_data = (outputData *)list_iterator_next(&output_data_list);
+        p_data = (outputData *)list_iterator_next(&ctx->output_data_list);
         if (NULL == p_data)
         {
           /* error on retrieving element from list */
@@ -794,17 +925,18 @@ display_output_data_list()
         }
         else
         {
+          output_data_format(str_record, STR_EXTRA, p_data);
           fprintf
           (
             stdout, 
             "[%6s][%6s][%s]\n", 
             "TRACE", 
             "OUTPUT", 
-            output_data_to_string(p_data)
+            str_record
           );
         }
       }
-      if (1 != list_iterator_stop(&output_data_list))
+      if (1 != list_iterator_stop(&ctx->output_data_list))
       {
         /* iteration not able to stop */
         return throw_err(err_list_stop_failed);
@@ -818,96 +950,111 @@ display_output_data_list()
 }
 
 /** @brief  initialize lookup list
- *  @param  none
+ *  @param  *ctx  context
  *  @return none
  *             
  */
-void 
-init_lut_data_list()
+static void
+atc_init_lut_data_list(atcContext *ctx)
 {
-  list_init(&lut_data_list);
-  list_attributes_copy(&lut_data_list, lut_data_meter, 1);
-  list_attributes_comparator(&lut_data_list, lut_data_comparator);
+  list_init(&ctx->p_lut->lut_data_list);
+  list_attributes_copy(&ctx->p_lut->lut_data_list, lut_data_meter, 1);
+  list_attributes_comparator(&ctx->p_lut->lut_data_list, lut_data_comparator);
+  init_list_memory(ctx, k_list_lut, sizeof(lutData));
 }
 
 /** @brief  initialize input data list
- *  @param  none
+ *  @param  *ctx  context
  *  @return none
  *             
  */
-void 
-init_input_data_list()
+static void
+atc_init_input_data_list(atcContext *ctx)
 {
   /* list initialization */
-  list_init(&input_data_list);
-  list_attributes_copy(&input_data_list, input_data_meter, 1);
-  list_attributes_comparator(&input_data_list, input_data_comparator);
+  list_init(&ctx->input_data_list);
+  list_attributes_copy(&ctx->input_data_list, input_data_meter, 1);
+  list_attributes_comparator(&ctx->input_data_list, input_data_comparator);
+  init_list_memory(ctx, k_list_input, sizeof(inputData));
 }
 
 /** @brief  initialize output data list
- *  @param  none
+ *  @param  *ctx  context
  *  @return none
  *             
  */
-void 
-init_output_data_list()
+static void
+atc_init_output_data_list(atcContext *ctx)
 {
   /* list initialization */
-  list_init(&output_data_list);
-  list_attributes_copy(&output_data_list, output_data_meter, 1);
-  list_attributes_comparator(&output_data_list, output_data_comparator);
+  list_init(&ctx->output_data_list);
+  list_attributes_copy(&ctx->output_data_list, output_data_meter, 1);
+  list_attributes_comparator(&ctx->output_data_list, output_data_comparator);
+  init_list_memory(ctx, k_list_output, sizeof(outputData));
 }
 
 /** @brief  sort input data list
- *  @param  none
+ *  @param  *ctx  context
  *  @return none
  *             
  */
-int 
-sort_input_data_list()
+int
+atc_sort_input_data_list(atcContext *ctx)
 {
-  if (list_empty(&input_data_list))
+  if (list_empty(&ctx->input_data_list))
   {
     return throw_err(err_list_is_empty);    
   }
   else
   {
-    list_sort(&input_data_list, -1);
+    list_sort(&ctx->input_data_list, -1);
     return 0;
   }
 }
 
 /** @brief  clear and free lookup table list
- *  @param  none
+ *  @param  *ctx  context
  *  @return none
  *             
  */
-void 
-free_lut_data_list()
+static void
+atc_free_lut_data_list(atcContext *ctx)
 {
-  list_destroy(&lut_data_list);
+  list_destroy(&ctx->p_lut->lut_data_list);
+  free(ctx->p_lut->p_index);
+  ctx->p_lut->p_index = NULL;
+  ctx->p_lut->index_cnt = 0;
+  ctx->p_lut->index_size = 0;
+  free(ctx->p_lut->p_block_index);
+  ctx->p_lut->p_block_index = NULL;
+  lut_cache_close(ctx->p_lut->p_cache);
+  ctx->p_lut->p_cache = NULL;
+  ctx->p_lut->p_embedded = NULL;
+  clear_list_memory(ctx, k_list_lut);
 }
 
 /** @brief  clear and free input data list
- *  @param  none
+ *  @param  *ctx  context
  *  @return none
  *             
  */
-void 
-free_input_data_list()
+static void
+atc_free_input_data_list(atcContext *ctx)
 {
-  list_destroy(&input_data_list);
+  list_destroy(&ctx->input_data_list);
+  clear_list_memory(ctx, k_list_input);
 }
 
 /** @brief  clear and free output data list
- *  @param  none
+ *  @param  *ctx  context
  *  @return none
  *             
  */
-void 
-free_output_data_list()
+static void
+atc_free_output_data_list(atcContext *ctx)
 {
-  list_destroy(&output_data_list);
+  list_destroy(&ctx->output_data_list);
+  clear_list_memory(ctx, k_list_output);
 }
 
 /** @brief  convert date time formatted string to time_t seconds format
@@ -1066,12 +1213,13 @@ is_csv_line(char *line, int num_col_lo)
  *            variables.
  *      split the line with delimiter ",", match token to header name and 
  *        store column number to input header.
+ *  @param  *ctx  context
  *  @param  *line  header line string 
  *  @return                 0     header parsed successfully
  *          err_missing_header    some header info is missing
  */
 int
-parse_input_header(char *line)
+atc_parse_input_header(atcContext *ctx, char *line)
 {
   char delim = ',';
   char *token = NULL;
@@ -1085,97 +1233,97 @@ parse_input_header(char *line)
   {
     if (0 == strcmp(trim(token), k_header_names[k_header_id_time]))
     {
-      input_header.col_time = num;
+      ctx->input_header.col_time = num;
       b_header_covered[k_header_id_time] = true;
     }
     else if (0 == strcmp(trim(token), k_header_names[k_header_id_location]))
     {
-      input_header.col_location = num;
+      ctx->input_header.col_location = num;
       b_header_covered[k_header_id_location] = true;
     }
     else if (0 == strcmp(trim(token), k_header_names[k_header_id_block]))
     {
-      input_header.col_block = num;
+      ctx->input_header.col_block = num;
       b_header_covered[k_header_id_block] = true;
     }
     else if (0 == strcmp(trim(token), k_header_names[k_header_id_run_number]))
     {
-      input_header.col_run_number = num;
+      ctx->input_header.col_run_number = num;
       b_header_covered[k_header_id_run_number] = true;
     }
     else if (0 == strcmp(trim(token), k_header_names[k_header_id_direction]))
     {
-      input_header.col_direction = num;
+      ctx->input_header.col_direction = num;
       b_header_covered[k_header_id_direction] = true;
     }
     else if (0 == strcmp(trim(token), k_header_names[k_header_id_destination_code]))
     {
-      input_header.col_destination_code = num;
+      ctx->input_header.col_destination_code = num;
       b_header_covered[k_header_id_destination_code] = true;
     }
     else if (0 == strcmp(trim(token), k_header_names[k_header_id_origination_code]))
     {
-      input_header.col_origination_code = num;
+      ctx->input_header.col_origination_code = num;
       b_header_covered[k_header_id_origination_code] = true;
     }
     else if (0 == strcmp(trim(token), k_header_names[k_header_id_schedule_class]))
     {
-      input_header.col_schedule_class = num;
+      ctx->input_header.col_schedule_class = num;
       b_header_covered[k_header_id_schedule_class] = true;
     }
     else if (0 == strcmp(trim(token), k_header_names[k_header_id_cc_id]))
     {
-      input_header.col_cc_id = num;
+      ctx->input_header.col_cc_id = num;
       b_header_covered[k_header_id_cc_id] = true;
     }
     else if (0 == strcmp(trim(token), k_header_names[k_header_id_current_driving_mode]))
     {
-      input_header.col_current_driving_mode = num;
+      ctx->input_header.col_current_driving_mode = num;
       b_header_covered[k_header_id_current_driving_mode] = true;
     }
     else if (0 == strcmp(trim(token), k_header_names[k_header_id_selected_driving_mode]))
     {
-      input_header.col_selected_driving_mode = num;
+      ctx->input_header.col_selected_driving_mode = num;
       b_header_covered[k_header_id_selected_driving_mode] = true;
     }
     else if (0 == strcmp(trim(token), k_header_names[k_header_id_talkative]))
     {
-      input_header.col_talkative = num;
+      ctx->input_header.col_talkative = num;
       b_header_covered[k_header_id_talkative] = true;
     }
     else if (0 == strcmp(trim(token), k_header_names[k_header_id_motion]))
     {
-      input_header.col_motion = num;
+      ctx->input_header.col_motion = num;
       b_header_covered[k_header_id_motion] = true;
     }
     else if (0 == strcmp(trim(token), k_header_names[k_header_id_skip_stop]))
     {
-      input_header.col_skip_stop = num;
+      ctx->input_header.col_skip_stop = num;
       b_header_covered[k_header_id_skip_stop] = true;
     }
     else if (0 == strcmp(trim(token), k_header_names[k_header_id_doors_open]))
     {
-      input_header.col_doors_open = num;
+      ctx->input_header.col_doors_open = num;
       b_header_covered[k_header_id_doors_open] = true;
     }
     else if (0 == strcmp(trim(token), k_header_names[k_header_id_door_fault]))
     {
-      input_header.col_door_fault = num;
+      ctx->input_header.col_door_fault = num;
       b_header_covered[k_header_id_door_fault] = true;
     }
     else if (0 == strcmp(trim(token), k_header_names[k_header_id_alarm]))
     {
-      input_header.col_alarm = num;
+      ctx->input_header.col_alarm = num;
       b_header_covered[k_header_id_alarm] = true;
     }
     else if (0 == strcmp(trim(token), k_header_names[k_header_id_emergency_brake]))
     {
-      input_header.col_emergency_brake = num;
+      ctx->input_header.col_emergency_brake = num;
       b_header_covered[k_header_id_emergency_brake] = true;
     }
     else if (0 == strcmp(trim(token), k_header_names[k_header_id_speed]))
     {
-      input_header.col_speed = num;
+      ctx->input_header.col_speed = num;
       b_header_covered[k_header_id_speed] = true;
     }
     else
@@ -1186,7 +1334,7 @@ parse_input_header(char *line)
     num++;
   }
 
-  while ((b_header_covered[i]) && (i < k_header_cnt))
+  while ((i < k_header_cnt) && (b_header_covered[i]))
   {
     i++;
   }
@@ -1204,85 +1352,114 @@ parse_input_header(char *line)
  *      convert time string into timestamp, validate the cc number, 
  *      calculate the sorting string, and generate id. returns negative on
  *      error.
+ *  @param  *ctx  context
  *  @param  *input_data  pointer to the new input data structure 
  *  @param  *str_data_line  input data string
  *  @param  *str_data_file  input data file
- *  @return err_cc_not_valid
+ *  @return INPUT_ROW_FILTERED  row outside the time window, only its
+ *                              timestamp is set
+ *          err_cc_not_valid
  *          err_date_not_valid
  *          err_maximum_number_exceeded
  */
-int 
-parse_input_data(inputData *input_data, char *str_data_line, char *str_data_file)
+int
+atc_parse_input_data(atcContext *ctx, inputData *input_data, char *str_data_line, char *str_data_file)
 {
   char delim = ',';
   char *token = NULL;
-  char col_data[k_header_cnt][STR_LONG] = {""};
+  /* columns are trimmed in place in the line, missing ones are empty */
+  char *col_data[k_header_cnt];
   
   int i = 0;
   int cc_num = 0;
   time_t timestamp = -1;
   char *p_temp;
 
+  for (i = 0; i < k_header_cnt; i++)
+  {
+    col_data[i] = "";
+  }
+  i = 0;
   token = cstrtok(str_data_line, delim);
   while ((NULL != token) && (i < k_header_cnt))
   {
-     strcpy(col_data[i], trim(token));
+     col_data[i] = trim(token);
      token = cstrtok(NULL, delim);
      i++;
   }
 
+  /* rows outside the time window or of trains not requested are dropped
+  ** before any other column is copied, a time or cc number not valid is
+  ** reported below */
+  timestamp = str_to_seconds(col_data[ctx->input_header.col_time]);
+  if (ctx->b_time_window && (timestamp >= 0) &&
+      (((ctx->time_from >= 0) && (timestamp < ctx->time_from)) ||
+       ((ctx->time_to >= 0) && (timestamp >= ctx->time_to))))
+  {
+    input_data->timestamp = timestamp;
+    return INPUT_ROW_FILTERED;
+  }
+  if (ctx->b_cc_filter)
+  {
+    cc_num = (int) strtol(col_data[ctx->input_header.col_cc_id], &p_temp, 10);
+    if ((cc_num > 0) && (cc_num <= CC_ID_MAX) && !ctx->b_cc_kept[cc_num])
+    {
+      input_data->timestamp = timestamp;
+      return INPUT_ROW_FILTERED;
+    }
+  }
+
   /* str_time[STR_MEDIUM] */
-  strcpy(input_data->str_time, col_data[input_header.col_time]);
+  strcpy(input_data->str_time, col_data[ctx->input_header.col_time]);
 
   /* str_location[STR_MEDIUM] */
-  strcpy(input_data->str_location, col_data[input_header.col_location]);
+  strcpy(input_data->str_location, col_data[ctx->input_header.col_location]);
   /* str_block[STR_SHORT] */
-  strcpy(input_data->str_block, col_data[input_header.col_block]);
+  strcpy(input_data->str_block, col_data[ctx->input_header.col_block]);
   /* str_run_number[STR_MIN] */  
-  strcpy(input_data->str_run_number, col_data[input_header.col_run_number]);
+  strcpy(input_data->str_run_number, col_data[ctx->input_header.col_run_number]);
   /* str_direction[STR_MIN] */
-  strcpy(input_data->str_direction, col_data[input_header.col_direction]);
+  strcpy(input_data->str_direction, col_data[ctx->input_header.col_direction]);
   /* str_destination_code[STR_MIN] */
-  strcpy(input_data->str_destination_code, col_data[input_header.col_destination_code]);
+  strcpy(input_data->str_destination_code, col_data[ctx->input_header.col_destination_code]);
   /* str_origination_code[STR_MIN] */
-  strcpy(input_data->str_origination_code, col_data[input_header.col_origination_code]);
+  strcpy(input_data->str_origination_code, col_data[ctx->input_header.col_origination_code]);
   /* str_schedule_class[STR_MIN] */
-  strcpy(input_data->str_schedule_class, col_data[input_header.col_schedule_class]);
+  strcpy(input_data->str_schedule_class, col_data[ctx->input_header.col_schedule_class]);
   /* str_cc_id[STR_MIN] */
-  strcpy(input_data->str_cc_id, col_data[input_header.col_cc_id]);
+  strcpy(input_data->str_cc_id, col_data[ctx->input_header.col_cc_id]);
   /* str_current_driving_mode[STR_MIN] */
-  strcpy(input_data->str_current_driving_mode, col_data[input_header.col_current_driving_mode]);
+  strcpy(input_data->str_current_driving_mode, col_data[ctx->input_header.col_current_driving_mode]);
   /* str_selected_driving_mode[STR_MIN] */
-  strcpy(input_data->str_selected_driving_mode, col_data[input_header.col_selected_driving_mode]);
+  strcpy(input_data->str_selected_driving_mode, col_data[ctx->input_header.col_selected_driving_mode]);
   /* str_talkative[STR_MIN] */
-  strcpy(input_data->str_talkative, col_data[input_header.col_talkative]);
+  strcpy(input_data->str_talkative, col_data[ctx->input_header.col_talkative]);
   /* str_motion[STR_MIN] */
-  strcpy(input_data->str_motion, col_data[input_header.col_motion]);
+  strcpy(input_data->str_motion, col_data[ctx->input_header.col_motion]);
   /* str_skip_stop[STR_MIN] */
-  strcpy(input_data->str_skip_stop, col_data[input_header.col_skip_stop]);
+  strcpy(input_data->str_skip_stop, col_data[ctx->input_header.col_skip_stop]);
   /* str_doors_open[STR_MIN] */
-  strcpy(input_data->str_doors_open, col_data[input_header.col_doors_open]);
+  strcpy(input_data->str_doors_open, col_data[ctx->input_header.col_doors_open]);
   /* str_door_fault[STR_MIN] */
-  strcpy(input_data->str_door_fault, col_data[input_header.col_door_fault]);
+  strcpy(input_data->str_door_fault, col_data[ctx->input_header.col_door_fault]);
   /* str_alarm[STR_MIN] */
-  strcpy(input_data->str_alarm, col_data[input_header.col_alarm]);
+  strcpy(input_data->str_alarm, col_data[ctx->input_header.col_alarm]);
   /* str_emergency_brake[STR_MIN] */
-  strcpy(input_data->str_emergency_brake, col_data[input_header.col_emergency_brake]);
+  strcpy(input_data->str_emergency_brake, col_data[ctx->input_header.col_emergency_brake]);
   /* str_speed[STR_MIN] */
-  strcpy(input_data->str_speed, col_data[input_header.col_speed]);
+  strcpy(input_data->str_speed, col_data[ctx->input_header.col_speed]);
 
   /* id */
-  if (LIST_MAX_SIZE == input_list_id)
+  if (LIST_MAX_SIZE == ctx->input_list_id)
   {
     /* reach the maximum number of input list id */
     return throw_err(err_maximum_number_exceeded);
   }
-  input_data->id = input_list_id++;
+  input_data->id = ctx->input_list_id++;
   /* input_data_file */
   strcpy(input_data->input_data_file, strip_path(str_data_file));
 
   /* YYYYMMDDHHMMSS converted from str_time */
-  timestamp = str_to_seconds(input_data->str_time);
   if (0 > timestamp){
     input_data->timestamp = -1;
     return throw_err(err_date_not_valid);
@@ -1293,7 +1470,7 @@ parse_input_data(inputData *input_data, char *str_data_line, char *str_data_file
   /* sorting value "nnnYYYYMMDDHHMMSS" */
   /* combination of str_cc_id, str_timestamp */
   cc_num = (int) strtol(input_data->str_cc_id, &p_temp, 10);
-  if ((cc_num <= 0) || (cc_num > 999))
+  if ((cc_num <= 0) || (cc_num > CC_ID_MAX))
   {
     /* cc number is not valid */
     input_data->cc_id = 0;
@@ -1460,13 +1637,15 @@ parse_lut_data(lutData *input_data, char *str_data_line)
 }
 
 /** @brief  calculate run profile file name from the output data 
+ *  @param  *ctx  context
  *  @param  filename  buffer to store resulted filename
  *  @param  data      pointer to output data
+ *  @param  *file_cnt run counter in the file name output
  *  @return err_insufficient_buffer_size 
  *  
  */
-int
-get_output_file(char *filename, outputData *data)
+static int
+atc_get_output_file(atcContext *ctx, char *filename, outputData *data, int *file_cnt)
 {
   char str_temp[STR_MAX] = "";
   char str_station_code[STR_MIN] = "";
@@ -1476,7 +1655,10 @@ get_output_file(char *filename, outputData *data)
   bool b_available = false;
   FILE *fp = NULL;
 
-  if ((strlen(RUN_PROFILE_PATH) +
+  const char *str_output_path = ('\0' != ctx->str_output_path[0]) ? 
+                                ctx->str_output_path : RUN_PROFILE_PATH;
+
+  if ((strlen(str_output_path) +
        strlen(RUN_PROFILE_PREFIX) + 
        strlen(data->str_station_code) + 
        strlen(data->str_platform) + 
@@ -1511,7 +1693,7 @@ get_output_file(char *filename, outputData *data)
       str_temp, 
       STR_MAX, 
       "%s%s%s%s_%02d_CC%03d_%s", 
-      RUN_PROFILE_PATH,
+      str_output_path,
       RUN_PROFILE_PREFIX,
       str_station_code, 
       str_platform, 
@@ -1522,7 +1704,8 @@ get_output_file(char *filename, outputData *data)
     fp = fopen(str_temp,"r");
     if (NULL == fp)
     {
-      b_available = true;
+      /* name may already be taken by a run still queued for writing */
+      b_available = !async_writer_is_pending(ctx->p_async_writer, str_temp);
     }
     else
     {
@@ -1532,107 +1715,208 @@ get_output_file(char *filename, outputData *data)
   }
     
   strcpy(filename, str_temp);  
+  *file_cnt = i - 1;
   return 0;
 }
 
-/** @brief  match input_data str_block(segment_id) and str_direction           
- *          to lookup table, retrieve direction, str_station_code, 
- *          str_platform, is_platform, and store in input_data 
- *  @param  *input_data  input data 
+/** @brief  claim the next free run profile file name by creating the file
+ *          empty, the creation fails if the name is taken meanwhile, so 
+ *          jobs exporting to the same folder never share a name
+ *  @param  *ctx       context
+ *  @param  filename   buffer to store resulted filename
+ *  @param  data       pointer to output data
+ *  @param  *file_cnt  run index used in the file name, output
  *  @return 0
- *          err_lut_is_empty 
- *          err_lut_match_not_found
- *          err_file_format_not_valid
- *          err_list_iteration_failed 
- * 
+ *          err_insufficient_buffer_size
+ *          err_file_not_accessible
+ *          err_file_already_exist       every run index is taken
  */
-int
-expand_data_use_lut(inputData *input_data)
+static int
+atc_claim_output_file(atcContext *ctx, char *filename, outputData *data, int *file_cnt)
 {
-  lutData *p_lut_data = NULL;  
-  bool is_matched = false;
-  double speed_km_h = 0;
+  int fd = -1;
   int err = 0;
+  int i = 0;
 
-  bool b_enabled = true;
-
-  if (  (NULL == input_data->str_block) ||
-        (strlen(input_data->str_block) < 2) ||
-        (NULL == input_data->str_direction) ||
-        (strlen(input_data->str_direction) < 1) )
-  { 
-    return throw_err(err_file_format_not_valid);
-  }
-  if ( list_empty(&lut_data_list) )
+  for (i = 0; i <= MAX_FILE_CNT; i++)
   {
-    return throw_err(err_lut_is_empty);
+    err = atc_get_output_file(ctx, filename, data, file_cnt);
+    if (err < 0)
+    {
+      return err;
+    }
+    fd = open(filename, O_WRONLY | O_CREAT | O_EXCL, 0666);
+    if (fd >= 0)
+    {
+      close(fd);
+      return 0;
+    }
+    if (EEXIST != errno)
+    {
+      return throw_err(err_file_not_accessible);
+    }
   }
-  /* iterate through the lut list until find match */
-  /* iteration start */
-  /* check err, 0 - not able to start iteration; 1 - ok to iterate */
-  if (1 != list_iterator_start(&lut_data_list))
+  return throw_err(err_file_already_exist);
+}
+
+/** @brief  find the first lookup record of a block in list order
+ *  @param  *p_lut      lookup table with its block index built
+ *  @param  *str_block  block
+ *  @return NULL        block not in the table
+ *          lookup record
+ */
+static const lutData *
+atc_find_lut_block(const atcLut *p_lut, const char *str_block)
+{
+  unsigned int lo = 0;
+  unsigned int hi = p_lut->index_cnt;
+  unsigned int mid = 0;
+  const lutData *p_data = NULL;
+
+  if (NULL != p_lut->p_embedded)
   {
-    /* iteration not able to start */
-    return throw_err(err_list_iteration_failed);
+    return lut_embed_find(p_lut->p_embedded, str_block);
   }
-
-  while ((!is_matched) && (list_iterator_hasnext(&lut_data_list)) && (b_enabled)) 
-  { 
-    /* check for next element */
-    p_lut_data = (lutData *)list_iterator_next(&lut_data_list);
-    if (NULL == p_lut_data)
+  /* lower bound, the entries of one block are in list order */
+  while (lo < hi)
+  {
+    mid = lo + (hi - lo) / 2;
+    if (strcmp(p_lut->p_index[p_lut->p_block_index[mid]]->str_block, str_block) < 0)
     {
-      /* error on retrieving element from list */
-      err = throw_err(err_list_retrieval_failed);
-      b_enabled = false;
+      lo = mid + 1;
     }
     else
     {
-      /* process lut data constructs output data structure */
-      /* generate output list id */
-      if (0 == strcmp(p_lut_data->str_block, input_data->str_block))
-      {
-        strcpy(input_data->str_station_code, p_lut_data->str_station_code);
-        strcpy(input_data->str_platform, p_lut_data->str_platform);
-        strcpy(input_data->str_from_station, p_lut_data->str_from_station);
-        strcpy(input_data->str_to_station, p_lut_data->str_to_station);
-        strcpy(input_data->str_direction_code, p_lut_data->str_direction_code);
-
-        input_data->is_platform = p_lut_data->is_platform;
-        input_data->direction = p_lut_data->direction;
+      hi = mid;
+    }
+  }
+  if (lo < p_lut->index_cnt)
+  {
+    p_data = p_lut->p_index[p_lut->p_block_index[lo]];
+    if (0 == strcmp(p_data->str_block, str_block))
+    {
+      return p_data;
+    }
+  }
+  return NULL;
+}
 
-        /* calculate signed_measured_speed_km_h */
-        if ((input_data->str_speed[0] < '0') || (input_data->str_speed[0] > '9'))
-        {
-          err = throw_err(err_speed_not_valid);
-        }
-        else
-        {
-          sscanf(input_data->str_speed, "%lf", &speed_km_h);
-          
-          if (1 == input_data->direction)
-          {
-            input_data->signed_measured_speed_km_h = speed_km_h;
-          }
-          else if (2 == input_data->direction)
-          {
-            input_data->signed_measured_speed_km_h = 0 - speed_km_h;
-          }
-          else
-          {
-            err = throw_err(err_file_format_not_valid);
-          }
-        } 
+/** @brief  take the lookup table from its compiled image, the records stay
+ *          in the mapped image
+ *  @param  *ctx           context with an empty lookup table
+ *  @param  *str_lut_file  lookup table csv path
+ *  @return 0
+ *          err_file_not_accessible       no valid image
+ *          err_maximum_number_exceeded   not enough memory
+ */
+static int
+atc_load_lut_cache(atcContext *ctx, const char *str_lut_file)
+{
+  atcLut *p_lut = ctx->p_lut;
+  const lutData *p_records = NULL;
+  lutCache *p_cache = NULL;
+  unsigned int cnt = 0;
+  unsigned int i = 0;
 
-        is_matched = true;
-      }
-    }
+  if (NULL == (p_cache = lut_cache_open(str_lut_file, ctx->b_lut_verify)))
+  {
+    return throw_err(err_file_not_accessible);
+  }
+  p_records = lut_cache_records(p_cache, &cnt);
+  p_lut->p_index = (lutData **) malloc(cnt * sizeof(lutData *));
+  p_lut->p_block_index = (unsigned int *) malloc(cnt * sizeof(unsigned int));
+  if ((NULL == p_lut->p_index) || (NULL == p_lut->p_block_index))
+  {
+    free(p_lut->p_index);
+    free(p_lut->p_block_index);
+    p_lut->p_index = NULL;
+    p_lut->p_block_index = NULL;
+    lut_cache_close(p_cache);
+    return throw_err(err_maximum_number_exceeded);
   }
+  for (i = 0; i < cnt; i++)
+  {
+    /* mapped read only, the lookups never write a record */
+    p_lut->p_index[i] = (lutData *) &p_records[i];
+  }
+  memcpy(p_lut->p_block_index, lut_cache_block_index(p_cache), cnt * sizeof(unsigned int));
+  p_lut->index_cnt = cnt;
+  p_lut->index_size = cnt;
+  p_lut->p_cache = p_cache;
+  ctx->tool_stats.lut_bytes_read += (uint64_t) lut_cache_size(p_cache);
+  return 0;
+}
 
-  if (1 != list_iterator_stop(&lut_data_list))
+/** @brief  match input_data str_block(segment_id) and str_direction           
+ *          to lookup table, retrieve direction, str_station_code, 
+ *          str_platform, is_platform, and store in input_data 
+ *  @param  *ctx  context
+ *  @param  *input_data  input data 
+ *  @return 0
+ *          err_lut_is_empty 
+ *          err_lut_match_not_found
+ *          err_file_format_not_valid
+ * 
+ */
+static int
+atc_expand_data_use_lut(atcContext *ctx, inputData *input_data)
+{
+  const atcLut *p_lut = ctx->p_lut;
+  const lutData *p_lut_data = NULL;  
+  bool is_matched = false;
+  double speed_km_h = 0;
+  int err = 0;
+
+  if (  (NULL == input_data->str_block) ||
+        (strlen(input_data->str_block) < 2) ||
+        (NULL == input_data->str_direction) ||
+        (strlen(input_data->str_direction) < 1) )
+  { 
+    return throw_err(err_file_format_not_valid);
+  }
+  if (0 == p_lut->index_cnt)
   {
-    return throw_err(err_list_stop_failed);
+    return throw_err(err_lut_is_empty);
+  }
+  /* binary search of the block index, the index is read only so a
+  ** shared table serves several jobs at once */
+  if (NULL != (p_lut_data = atc_find_lut_block(p_lut, input_data->str_block)))
+  {
+    strcpy(input_data->str_station_code, p_lut_data->str_station_code);
+    strcpy(input_data->str_platform, p_lut_data->str_platform);
+    strcpy(input_data->str_from_station, p_lut_data->str_from_station);
+    strcpy(input_data->str_to_station, p_lut_data->str_to_station);
+    strcpy(input_data->str_direction_code, p_lut_data->str_direction_code);
+
+    input_data->is_platform = p_lut_data->is_platform;
+    input_data->direction = p_lut_data->direction;
+
+    /* calculate signed_measured_speed_km_h */
+    if ((input_data->str_speed[0] < '0') || (input_data->str_speed[0] > '9'))
+    {
+      err = throw_err(err_speed_not_valid);
+    }
+    else
+    {
+      sscanf(input_data->str_speed, "%lf", &speed_km_h);
+      
+      if (1 == input_data->direction)
+      {
+        input_data->signed_measured_speed_km_h = speed_km_h;
+      }
+      else if (2 == input_data->direction)
+      {
+        input_data->signed_measured_speed_km_h = 0 - speed_km_h;
+      }
+      else
+      {
+        err = throw_err(err_file_format_not_valid);
+      }
+    } 
+
+    is_matched = true;
   }
+
   if (0 != err)
   {
     return err;
@@ -1645,12 +1929,13 @@ expand_data_use_lut(inputData *input_data)
 }
 
 /** @brief  read lookup table file and add to lookup table data list
+ *  @param  *ctx  context
  *  @param  *str_lut_file  lookup table file path 
  *  @return err_list_append_failed
  *          err_file_not_accessible      
  */
 int
-read_lut_file(char *str_lut_file)
+atc_read_lut_file(atcContext *ctx, char *str_lut_file)
 {
 
   int err = 0;
@@ -1660,6 +1945,8 @@ read_lut_file(char *str_lut_file)
   FILE *p_lut_file = NULL;
 
   bool b_enabled = true;
+  /* every line imported, only then the table is compiled */
+  bool b_clean = true;
 
   if (NULL == str_lut_file)
   {
@@ -1674,37 +1961,49 @@ read_lut_file(char *str_lut_file)
     err = throw_err(err_file_not_accessible); 
     return err;
   }
+
+  /* compiled image of the same csv, nothing to parse */
+  if (ctx->b_lut_cache && (0 == ctx->p_lut->index_cnt))
+  {
+    if (atc_load_lut_cache(ctx, str_lut_file) >= 0)
+    {
+      log_debug("[%s][%s]", "lookup table mapped from its compiled image", str_lut_file);
+      return 0;
+    }
+    /* missing or stale image, not an error of the import */
+    err_clear();
+  }
   
   if (NULL != (p_lut_file = fopen(str_lut_file, "r")))
   {
     while ((NULL != fgets(str_data_line, STR_MAX, p_lut_file)) && (b_enabled))
     {
+      ctx->tool_stats.lut_lines_read++;
+      /* remove line terminator */
+      str_data_line[strcspn(str_data_line, "\r\n")] = '\0';
       /* check if line is csv */
       if (!is_csv_line(str_data_line, k_lut_header_cnt))
       {
-        fprintf
+        log_error
         (
-          stdout, 
-          "[%6s][%s][%s][%s]\n", 
-          "ERROR", 
+          "[%s][%s][%s]", 
           "Not a valid csv line",
-          str_lut_file, 
+          str_lut_file,
           str_data_line
         );
         err = throw_err(err_file_format_not_valid);
+        b_clean = false;
       }
       else
       {
         /* check if line is header */
         if (is_header(str_data_line, k_lut_header_num_digit))
         {
-          fprintf
+          log_debug
           (
-            stdout, 
-            "[%6s][%s][%s][%s]\n", 
-            "DEBUG", 
-            "line is header", 
-            str_lut_file, 
+            "[%s][%s][%s]", 
+            "line is header",
+            str_lut_file,
             str_data_line
           );
           
@@ -1715,32 +2014,29 @@ read_lut_file(char *str_lut_file)
           /* check err */
           if (err < 0)
           {
-            fprintf
+            b_clean = false;
+            log_error
             (
-              stdout, 
-              "[%6s][%s][%s][%s][%s]\n", 
-              "ERROR", 
+              "[%s][%s][%s][%s]", 
               "line is not parsed correctly",
               get_err_description(err),
-              str_lut_file, 
+              str_lut_file,
               str_data_line
             );
           }
           else
           {
             /* add lut data to lut data list */
-            err = add_to_lut_data_list(&lut_data);
+            err = atc_add_to_lut_data_list(ctx, &lut_data);
             /* check err */
             if (err < 0)
             {
-              fprintf
+              log_error
               (
-                stdout, 
-                "[%6s][%s][%s][%s][%s]\n", 
-                "ERROR", 
+                "[%s][%s][%s][%s]", 
                 "line is not appended correctly",
                 get_err_description(err),
-                str_lut_file, 
+                str_lut_file,
                 str_data_line
               );
               b_enabled = false;
@@ -1749,6 +2045,7 @@ read_lut_file(char *str_lut_file)
         }
       }
     }
+    ctx->tool_stats.lut_bytes_read += (uint64_t) ftell(p_lut_file);
     fclose(p_lut_file);
     if (!b_enabled)
     {
@@ -1761,6 +2058,13 @@ read_lut_file(char *str_lut_file)
         str_lut_file
       );
     }
+    else if (ctx->b_lut_cache && b_clean && (ctx->p_lut->index_cnt > 0) &&
+             (lut_cache_write(str_lut_file, ctx->p_lut->p_index, 
+                              ctx->p_lut->p_block_index, ctx->p_lut->index_cnt) < 0))
+    {
+      /* a read only configuration folder parses the csv every start */
+      log_warn("[%s][%s]", "lookup table image cannot be written", str_lut_file);
+    }
   }
   else
   {
@@ -1771,20 +2075,231 @@ read_lut_file(char *str_lut_file)
   return err;
 }
 
-/** @brief  read input data file and add to input data list 
+/** @brief  take the lookup table compiled into the binary
+ *  @param  *ctx  context with an empty lookup table
+ *  @return 0
+ *          err_lut_is_empty              built without ATC_EMBEDDED_LUT
+ *          err_file_already_exist        the context has a table already
+ *          err_maximum_number_exceeded   not enough memory
+ */
+int
+atc_load_embedded_lut(atcContext *ctx)
+{
+#ifdef ATC_EMBEDDED_LUT
+  const lutEmbedded *p_embedded = &lut_embedded_table;
+  atcLut *p_lut = ctx->p_lut;
+  unsigned int i = 0;
+
+  if (p_lut->index_cnt > 0)
+  {
+    return throw_err(err_file_already_exist);
+  }
+  p_lut->p_index = (lutData **) malloc(p_embedded->record_cnt * sizeof(lutData *));
+  p_lut->p_block_index = (unsigned int *) malloc(p_embedded->record_cnt * sizeof(unsigned int));
+  if ((NULL == p_lut->p_index) || (NULL == p_lut->p_block_index))
+  {
+    free(p_lut->p_index);
+    free(p_lut->p_block_index);
+    p_lut->p_index = NULL;
+    p_lut->p_block_index = NULL;
+    return throw_err(err_maximum_number_exceeded);
+  }
+  for (i = 0; i < p_embedded->record_cnt; i++)
+  {
+    /* const data, the lookups never write a record */
+    p_lut->p_index[i] = (lutData *) &p_embedded->p_records[i];
+  }
+  memcpy(p_lut->p_block_index, p_embedded->p_block_index, 
+         p_embedded->record_cnt * sizeof(unsigned int));
+  p_lut->index_cnt = p_embedded->record_cnt;
+  p_lut->index_size = p_embedded->record_cnt;
+  p_lut->p_embedded = p_embedded;
+  return 0;
+#else
+  (void) ctx;
+  return throw_err(err_lut_is_empty);
+#endif
+}
+
+/** @brief  get the csv the lookup table compiled into the binary was
+ *          generated from
+ *  @return NULL  built without ATC_EMBEDDED_LUT
+ *          csv path
+ */
+const char *
+atc_embedded_lut_source()
+{
+#ifdef ATC_EMBEDDED_LUT
+  return lut_embedded_table.str_source;
+#else
+  return NULL;
+#endif
+}
+
+/** @brief  write the lookup table of a context as C source, to be built
+ *          with ATC_EMBEDDED_LUT
+ *  @param  *ctx         context holding the loaded table
+ *  @param  *str_source  csv the table was read from
+ *  @param  *fp          source output
+ *  @return 0
+ *          err_null_string
+ *          err_lut_is_empty
+ *          err_list_append_failed
+ *          err_maximum_number_exceeded
+ *          err_file_not_accessible
+ */
+int
+atc_write_embedded_lut(atcContext *ctx, const char *str_source, FILE *fp)
+{
+  return lut_embed_write_source(fp, str_source, ctx->p_lut->p_index, 
+                                ctx->p_lut->p_block_index, ctx->p_lut->index_cnt);
+}
+
+/** @brief  position a followed file after the lines already read, a file
+ *          shorter than that was replaced and is read from the start
+ *  @param  *ctx            context
+ *  @param  *p_data_file    opened input data file
+ *  @param  *str_data_file  input data file path
+ *  @return offset reading starts from
+ */
+static long
+atc_follow_seek(atcContext *ctx, FILE *p_data_file, const char *str_data_file)
+{
+  if ((0 == fseek(p_data_file, 0, SEEK_END)) && 
+      (ftell(p_data_file) < ctx->p_follow->offset))
+  {
+    log_warn
+    (
+      "[%s][%s]", 
+      "Followed file is shorter than before, read from the start",
+      str_data_file
+    );
+    atc_follow_close_runs(ctx);
+    ctx->p_follow->offset = 0;
+  }
+  if (0 != fseek(p_data_file, ctx->p_follow->offset, SEEK_SET))
+  {
+    ctx->p_follow->offset = 0;
+    rewind(p_data_file);
+  }
+  return ctx->p_follow->offset;
+}
+
+/** @brief  get the time of the first input line starting at or after an
+ *          offset
+ *  @param  *ctx          context
+ *  @param  *p_data_file  opened input data file
+ *  @param  offset        offset, after the header line
+ *  @param  *p_start      start of the line output, the file length if none
+ *  @return time of the line
+ *          -1  no line, or a time not valid
+ */
+static time_t
+atc_get_line_time(atcContext *ctx, FILE *p_data_file, long offset, long *p_start)
+{
+  char str_line[STR_MAX] = "";
+  char *token = NULL;
+  int i = 0;
+
+  /* the line holding offset - 1 ends right before the next line start */
+  if ((0 != fseek(p_data_file, offset - 1, SEEK_SET)) ||
+      (NULL == fgets(str_line, STR_MAX, p_data_file)))
+  {
+    *p_start = offset;
+    return -1;
+  }
+  while ((NULL == strchr(str_line, '\n')) && 
+         (NULL != fgets(str_line, STR_MAX, p_data_file)))
+  {
+    /* rest of a line longer than the buffer */
+  }
+  *p_start = ftell(p_data_file);
+  if (NULL == fgets(str_line, STR_MAX, p_data_file))
+  {
+    return -1;
+  }
+  str_line[strcspn(str_line, "\r\n")] = '\0';
+  token = cstrtok(str_line, ',');
+  for (i = 0; (NULL != token) && (i < ctx->input_header.col_time); i++)
+  {
+    token = cstrtok(NULL, ',');
+  }
+  return (NULL == token) ? -1 : str_to_seconds(trim(token));
+}
+
+/** @brief  position a time ordered input file at the first line not 
+ *          before the time window, by a binary search over the file 
+ *          offsets. lines with a time not valid count as before the window
+ *  @param  *ctx          context
+ *  @param  *p_data_file  input data file positioned after its header line
+ *  @return bytes skipped
+ */
+static long
+atc_seek_time_window(atcContext *ctx, FILE *p_data_file)
+{
+  long lo = ftell(p_data_file);
+  long start = lo;
+  long hi = 0;
+  long mid = 0;
+  long line_start = 0;
+
+  if ((lo <= 0) || (0 != fseek(p_data_file, 0, SEEK_END)) || 
+      ((hi = ftell(p_data_file)) < lo))
+  {
+    fseek(p_data_file, start, SEEK_SET);
+    return 0;
+  }
+  /* first offset whose next line is not before the window */
+  while (lo < hi)
+  {
+    mid = lo + (hi - lo) / 2;
+    if (atc_get_line_time(ctx, p_data_file, mid, &line_start) >= ctx->time_from)
+    {
+      hi = mid;
+    }
+    else
+    {
+      lo = mid + 1;
+    }
+  }
+  atc_get_line_time(ctx, p_data_file, lo, &line_start);
+  err_clear();
+  fseek(p_data_file, line_start, SEEK_SET);
+  return line_start - start;
+}
+
+/** @brief  read input data file and add to input data list. rows not 
+ *          valid are counted in the data quality report and skipped, 
+ *          only a header not parsed or a failed append ends the file. 
+ *          when following, reading resumes after the last complete line 
+ *          read before and a trailing partial line is left for the next 
+ *          call
+ *  @param  *ctx  context
  *  @param  *str_data_file  input data file path 
  *  @return err_list_append_failed 
  *          err_file_not_accessible 
  */
-int 
-read_input_file(char *str_data_file)
+int
+atc_read_input_file(atcContext *ctx, char *str_data_file)
 {
   
   int err = 0; 
   
   char str_data_line[STR_MAX] = "";
+  /* unparsed copy of the line, kept for the data quality report */
+  char str_raw_line[STR_MAX] = "";
+  size_t line_len = 0;
+  int report_id = -1;
+  int exemplar = -1;
   inputData input_data = {0};
   FILE * p_data_file = NULL; 
+  /* where a followed file is read from */
+  long offset_start = 0;
+  /* before the time window, skipped without reading */
+  long bytes_skipped = 0;
+  /* the time order of the file is used to skip rows */
+  bool b_time_ordered = ctx->b_time_window && ctx->b_time_ordered && 
+                        (NULL == ctx->p_follow);
 
   bool b_enabled = true;
 
@@ -1804,83 +2319,125 @@ read_input_file(char *str_data_file)
 
   if (NULL != (p_data_file = fopen(str_data_file, "r")))
   {
+    if (NULL != ctx->p_follow)
+    {
+      offset_start = atc_follow_seek(ctx, p_data_file, str_data_file);
+    }
+    report_id = err_report_open(strip_path(str_data_file));
     while (NULL != (fgets(str_data_line, STR_MAX, p_data_file)) && (0 == err))
     {
+      /* a line still being written is read again on the next increment */
+      if ((NULL != ctx->p_follow) && 
+          (NULL == strchr(str_data_line, '\n')) && 
+          feof(p_data_file))
+      {
+        break;
+      }
+      ctx->tool_stats.input_lines_read++;
+      /* remove line terminator */
+      line_len = strcspn(str_data_line, "\r\n");
+      str_data_line[line_len] = '\0';
       /* check if line is csv */
       if (!is_csv_line(str_data_line, k_input_csv_num_col))
       {
-        fprintf
-        (
-          stdout, 
-          "[%6s][%s][%s][%s]\n", 
-          "ERROR", 
-          "Not a valid csv line",
-          str_data_file, 
-          str_data_line
-        );
-        err = throw_err(err_file_format_not_valid);
+        /* counted, the next rows are still read */
+        exemplar = err_report_count(report_id, err_file_format_not_valid);
+        if (exemplar >= 0)
+        {
+          err_report_exemplar(report_id, err_file_format_not_valid, exemplar, str_data_line);
+        }
+        if ((report_id < 0) || (exemplar >= 0))
+        {
+          log_error
+          (
+            "[%s][%s][%s]", 
+            "Not a valid csv line",
+            str_data_file,
+            str_data_line
+          );
+        }
+        throw_err(err_file_format_not_valid);
       }
       else
       {
         /* check if line is header */
         if (is_header(str_data_line, k_header_num_digit))
         {
-          fprintf
+          log_debug
           (
-            stdout, 
-            "[%6s][%s][%s][%s]\n", 
-            "DEBUG", 
-            "line is header", 
-            str_data_file, 
+            "[%s][%s][%s]", 
+            "line is header",
+            str_data_file,
             str_data_line
           );
-          err = parse_input_header(str_data_line);
+          err = atc_parse_input_header(ctx, str_data_line);
           if (err < 0)
           {
-            fprintf
+            log_error
             (
-              stdout, 
-              "[%6s][%s][%s][%s]\n", 
-              "ERROR", 
-              "header is not parsed correctly", 
-              str_data_file, 
+              "[%s][%s][%s]", 
+              "header is not parsed correctly",
+              str_data_file,
               str_data_line
             );
             
           }
+          else if (b_time_ordered && (ctx->time_from >= 0))
+          {
+            bytes_skipped += atc_seek_time_window(ctx, p_data_file);
+          }
         }
         else
         {
-          err = parse_input_data(&input_data, str_data_line, str_data_file);
+          memcpy(str_raw_line, str_data_line, line_len + 1);
+          err = atc_parse_input_data(ctx, &input_data, str_data_line, str_data_file);
           /* check err */
-          if (err < 0)
+          if (INPUT_ROW_FILTERED == err)
           {
-            fprintf
-            (
-              stdout, 
-              "[%6s][%s][%s][%s][%s]\n", 
-              "ERROR", 
-              "line is not parsed correctly",
-              get_err_description(err),
-              str_data_file, 
-              str_data_line
-            );
+            ctx->tool_stats.input_filtered++;
+            err = 0;
+            /* the rest of a time ordered file is past the window too */
+            if (b_time_ordered && (ctx->time_to >= 0) && 
+                (input_data.timestamp >= ctx->time_to))
+            {
+              break;
+            }
+          }
+          else if (err < 0)
+          {
+            /* counted, the next rows are still read. the first rows of 
+            ** each error are logged, every row once the report is full */
+            exemplar = err_report_count(report_id, err);
+            if (exemplar >= 0)
+            {
+              err_report_exemplar(report_id, err, exemplar, str_raw_line);
+            }
+            if ((report_id < 0) || (exemplar >= 0))
+            {
+              log_error
+              (
+                "[%s][%s][%s][%s]", 
+                "line is not parsed correctly",
+                get_err_description(err),
+                str_data_file,
+                str_raw_line
+              );
+            }
+            err = 0;
           }
           else
           {
             /* add input data to input data list */
-            err = add_to_input_data_list(&input_data);
+            err = atc_add_to_input_data_list(ctx, &input_data);
             /* check err */
             if (err < 0)
             {
-              fprintf
+              log_error
               (
-                stdout, 
-                "[%6s][%s][%s][%s][%s]\n", 
-                "ERROR", 
+                "[%s][%s][%s][%s]", 
                 "line is not appended correctly",
                 get_err_description(err),
-                str_data_file, 
+                str_data_file,
                 str_data_line
               );
               b_enabled = false;
@@ -1888,6 +2445,18 @@ read_input_file(char *str_data_file)
           }
         }
       }
+      if (NULL != ctx->p_follow)
+      {
+        ctx->p_follow->offset = ftell(p_data_file);
+      }
+    }
+    if (NULL != ctx->p_follow)
+    {
+      ctx->tool_stats.input_bytes_read += (uint64_t) (ctx->p_follow->offset - offset_start);
+    }
+    else
+    {
+      ctx->tool_stats.input_bytes_read += (uint64_t) (ftell(p_data_file) - bytes_skipped);
     }
     fclose(p_data_file);
     if (!b_enabled)
@@ -1912,6 +2481,7 @@ read_input_file(char *str_data_file)
 }
 
 /** @brief  display program title, version, usage information
+ *  @param  *ctx  context
  *  @return none
  *      
  */
@@ -1926,25 +2496,110 @@ display_usage(char **argv)
   printf("************************************************************\n");
   printf("\n");
   printf("USAGE: %s ", strip_path(argv[0]));
-  printf("[FILE]...\n");
+  printf("[OPTION]... [FILE]...\n");
   printf("function description\n");
   printf("\n");
+  printf("OPTIONS:\n");
+  printf("  %-20s %s\n", "--async-export", "write run profiles in the background while export formats the next ones");
+  printf("  %-20s %s\n", "--queue-depth N", "run profiles waiting to be written (implies --async-export)");
+  printf("  %-20s %s\n", "--fsync", "flush run profiles to disk once export completes");
+  printf("  %-20s %s\n", "--log-level LEVEL", "TRACE, DEBUG, INFO (default), WARN, ERROR or FATAL");
+  printf("  %-20s %s\n", "--log-file FILE", "also append diagnostics to FILE");
+  printf("  %-20s %s\n", "--log-buffer BYTES", "diagnostics buffer size, 0 writes every line");
+  printf("  %-20s %s\n", "--profile", "print per stage timing and throughput");
+  printf("  %-20s %s\n", "--profile-json FILE", "also write the stage profile as json");
+  printf("  %-20s %s\n", "--watch DIR", "stay resident, process train data files landing in DIR");
+  printf("  %-20s %s\n", "--follow", "process only lines added to growing files, with FILE or --watch");
+  printf("  %-20s %s\n", "--serve SOCKET", "stay resident, run jobs submitted over a local socket");
+  printf("  %-20s %s\n", "--workers N", "jobs run at once by --serve");
+  printf("  %-20s %s\n", "--lut FILE", "lookup table csv, also overrides a built in table");
+  printf("  %-20s %s\n", "--no-lut-cache", "parse the lookup table csv, no compiled image");
+  printf("  %-20s %s\n", "--lut-verify", "hash the lookup table csv before using its compiled image");
+  printf("  %-20s %s\n", "--block-stats FILE", "add block run times per direction and hour to FILE");
+  printf("  %-20s %s\n", "--from DATE", "keep rows at or after \"YYYY/MM/DD HH:MM:SS\"");
+  printf("  %-20s %s\n", "--to DATE", "keep rows before \"YYYY/MM/DD HH:MM:SS\"");
+  printf("  %-20s %s\n", "--time-ordered", "data files are in time order, skip rows outside the window unread");
+  printf("  %-20s %s\n", "--cc N[,N]...", "keep the rows of these trains only");
+  printf("  %-20s %s\n", "--station CODE", "keep the runs departing from CODE, not those arriving, repeatable");
+  printf("  %-20s %s\n", "--platform P", "keep the runs departing from platform P of the stations");
+  printf("\n");
+}
+
+/** @brief  check if a station is requested by the station filter
+ *  @param  *ctx               context with a station filter
+ *  @param  *str_station_code  station code
+ *  @return true               station requested
+ *          false              station not requested
+ */
+static bool
+atc_is_station_requested(const atcContext *ctx, const char *str_station_code)
+{
+  int i = 0;
+
+  for (i = 0; i < ctx->station_filter_cnt; i++)
+  {
+    if (0 == strcmp(ctx->str_station_filter[i], str_station_code))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+/** @brief  check if a run departing from a platform is kept
+ *  @param  *ctx               context
+ *  @param  *str_station_code  departing station code
+ *  @param  *str_platform      departing platform
+ *  @return true               run kept, always without a station filter
+ *          false              run not kept
+ */
+static bool
+atc_is_run_requested(const atcContext *ctx, const char *str_station_code, 
+                     const char *str_platform)
+{
+  int i = 0;
+
+  if (0 == ctx->station_filter_cnt)
+  {
+    return true;
+  }
+  for (i = 0; i < ctx->station_filter_cnt; i++)
+  {
+    if ((0 == strcmp(ctx->str_station_filter[i], str_station_code)) &&
+        (('\0' == ctx->str_platform_filter[i][0]) ||
+         (0 == strcmp(ctx->str_platform_filter[i], str_platform))))
+    {
+      return true;
+    }
+  }
+  return false;
 }
 
 /** @brief  expand input data list with lookup table 
+ *  @param  *ctx  context
  *  @return err_list_iteration_failed 
  *          err_list_retrieval_failed 
  */
 int
-expand_data_list_use_lut()
+atc_expand_data_list_use_lut(atcContext *ctx)
 {
   inputData *p_input_data = NULL;
   int err = 0;
+  /* previous row of the train and whether the rows after a requested
+  ** station are still in the run departing from it */
+  inputData *p_prev_row = NULL;
+  bool b_station_tail = false;
+  bool b_station_filter = (ctx->station_filter_cnt > 0) && (NULL == ctx->p_follow);
 
   bool b_enabled = true;
+  /* data quality report file of the previous record */
+  char str_report_file[STR_MAX] = "";
+  int report_id = -1;
+  int exemplar = -1;
+  char str_record[STR_EXTRA] = "";
 
   /* check err, 0 - not able to start iteration; 1 - ok to iterate */
-  if (1 != list_iterator_start(&input_data_list))
+  if (1 != list_iterator_start(&ctx->input_data_list))
   {
     /* iteration not able to start */
     err = throw_err(err_list_iteration_failed);
@@ -1958,10 +2613,10 @@ expand_data_list_use_lut()
     );
     return err;
   }
-  while (list_iterator_hasnext(&input_data_list) && (b_enabled)) 
+  while (list_iterator_hasnext(&ctx->input_data_list) && (b_enabled)) 
   {
     /* check for next element */
-    p_input_data = (inputData *)list_iterator_next(&input_data_list);
+    p_input_data = (inputData *)list_iterator_next(&ctx->input_data_list);
     if (NULL == p_input_data)
     {
       /* error on retrieving element from list */
@@ -1978,28 +2633,74 @@ expand_data_list_use_lut()
     }
     else
     {
-      err = expand_data_use_lut(p_input_data);
-      if (err < 0)
+      err = atc_expand_data_use_lut(ctx, p_input_data);
+      if (0 == err)
       {
-        fprintf
-        (
-          stdout, 
-          "[%6s][%s][%s][%s]\n", 
-          "ERROR", 
-          "Input Data Not Valid",
-          get_err_description(err),
-          input_data_to_string(p_input_data)
-        );
+        ctx->tool_stats.input_expanded++;
       }
-      if (err == throw_err(err_lut_match_not_found))
+      else
       {
-        /* ignore if err is lut match not found */
-        err = 0; 
-      }
-    }
-  }
-
-  if (!b_enabled)
+        /* records are sorted by train, look up the file only on change */
+        if ((report_id < 0) || 
+            (0 != strcmp(str_report_file, p_input_data->input_data_file)))
+        {
+          strcpy(str_report_file, p_input_data->input_data_file);
+          report_id = err_report_open(str_report_file);
+        }
+        /* only the first few records of each error are formatted */
+        exemplar = err_report_count(report_id, err);
+        if (exemplar >= 0)
+        {
+          input_data_format(str_record, STR_EXTRA, p_input_data);
+          err_report_exemplar(report_id, err, exemplar, str_record);
+          log_error
+          (
+            "[%s][%s][%s]", 
+            "Input Data Not Valid",
+            get_err_description(err),
+            str_record
+          );
+        }
+      }
+      if (err == (0 - err_lut_match_not_found))
+      {
+        /* ignore if err is lut match not found */
+        err = 0; 
+      }
+      if (b_station_filter)
+      {
+        if ((NULL != p_prev_row) && (p_prev_row->cc_id != p_input_data->cc_id))
+        {
+          p_prev_row = NULL;
+          b_station_tail = false;
+        }
+        p_input_data->b_filtered = false;
+        if (atc_is_station_requested(ctx, p_input_data->str_station_code))
+        {
+          /* a run departing from the station starts on a block of another
+          ** one, the row before is kept to start it the same way */
+          if ((NULL != p_prev_row) && p_prev_row->b_filtered)
+          {
+            p_prev_row->b_filtered = false;
+            ctx->tool_stats.input_skipped--;
+          }
+          b_station_tail = true;
+        }
+        else if (!b_station_tail || 
+                 (p_input_data->is_platform && ('1' == p_input_data->str_doors_open[0])))
+        {
+          /* the run leaving a station lasts at most until the doors open
+          ** at a later platform */
+          b_station_tail = false;
+          p_input_data->b_filtered = true;
+          ctx->tool_stats.input_skipped++;
+        }
+        p_prev_row = p_input_data;
+      }
+    }
+  }
+
+  if (!b_enabled)
   {
     fprintf
     (
@@ -2010,7 +2711,7 @@ expand_data_list_use_lut()
     );
   }
 
-  if (1 != list_iterator_stop(&input_data_list))
+  if (1 != list_iterator_stop(&ctx->input_data_list))
   {
     return throw_err(err_list_stop_failed);
   }
@@ -2020,45 +2721,157 @@ expand_data_list_use_lut()
   }
 }
 
+/** @brief  segmentation state for the train of a row
+ *  @param  *ctx           context
+ *  @param  *p_default     state used for the whole list when not following
+ *  @param  *p_input_data  row
+ *  @return NULL           not enough memory or cc number not valid
+ *          state of the train
+ */
+static runState *
+atc_get_run_state(atcContext *ctx, runState *p_default, const inputData *p_input_data)
+{
+  runState **pp_state = NULL;
+
+  if (NULL == ctx->p_follow)
+  {
+    return p_default;
+  }
+  if ((p_input_data->cc_id <= 0) || (p_input_data->cc_id > CC_ID_MAX))
+  {
+    return NULL;
+  }
+  pp_state = &ctx->p_follow->p_run_state[p_input_data->cc_id];
+  if (NULL == *pp_state)
+  {
+    *pp_state = (runState *) calloc(1, sizeof(runState));
+  }
+  return *pp_state;
+}
+
+/** @brief  release the calculated rows of a followed file, each train 
+ *          keeps a copy of its last row for the next increment
+ *  @param  *ctx  context
+ *  @return none
+ */
+static void
+atc_follow_release_input(atcContext *ctx)
+{
+  runState *p_state = NULL;
+  int i = 0;
+
+  for (i = 0; i <= CC_ID_MAX; i++)
+  {
+    p_state = ctx->p_follow->p_run_state[i];
+    if ((NULL != p_state) && 
+        (NULL != p_state->p_prev) && 
+        (&p_state->prev != p_state->p_prev))
+    {
+      p_state->prev = *p_state->p_prev;
+      p_state->p_prev = &p_state->prev;
+    }
+  }
+  atc_free_input_data_list(ctx);
+  atc_init_input_data_list(ctx);
+}
+
+/** @brief  check if an output row belongs to a run that a followed file
+ *          may still continue
+ *  @param  *ctx     context
+ *  @param  *p_data  output row
+ *  @return true     run is open, the row is held back
+ *          false    run is complete or not following
+ */
+static bool
+atc_is_run_open(atcContext *ctx, const outputData *p_data)
+{
+  const runState *p_state = NULL;
+
+  if ((NULL == ctx->p_follow) || (p_data->cc_id <= 0) || (p_data->cc_id > CC_ID_MAX))
+  {
+    return false;
+  }
+  p_state = ctx->p_follow->p_run_state[p_data->cc_id];
+  return (NULL != p_state) && 
+         (NULL != p_state->p_prev) && 
+         (p_data->id >= p_state->run_first_id);
+}
+
+/** @brief  drop the exported rows of a followed file, the rows of open
+ *          runs stay in the output list for the next increment
+ *  @param  *ctx  context
+ *  @return 0
+ *          err_list_iteration_failed
+ *          err_list_append_failed
+ */
+static int
+atc_follow_keep_open_runs(atcContext *ctx)
+{
+  outputData *p_held = NULL;
+  outputData *p_data = NULL;
+  unsigned int held_cnt = 0;
+  unsigned int i = 0;
+  int err = 0;
+
+  p_held = (outputData *) malloc((list_size(&ctx->output_data_list) + 1) * sizeof(outputData));
+  if (NULL == p_held)
+  {
+    return throw_err(err_list_append_failed);
+  }
+  if (1 != list_iterator_start(&ctx->output_data_list))
+  {
+    free(p_held);
+    return throw_err(err_list_iteration_failed);
+  }
+  while (list_iterator_hasnext(&ctx->output_data_list))
+  {
+    p_data = (outputData *) list_iterator_next(&ctx->output_data_list);
+    if ((NULL != p_data) && atc_is_run_open(ctx, p_data))
+    {
+      p_held[held_cnt++] = *p_data;
+    }
+  }
+  list_iterator_stop(&ctx->output_data_list);
+
+  atc_free_output_data_list(ctx);
+  atc_init_output_data_list(ctx);
+  for (i = 0; (i < held_cnt) && (0 == err); i++)
+  {
+    err = atc_add_to_output_data_list(ctx, &p_held[i]);
+  }
+  free(p_held);
+  return err;
+}
+
 /** @brief  process input data list, generate output data, and 
- *          add to output data list 
+ *          add to output data list. when following, each train resumes
+ *          from the state of the previous increment and the input list 
+ *          is released afterwards
+ *  @param  *ctx  context
  *  @return err_list_iteration_failed 
  *          err_list_retrieval_failed
  *          err_maximum_number_exceeded
  *  
  */
 int
-calculate_output_data_list()
+atc_calculate_output_data_list(atcContext *ctx)
 {  
   inputData *p_input_data = NULL;
-  inputData *p_input_data_prev = NULL;
   outputData output_data = {0};  
-  
-  time_t time_origin = 0;
-  time_t travel_time_origin = 0;
-  uint8_t cur_run_cnt = 0;
+  /* segmentation state, one for the whole list unless following */
+  runState run_state = {0};
+  runState *p_state = &run_state;
   
   double displacement_m = 0;
-  double accum_displacement_m = 0;
-  double accum_travelled_m = 0;
-
-  bool b_departure_complete = false;
-  bool b_arrival_complete = false;
-  bool b_run_complete = false;
-  bool b_run_interrupted = false;
-  bool b_stopped = false;
-  bool b_departed = false;
-
-  char str_departure_block[STR_SHORT] = "";
-  char str_arrival_block[STR_SHORT] = "";
 
   char *p_temp = NULL;
   int err = 0;
   bool b_enabled = true;
+  char str_record[STR_EXTRA] = "";
 
   /* iteration start on input list */
   /* check err, 0 - not able to start iteration; 1 - ok to iterate */
-  if (1 != list_iterator_start(&input_data_list))
+  if (1 != list_iterator_start(&ctx->input_data_list))
   {
     /* iteration not able to start */
     fprintf
@@ -2071,10 +2884,10 @@ calculate_output_data_list()
     );
     return throw_err(err_list_iteration_failed);
   }
-  while (list_iterator_hasnext(&input_data_list) && (b_enabled)) 
+  while (list_iterator_hasnext(&ctx->input_data_list) && (b_enabled)) 
   { 
     /* check for next element */
-    p_input_data = (inputData *)list_iterator_next(&input_data_list);
+    p_input_data = (inputData *)list_iterator_next(&ctx->input_data_list);
     if (NULL == p_input_data)
     {
       /* error on retrieving element from list */
@@ -2093,10 +2906,17 @@ calculate_output_data_list()
     {
       /* process input data constructs output data structure */
       /* generate output list id */
-      if (LIST_MAX_SIZE == output_list_id)
+      if (p_input_data->b_filtered)
+      {
+        /* outside the stations requested, only skipped when not following,
+        ** the next row kept starts a run */
+        run_state.p_prev = NULL;
+      }
+      else if (LIST_MAX_SIZE == ctx->output_list_id)
       {
         b_enabled = false;
         err = throw_err(err_maximum_number_exceeded);
+        input_data_format(str_record, STR_EXTRA, p_input_data);
         fprintf
         (
           stdout, 
@@ -2104,12 +2924,27 @@ calculate_output_data_list()
           "ERROR", 
           "Input Data Numbers Exceeded Limitation",
           get_err_description(err),
-          input_data_to_string(p_input_data)
+          str_record
+        );
+      }
+      else if (NULL == (p_state = atc_get_run_state(ctx, &run_state, p_input_data)))
+      {
+        b_enabled = false;
+        err = throw_err(err_list_append_failed);
+        input_data_format(str_record, STR_EXTRA, p_input_data);
+        fprintf
+        (
+          stdout, 
+          "[%6s][%s][%s][%s]\n", 
+          "ERROR", 
+          "Train State Not Available",
+          get_err_description(err),
+          str_record
         );
       }
       else
       {      
-        output_data.id = output_list_id++;
+        output_data.id = ctx->output_list_id++;
         /* copy known data from input data to output data */
         strcpy(output_data.sorting_str, p_input_data->sorting_str);
         strcpy(output_data.input_data_file, p_input_data->input_data_file);
@@ -2146,31 +2981,32 @@ calculate_output_data_list()
         if 
         (
           /* first item */
-          (NULL == p_input_data_prev) ||
+          (NULL == p_state->p_prev) ||
           /* different cc number */
-          (strcmp(p_input_data_prev->str_cc_id, p_input_data->str_cc_id)) ||
+          (strcmp(p_state->p_prev->str_cc_id, p_input_data->str_cc_id)) ||
           /* delta_t > 3 sec and different track*/
-          ( ((p_input_data->timestamp - p_input_data_prev->timestamp) > 3) && 
-            !(p_input_data_prev->is_motion) && 
-            (strcmp(p_input_data_prev->str_block, p_input_data->str_block))) ||
+          ( ((p_input_data->timestamp - p_state->p_prev->timestamp) > 3) && 
+            !(p_state->p_prev->is_motion) && 
+            (strcmp(p_state->p_prev->str_block, p_input_data->str_block))) ||
           /* normal service - first door open event */
           ((p_input_data->is_platform) && 
-          ('0' == p_input_data_prev->str_doors_open[0]) &&
+          ('0' == p_state->p_prev->str_doors_open[0]) &&
           ('1' == p_input_data->str_doors_open[0]) &&
-          (strcmp(str_departure_block, p_input_data->str_block))) ||
+          (strcmp(p_state->str_departure_block, p_input_data->str_block))) ||
           /* skip station */
-          (('1' == p_input_data_prev->str_skip_stop[0]) && 
-          (p_input_data_prev->is_platform) &&
+          (('1' == p_state->p_prev->str_skip_stop[0]) && 
+          (p_state->p_prev->is_platform) &&
           !(p_input_data->is_platform)) 
         )
         /* new run profile */
         {
-          time_origin = p_input_data->timestamp;
-          travel_time_origin = p_input_data->timestamp;
-          if (MAX_RUN_CNT == run_cnt)
+          p_state->time_origin = p_input_data->timestamp;
+          p_state->travel_time_origin = p_input_data->timestamp;
+          if (MAX_RUN_CNT == ctx->run_cnt)
           {
             b_enabled = false;
             err = throw_err(err_maximum_run_number_exceeded);
+            input_data_format(str_record, STR_EXTRA, p_input_data);
             fprintf
             (
               stdout, 
@@ -2178,16 +3014,19 @@ calculate_output_data_list()
               "ERROR", 
               "Speed Profiles Numbers Exceeded Limitation",
               get_err_description(err),
-              input_data_to_string(p_input_data)
+              str_record
             );
           }
           else
           {
-            cur_run_cnt = run_cnt++;
-            output_data.run_cnt = cur_run_cnt;
+            p_state->cur_run_cnt = ctx->run_cnt++;
+            output_data.run_cnt = p_state->cur_run_cnt;
           }
-          accum_displacement_m = 0;
-          accum_travelled_m = 0;
+          p_state->run_first_id = output_data.id;
+          p_state->b_run_kept = atc_is_run_requested(ctx, p_input_data->str_station_code, 
+                                                     p_input_data->str_platform);
+          p_state->accum_displacement_m = 0;
+          p_state->accum_travelled_m = 0;
 
           output_data.log_time_s = 0;
           output_data.travel_time_s = 0;
@@ -2196,20 +3035,20 @@ calculate_output_data_list()
           output_data.distance_travelled_1_m = 0;
           output_data.accum_distance_travelled_ft = 0;
 
-          strcpy(str_departure_block, p_input_data->str_block);
+          strcpy(p_state->str_departure_block, p_input_data->str_block);
 
-          b_departure_complete = false;
-          b_arrival_complete = false;
-          b_run_complete = false;
-          b_run_interrupted = false;
-          b_stopped = false;
-          b_departed = false;
-          strcpy(str_arrival_block, "");
+          p_state->b_departure_complete = false;
+          p_state->b_arrival_complete = false;
+          p_state->b_run_complete = false;
+          p_state->b_run_interrupted = false;
+          p_state->b_stopped = false;
+          p_state->b_departed = false;
+          strcpy(p_state->str_arrival_block, "");
         }
         else
         /* continue the current run profile */
         {
-          output_data.run_cnt = cur_run_cnt;
+          output_data.run_cnt = p_state->cur_run_cnt;
           output_data.log_time_s = 
             (double) 
             (
@@ -2217,18 +3056,18 @@ calculate_output_data_list()
                       &p_temp, 
                       10
                     ) 
-              - time_origin
+              - p_state->time_origin
             );
 
-          if (!b_departed)
+          if (!p_state->b_departed)
           {
             if (p_input_data->is_motion)
             {
-              b_departed = true;
+              p_state->b_departed = true;
             }
             else
             {
-              travel_time_origin = p_input_data->timestamp;
+              p_state->travel_time_origin = p_input_data->timestamp;
             }
           }
           output_data.travel_time_s = 
@@ -2238,80 +3077,85 @@ calculate_output_data_list()
                       &p_temp, 
                       10
                     ) 
-              - travel_time_origin
+              - p_state->travel_time_origin
             );
 
           displacement_m = integrate_trapezoidal(
-            p_input_data_prev->timestamp,
-            1/3.6*p_input_data_prev->signed_measured_speed_km_h,
+            p_state->p_prev->timestamp,
+            1/3.6*p_state->p_prev->signed_measured_speed_km_h,
             p_input_data->timestamp,
             1/3.6*p_input_data->signed_measured_speed_km_h
           );
           output_data.distance_travelled_0_m = displacement_m;
           output_data.distance_travelled_1_m = displacement_m;
-          accum_displacement_m += displacement_m;
+          p_state->accum_displacement_m += displacement_m;
           if (displacement_m < 0)
           {        
-            accum_travelled_m -= displacement_m;
+            p_state->accum_travelled_m -= displacement_m;
           }
           else
           {
-            accum_travelled_m += displacement_m;
+            p_state->accum_travelled_m += displacement_m;
           }
-          output_data.accum_distance_travelled_ft = 3.28084 * accum_travelled_m;
+          output_data.accum_distance_travelled_ft = 3.28084 * p_state->accum_travelled_m;
 
           if 
           (
-            (p_input_data_prev->is_motion) && 
+            (p_state->p_prev->is_motion) && 
             !(p_input_data->is_motion) &&
             (p_input_data->is_platform) &&
-            (strcmp(p_input_data->str_block, str_departure_block)) &&
-            (NULL == str_arrival_block)
+            (strcmp(p_input_data->str_block, p_state->str_departure_block)) &&
+            (NULL == p_state->str_arrival_block)
           )
           {
-            b_arrival_complete = true;
-            strcpy(str_arrival_block, p_input_data->str_block);
+            p_state->b_arrival_complete = true;
+            strcpy(p_state->str_arrival_block, p_input_data->str_block);
           }
-          if (!b_departure_complete)
+          if (!p_state->b_departure_complete)
           {
             if ((p_input_data->is_motion) && (p_input_data->is_platform))
             {
-              b_departure_complete = true;
+              p_state->b_departure_complete = true;
             }            
           }
           if
           (
-            (p_input_data_prev->is_motion) && 
+            (p_state->p_prev->is_motion) && 
             !(p_input_data->is_motion)
           )
           {
-            b_stopped = true;
+            p_state->b_stopped = true;
           }
           if
           (
-            !(p_input_data_prev->is_motion) && 
+            !(p_state->p_prev->is_motion) && 
             (p_input_data->is_motion) &&
-            (b_stopped) 
+            (p_state->b_stopped) 
           )
           {
-            b_run_interrupted = true;
+            p_state->b_run_interrupted = true;
           }
           if
           (
-            (b_departure_complete) &&
-            (b_arrival_complete)
+            (p_state->b_departure_complete) &&
+            (p_state->b_arrival_complete)
           )
           {
-            b_run_complete = true;
+            p_state->b_run_complete = true;
           }
         }
 
-        p_input_data_prev = p_input_data;
+        p_state->p_prev = p_input_data;
 
-        /* add output data structure to output list */
-        err = add_to_output_data_list(&output_data);
+        /* add output data structure to output list, runs departing from
+        ** stations not requested are not exported */
+        if (p_state->b_run_kept)
+        {
+          err = atc_add_to_output_data_list(ctx, &output_data);
+        }
         if (err < 0)
         {
+          output_data_format(str_record, STR_EXTRA, &output_data);
           fprintf
           (
             stdout, 
@@ -2319,7 +3163,7 @@ calculate_output_data_list()
             "ERROR", 
             "Speed Profile Append Failure!",
             get_err_description(err),
-            output_data_to_string(&output_data)
+            str_record
           );
           b_enabled = false;
         }
@@ -2338,268 +3182,1335 @@ calculate_output_data_list()
     );
   }
 
-  if (1 != list_iterator_stop(&input_data_list))
+  if (1 != list_iterator_stop(&ctx->input_data_list))
   {
     return throw_err(err_list_stop_failed);
   }
   else
   {
+    /* calculated rows are not read again when following */
+    if (NULL != ctx->p_follow)
+    {
+      atc_follow_release_input(ctx);
+    }
     return err;  
   }
 } 
 
-/** @brief  generate run profile output csv files, 
- *          one file per start-stop per train
- *  @return err_list_iteration_failed 
- *          err_list_retrieval_failed
- *          err_maximum_number_exceeded
- *  
+/** @brief  configure background export of run profile files
+ *  @param  *ctx  context
+ *  @param  queue_depth  number of completed run profiles waiting to be 
+ *                       written, 0 to export synchronously
+ *  @param  b_sync       flush file system buffers once export completes
+ *  @return none
+ *             
  */
-int
-export_run_profile_file()
+void
+atc_set_async_export(atcContext *ctx, int queue_depth, bool b_sync)
 {
-  FILE *fp_out = NULL;
-
-  int run_cnt_prev = -1;
-  char output_file_full_path[STR_MAX] = "";
-  char output_filename[STR_MAX] = "";
-  char prev_signal_name_graphing[STR_SHORT] = "";
-  char graphing_temp[STR_SHORT] = "";
-  char run_profile_description[STR_MAX] = "";
-  
-  int err = 0;
-  outputData *p_data = NULL;
+  ctx->async_export_depth = (queue_depth > 0) ? queue_depth : 0;
+  ctx->b_async_export_sync = b_sync;
+}
 
-  bool b_enabled = true;
+/** @brief  set the folder run profiles are written to
+ *  @param  *ctx       context
+ *  @param  *str_path  folder, a path delimiter is appended if missing,
+ *                     NULL or empty for the default RUN_PROFILE_PATH
+ *  @return 0
+ *          err_insufficient_buffer_size
+ */
+int
+atc_set_output_path(atcContext *ctx, const char *str_path)
+{
+  size_t len = (NULL != str_path) ? strlen(str_path) : 0;
 
-  /* start iteration */
-  /* iteration start on output list */
-  /* check err, 0 - not able to start iteration; 1 - ok to iterate */
-  if (1 != list_iterator_start(&output_data_list))
+  if (len + 2 > STR_MAX)
   {
-    /* iteration not able to start */
-    fprintf
-    (
-      stdout, 
-      "[%6s][%s][%s]\n", 
-      "ERROR", 
-      "Speed Profiles Not Available!",
-      get_err_description(err_list_iteration_failed)
-    );
-    return throw_err(err_list_iteration_failed);
+    return throw_err(err_insufficient_buffer_size);
   }
-  while (list_iterator_hasnext(&output_data_list) && (b_enabled)) 
-  { 
-    /* check for next element */
-    p_data = (outputData *)list_iterator_next(&output_data_list);
-    if (NULL == p_data)
-    {
-      /* error on retrieving element from list */
-      b_enabled = false;      
-      err = throw_err(err_list_retrieval_failed);
-      fprintf
-      (
-        stdout, 
-        "[%6s][%s][%s]\n", 
-        "ERROR", 
-        "Speed Profiles Not Available",
-        get_err_description(err)
-      );
-    }
-    else
-    {
-      if (run_cnt_prev != p_data->run_cnt)
-      {
-        /* new file */
-        /* close old file if open */
-        if (NULL != fp_out)
-        {
-          fclose(fp_out);
-        }
-
-        run_cnt_prev = p_data->run_cnt;
-        strcpy(prev_signal_name_graphing, "");
-        
-        err = get_output_file(output_filename, p_data);
-        if (err < 0)
-        {
-          b_enabled = false;
-          fprintf
-          (
-            stdout, 
-            "[%6s][%s][%s]\n", 
-            "ERROR", 
-            "Output File Not Available",
-            get_err_description(err)
-          );
-        }
-        else
-        {
-          strcpy(output_file_full_path, output_filename);
+  strcpy(ctx->str_output_path, (NULL != str_path) ? str_path : "");
+  if ((len > 0) && (NULL == strchr(PATH_DELIM, str_path[len - 1])))
+  {
+    strcat(ctx->str_output_path, PATH_DELIM);
+  }
+  return 0;
+}
 
-          /* check if file already exist */
-          fp_out = fopen(output_file_full_path, "r");
-          if (NULL != fp_out)
-          {
-            fclose(fp_out);
-            b_enabled = false;
-            err = throw_err(err_file_already_exist);
-            fprintf
-            (
-              stdout, 
-              "[%6s][%s][%s][%s]\n", 
-              "ERROR", 
-              "Output File Already Exists!",
-              get_err_description(err),
-              output_file_full_path
-            );
-          }
-          else
-          { 
-            /* create new file */
-            fp_out = fopen(output_file_full_path, "w");
-            /* file cannot be created */
-            if (NULL == fp_out)
-            {
-              b_enabled = false;
-              err = throw_err(err_file_not_accessible);
-              fprintf
-              (
-                stdout, 
-                "[%6s][%d][%s][%s][%s]\n", 
-                "ERROR", 
-                errno,
-                "Output File Cannot Be Created!",
-                get_err_description(err),
-                output_file_full_path
-              );
-            }
-            else
-            {
-              /* file created successfully */
-              strcpy(p_data->output_data_file, output_filename);
-              /* write header to new file */
-              
-              if (NULL != p_data->str_platform && strcmp(p_data->str_platform, "") > 0)
-              {
-                snprintf
-                (
-                  run_profile_description, 
-                  STR_MAX, 
-                  "%s%s%s%s%s%s%s%s%s",
-                  "ATC Speed Profile Departing From ", 
-                  p_data->str_from_station, 
-                  " Platform ", 
-                  p_data->str_platform, 
-                  " to ", 
-                  p_data->str_to_station,
-                  " (", 
-                  p_data->str_direction_code, 
-                  ")"
-                );
-              }
-              else
-              {
-                snprintf
-                (
-                  run_profile_description, 
-                  STR_MAX, 
-                  "%s%s%s%s%s%s%s",
-                  "ATC Speed Profile Departing From ", 
-                  p_data->str_from_station,  
-                  " to ", 
-                  p_data->str_to_station,
-                  " (", 
-                  p_data->str_direction_code, 
-                  ")"
-                );
-              }
-              fprintf
-              (
-                fp_out, 
-                "%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s\n", 
-                "Log_Time_[s]",
-                "Segment_ID",
-                "Distance_Travelled_0_[m]",
-                "Distance_Travelled_1_[m]",
-                "Accum_Distance_Travelled_[ft]",
-                "Permitted_Speed_[km/h]",
-                "Measured_Speed_[km/h]",
-                "Current_Tag_ID",
-                "TI_Tag",
-                "Signal_Name",
-                "Signal_Name_Graphing",
-                "Civil_Speed_[km/h]",
-                "Travel_Time_[s]",
-                run_profile_description, 
-                "Distance Travelled from Starting Point [ft]"
-              );
-            }
-          }
-        }
-      }
+/** @brief  load the lookup table of a context from its compiled image,
+ *          the image is written next to the csv and rebuilt when the csv
+ *          changes
+ *  @param  *ctx       context
+ *  @param  b_enabled  use the compiled image
+ *  @param  b_verify   hash the csv even if its size and time match
+ *  @return none
+ */
+void
+atc_set_lut_cache(atcContext *ctx, bool b_enabled, bool b_verify)
+{
+  ctx->b_lut_cache = b_enabled;
+  ctx->b_lut_verify = b_verify;
+}
 
-      /* if current_driving_mode changes, = new, otherwise = blank */
-      if (strcmp(prev_signal_name_graphing, p_data->signal_name_graphing))
-      /* not equal to last one, print current signal_name_graphing */
-      {
-        strcpy(graphing_temp, p_data->signal_name_graphing);
-      }
-      else 
-      /* equal to last one, print "" */
-      {
-        strcpy(graphing_temp, "");
-      }
-      /* write the current output data to the output file */
+/** @brief  keep only the input rows of a context within a time window
+ *  @param  *ctx            context
+ *  @param  from            first time kept, -1 for no lower bound
+ *  @param  to              first time past the window, -1 for no upper bound
+ *  @param  b_time_ordered  input files are in time order, rows before the
+ *                          window are skipped by a binary search and
+ *                          reading stops at the first row past it. not
+ *                          used while following files
+ *  @return none
+ */
+void
+atc_set_time_window(atcContext *ctx, time_t from, time_t to, bool b_time_ordered)
+{
+  ctx->b_time_window = (from >= 0) || (to >= 0);
+  ctx->time_from = (from >= 0) ? from : -1;
+  ctx->time_to = (to >= 0) ? to : -1;
+  ctx->b_time_ordered = b_time_ordered;
+}
 
-      fprintf
-      (
-        fp_out, 
-        "%f, %s, %f, %f, %f, %f, %f, %d, %d, %s, %s, %f, %f, %s\n", 
-        p_data->log_time_s,
-        p_data->segment_id,
-        p_data->distance_travelled_0_m,
-        p_data->distance_travelled_1_m,
-        p_data->accum_distance_travelled_ft,
-        p_data->permitted_speed_km_h,
-        p_data->measured_speed_km_h,
-        p_data->current_tag_id,
-        p_data->ti_tag,
-        p_data->signal_name,
-        graphing_temp,
-        p_data->civil_speed_km_h,
-        p_data->travel_time_s, 
-        p_data->str_timestamp
-      );
-    
-      /* copy current to prev */
-      strcpy(prev_signal_name_graphing, p_data->signal_name_graphing);
-    }
-    /* end of current iteration */
-  }
-  
-  if (NULL != fp_out)
+/** @brief  keep only the input rows of a train, trains added are kept. the
+ *          cc id column is checked before the rest of the row is parsed
+ *  @param  *ctx   context
+ *  @param  cc_id  cc number of the train
+ *  @return 0
+ *          err_cc_not_valid
+ */
+int
+atc_add_cc_filter(atcContext *ctx, int cc_id)
+{
+  if ((cc_id <= 0) || (cc_id > CC_ID_MAX))
   {
-    fclose(fp_out);
+    return throw_err(err_cc_not_valid);
   }
+  ctx->b_cc_filter = true;
+  ctx->b_cc_kept[cc_id] = true;
+  return 0;
+}
 
-  if (!b_enabled)
+/** @brief  keep only the runs departing from a station, stations added 
+ *          are kept. a run arriving at the station from another one is
+ *          not kept, run profiles are named by their departing platform.
+ *          rows away from the stations are skipped once matched with the
+ *          lookup table, before the calculation, except while following
+ *          files
+ *  @param  *ctx               context
+ *  @param  *str_station_code  station code, e.g. SCW
+ *  @param  *str_platform      departing platform, NULL or empty for any
+ *  @return 0
+ *          err_null_string
+ *          err_insufficient_buffer_size
+ *          err_maximum_number_exceeded   STATION_FILTER_MAX reached
+ */
+int
+atc_add_station_filter(atcContext *ctx, const char *str_station_code, const char *str_platform)
+{
+  if ((NULL == str_station_code) || ('\0' == str_station_code[0]))
   {
-    fprintf
-    (
-      stdout, 
-      "[%6s][%s]\n", 
-      "ERROR", 
-      "Speed Profiles Export Process Interrupted!"
-    );
+    return throw_err(err_null_string);
   }
-
-  if (1 != list_iterator_stop(&output_data_list))
+  if ((strlen(str_station_code) >= STR_MIN) || 
+      ((NULL != str_platform) && (strlen(str_platform) >= STR_MIN)))
   {
-    return throw_err(err_list_stop_failed);
+    return throw_err(err_insufficient_buffer_size);
   }
-  else
+  if (ctx->station_filter_cnt >= STATION_FILTER_MAX)
   {
-    return err;
+    return throw_err(err_maximum_number_exceeded);
   }
+  strcpy(ctx->str_station_filter[ctx->station_filter_cnt], str_station_code);
+  strcpy(ctx->str_platform_filter[ctx->station_filter_cnt], 
+         (NULL != str_platform) ? str_platform : "");
+  ctx->station_filter_cnt++;
+  return 0;
+}
+
+/** @brief  get a snapshot of the processing counters
+ *  @param  *ctx  context
+ *  @param  *stats  counters output
+ *  @return none
+ *             
+ */
+void
+atc_get_tool_stats(atcContext *ctx, toolStats *stats)
+{
+  if (NULL == stats)
+  {
+    return;
+  }
+  ctx->tool_stats.lut_cnt = ctx->p_lut->index_cnt;
+  ctx->tool_stats.input_cnt = list_size(&ctx->input_data_list);
+  ctx->tool_stats.output_cnt = list_size(&ctx->output_data_list);
+  *stats = ctx->tool_stats;
+}
+
+/** @brief  get the heap usage of a list
+ *  @param  *ctx  context
+ *  @param  list  enum tool_list
+ *  @param  *mem  heap usage output
+ *  @return 0
+ *          err_maximum_number_exceeded  list is not valid
+ */
+int
+atc_get_list_memory(atcContext *ctx, int list, listMemory *mem)
+{
+  if ((list < 0) || (list >= k_list_cnt) || (NULL == mem))
+  {
+    return throw_err(err_maximum_number_exceeded);
+  }
+  *mem = *context_list_memory(ctx, list);
+  return 0;
+}
+
+/** @brief  restart the list high-water mark from the bytes held now,
+ *          used to measure the high-water mark of each stage
+ *  @param  *ctx  context
+ *  @return none
+ */
+void
+atc_reset_list_memory_high_water(atcContext *ctx)
+{
+  ctx->tool_stats.list_bytes_high_water = ctx->tool_stats.list_bytes;
+}
+
+/** @brief  write a formatted run profile to its output file, either
+ *          directly or through the background writer when enabled
+ *  @param  *ctx  context
+ *  @param  *path  output file path
+ *  @param  *buf   formatted run profile, reset on return
+ *  @return 0
+ *          err_file_not_accessible
+ */
+static int
+atc_flush_run_profile_file(atcContext *ctx, char *path, strBuffer *buf)
+{
+  FILE *fp_out = NULL;
+  int err = 0;
+
+  ctx->tool_stats.files_written++;
+  ctx->tool_stats.bytes_written += buf->len;
+  if (NULL != ctx->p_async_writer)
+  {
+    err = async_writer_submit(ctx->p_async_writer, path, buf);
+    if (err < 0)
+    {
+      fprintf
+      (
+        stdout, 
+        "[%6s][%s][%s][%s]\n", 
+        "ERROR", 
+        "Output File Cannot Be Queued!",
+        get_err_description(err),
+        path
+      );
+    }
+    return err;
+  }
+
+  /* create new file */
+  fp_out = fopen(path, "w");
+  /* file cannot be created */
+  if (NULL == fp_out)
+  {
+    err = throw_err(err_file_not_accessible);
+    fprintf
+    (
+      stdout, 
+      "[%6s][%d][%s][%s][%s]\n", 
+      "ERROR", 
+      errno,
+      "Output File Cannot Be Created!",
+      get_err_description(err),
+      path
+    );
+  }
+  else
+  {
+    if (buf->len != fwrite(buf->data, 1, buf->len, fp_out))
+    {
+      err = throw_err(err_file_not_accessible);
+    }
+    fclose(fp_out);
+  }
+  buf->len = 0;
+  return err;
+}
+
+/** @brief  add the manifest row of a written run profile
+ *  @param  *buf  manifest rows
+ *  @param  *run  run profile written
+ *  @return none
+ */
+static void
+atc_add_manifest_row(strBuffer *buf, const runManifest *run)
+{
+  const outputData *p_first = run->p_first;
+  const outputData *p_last = run->p_last;
+  char str_run_id[STR_MAX] = "";
+  char *p_name = strip_path((char *) run->str_output_file);
+  size_t len = 0;
+
+  /* run id is the file name without extension */
+  strcpy(str_run_id, (NULL != p_name) ? p_name : run->str_output_file);
+  len = strlen(str_run_id);
+  if ((len > 4) && (0 == strcmp(str_run_id + len - 4, ".csv")))
+  {
+    str_run_id[len - 4] = '\0';
+  }
+  str_buffer_printf
+  (
+    buf, 
+    "%s,%s,%s,%s,%s,%s,%s,%03d,%02d,%s,%u,%f,%f,%f\n", 
+    str_run_id,
+    run->str_output_file,
+    p_first->str_station_code,
+    p_first->str_platform,
+    p_first->str_direction_code,
+    p_first->str_from_station,
+    p_first->str_to_station,
+    p_first->cc_id,
+    run->file_cnt,
+    p_first->str_timestamp,
+    run->row_cnt,
+    p_last->travel_time_s,
+    p_last->accum_distance_travelled_ft,
+    run->max_speed_km_h
+  );
+}
+
+/** @brief  append manifest rows to the manifest of the run profile folder,
+ *          the header is written with the first rows
+ *  @param  *ctx  context
+ *  @param  *buf  manifest rows, reset on return
+ *  @return 0
+ *          err_insufficient_buffer_size
+ *          err_file_not_accessible
+ */
+static int
+atc_write_manifest(atcContext *ctx, strBuffer *buf)
+{
+  char str_manifest_file[STR_MAX] = "";
+  FILE *fp = NULL;
+  int err = 0;
+
+  const char *str_output_path = ('\0' != ctx->str_output_path[0]) ? 
+                                ctx->str_output_path : RUN_PROFILE_PATH;
+
+  if (0 == buf->len)
+  {
+    return 0;
+  }
+  if ((size_t) snprintf(str_manifest_file, STR_MAX, "%s%s", 
+                        str_output_path, RUN_PROFILE_MANIFEST) >= STR_MAX)
+  {
+    buf->len = 0;
+    return throw_err(err_insufficient_buffer_size);
+  }
+
+  pthread_mutex_lock(&manifest_lock);
+  if (NULL == (fp = fopen(str_manifest_file, "a")))
+  {
+    err = throw_err(err_file_not_accessible);
+  }
+  else
+  {
+    fseek(fp, 0, SEEK_END);
+    if (0 == ftell(fp))
+    {
+      fprintf
+      (
+        fp, 
+        "%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s\n", 
+        "Run_ID",
+        "Output_File",
+        "Station_Code",
+        "Platform",
+        "Direction",
+        "From_Station",
+        "To_Station",
+        "CC_ID",
+        "File_Cnt",
+        "Start_Timestamp",
+        "Row_Cnt",
+        "Travel_Time_[s]",
+        "Distance_Travelled_[ft]",
+        "Max_Speed_[km/h]"
+      );
+    }
+    if (buf->len != fwrite(buf->data, 1, buf->len, fp))
+    {
+      err = throw_err(err_file_not_accessible);
+    }
+    if ((0 != fclose(fp)) && (err >= 0))
+    {
+      err = throw_err(err_file_not_accessible);
+    }
+  }
+  pthread_mutex_unlock(&manifest_lock);
+
+  if (err < 0)
+  {
+    fprintf
+    (
+      stdout, 
+      "[%6s][%s][%s][%s]\n", 
+      "ERROR", 
+      "Manifest Not Written!",
+      get_err_description(err),
+      str_manifest_file
+    );
+  }
+  buf->len = 0;
+  return err;
+}
+
+/** @brief  generate run profile output csv files, 
+ *          one file per start-stop per train. when following, the last
+ *          run of each train is held back until a new run starts or the
+ *          runs are closed with atc_follow_close_runs
+ *  @param  *ctx  context
+ *  @return err_list_iteration_failed 
+ *          err_list_retrieval_failed
+ *          err_maximum_number_exceeded
+ *  
+ */
+int
+atc_export_run_profile_file(atcContext *ctx)
+{
+  /* content of the run profile being formatted */
+  strBuffer run_buf = {0};
+  bool b_run_open = false;
+  /* manifest rows of the run profiles written */
+  strBuffer manifest_buf = {0};
+  runManifest run = {0};
+
+  int run_cnt_prev = -1;
+  char output_file_full_path[STR_MAX] = "";
+  char output_filename[STR_MAX] = "";
+  char prev_signal_name_graphing[STR_SHORT] = "";
+  char graphing_temp[STR_SHORT] = "";
+  char run_profile_description[STR_MAX] = "";
+  
+  int err = 0;
+  int err_writer = 0;
+  outputData *p_data = NULL;
+
+  bool b_enabled = true;
+
+  /* rows continuing a held run follow it again */
+  if (NULL != ctx->p_follow)
+  {
+    list_attributes_comparator(&ctx->output_data_list, output_data_follow_comparator);
+    list_sort(&ctx->output_data_list, -1);
+    list_attributes_comparator(&ctx->output_data_list, output_data_comparator);
+  }
+
+  /* start iteration */
+  /* iteration start on output list */
+  /* check err, 0 - not able to start iteration; 1 - ok to iterate */
+  if (1 != list_iterator_start(&ctx->output_data_list))
+  {
+    /* iteration not able to start */
+    fprintf
+    (
+      stdout, 
+      "[%6s][%s][%s]\n", 
+      "ERROR", 
+      "Speed Profiles Not Available!",
+      get_err_description(err_list_iteration_failed)
+    );
+    return throw_err(err_list_iteration_failed);
+  }
+  if (ctx->async_export_depth > 0)
+  {
+    /* file writes of a run overlap with formatting of the next ones, 
+    ** the writer lives for this export only and calculation has 
+    ** already finished */
+    ctx->p_async_writer = async_writer_create(ctx->async_export_depth, ctx->b_async_export_sync);
+    if (NULL == ctx->p_async_writer)
+    {
+      fprintf
+      (
+        stdout, 
+        "[%6s][%s]\n", 
+        "WARN", 
+        "Background Writer Not Available, Export Synchronously"
+      );
+    }
+  }
+  while (list_iterator_hasnext(&ctx->output_data_list) && (b_enabled)) 
+  { 
+    /* check for next element */
+    p_data = (outputData *)list_iterator_next(&ctx->output_data_list);
+    if (NULL == p_data)
+    {
+      /* error on retrieving element from list */
+      b_enabled = false;      
+      err = throw_err(err_list_retrieval_failed);
+      fprintf
+      (
+        stdout, 
+        "[%6s][%s][%s]\n", 
+        "ERROR", 
+        "Speed Profiles Not Available",
+        get_err_description(err)
+      );
+    }
+    else if (atc_is_run_open(ctx, p_data))
+    {
+      /* the followed file may still continue this run, the next row 
+      ** exported starts a new run profile */
+      run_cnt_prev = -1;
+    }
+    else
+    {
+      if (run_cnt_prev != p_data->run_cnt)
+      {
+        /* new file */
+        /* write out the completed run profile */
+        if (b_run_open)
+        {
+          b_run_open = false;
+          err = atc_flush_run_profile_file(ctx, output_file_full_path, &run_buf);
+          if (err < 0)
+          {
+            b_enabled = false;
+          }
+          else
+          {
+            atc_add_manifest_row(&manifest_buf, &run);
+          }
+        }
+
+        run_cnt_prev = p_data->run_cnt;
+        strcpy(prev_signal_name_graphing, "");
+        
+        /* previous run profile written, open the next one */
+        if (b_enabled)
+        {
+          err = atc_claim_output_file(ctx, output_filename, p_data, &run.file_cnt);
+          if (err < 0)
+          {
+            b_enabled = false;
+            fprintf
+            (
+              stdout, 
+              "[%6s][%s][%s][%s]\n", 
+              "ERROR", 
+              (err == -err_file_already_exist) ? 
+              "Output File Already Exists!" : "Output File Not Available",
+              get_err_description(err),
+              output_filename
+            );
+          }
+          else
+          {
+            strcpy(output_file_full_path, output_filename);
+            /* file is claimed empty now and written when the run 
+            ** profile is complete */
+            b_run_open = true;
+            strcpy(p_data->output_data_file, output_filename);
+            strcpy(run.str_output_file, output_filename);
+            run.p_first = p_data;
+            run.row_cnt = 0;
+            run.max_speed_km_h = p_data->measured_speed_km_h;
+            /* write header to new file */
+          
+            if (NULL != p_data->str_platform && strcmp(p_data->str_platform, "") > 0)
+            {
+              snprintf
+              (
+                run_profile_description, 
+                STR_MAX, 
+                "%s%s%s%s%s%s%s%s%s",
+                "ATC Speed Profile Departing From ", 
+                p_data->str_from_station, 
+                " Platform ", 
+                p_data->str_platform, 
+                " to ", 
+                p_data->str_to_station,
+                " (", 
+                p_data->str_direction_code, 
+                ")"
+              );
+            }
+            else
+            {
+              snprintf
+              (
+                run_profile_description, 
+                STR_MAX, 
+                "%s%s%s%s%s%s%s",
+                "ATC Speed Profile Departing From ", 
+                p_data->str_from_station,  
+                " to ", 
+                p_data->str_to_station,
+                " (", 
+                p_data->str_direction_code, 
+                ")"
+              );
+            }
+            str_buffer_printf
+            (
+              &run_buf, 
+              "%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s\n", 
+              "Log_Time_[s]",
+              "Segment_ID",
+              "Distance_Travelled_0_[m]",
+              "Distance_Travelled_1_[m]",
+              "Accum_Distance_Travelled_[ft]",
+              "Permitted_Speed_[km/h]",
+              "Measured_Speed_[km/h]",
+              "Current_Tag_ID",
+              "TI_Tag",
+              "Signal_Name",
+              "Signal_Name_Graphing",
+              "Civil_Speed_[km/h]",
+              "Travel_Time_[s]",
+              run_profile_description, 
+              "Distance Travelled from Starting Point [ft]"
+            );
+          }
+        }
+      }
+
+      if (b_run_open)
+      {
+        /* if current_driving_mode changes, = new, otherwise = blank */
+        if (strcmp(prev_signal_name_graphing, p_data->signal_name_graphing))
+        /* not equal to last one, print current signal_name_graphing */
+        {
+          strcpy(graphing_temp, p_data->signal_name_graphing);
+        }
+        else 
+        /* equal to last one, print "" */
+        {
+          strcpy(graphing_temp, "");
+        }
+        /* write the current output data to the run profile */
+
+        str_buffer_printf
+        (
+          &run_buf, 
+          "%f, %s, %f, %f, %f, %f, %f, %d, %d, %s, %s, %f, %f, %s\n", 
+          p_data->log_time_s,
+          p_data->segment_id,
+          p_data->distance_travelled_0_m,
+          p_data->distance_travelled_1_m,
+          p_data->accum_distance_travelled_ft,
+          p_data->permitted_speed_km_h,
+          p_data->measured_speed_km_h,
+          p_data->current_tag_id,
+          p_data->ti_tag,
+          p_data->signal_name,
+          graphing_temp,
+          p_data->civil_speed_km_h,
+          p_data->travel_time_s, 
+          p_data->str_timestamp
+        );
+      
+        /* copy current to prev */
+        strcpy(prev_signal_name_graphing, p_data->signal_name_graphing);
+
+        run.p_last = p_data;
+        run.row_cnt++;
+        if (p_data->measured_speed_km_h > run.max_speed_km_h)
+        {
+          run.max_speed_km_h = p_data->measured_speed_km_h;
+        }
+      }
+    }
+    /* end of current iteration */
+  }
+  
+  /* write out the last run profile */
+  if (b_run_open)
+  {
+    err = atc_flush_run_profile_file(ctx, output_file_full_path, &run_buf);
+    if (err < 0)
+    {
+      b_enabled = false;
+    }
+    else
+    {
+      atc_add_manifest_row(&manifest_buf, &run);
+    }
+  }
+  str_buffer_free(&run_buf);
+
+  if (NULL != ctx->p_async_writer)
+  {
+    /* wait for the queued files, report the first failed write */
+    err_writer = async_writer_close(ctx->p_async_writer);
+    ctx->p_async_writer = NULL;
+    if (err_writer < 0)
+    {
+      b_enabled = false;
+      err = err_writer;
+    }
+  }
+
+  /* a failed background write leaves unknown files missing, the manifest
+  ** then lists none of this export */
+  if (err_writer >= 0)
+  {
+    err_writer = atc_write_manifest(ctx, &manifest_buf);
+    if ((err_writer < 0) && b_enabled)
+    {
+      b_enabled = false;
+      err = err_writer;
+    }
+  }
+  str_buffer_free(&manifest_buf);
+
+  if (!b_enabled)
+  {
+    fprintf
+    (
+      stdout, 
+      "[%6s][%s]\n", 
+      "ERROR", 
+      "Speed Profiles Export Process Interrupted!"
+    );
+  }
+
+  if (1 != list_iterator_stop(&ctx->output_data_list))
+  {
+    return throw_err(err_list_stop_failed);
+  }
+  else if ((NULL != ctx->p_follow) && (0 == err))
+  {
+    return atc_follow_keep_open_runs(ctx);
+  }
+  else
+  {
+    return err;
+  }
+}
+
+/** @brief  add the block traversals of the calculated run profiles to the
+ *          block run time statistics saved in a file. a traversal lasts
+ *          from the first row in a block to the first row in the next
+ *          one, the last block of a run has no end and is not counted
+ *  @param  *ctx             context
+ *  @param  *str_stats_file  block run time csv, created if missing
+ *  @return 0
+ *          err_list_iteration_failed
+ *          err_list_append_failed
+ *          err_file_format_not_valid
+ *          err_file_not_accessible
+ */
+int
+atc_update_block_stats(atcContext *ctx, const char *str_stats_file)
+{
+  blockStatsTable *tbl = NULL;
+  const outputData *p_data = NULL;
+  /* first row of the block being traversed, and the row before */
+  const outputData *p_entry = NULL;
+  const outputData *p_prev = NULL;
+  double distance_m = 0;
+  struct tm tm_entry;
+  int err = 0;
+
+  if (NULL == (tbl = block_stats_create()))
+  {
+    return throw_err(err_list_append_failed);
+  }
+  /* only the saved statistics are read, not the days behind them */
+  if ((err = block_stats_read(tbl, str_stats_file)) < 0)
+  {
+    block_stats_free(tbl);
+    return err;
+  }
+  if (1 != list_iterator_start(&ctx->output_data_list))
+  {
+    block_stats_free(tbl);
+    return throw_err(err_list_iteration_failed);
+  }
+  while ((err >= 0) && list_iterator_hasnext(&ctx->output_data_list))
+  {
+    p_data = (const outputData *) list_iterator_next(&ctx->output_data_list);
+    if (NULL == p_data)
+    {
+      err = throw_err(err_list_retrieval_failed);
+    }
+    else if ((NULL == p_entry) || 
+             (p_data->cc_id != p_prev->cc_id) || 
+             (p_data->run_cnt != p_prev->run_cnt))
+    {
+      /* new run */
+      p_entry = p_data;
+      distance_m = 0;
+    }
+    else if (0 != strcmp(p_data->segment_id, p_entry->segment_id))
+    {
+      /* the move into the next block ends the traversal */
+      distance_m += fabs(p_data->distance_travelled_0_m);
+      if ('\0' != p_entry->segment_id[0])
+      {
+#ifdef _WIN32
+        localtime_s(&tm_entry, &p_entry->timestamp);
+#else
+        localtime_r(&p_entry->timestamp, &tm_entry);
+#endif
+        err = block_stats_add
+        (
+          tbl, 
+          p_entry->segment_id, 
+          p_entry->str_direction_code, 
+          tm_entry.tm_hour,
+          difftime(p_data->timestamp, p_entry->timestamp),
+          distance_m
+        );
+      }
+      p_entry = p_data;
+      distance_m = 0;
+    }
+    else
+    {
+      distance_m += fabs(p_data->distance_travelled_0_m);
+    }
+    p_prev = p_data;
+  }
+  list_iterator_stop(&ctx->output_data_list);
+
+  if (err >= 0)
+  {
+    err = block_stats_write(tbl, str_stats_file);
+  }
+  block_stats_free(tbl);
+  return err;
+}
+
+/*
+** Context Functions
+*/
+
+/** @brief  release one reference to a lookup table, the table is freed
+ *          with its last reference
+ *  @param  *p_lut  lookup table
+ *  @return none
+ */
+static void
+release_lut(atcLut *p_lut)
+{
+  bool b_last = false;
+
+  pthread_mutex_lock(&lut_ref_lock);
+  b_last = (0 == --p_lut->ref_cnt);
+  pthread_mutex_unlock(&lut_ref_lock);
+  if (b_last)
+  {
+    list_destroy(&p_lut->lut_data_list);
+    free(p_lut->p_index);
+    free(p_lut->p_block_index);
+    lut_cache_close(p_lut->p_cache);
+    if (&default_lut != p_lut)
+    {
+      free(p_lut);
+    }
+  }
+}
+
+/** @brief  create the context of one analysis job with its own empty
+ *          lookup table, lists, counters and options
+ *  @return NULL  out of memory
+ *          new context, released with atc_context_free
+ */
+atcContext *
+atc_context_create()
+{
+  atcContext *ctx = NULL;
+
+  if (NULL == (ctx = (atcContext *) calloc(1, sizeof(atcContext))))
+  {
+    return NULL;
+  }
+  if (NULL == (ctx->p_lut = (atcLut *) calloc(1, sizeof(atcLut))))
+  {
+    free(ctx);
+    return NULL;
+  }
+  ctx->p_lut->ref_cnt = 1;
+  /* default column layout until a header line is read */
+  ctx->input_header = input_header;
+  atc_init_lut_data_list(ctx);
+  atc_init_input_data_list(ctx);
+  atc_init_output_data_list(ctx);
+  return ctx;
+}
+
+/** @brief  free a context, its lists, and its lookup table unless other
+ *          contexts still share it
+ *  @param  *ctx  context, may be NULL
+ *  @return none
+ */
+void
+atc_context_free(atcContext *ctx)
+{
+  if (NULL == ctx)
+  {
+    return;
+  }
+  atc_free_input_data_list(ctx);
+  atc_free_output_data_list(ctx);
+  release_lut(ctx->p_lut);
+  if (NULL != ctx->p_follow)
+  {
+    atc_follow_close_runs(ctx);
+    free(ctx->p_follow);
+  }
+  free(ctx);
+}
+
+/** @brief  make a context use the lookup table of another one instead of
+ *          its own, the table is read only from then on and stays loaded
+ *          until every context using it is freed
+ *  @param  *ctx  context taking the table
+ *  @param  *src  context holding a loaded table
+ *  @return 0
+ *          err_null_string  a context is missing
+ */
+int
+atc_context_share_lut(atcContext *ctx, atcContext *src)
+{
+  if ((NULL == ctx) || (NULL == src))
+  {
+    return throw_err(err_null_string);
+  }
+  if (ctx->p_lut == src->p_lut)
+  {
+    return 0;
+  }
+  pthread_mutex_lock(&lut_ref_lock);
+  src->p_lut->ref_cnt++;
+  pthread_mutex_unlock(&lut_ref_lock);
+
+  ctx->tool_stats.list_bytes -= ctx->p_lut->memory.bytes;
+  release_lut(ctx->p_lut);
+  ctx->p_lut = src->p_lut;
+  ctx->tool_stats.list_bytes += ctx->p_lut->memory.bytes;
+  if (ctx->tool_stats.list_bytes > ctx->tool_stats.list_bytes_high_water)
+  {
+    ctx->tool_stats.list_bytes_high_water = ctx->tool_stats.list_bytes;
+  }
+  return 0;
+}
+
+/** @brief  follow a growing input file: each atc_read_input_file reads 
+ *          only the lines added since the previous call, every train 
+ *          resumes its run segmentation where the previous increment 
+ *          stopped and only completed runs are exported. one context
+ *          follows one file.
+ *  @param  *ctx  context
+ *  @return 0
+ *          err_null_string         context is missing
+ *          err_list_append_failed  not enough memory
+ */
+int
+atc_follow_enable(atcContext *ctx)
+{
+  if (NULL == ctx)
+  {
+    return throw_err(err_null_string);
+  }
+  if (NULL == ctx->p_follow)
+  {
+    ctx->p_follow = (followState *) calloc(1, sizeof(followState));
+    if (NULL == ctx->p_follow)
+    {
+      return throw_err(err_list_append_failed);
+    }
+  }
+  return 0;
+}
+
+/** @brief  bytes of the followed file consumed so far
+ *  @param  *ctx  context
+ *  @return offset after the last complete line read
+ *          -1    not following
+ */
+long
+atc_follow_offset(atcContext *ctx)
+{
+  return ((NULL == ctx) || (NULL == ctx->p_follow)) ? -1 : ctx->p_follow->offset;
+}
+
+/** @brief  end the runs of every followed train, the next export writes
+ *          the runs held back so far and new rows start new runs
+ *  @param  *ctx  context
+ *  @return none
+ */
+void
+atc_follow_close_runs(atcContext *ctx)
+{
+  int i = 0;
+
+  if ((NULL == ctx) || (NULL == ctx->p_follow))
+  {
+    return;
+  }
+  for (i = 0; i <= CC_ID_MAX; i++)
+  {
+    free(ctx->p_follow->p_run_state[i]);
+    ctx->p_follow->p_run_state[i] = NULL;
+  }
+}
+
+/*
+** Single Job Functions
+** the original interface, working on one context for the whole process
+*/
+
+/** @brief  get the context behind the single job functions
+ *  @return default context
+ */
+static atcContext *
+get_default_context()
+{
+  if (!b_default_context_ready)
+  {
+    default_lut.ref_cnt = 1;
+    default_context.p_lut = &default_lut;
+    default_context.input_header = input_header;
+    b_default_context_ready = true;
+  }
+  return &default_context;
+}
+
+/** @brief  add input data structure to the default input data list
+ *  @param  *data  pointer to the new input data structure 
+ *  @return err_list_append_failed
+ */
+int 
+add_to_input_data_list(inputData *data) 
+{
+  return atc_add_to_input_data_list(get_default_context(), data);
+}
+
+/** @brief  add output data structure to the default output data list
+ *  @param  *data  pointer to the new output data structure 
+ *  @return err_list_append_failed
+ */
+int 
+add_to_output_data_list(outputData *data) 
+{
+  return atc_add_to_output_data_list(get_default_context(), data);
+}
+
+/** @brief  add lookup table data structure to the default lut data list
+ *  @param  *data  pointer to the new lut data structure 
+ *  @return err_list_append_failed
+ *          err_maximum_number_exceeded
+ */
+int 
+add_to_lut_data_list(lutData *data) 
+{
+  return atc_add_to_lut_data_list(get_default_context(), data);
+}
+
+/** @brief  convert the default inputHeader and format into string 
+ *  @return converted static string             
+ */
+char *
+input_header_to_string()
+{
+  return atc_input_header_to_string(get_default_context());
+}
+
+/** @brief  print block look up table on the screen
+ *  @return errorCode
+ */
+int 
+display_lut_data_list()
+{
+  return atc_display_lut_data_list(get_default_context());
+}
+
+/** @brief  print input data list on the screen
+ *  @return errorCode
+ */
+int 
+display_input_data_list()
+{
+  return atc_display_input_data_list(get_default_context());
+}
+
+/** @brief  print output data list on the screen
+ *  @return errorCode
+ */
+int 
+display_output_data_list()
+{
+  return atc_display_output_data_list(get_default_context());
+}
+
+/** @brief  initialize lookup list
+ *  @return none
+ */
+void 
+init_lut_data_list()
+{
+  atc_init_lut_data_list(get_default_context());
+}
+
+/** @brief  initialize input data list
+ *  @return none
+ */
+void 
+init_input_data_list()
+{
+  atc_init_input_data_list(get_default_context());
+}
+
+/** @brief  initialize output data list
+ *  @return none
+ */
+void 
+init_output_data_list()
+{
+  atc_init_output_data_list(get_default_context());
+}
+
+/** @brief  sort input data list
+ *  @return err_list_is_empty
+ */
+int 
+sort_input_data_list()
+{
+  return atc_sort_input_data_list(get_default_context());
+}
+
+/** @brief  clear and free lookup table list
+ *  @return none
+ */
+void 
+free_lut_data_list()
+{
+  atc_free_lut_data_list(get_default_context());
+}
+
+/** @brief  clear and free input data list
+ *  @return none
+ */
+void 
+free_input_data_list()
+{
+  atc_free_input_data_list(get_default_context());
+}
+
+/** @brief  clear and free output data list
+ *  @return none
+ */
+void 
+free_output_data_list()
+{
+  atc_free_output_data_list(get_default_context());
+}
+
+/** @brief  parse the header line into the default input header
+ *  @param  *line  header line string 
+ *  @return                 0     header parsed successfully
+ *          err_missing_header    some header info is missing
+ */
+int
+parse_input_header(char *line)
+{
+  return atc_parse_input_header(get_default_context(), line);
+}
+
+/** @brief  parse the data line string into the input_data structure 
+ *          using the default input header
+ *  @param  *input_data  pointer to the new input data structure 
+ *  @param  *str_data_line  input data string
+ *  @param  *str_data_file  input data file
+ *  @return err_cc_not_valid
+ *          err_date_not_valid
+ *          err_maximum_number_exceeded
+ */
+int 
+parse_input_data(inputData *input_data, char *str_data_line, char *str_data_file)
+{
+  return atc_parse_input_data(get_default_context(), input_data, str_data_line, str_data_file);
+}
+
+/** @brief  calculate run profile file name from the output data 
+ *  @param  filename  buffer to store resulted filename
+ *  @param  data      pointer to output data
+ *  @return err_insufficient_buffer_size 
+ */
+int
+get_output_file(char *filename, outputData *data)
+{
+  int file_cnt = 0;
+
+  return atc_get_output_file(get_default_context(), filename, data, &file_cnt);
+}
+
+/** @brief  match input_data to the default lookup table
+ *  @param  *input_data  input data 
+ *  @return 0
+ *          err_lut_is_empty 
+ *          err_lut_match_not_found
+ *          err_file_format_not_valid
+ */
+int
+expand_data_use_lut(inputData *input_data)
+{
+  return atc_expand_data_use_lut(get_default_context(), input_data);
+}
+
+/** @brief  read lookup table file and add to lookup table data list
+ *  @param  *str_lut_file  lookup table file path 
+ *  @return err_list_append_failed
+ *          err_file_not_accessible      
+ */
+int
+read_lut_file(char *str_lut_file)
+{
+  return atc_read_lut_file(get_default_context(), str_lut_file);
+}
+
+/** @brief  read input data file and add to input data list, rows not 
+ *          valid are counted in the data quality report and skipped
+ *  @param  *str_data_file  input data file path 
+ *  @return err_list_append_failed 
+ *          err_file_not_accessible 
+ */
+int 
+read_input_file(char *str_data_file)
+{
+  return atc_read_input_file(get_default_context(), str_data_file);
+}
+
+/** @brief  expand input data list with lookup table 
+ *  @return err_list_iteration_failed 
+ *          err_list_retrieval_failed 
+ */
+int
+expand_data_list_use_lut()
+{
+  return atc_expand_data_list_use_lut(get_default_context());
+}
+
+/** @brief  process input data list, generate output data, and 
+ *          add to output data list 
+ *  @return err_list_iteration_failed 
+ *          err_list_retrieval_failed
+ *          err_maximum_number_exceeded
+ */
+int
+calculate_output_data_list()
+{
+  return atc_calculate_output_data_list(get_default_context());
+}
+
+/** @brief  generate run profile output csv files, 
+ *          one file per start-stop per train
+ *  @return err_list_iteration_failed 
+ *          err_list_retrieval_failed
+ *          err_maximum_number_exceeded
+ */
+int
+export_run_profile_file()
+{
+  return atc_export_run_profile_file(get_default_context());
+}
+
+/** @brief  add the block traversals of the calculated run profiles to the
+ *          block run time statistics saved in a file
+ *  @param  *str_stats_file  block run time csv, created if missing
+ *  @return err_list_iteration_failed 
+ *          err_file_format_not_valid
+ *          err_file_not_accessible
+ */
+int
+update_block_stats(const char *str_stats_file)
+{
+  return atc_update_block_stats(get_default_context(), str_stats_file);
+}
+
+/** @brief  configure background export of run profile files
+ *  @param  queue_depth  number of completed run profiles waiting to be 
+ *                       written, 0 to export synchronously
+ *  @param  b_sync       flush file system buffers once export completes
+ *  @return none
+ */
+void
+set_async_export(int queue_depth, bool b_sync)
+{
+  atc_set_async_export(get_default_context(), queue_depth, b_sync);
+}
+
+/** @brief  keep only the input rows within a time window
+ *  @param  from            first time kept, -1 for no lower bound
+ *  @param  to              first time past the window, -1 for no upper bound
+ *  @param  b_time_ordered  input files are in time order, rows before the
+ *                          window are skipped by a binary search and
+ *                          reading stops at the first row past it
+ *  @return none
+ */
+void
+set_time_window(time_t from, time_t to, bool b_time_ordered)
+{
+  atc_set_time_window(get_default_context(), from, to, b_time_ordered);
+}
+
+/** @brief  keep only the input rows of a train, trains added are kept
+ *  @param  cc_id  cc number of the train
+ *  @return 0
+ *          err_cc_not_valid
+ */
+int
+add_cc_filter(int cc_id)
+{
+  return atc_add_cc_filter(get_default_context(), cc_id);
+}
+
+/** @brief  keep only the runs departing from a station, stations added 
+ *          are kept. a run arriving at the station from another one is
+ *          not kept
+ *  @param  *str_station_code  station code, e.g. SCW
+ *  @param  *str_platform      departing platform, NULL or empty for any
+ *  @return 0
+ *          err_null_string
+ *          err_insufficient_buffer_size
+ *          err_maximum_number_exceeded   STATION_FILTER_MAX reached
+ */
+int
+add_station_filter(const char *str_station_code, const char *str_platform)
+{
+  return atc_add_station_filter(get_default_context(), str_station_code, str_platform);
+}
+
+/** @brief  get a snapshot of the processing counters
+ *  @param  *stats  counters output
+ *  @return none
+ */
+void
+get_tool_stats(toolStats *stats)
+{
+  atc_get_tool_stats(get_default_context(), stats);
+}
+
+/** @brief  get the heap usage of a list
+ *  @param  list  enum tool_list
+ *  @param  *mem  heap usage output
+ *  @return 0
+ *          err_maximum_number_exceeded  list is not valid
+ */
+int
+get_list_memory(int list, listMemory *mem)
+{
+  return atc_get_list_memory(get_default_context(), list, mem);
+}
+
+/** @brief  restart the list high-water mark from the bytes held now
+ *  @return none
+ */
+void
+reset_list_memory_high_water()
+{
+  atc_reset_list_memory_high_water(get_default_context());
 }
@@ -28,6 +28,7 @@
 ** Outputs:
 ** Run Profile Files:
 ** run_profiles\*.csv
+** run_profiles\run_profile_manifest.csv
 **
 ** ----------------------------------------------------
 */
@@ -73,10 +74,30 @@
 #define RUN_PROFILE_PATH          "run_profiles\\"
 /* folder store output ECD format logs */ 
 #define RUN_PROFILE_PREFIX        "DEPARTING_FROM_PLATFORM_"
+/* one row per run profile written to the folder, appended on export */
+#define RUN_PROFILE_MANIFEST      "run_profile_manifest.csv"
 /* Look up table header (data column) count */
 #define LUT_HEADER_CNT            11
 /* Input file list maximum length */
 #define FILE_LIST_MAX_LENGTH      99
+/* highest valid train (cc) number */
+#define CC_ID_MAX                 999
+/* atc_parse_input_data return of a row outside the time window or of a
+** train not requested, the row is valid but not kept */
+#define INPUT_ROW_FILTERED        1
+/* maximum number of stations requested by a station filter */
+#define STATION_FILTER_MAX        16
+
+/* lists held in memory, memory accounting */
+enum tool_list
+{
+  k_list_lut = 0,
+  k_list_input,
+  k_list_output,
+
+  /* number of lists */
+  k_list_cnt
+};
 
 
 /*
@@ -130,6 +151,8 @@ typedef struct input_data_t
   char str_platform[STR_MIN];
   bool is_platform;
   bool is_motion;
+  /* outside the stations requested, skipped by the calculation */
+  bool b_filtered;
 
 } inputData;
 
@@ -229,6 +252,56 @@ typedef struct input_header_t
   int col_speed;
 } inputHeader;
 
+/* processing counters, cumulative since program start */
+typedef struct tool_stats_t
+{
+  /* lines and bytes consumed from the lookup table files */
+  uint64_t lut_lines_read;
+  uint64_t lut_bytes_read;
+  /* lines and bytes consumed from the input data files */
+  uint64_t input_lines_read;
+  uint64_t input_bytes_read;
+  /* input records read and dropped by the time window or train filter */
+  uint64_t input_filtered;
+  /* input records outside the stations requested, not calculated */
+  uint64_t input_skipped;
+  /* records currently held in the lists */
+  uint64_t lut_cnt;
+  uint64_t input_cnt;
+  uint64_t output_cnt;
+  /* input records matched with the lookup table */
+  uint64_t input_expanded;
+  /* run profile files and bytes handed to the file system */
+  uint64_t files_written;
+  uint64_t bytes_written;
+  /* heap bytes currently held by the lists, and the high-water mark 
+  ** since the last reset_list_memory_high_water */
+  uint64_t list_bytes;
+  uint64_t list_bytes_high_water;
+} toolStats;
+
+/* heap usage of one list */
+typedef struct list_memory_t
+{
+  /* elements held now and at the high-water mark */
+  uint64_t cnt;
+  uint64_t peak_cnt;
+  /* element structure size */
+  uint64_t element_size;
+  /* heap bytes per element, element copy plus list node, each with 
+  ** the allocator header and rounding */
+  uint64_t node_size;
+  /* heap bytes held now and at the high-water mark */
+  uint64_t bytes;
+  uint64_t peak_bytes;
+} listMemory;
+
+/* state of one analysis job: lookup table, lists, counters and options,
+** created with atc_context_create */
+typedef struct atc_context_t atcContext;
+/* lookup table, shared by reference between contexts */
+typedef struct atc_lut_t atcLut;
+
 /*
 ** Variables
 ** -----------------------------------------------------
@@ -242,8 +315,8 @@ static const int k_header_num_digit = 1;
 static const int k_lut_header_num_digit = 4;
 /* number of columns in lookup table csv */
 static const int k_lut_header_cnt = LUT_HEADER_CNT;
-/* static string to support _to_string function */
-static char str_static_data[STR_EXTRA];
+/* static string to support _to_string function, one per thread */
+static THREAD_LOCAL char str_static_data[STR_EXTRA];
 
 /* input data header index */
 enum header_index
@@ -342,6 +415,17 @@ input_header_to_string();
 char *
 input_data_to_string(inputData *data);
 
+/** @brief  format inputData as a csv record into a caller supplied buffer
+ *      in a single pass, the output is truncated if the buffer is too small
+ *  @param  *buf   destination buffer 
+ *  @param  size   destination buffer size in bytes
+ *  @param  *data  inputData to be converted 
+ *  @return number of characters needed, excluding the null terminator
+ *             
+ */
+size_t
+input_data_format(char *buf, size_t size, const inputData *data);
+
 /** @brief  convert lutData and format into string 
  *  @param  *data  lutData to be converted 
  *  @return NULL      input is not valid
@@ -351,6 +435,17 @@ input_data_to_string(inputData *data);
 char *
 lut_data_to_string(lutData *data);
 
+/** @brief  format lutData as a csv record into a caller supplied buffer
+ *      in a single pass, the output is truncated if the buffer is too small
+ *  @param  *buf   destination buffer 
+ *  @param  size   destination buffer size in bytes
+ *  @param  *data  lutData to be converted 
+ *  @return number of characters needed, excluding the null terminator
+ *             
+ */
+size_t
+lut_data_format(char *buf, size_t size, const lutData *data);
+
 /** @brief  convert outputData and format into string 
  *  @param  *data  outputData to be converted 
  *  @return NULL      input is not valid
@@ -360,6 +455,17 @@ lut_data_to_string(lutData *data);
 char *
 output_data_to_string(outputData *data);
 
+/** @brief  format outputData as a csv record into a caller supplied buffer
+ *      in a single pass, the output is truncated if the buffer is too small
+ *  @param  *buf   destination buffer 
+ *  @param  size   destination buffer size in bytes
+ *  @param  *data  outputData to be converted 
+ *  @return number of characters needed, excluding the null terminator
+ *             
+ */
+size_t
+output_data_format(char *buf, size_t size, const outputData *data);
+
 /** @brief  print block look up table on the screen
  *  @param  none
  *  @return errorCode
@@ -440,6 +546,79 @@ free_input_data_list();
 void 
 free_output_data_list();
 
+/** @brief  convert date time formatted string to time_t seconds format
+ *      this function validates the str_date_time, returns negative if date is 
+ *      not valid. 
+ *  @param  *str_date_time  date time string in "2018/08/27 20:00:00" 
+ *  @return err_date_not_valid    negative on error
+ *          timestamp in seconds  
+ *             
+ */
+time_t
+str_to_seconds(const char *str_date_time);
+
+/** @brief  check if a line is header
+ *      traverse through the line until reach end, count number of digits
+ *      in the line, compare to the limit, return true if less than the limit
+ *  @param  *line  line string in question 
+ *  @param  *num_digit_hi  number of digits high limit
+ *  @return true    line is header
+ *          false   line is not header
+ */
+bool
+is_header(char *line, int num_digit_hi);
+
+/** @brief  check if a line is in valid csv format with minimum number of 
+ *            columns
+ *      traverse through the line until reach end, count number of delimiter
+ *      ',' in the case of csv, compare to the limit, return true if more 
+ *      than the limit
+ *  @param  *line  line string in question 
+ *  @param  *num_col_lo  number of columns low limit
+ *  @return true    line is valid csv
+ *          false   line is not valid csv
+ */
+bool
+is_csv_line(char *line, int num_col_lo);
+
+/** @brief  parse the header line and determine the column location for each
+ *            variables.
+ *      split the line with delimiter ",", match token to header name and 
+ *        store column number to input header.
+ *  @param  *line  header line string 
+ *  @return                 0     header parsed successfully
+ *          err_missing_header    some header info is missing
+ */
+int
+parse_input_header(char *line);
+
+/** @brief  parse the data line string into the input_data structure, 
+ *      convert time string into timestamp, validate the cc number, 
+ *      calculate the sorting string, and generate id. returns negative on
+ *      error.
+ *  @param  *input_data  pointer to the new input data structure 
+ *  @param  *str_data_line  input data string
+ *  @param  *str_data_file  input data file
+ *  @return INPUT_ROW_FILTERED  row outside the time window or of a train
+ *                              not requested
+ *          err_cc_not_valid
+ *          err_date_not_valid
+ *          err_maximum_number_exceeded
+ */
+int
+parse_input_data(inputData *input_data, char *str_data_line, char *str_data_file);
+
+/** @brief  parse lookup table data line string into the lut_data structure, 
+ *      convert id, direction number, block length, validate block, direction,
+ *      returns negative on error.
+ *  @param  *input_data  pointer to the new lut data structure 
+ *  @param  *str_data_line  input data string
+ *  @return err_file_format_not_valid
+ *          err_maximum_number_exceeded
+ */
+int
+parse_lut_data(lutData *input_data, char *str_data_line);
+
 /** @brief  read lookup table file and add to lookup table data list
  *  @param  *str_lut_file  lookup table file path 
  *  @return err_list_append_failed
@@ -448,7 +627,8 @@ free_output_data_list();
 int
 read_lut_file(char *str_lut_file);
 
-/** @brief  read input data file and add to input data list 
+/** @brief  read input data file and add to input data list, rows not 
+ *          valid are counted in the data quality report and skipped
  *  @param  *str_lut_file  input data file path 
  *  @return err_list_append_failed 
  *          err_file_not_accessible 
@@ -490,4 +670,368 @@ calculate_output_data_list();
 int
 export_run_profile_file();
 
+/** @brief  add the block traversals of the calculated run profiles to the
+ *          block run time statistics saved in a file
+ *  @param  *str_stats_file  block run time csv, created if missing
+ *  @return err_list_iteration_failed 
+ *          err_file_format_not_valid
+ *          err_file_not_accessible
+ */
+int
+update_block_stats(const char *str_stats_file);
+
+/** @brief  configure background export of run profile files. the writer
+ *          runs during export only, file writes overlap with formatting
+ *          of the next run profiles, not with calculation
+ *  @param  queue_depth  number of completed run profiles waiting to be 
+ *                       written, 0 to export synchronously
+ *  @param  b_sync       flush file system buffers once export completes
+ *  @return none
+ *             
+ */
+void
+set_async_export(int queue_depth, bool b_sync);
+
+/** @brief  keep only the input rows within a time window
+ *  @param  from            first time kept, -1 for no lower bound
+ *  @param  to              first time past the window, -1 for no upper bound
+ *  @param  b_time_ordered  input files are in time order, rows before the
+ *                          window are skipped by a binary search and
+ *                          reading stops at the first row past it
+ *  @return none
+ */
+void
+set_time_window(time_t from, time_t to, bool b_time_ordered);
+
+/** @brief  keep only the input rows of a train, trains added are kept
+ *  @param  cc_id  cc number of the train
+ *  @return 0
+ *          err_cc_not_valid
+ */
+int
+add_cc_filter(int cc_id);
+
+/** @brief  keep only the runs departing from a station, stations added 
+ *          are kept. a run arriving at the station from another one is
+ *          not kept
+ *  @param  *str_station_code  station code, e.g. SCW
+ *  @param  *str_platform      departing platform, NULL or empty for any
+ *  @return 0
+ *          err_null_string
+ *          err_insufficient_buffer_size
+ *          err_maximum_number_exceeded   STATION_FILTER_MAX reached
+ */
+int
+add_station_filter(const char *str_station_code, const char *str_platform);
+
+/** @brief  get a snapshot of the processing counters
+ *  @param  *stats  counters output
+ *  @return none
+ *             
+ */
+void
+get_tool_stats(toolStats *stats);
+
+/** @brief  get the heap usage of a list
+ *  @param  list  enum tool_list
+ *  @param  *mem  heap usage output
+ *  @return 0
+ *          err_maximum_number_exceeded  list is not valid
+ */
+int
+get_list_memory(int list, listMemory *mem);
+
+/** @brief  restart the list high-water mark from the bytes held now,
+ *          used to measure the high-water mark of each stage
+ *  @return none
+ */
+void
+reset_list_memory_high_water();
+
+/*
+** Context Function Prototypes
+** -----------------------------------------------------
+** each analysis job works on its own context, separate contexts can be
+** processed by separate threads. the functions above work on a single
+** context for the whole process.
+*/
+
+/** @brief  create the context of one analysis job with its own empty
+ *          lookup table, lists, counters and options
+ *  @return NULL  out of memory
+ *          new context, released with atc_context_free
+ */
+atcContext *
+atc_context_create();
+
+/** @brief  free a context, its lists, and its lookup table unless other
+ *          contexts still share it
+ *  @param  *ctx  context, may be NULL
+ *  @return none
+ */
+void
+atc_context_free(atcContext *ctx);
+
+/** @brief  make a context use the lookup table of another one instead of
+ *          its own, the table is read only from then on and stays loaded
+ *          until every context using it is freed
+ *  @param  *ctx  context taking the table
+ *  @param  *src  context holding a loaded table
+ *  @return 0
+ *          err_null_string  a context is missing
+ */
+int
+atc_context_share_lut(atcContext *ctx, atcContext *src);
+
+/** @brief  follow a growing input file: each atc_read_input_file reads 
+ *          only the lines added since the previous call, every train 
+ *          resumes its run segmentation where the previous increment 
+ *          stopped and only completed runs are exported. one context
+ *          follows one file.
+ *  @param  *ctx  context
+ *  @return 0
+ *          err_null_string         context is missing
+ *          err_list_append_failed  not enough memory
+ */
+int
+atc_follow_enable(atcContext *ctx);
+
+/** @brief  bytes of the followed file consumed so far
+ *  @param  *ctx  context
+ *  @return offset after the last complete line read
+ *          -1    not following
+ */
+long
+atc_follow_offset(atcContext *ctx);
+
+/** @brief  end the runs of every followed train, the next export writes
+ *          the runs held back so far and new rows start new runs
+ *  @param  *ctx  context
+ *  @return none
+ */
+void
+atc_follow_close_runs(atcContext *ctx);
+
+/** @brief  read lookup table file into the lookup table of a context
+ *  @param  *ctx           context
+ *  @param  *str_lut_file  lookup table file path 
+ *  @return err_list_append_failed
+ *          err_file_not_accessible      
+ */
+int
+atc_read_lut_file(atcContext *ctx, char *str_lut_file);
+
+/** @brief  read input data file into the input data list of a context.
+ *          rows not valid are counted in the data quality report and 
+ *          skipped, reading goes on with the next row
+ *  @param  *ctx            context
+ *  @param  *str_data_file  input data file path 
+ *  @return err_list_append_failed 
+ *          err_file_not_accessible 
+ */
+int
+atc_read_input_file(atcContext *ctx, char *str_data_file);
+
+/** @brief  parse a header line into the input header of a context
+ *  @param  *ctx   context
+ *  @param  *line  header line string 
+ *  @return                 0     header parsed successfully
+ *          err_missing_header    some header info is missing
+ */
+int
+atc_parse_input_header(atcContext *ctx, char *line);
+
+/** @brief  parse a data line using the input header of a context
+ *  @param  *ctx            context
+ *  @param  *input_data     pointer to the new input data structure 
+ *  @param  *str_data_line  input data string
+ *  @param  *str_data_file  input data file
+ *  @return INPUT_ROW_FILTERED  row outside the time window or of a train
+ *                              not requested, only its timestamp is set
+ *          err_cc_not_valid
+ *          err_date_not_valid
+ *          err_maximum_number_exceeded
+ */
+int
+atc_parse_input_data(atcContext *ctx, inputData *input_data, char *str_data_line, char *str_data_file);
+
+/** @brief  sort the input data list of a context
+ *  @param  *ctx  context
+ *  @return err_list_is_empty
+ */
+int
+atc_sort_input_data_list(atcContext *ctx);
+
+/** @brief  expand the input data list of a context with its lookup table
+ *  @param  *ctx  context
+ *  @return err_list_iteration_failed 
+ *          err_list_retrieval_failed 
+ */
+int
+atc_expand_data_list_use_lut(atcContext *ctx);
+
+/** @brief  generate the output data list of a context from its input 
+ *          data list
+ *  @param  *ctx  context
+ *  @return err_list_iteration_failed 
+ *          err_list_retrieval_failed
+ *          err_maximum_number_exceeded
+ */
+int
+atc_calculate_output_data_list(atcContext *ctx);
+
+/** @brief  write the run profiles of a context, one file per start-stop 
+ *          per train
+ *  @param  *ctx  context
+ *  @return err_list_iteration_failed 
+ *          err_list_retrieval_failed
+ *          err_maximum_number_exceeded
+ */
+int
+atc_export_run_profile_file(atcContext *ctx);
+
+/** @brief  add the block traversals of the calculated run profiles to the
+ *          block run time statistics saved in a file
+ *  @param  *ctx             context
+ *  @param  *str_stats_file  block run time csv, created if missing
+ *  @return 0
+ *          err_list_iteration_failed
+ *          err_file_format_not_valid
+ *          err_file_not_accessible
+ */
+int
+atc_update_block_stats(atcContext *ctx, const char *str_stats_file);
+
+/** @brief  configure background export of run profile files of a context,
+ *          the writer runs during export only, see set_async_export
+ *  @param  *ctx         context
+ *  @param  queue_depth  number of completed run profiles waiting to be 
+ *                       written, 0 to export synchronously
+ *  @param  b_sync       flush file system buffers once export completes
+ *  @return none
+ */
+void
+atc_set_async_export(atcContext *ctx, int queue_depth, bool b_sync);
+
+/** @brief  set the folder run profiles of a context are written to
+ *  @param  *ctx       context
+ *  @param  *str_path  folder, a path delimiter is appended if missing,
+ *                     NULL or empty for the default RUN_PROFILE_PATH
+ *  @return 0
+ *          err_insufficient_buffer_size
+ */
+int
+atc_set_output_path(atcContext *ctx, const char *str_path);
+
+/** @brief  take the lookup table compiled into the binary, see lut_embed.h
+ *  @param  *ctx  context with an empty lookup table
+ *  @return 0
+ *          err_lut_is_empty              built without ATC_EMBEDDED_LUT
+ *          err_file_already_exist        the context has a table already
+ *          err_maximum_number_exceeded   not enough memory
+ */
+int
+atc_load_embedded_lut(atcContext *ctx);
+
+/** @brief  get the csv the lookup table compiled into the binary was
+ *          generated from
+ *  @return NULL  built without ATC_EMBEDDED_LUT
+ *          csv path
+ */
+const char *
+atc_embedded_lut_source();
+
+/** @brief  write the lookup table of a context as C source, to be built
+ *          with ATC_EMBEDDED_LUT
+ *  @param  *ctx         context holding the loaded table
+ *  @param  *str_source  csv the table was read from
+ *  @param  *fp          source output
+ *  @return 0
+ *          err_null_string
+ *          err_lut_is_empty
+ *          err_list_append_failed
+ *          err_maximum_number_exceeded   no perfect hash found
+ *          err_file_not_accessible
+ */
+int
+atc_write_embedded_lut(atcContext *ctx, const char *str_source, FILE *fp);
+
+/** @brief  load the lookup table of a context from its compiled image,
+ *          the image is written next to the csv and rebuilt when the csv
+ *          size or content changes. the csv is hashed only when its
+ *          modification time differs from the image, unless verified
+ *  @param  *ctx       context
+ *  @param  b_enabled  use the compiled image
+ *  @param  b_verify   hash the csv even if its size and time match
+ *  @return none
+ */
+void
+atc_set_lut_cache(atcContext *ctx, bool b_enabled, bool b_verify);
+
+/** @brief  keep only the input rows of a context within a time window
+ *  @param  *ctx            context
+ *  @param  from            first time kept, -1 for no lower bound
+ *  @param  to              first time past the window, -1 for no upper bound
+ *  @param  b_time_ordered  input files are in time order, rows before the
+ *                          window are skipped by a binary search and
+ *                          reading stops at the first row past it. not
+ *                          used while following files
+ *  @return none
+ */
+void
+atc_set_time_window(atcContext *ctx, time_t from, time_t to, bool b_time_ordered);
+
+/** @brief  keep only the input rows of a train, trains added are kept. the
+ *          cc id column is checked before the rest of the row is parsed
+ *  @param  *ctx   context
+ *  @param  cc_id  cc number of the train
+ *  @return 0
+ *          err_cc_not_valid
+ */
+int
+atc_add_cc_filter(atcContext *ctx, int cc_id);
+
+/** @brief  keep only the runs departing from a station, stations added 
+ *          are kept. a run arriving at the station from another one is
+ *          not kept, run profiles are named by their departing platform.
+ *          rows away from the stations are skipped once matched with the
+ *          lookup table, before the calculation, except while following
+ *          files
+ *  @param  *ctx               context
+ *  @param  *str_station_code  station code, e.g. SCW
+ *  @param  *str_platform      departing platform, NULL or empty for any
+ *  @return 0
+ *          err_null_string
+ *          err_insufficient_buffer_size
+ *          err_maximum_number_exceeded   STATION_FILTER_MAX reached
+ */
+int
+atc_add_station_filter(atcContext *ctx, const char *str_station_code, const char *str_platform);
+
+/** @brief  get a snapshot of the processing counters of a context
+ *  @param  *ctx    context
+ *  @param  *stats  counters output
+ *  @return none
+ */
+void
+atc_get_tool_stats(atcContext *ctx, toolStats *stats);
+
+/** @brief  get the heap usage of a list of a context
+ *  @param  *ctx  context
+ *  @param  list  enum tool_list
+ *  @param  *mem  heap usage output
+ *  @return 0
+ *          err_maximum_number_exceeded  list is not valid
+ */
+int
+atc_get_list_memory(atcContext *ctx, int list, listMemory *mem);
+
+/** @brief  restart the list high-water mark of a context from the bytes 
+ *          held now
+ *  @param  *ctx  context
+ *  @return none
+ */
+void
+atc_reset_list_memory_high_water(atcContext *ctx);
+
 #endif
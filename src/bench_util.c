@@ -0,0 +1,468 @@
+/*------------------------------------------------------
+**
+** File:      bench_util.c
+** Author:    Eric Lu
+** Created:   2026-10-19
+**
+** Copyright ©2012 Toronto Transit Commission
+**
+**
+** Function Description
+** -----------------------------------------------------
+**
+** timing samples, summary statistics and result files shared by the
+** atc_speed_profile_tool benchmarks
+**
+** -----------------------------------------------------
+** Revision History
+**
+** 19 OCT 2026: Rev 1.0 - erilu
+**                      - Initial Design
+**
+** Inputs:
+** Elapsed time of each benchmark repetition
+**
+** Outputs:
+** Summary table on the screen, csv result file
+**
+** ----------------------------------------------------
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "errorhandler.h"
+#include "bench_util.h"
+
+/*
+** Source Code
+** -----------------------------------------------------
+*/
+
+/* comparator function required for qsort, ascending */
+static int
+sample_comparator(const void *a, const void *b)
+{
+  double x = *(const double *) a;
+  double y = *(const double *) b;
+
+  return (x > y) - (x < y);
+}
+
+/** @brief  clear a result and name it
+ *  @param  *result  benchmark result
+ *  @param  *name    benchmark name, truncated to STR_LONG
+ *  @param  rows     rows processed by one repetition
+ *  @return none
+ */
+void
+bench_result_init(benchResult *result, const char *name, uint64_t rows)
+{
+  memset(result, 0, sizeof(benchResult));
+  snprintf(result->name, STR_LONG, "%s", name);
+  result->rows = rows;
+}
+
+/** @brief  add the elapsed time of one repetition
+ *  @param  *result     benchmark result
+ *  @param  elapsed_s   elapsed time in seconds
+ *  @return 0
+ *          err_maximum_number_exceeded
+ */
+int
+bench_result_add(benchResult *result, double elapsed_s)
+{
+  if (result->reps >= BENCH_MAX_SAMPLES)
+  {
+    return throw_err(err_maximum_number_exceeded);
+  }
+  result->samples[result->reps] = elapsed_s;
+  result->reps++;
+  return 0;
+}
+
+/** @brief  add the list memory high-water mark of one repetition, the
+ *          highest of all repetitions is kept
+ *  @param  *result     benchmark result
+ *  @param  peak_bytes  list memory high-water mark in bytes
+ *  @return none
+ */
+void
+bench_result_add_memory(benchResult *result, uint64_t peak_bytes)
+{
+  uint64_t peak_kb = (peak_bytes + 1023) / 1024;
+
+  if (peak_kb > result->peak_kb)
+  {
+    result->peak_kb = peak_kb;
+  }
+}
+
+/** @brief  compute median, p95, min, mean and rows per second from the
+ *          samples, rows per second is based on the median
+ *  @param  *result  benchmark result
+ *  @return none
+ */
+void
+bench_result_finish(benchResult *result)
+{
+  double sorted[BENCH_MAX_SAMPLES];
+  double sum = 0;
+  int n = result->reps;
+  int i = 0;
+
+  if (n <= 0)
+  {
+    return;
+  }
+
+  memcpy(sorted, result->samples, n * sizeof(double));
+  qsort(sorted, n, sizeof(double), sample_comparator);
+  for (i = 0; i < n; i++)
+  {
+    sum += sorted[i];
+  }
+
+  result->min_s = sorted[0];
+  result->mean_s = sum / n;
+  result->median_s = (n % 2) ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+  /* nearest rank */
+  result->p95_s = sorted[(95 * n + 99) / 100 - 1];
+  result->rows_per_s = (result->median_s > 0) ? (double) result->rows / result->median_s : 0;
+}
+
+/** @brief  print the summary table header
+ *  @param  *fp  output stream
+ *  @return none
+ */
+void
+bench_print_header(FILE *fp)
+{
+  fprintf
+  (
+    fp,
+    "[%6s][%-40s][%10s][%5s][%12s][%12s][%14s][%12s]\n",
+    "INFO",
+    "BENCHMARK",
+    "ROWS",
+    "REPS",
+    "MEDIAN_S",
+    "P95_S",
+    "ROWS/S",
+    "PEAK_KB"
+  );
+}
+
+/** @brief  print one summary table row
+ *  @param  *fp      output stream
+ *  @param  *result  finished benchmark result
+ *  @return none
+ */
+void
+bench_print_result(FILE *fp, const benchResult *result)
+{
+  fprintf
+  (
+    fp,
+    "[%6s][%-40s][%10" PRIu64 "][%5d][%12.6f][%12.6f][%14.0f][%12" PRIu64 "]\n",
+    "INFO",
+    result->name,
+    result->rows,
+    result->reps,
+    result->median_s,
+    result->p95_s,
+    result->rows_per_s,
+    result->peak_kb
+  );
+}
+
+/** @brief  write finished results as csv, one row per benchmark
+ *  @param  *str_file  csv file path
+ *  @param  *results   finished benchmark results
+ *  @param  cnt        number of results
+ *  @return 0
+ *          err_file_not_accessible
+ */
+int
+bench_write_csv(const char *str_file, const benchResult *results, int cnt)
+{
+  FILE *fp_out = NULL;
+  int i = 0;
+
+  if ((NULL == str_file) || (NULL == (fp_out = fopen(str_file, "w"))))
+  {
+    return throw_err(err_file_not_accessible);
+  }
+
+  fprintf(fp_out, "%s\n", BENCH_CSV_HEADER);
+  for (i = 0; i < cnt; i++)
+  {
+    fprintf
+    (
+      fp_out,
+      "%s,%" PRIu64 ",%d,%.9f,%.9f,%.9f,%.9f,%.1f,%" PRIu64 "\n",
+      results[i].name,
+      results[i].rows,
+      results[i].reps,
+      results[i].median_s,
+      results[i].p95_s,
+      results[i].min_s,
+      results[i].mean_s,
+      results[i].rows_per_s,
+      results[i].peak_kb
+    );
+  }
+
+  if (0 != fclose(fp_out))
+  {
+    return throw_err(err_file_not_accessible);
+  }
+  return 0;
+}
+
+/** @brief  read results written by bench_write_csv, samples are not
+ *          stored in the file and are left empty
+ *  @param  *str_file  csv file path
+ *  @param  *results   results output
+ *  @param  max_cnt    capacity of results
+ *  @return number of results read
+ *          err_file_not_accessible
+ *          err_file_format_not_valid
+ *          err_maximum_number_exceeded
+ */
+int
+bench_read_csv(const char *str_file, benchResult *results, int max_cnt)
+{
+  FILE *fp_in = NULL;
+  char str_line[STR_MAX] = "";
+  char str_name[STR_LONG] = "";
+  unsigned long long rows = 0;
+  unsigned long long peak_kb = 0;
+  benchResult *p_result = NULL;
+  int cnt = 0;
+  int err = 0;
+
+  if ((NULL == str_file) || (NULL == (fp_in = fopen(str_file, "r"))))
+  {
+    return throw_err(err_file_not_accessible);
+  }
+
+  while ((0 == err) && (NULL != fgets(str_line, STR_MAX, fp_in)))
+  {
+    str_line[strcspn(str_line, "\r\n")] = '\0';
+    if (('\0' == str_line[0]) || (0 == strncmp(str_line, "NAME,", 5)))
+    {
+      /* header or blank line */
+      continue;
+    }
+    if (cnt >= max_cnt)
+    {
+      err = throw_err(err_maximum_number_exceeded);
+      break;
+    }
+    p_result = &results[cnt];
+    memset(p_result, 0, sizeof(benchResult));
+    if (9 != sscanf
+             (
+               str_line,
+               "%99[^,],%llu,%d,%lf,%lf,%lf,%lf,%lf,%llu",
+               str_name,
+               &rows,
+               &p_result->reps,
+               &p_result->median_s,
+               &p_result->p95_s,
+               &p_result->min_s,
+               &p_result->mean_s,
+               &p_result->rows_per_s,
+               &peak_kb
+             ))
+    {
+      err = throw_err(err_file_format_not_valid);
+      break;
+    }
+    strcpy(p_result->name, str_name);
+    p_result->rows = rows;
+    p_result->peak_kb = peak_kb;
+    cnt++;
+  }
+
+  fclose(fp_in);
+  return (err < 0) ? err : cnt;
+}
+
+/** @brief  find a result by name
+ *  @param  *results  results
+ *  @param  cnt       number of results
+ *  @param  *name     benchmark name
+ *  @return NULL if not found, pointer to the result
+ */
+static const benchResult *
+bench_find(const benchResult *results, int cnt, const char *name)
+{
+  int i = 0;
+
+  for (i = 0; i < cnt; i++)
+  {
+    if (0 == strcmp(results[i].name, name))
+    {
+      return &results[i];
+    }
+  }
+  return NULL;
+}
+
+/** @brief  relative change in percent
+ *  @param  base  baseline value
+ *  @param  cur   current value
+ *  @return percent change, 0 if the baseline is 0
+ */
+static double
+bench_change_pct(double base, double cur)
+{
+  return (base > 0) ? (cur - base) * 100.0 / base : 0;
+}
+
+/** @brief  compare results to a baseline by name and print a per benchmark
+ *          diff. a benchmark regresses when its throughput drops by more
+ *          than tolerance_pct or its peak list memory grows by more than
+ *          mem_tolerance_pct. benchmarks missing on either side are
+ *          reported but do not regress.
+ *  @param  *fp                 output stream
+ *  @param  *baseline           baseline results
+ *  @param  baseline_cnt        number of baseline results
+ *  @param  *results            current results
+ *  @param  cnt                 number of current results
+ *  @param  tolerance_pct       allowed throughput drop, percent
+ *  @param  mem_tolerance_pct   allowed peak list memory growth, percent
+ *  @return number of regressed benchmarks
+ */
+int
+bench_compare(FILE *fp,
+              const benchResult *baseline, int baseline_cnt,
+              const benchResult *results, int cnt,
+              double tolerance_pct, double mem_tolerance_pct)
+{
+  const benchResult *p_base = NULL;
+  const char *str_status = NULL;
+  double rate_pct = 0;
+  double mem_pct = 0;
+  int regressions = 0;
+  int i = 0;
+
+  fprintf
+  (
+    fp,
+    "[%6s][%-40s][%14s][%14s][%9s][%12s][%9s][%8s]\n",
+    "INFO", "BENCHMARK", "BASE_ROWS/S", "ROWS/S", "CHANGE_%", "PEAK_KB", "CHANGE_%", "STATUS"
+  );
+  for (i = 0; i < cnt; i++)
+  {
+    p_base = bench_find(baseline, baseline_cnt, results[i].name);
+    if (NULL == p_base)
+    {
+      fprintf
+      (
+        fp,
+        "[%6s][%-40s][%14s][%14.0f][%9s][%12" PRIu64 "][%9s][%8s]\n",
+        "INFO", results[i].name, "", results[i].rows_per_s, "", results[i].peak_kb, "", "NEW"
+      );
+      continue;
+    }
+    rate_pct = bench_change_pct(p_base->rows_per_s, results[i].rows_per_s);
+    mem_pct = bench_change_pct((double) p_base->peak_kb, (double) results[i].peak_kb);
+    if (rate_pct < -tolerance_pct)
+    {
+      str_status = "SLOWER";
+      regressions++;
+    }
+    else if (mem_pct > mem_tolerance_pct)
+    {
+      str_status = "MEMORY";
+      regressions++;
+    }
+    else
+    {
+      str_status = "OK";
+    }
+    fprintf
+    (
+      fp,
+      "[%6s][%-40s][%14.0f][%14.0f][%+9.1f][%12" PRIu64 "][%+9.1f][%8s]\n",
+      (0 == strcmp(str_status, "OK")) ? "INFO" : "ERROR",
+      results[i].name,
+      p_base->rows_per_s,
+      results[i].rows_per_s,
+      rate_pct,
+      results[i].peak_kb,
+      mem_pct,
+      str_status
+    );
+  }
+  for (i = 0; i < baseline_cnt; i++)
+  {
+    if (NULL == bench_find(results, cnt, baseline[i].name))
+    {
+      fprintf
+      (
+        fp,
+        "[%6s][%-40s][%14.0f][%14s][%9s][%12s][%9s][%8s]\n",
+        "INFO", baseline[i].name, baseline[i].rows_per_s, "", "", "", "", "MISSING"
+      );
+    }
+  }
+
+  return regressions;
+}
+
+/** @brief  load a baseline result file and compare results against it
+ *  @param  *fp                 output stream
+ *  @param  *str_file           baseline csv file path
+ *  @param  *results            current results
+ *  @param  cnt                 number of current results
+ *  @param  tolerance_pct       allowed throughput drop, percent
+ *  @param  mem_tolerance_pct   allowed peak list memory growth, percent
+ *  @return number of regressed benchmarks
+ *          err_file_not_accessible
+ *          err_file_format_not_valid
+ *          err_maximum_number_exceeded
+ */
+int
+bench_check_baseline(FILE *fp, const char *str_file,
+                     const benchResult *results, int cnt,
+                     double tolerance_pct, double mem_tolerance_pct)
+{
+  benchResult *baseline = NULL;
+  int baseline_cnt = 0;
+  int ret = 0;
+
+  baseline = (benchResult *) calloc(BENCH_MAX_RESULTS, sizeof(benchResult));
+  if (NULL == baseline)
+  {
+    return throw_err(err_maximum_number_exceeded);
+  }
+  baseline_cnt = bench_read_csv(str_file, baseline, BENCH_MAX_RESULTS);
+  if (baseline_cnt < 0)
+  {
+    ret = baseline_cnt;
+  }
+  else
+  {
+    fprintf
+    (
+      fp,
+      "[%6s][%s][%s][%s%.1f%%][%s%.1f%%]\n",
+      "INFO",
+      "Baseline Comparison",
+      str_file,
+      "throughput -",
+      tolerance_pct,
+      "memory +",
+      mem_tolerance_pct
+    );
+    ret = bench_compare(fp, baseline, baseline_cnt, results, cnt,
+                        tolerance_pct, mem_tolerance_pct);
+  }
+  free(baseline);
+  return ret;
+}
@@ -0,0 +1,209 @@
+/*------------------------------------------------------
+**
+** File:      bench_util.h
+** Author:    Eric Lu
+** Created:   2026-10-19
+**
+** Copyright ©2012 Toronto Transit Commission
+**
+**
+** Function Description
+** -----------------------------------------------------
+**
+** timing samples, summary statistics and result files shared by the
+** atc_speed_profile_tool benchmarks
+**
+** the benchmarks exit nonzero when a run regresses against a baseline,
+** which is the regression gate used by CI. build and record a baseline
+** once, then rerun against it after each change:
+**
+**   gcc -O2 -I. atc_speed_profile_bench.c atc_speed_profile_tool.c
+**       common_util.c errorhandler.c log.c simclist.c async_writer.c
+**       profiler.c lut_cache.c lut_embed.c block_stats.c bench_util.c
+**       datagen.c -o atc_speed_profile_bench -lpthread -lm
+**   atc_speed_profile_bench --rows 100000 --csv baseline.csv
+**   atc_speed_profile_bench --rows 100000 --baseline baseline.csv
+**
+** atc_speed_profile_microbench is built the same way and takes the same
+** --csv and --baseline options
+**
+** -----------------------------------------------------
+** Revision History
+**
+** 19 OCT 2026: Rev 1.0 - erilu
+**                      - Initial Design
+**
+** Inputs:
+** Elapsed time of each benchmark repetition
+**
+** Outputs:
+** Summary table on the screen, csv result file
+**
+** ----------------------------------------------------
+*/
+
+#ifndef ATC_SPEED_PROFILE_BENCH_UTIL_H
+#define ATC_SPEED_PROFILE_BENCH_UTIL_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "common_util.h"
+
+/*
+** Constants
+** -----------------------------------------------------
+*/
+
+/* maximum number of repetitions kept per benchmark */
+#define BENCH_MAX_SAMPLES         1024
+/* maximum number of benchmarks in one result file */
+#define BENCH_MAX_RESULTS         256
+/* csv result file header */
+#define BENCH_CSV_HEADER          "NAME,ROWS,REPS,MEDIAN_S,P95_S,MIN_S,MEAN_S,ROWS_PER_S,PEAK_KB"
+/* default allowed throughput drop against a baseline, percent */
+#define BENCH_DEFAULT_TOLERANCE   10.0
+/* default allowed peak list memory growth against a baseline, percent */
+#define BENCH_DEFAULT_MEM_TOLERANCE 10.0
+
+/*
+** Structures
+** -----------------------------------------------------
+*/
+
+/* samples and summary of one benchmark */
+typedef struct bench_result_t
+{
+  char name[STR_LONG];
+  /* rows processed by one repetition */
+  uint64_t rows;
+  int reps;
+  double samples[BENCH_MAX_SAMPLES];
+
+  /* summary, valid after bench_result_finish */
+  double median_s;
+  double p95_s;
+  double min_s;
+  double mean_s;
+  double rows_per_s;
+  /* highest list memory held while the benchmark ran, in KiB, 0 if the
+  ** benchmark holds no lists */
+  uint64_t peak_kb;
+} benchResult;
+
+/*
+** Function Prototypes
+** -----------------------------------------------------
+*/
+
+/** @brief  clear a result and name it
+ *  @param  *result  benchmark result
+ *  @param  *name    benchmark name, truncated to STR_LONG
+ *  @param  rows     rows processed by one repetition
+ *  @return none
+ */
+void
+bench_result_init(benchResult *result, const char *name, uint64_t rows);
+
+/** @brief  add the elapsed time of one repetition
+ *  @param  *result     benchmark result
+ *  @param  elapsed_s   elapsed time in seconds
+ *  @return 0
+ *          err_maximum_number_exceeded
+ */
+int
+bench_result_add(benchResult *result, double elapsed_s);
+
+/** @brief  add the list memory high-water mark of one repetition, the
+ *          highest of all repetitions is kept
+ *  @param  *result     benchmark result
+ *  @param  peak_bytes  list memory high-water mark in bytes
+ *  @return none
+ */
+void
+bench_result_add_memory(benchResult *result, uint64_t peak_bytes);
+
+/** @brief  compute median, p95, min, mean and rows per second from the
+ *          samples, rows per second is based on the median
+ *  @param  *result  benchmark result
+ *  @return none
+ */
+void
+bench_result_finish(benchResult *result);
+
+/** @brief  print the summary table header
+ *  @param  *fp  output stream
+ *  @return none
+ */
+void
+bench_print_header(FILE *fp);
+
+/** @brief  print one summary table row
+ *  @param  *fp      output stream
+ *  @param  *result  finished benchmark result
+ *  @return none
+ */
+void
+bench_print_result(FILE *fp, const benchResult *result);
+
+/** @brief  write finished results as csv, one row per benchmark
+ *  @param  *str_file  csv file path
+ *  @param  *results   finished benchmark results
+ *  @param  cnt        number of results
+ *  @return 0
+ *          err_file_not_accessible
+ */
+int
+bench_write_csv(const char *str_file, const benchResult *results, int cnt);
+
+/** @brief  read results written by bench_write_csv, samples are not
+ *          stored in the file and are left empty
+ *  @param  *str_file  csv file path
+ *  @param  *results   results output
+ *  @param  max_cnt    capacity of results
+ *  @return number of results read
+ *          err_file_not_accessible
+ *          err_file_format_not_valid
+ *          err_maximum_number_exceeded
+ */
+int
+bench_read_csv(const char *str_file, benchResult *results, int max_cnt);
+
+/** @brief  compare results to a baseline by name and print a per benchmark
+ *          diff. a benchmark regresses when its throughput drops by more
+ *          than tolerance_pct or its peak list memory grows by more than
+ *          mem_tolerance_pct. benchmarks missing on either side are
+ *          reported but do not regress.
+ *  @param  *fp                 output stream
+ *  @param  *baseline           baseline results
+ *  @param  baseline_cnt        number of baseline results
+ *  @param  *results            current results
+ *  @param  cnt                 number of current results
+ *  @param  tolerance_pct       allowed throughput drop, percent
+ *  @param  mem_tolerance_pct   allowed peak list memory growth, percent
+ *  @return number of regressed benchmarks
+ */
+int
+bench_compare(FILE *fp,
+              const benchResult *baseline, int baseline_cnt,
+              const benchResult *results, int cnt,
+              double tolerance_pct, double mem_tolerance_pct);
+
+/** @brief  load a baseline result file and compare results against it
+ *  @param  *fp                 output stream
+ *  @param  *str_file           baseline csv file path
+ *  @param  *results            current results
+ *  @param  cnt                 number of current results
+ *  @param  tolerance_pct       allowed throughput drop, percent
+ *  @param  mem_tolerance_pct   allowed peak list memory growth, percent
+ *  @return number of regressed benchmarks
+ *          err_file_not_accessible
+ *          err_file_format_not_valid
+ *          err_maximum_number_exceeded
+ */
+int
+bench_check_baseline(FILE *fp, const char *str_file,
+                     const benchResult *results, int cnt,
+                     double tolerance_pct, double mem_tolerance_pct);
+
+#endif
@@ -0,0 +1,381 @@
+/*------------------------------------------------------
+**
+** File:      block_stats.c
+** Author:    Eric Lu
+** Created:   2026-10-19
+**
+** Copyright ©2012 Toronto Transit Commission
+**
+**
+** Function Description
+** -----------------------------------------------------
+**
+** block run time statistics, see block_stats.h
+**
+** -----------------------------------------------------
+** Revision History
+**
+** 19 OCT 2026: Rev 1.0 - erilu
+**                      - Initial Design
+**
+** Inputs:
+**  block run time csv
+**
+** Outputs:
+**  block run time csv
+**
+** ----------------------------------------------------
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <math.h>
+#include "errorhandler.h"
+#include "block_stats.h"
+
+/*
+** Constants
+** -----------------------------------------------------
+*/
+
+/* suffix of the table while it is written */
+#define BLOCK_STATS_TMP_SUFFIX    ".tmp"
+/* columns before the bins */
+#define BLOCK_STATS_FIELD_CNT     8
+
+/*
+** Structures
+** -----------------------------------------------------
+*/
+
+struct block_stats_table_t
+{
+  blockStats *p_entries;
+  size_t cnt;
+  size_t cap;
+};
+
+/*
+** Source Code
+** -----------------------------------------------------
+*/
+
+/** @brief  get the bin of a traversal time
+ *  @param  time_s  traversal time
+ *  @return bin
+ */
+static int
+block_stats_bin(double time_s)
+{
+  int bin = 0;
+
+  if (time_s < 1.0)
+  {
+    return 0;
+  }
+  bin = 1 + (int) floor(3.0 * log2(time_s));
+  return (bin < BLOCK_STATS_BINS) ? bin : BLOCK_STATS_BINS - 1;
+}
+
+/** @brief  get the statistics of a block, direction and hour, added
+ *          empty when missing
+ *  @param  *tbl            table
+ *  @param  *str_block      block
+ *  @param  *str_direction  direction code
+ *  @param  hour            hour of day
+ *  @param  **p_entry       statistics output
+ *  @return 0
+ *          err_list_append_failed  not enough memory
+ */
+static int
+block_stats_get(blockStatsTable *tbl, const char *str_block, const char *str_direction,
+                int hour, blockStats **p_entry)
+{
+  blockStats *p_entries = NULL;
+  size_t lo = 0;
+  size_t hi = tbl->cnt;
+  size_t mid = 0;
+  size_t cap = 0;
+  int cmp = 0;
+
+  while (lo < hi)
+  {
+    mid = lo + (hi - lo) / 2;
+    if ((0 == (cmp = strcmp(tbl->p_entries[mid].str_block, str_block))) &&
+        (0 == (cmp = strcmp(tbl->p_entries[mid].str_direction, str_direction))))
+    {
+      cmp = tbl->p_entries[mid].hour - hour;
+    }
+    if (0 == cmp)
+    {
+      *p_entry = &tbl->p_entries[mid];
+      return 0;
+    }
+    else if (cmp < 0)
+    {
+      lo = mid + 1;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+  if (tbl->cnt == tbl->cap)
+  {
+    cap = (0 == tbl->cap) ? 256 : 2 * tbl->cap;
+    if (NULL == (p_entries = realloc(tbl->p_entries, cap * sizeof(blockStats))))
+    {
+      return throw_err(err_list_append_failed);
+    }
+    tbl->p_entries = p_entries;
+    tbl->cap = cap;
+  }
+  memmove(&tbl->p_entries[lo + 1], &tbl->p_entries[lo], (tbl->cnt - lo) * sizeof(blockStats));
+  tbl->cnt++;
+  *p_entry = &tbl->p_entries[lo];
+  memset(*p_entry, 0, sizeof(blockStats));
+  strncpy((*p_entry)->str_block, str_block, STR_SHORT - 1);
+  strncpy((*p_entry)->str_direction, str_direction, STR_MIN - 1);
+  (*p_entry)->hour = hour;
+  return 0;
+}
+
+/** @brief  create an empty table
+ *  @return NULL  not enough memory
+ *          table, released with block_stats_free
+ */
+blockStatsTable *
+block_stats_create(void)
+{
+  return (blockStatsTable *) calloc(1, sizeof(blockStatsTable));
+}
+
+/** @brief  release a table
+ *  @param  *tbl  table, NULL is ignored
+ *  @return none
+ */
+void
+block_stats_free(blockStatsTable *tbl)
+{
+  if (NULL == tbl)
+  {
+    return;
+  }
+  free(tbl->p_entries);
+  free(tbl);
+}
+
+/** @brief  add one traversal of a block
+ *  @param  *tbl            table
+ *  @param  *str_block      block
+ *  @param  *str_direction  direction code
+ *  @param  hour            hour of day the block was entered, [0, 23]
+ *  @param  time_s          time from entering the block to leaving it
+ *  @param  distance_m      distance travelled in the block
+ *  @return 0
+ *          err_maximum_number_exceeded  hour not valid
+ *          err_list_append_failed       not enough memory
+ */
+int
+block_stats_add(blockStatsTable *tbl, const char *str_block, const char *str_direction,
+                int hour, double time_s, double distance_m)
+{
+  blockStats *p_entry = NULL;
+  int err = 0;
+
+  if ((hour < 0) || (hour >= BLOCK_STATS_HOURS))
+  {
+    return throw_err(err_maximum_number_exceeded);
+  }
+  if ((err = block_stats_get(tbl, str_block, str_direction, hour, &p_entry)) < 0)
+  {
+    return err;
+  }
+  p_entry->traversal_cnt++;
+  p_entry->time_s += time_s;
+  p_entry->distance_m += distance_m;
+  p_entry->bins[block_stats_bin(time_s)]++;
+  return 0;
+}
+
+/** @brief  get the statistics of a table in block, direction, hour order
+ *  @param  *tbl  table
+ *  @param  *cnt  number of statistics output
+ *  @return first statistics, valid until the table is changed
+ */
+const blockStats *
+block_stats_entries(const blockStatsTable *tbl, size_t *cnt)
+{
+  *cnt = tbl->cnt;
+  return tbl->p_entries;
+}
+
+/** @brief  add the statistics of a saved table, a missing file adds none
+ *  @param  *tbl         table
+ *  @param  *str_file    saved table
+ *  @return 0
+ *          err_file_format_not_valid
+ *          err_list_append_failed     not enough memory
+ */
+int
+block_stats_read(blockStatsTable *tbl, const char *str_file)
+{
+  char str_line[STR_EXTRA] = "";
+  char *p_fields[BLOCK_STATS_FIELD_CNT + 1];
+  char *p_tok = NULL;
+  char *p_end = NULL;
+  blockStats *p_entry = NULL;
+  blockStats stats;
+  FILE *fp = NULL;
+  int field_cnt = 0;
+  int err = 0;
+  int i = 0;
+
+  if (NULL == (fp = fopen(str_file, "r")))
+  {
+    /* first run, nothing saved yet */
+    return 0;
+  }
+  /* header */
+  if (NULL == fgets(str_line, STR_EXTRA, fp))
+  {
+    fclose(fp);
+    return 0;
+  }
+  while ((err >= 0) && (NULL != fgets(str_line, STR_EXTRA, fp)))
+  {
+    str_line[strcspn(str_line, "\r\n")] = '\0';
+    if ('\0' == str_line[0])
+    {
+      continue;
+    }
+    field_cnt = 0;
+    p_tok = cstrtok(str_line, ',');
+    while ((NULL != p_tok) && (field_cnt <= BLOCK_STATS_FIELD_CNT))
+    {
+      p_fields[field_cnt++] = p_tok;
+      p_tok = cstrtok(NULL, ',');
+    }
+    if (BLOCK_STATS_FIELD_CNT + 1 != field_cnt)
+    {
+      err = throw_err(err_file_format_not_valid);
+      break;
+    }
+    memset(&stats, 0, sizeof(blockStats));
+    stats.hour = (int) strtol(p_fields[2], &p_end, 10);
+    stats.traversal_cnt = strtoull(p_fields[3], NULL, 10);
+    stats.time_s = strtod(p_fields[4], NULL);
+    stats.distance_m = strtod(p_fields[5], NULL);
+    /* bins, separated by spaces */
+    p_tok = p_fields[BLOCK_STATS_FIELD_CNT];
+    for (i = 0; i < BLOCK_STATS_BINS; i++)
+    {
+      stats.bins[i] = (uint32_t) strtoul(p_tok, &p_end, 10);
+      if (p_end == p_tok)
+      {
+        break;
+      }
+      p_tok = p_end;
+    }
+    if ((i < BLOCK_STATS_BINS) || (stats.hour < 0) || (stats.hour >= BLOCK_STATS_HOURS))
+    {
+      err = throw_err(err_file_format_not_valid);
+      break;
+    }
+    if ((err = block_stats_get(tbl, p_fields[0], p_fields[1], stats.hour, &p_entry)) < 0)
+    {
+      break;
+    }
+    p_entry->traversal_cnt += stats.traversal_cnt;
+    p_entry->time_s += stats.time_s;
+    p_entry->distance_m += stats.distance_m;
+    for (i = 0; i < BLOCK_STATS_BINS; i++)
+    {
+      p_entry->bins[i] += stats.bins[i];
+    }
+  }
+  fclose(fp);
+  return err;
+}
+
+/** @brief  save a table, the file is replaced once completely written
+ *  @param  *tbl         table
+ *  @param  *str_file    file
+ *  @return 0
+ *          err_insufficient_buffer_size
+ *          err_file_not_accessible
+ */
+int
+block_stats_write(const blockStatsTable *tbl, const char *str_file)
+{
+  char str_tmp_file[STR_MAX] = "";
+  const blockStats *p_entry = NULL;
+  FILE *fp = NULL;
+  size_t i = 0;
+  int j = 0;
+  bool b_ok = true;
+
+  if ((size_t) snprintf(str_tmp_file, STR_MAX, "%s%s",
+                        str_file, BLOCK_STATS_TMP_SUFFIX) >= STR_MAX)
+  {
+    return throw_err(err_insufficient_buffer_size);
+  }
+  if (NULL == (fp = fopen(str_tmp_file, "w")))
+  {
+    return throw_err(err_file_not_accessible);
+  }
+  b_ok = (0 < fprintf
+  (
+    fp,
+    "%s,%s,%s,%s,%s,%s,%s,%s,%s\n",
+    "block",
+    "direction",
+    "hour",
+    "traversal_cnt",
+    "time_s",
+    "distance_m",
+    "mean_time_s",
+    "mean_speed_km_h",
+    "bins"
+  ));
+  for (i = 0; (i < tbl->cnt) && b_ok; i++)
+  {
+    p_entry = &tbl->p_entries[i];
+    b_ok = (0 < fprintf
+    (
+      fp,
+      "%s,%s,%02d,%" PRIu64 ",%f,%f,%f,%f,",
+      p_entry->str_block,
+      p_entry->str_direction,
+      p_entry->hour,
+      p_entry->traversal_cnt,
+      p_entry->time_s,
+      p_entry->distance_m,
+      (p_entry->traversal_cnt > 0) ? p_entry->time_s / (double) p_entry->traversal_cnt : 0,
+      (p_entry->time_s > 0) ? 3.6 * p_entry->distance_m / p_entry->time_s : 0
+    ));
+    for (j = 0; (j < BLOCK_STATS_BINS) && b_ok; j++)
+    {
+      b_ok = (0 < fprintf(fp, "%s%" PRIu32, (0 == j) ? "" : " ", p_entry->bins[j]));
+    }
+    b_ok = b_ok && (EOF != fputc('\n', fp));
+  }
+  if ((0 != fclose(fp)) || !b_ok)
+  {
+    remove(str_tmp_file);
+    return throw_err(err_file_not_accessible);
+  }
+#ifdef _WIN32
+  /* rename does not replace an existing file */
+  remove(str_file);
+#endif
+  if (0 != rename(str_tmp_file, str_file))
+  {
+    remove(str_tmp_file);
+    return throw_err(err_file_not_accessible);
+  }
+  return 0;
+}
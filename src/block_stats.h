@@ -0,0 +1,136 @@
+/*------------------------------------------------------
+**
+** File:      block_stats.h
+** Author:    Eric Lu
+** Created:   2026-10-19
+**
+** Copyright ©2012 Toronto Transit Commission
+**
+**
+** Function Description
+** -----------------------------------------------------
+**
+** run time of the trains through each block, per direction and hour of
+** day. each (block, direction, hour) keeps its traversal count, total
+** time and distance, and a histogram of the traversal times in fixed
+** third-octave bins, so the table size depends on the blocks only and
+** not on the days added. the table is kept in a csv that each run reads,
+** adds its own traversals to, and writes back:
+**
+**   block,direction,hour,traversal_cnt,time_s,distance_m,...,bins
+**
+** -----------------------------------------------------
+** Revision History
+**
+** 19 OCT 2026: Rev 1.0 - erilu
+**                      - Initial Design
+**
+** Inputs:
+**  block run time csv
+**
+** Outputs:
+**  block run time csv
+**
+** ----------------------------------------------------
+*/
+
+#ifndef ATC_SPEED_PROFILE_BLOCK_STATS_H
+#define ATC_SPEED_PROFILE_BLOCK_STATS_H
+
+#include <stdint.h>
+#include "common_util.h"
+
+/*
+** Constants
+** -----------------------------------------------------
+*/
+
+/* traversal time bins: below 1 s, third-octave bins up to
+** 2^((BLOCK_STATS_BINS - 2) / 3) s, and above */
+#define BLOCK_STATS_BINS          32
+/* hours of a day */
+#define BLOCK_STATS_HOURS         24
+
+/*
+** Structures
+** -----------------------------------------------------
+*/
+
+/* run times through one block in one direction and hour of day */
+typedef struct block_stats_t
+{
+  char str_block[STR_SHORT];
+  char str_direction[STR_MIN];
+  int hour;
+  uint64_t traversal_cnt;
+  double time_s;
+  double distance_m;
+  uint32_t bins[BLOCK_STATS_BINS];
+} blockStats;
+
+/* block run times sorted by block, direction and hour, opaque */
+typedef struct block_stats_table_t blockStatsTable;
+
+/*
+** Function Prototypes
+** -----------------------------------------------------
+*/
+
+/** @brief  create an empty table
+ *  @return NULL  not enough memory
+ *          table, released with block_stats_free
+ */
+blockStatsTable *
+block_stats_create(void);
+
+/** @brief  release a table
+ *  @param  *tbl  table, NULL is ignored
+ *  @return none
+ */
+void
+block_stats_free(blockStatsTable *tbl);
+
+/** @brief  add one traversal of a block
+ *  @param  *tbl            table
+ *  @param  *str_block      block
+ *  @param  *str_direction  direction code
+ *  @param  hour            hour of day the block was entered, [0, 23]
+ *  @param  time_s          time from entering the block to leaving it
+ *  @param  distance_m      distance travelled in the block
+ *  @return 0
+ *          err_maximum_number_exceeded  hour not valid
+ *          err_list_append_failed       not enough memory
+ */
+int
+block_stats_add(blockStatsTable *tbl, const char *str_block, const char *str_direction,
+                int hour, double time_s, double distance_m);
+
+/** @brief  get the statistics of a table in block, direction, hour order
+ *  @param  *tbl  table
+ *  @param  *cnt  number of statistics output
+ *  @return first statistics, valid until the table is changed
+ */
+const blockStats *
+block_stats_entries(const blockStatsTable *tbl, size_t *cnt);
+
+/** @brief  add the statistics of a saved table, a missing file adds none
+ *  @param  *tbl         table
+ *  @param  *str_file    saved table
+ *  @return 0
+ *          err_file_format_not_valid
+ *          err_list_append_failed     not enough memory
+ */
+int
+block_stats_read(blockStatsTable *tbl, const char *str_file);
+
+/** @brief  save a table, the file is replaced once completely written
+ *  @param  *tbl         table
+ *  @param  *str_file    file
+ *  @return 0
+ *          err_insufficient_buffer_size
+ *          err_file_not_accessible
+ */
+int
+block_stats_write(const blockStatsTable *tbl, const char *str_file);
+
+#endif
@@ -30,6 +30,8 @@
 
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
 #include <ctype.h>
 #include "common_util.h"
 #include "errorhandler.h"
@@ -38,10 +40,11 @@
 ** Source Code
 ** -----------------------------------------------------
 */
-static char str_temp[STR_MAX] = "";
-static char *p_tok;
-static char *p_ret;
-static int n_tok = 1;
+/* strip_path result and cstrtok position, one per thread */
+static THREAD_LOCAL char str_temp[STR_MAX] = "";
+static THREAD_LOCAL char *p_tok;
+static THREAD_LOCAL char *p_ret;
+static THREAD_LOCAL int n_tok = 1;
 /* 
 ** Supporting Functions (If any)
 */
@@ -111,14 +114,14 @@ integrate_trapezoidal(double x0, double y0, double x1, double y1)
 
 /** @brief  strip file path and return only file name
  *  @param  *str_path full path and filename string
- *  @return filename string
+ *  @return filename string, valid until the next call on the same thread
  */
 char *
 strip_path(char *str_path)
 {
   
-  char *token = NULL;
-  char *token_prev = NULL;
+  char *start = NULL;
+  char *end = NULL;
 
   if (NULL == str_path)
   {
@@ -130,13 +133,22 @@ strip_path(char *str_path)
     return NULL;
   }
   strcpy(str_temp, str_path);
-  token = strtok(str_temp, PATH_DELIM);
-  while (NULL != token)
+  /* last non empty path element, found without strtok state */
+  end = str_temp + strlen(str_temp);
+  while ((end > str_temp) && (NULL != strchr(PATH_DELIM, end[-1])))
   {
-    token_prev = token;
-    token = strtok(NULL, PATH_DELIM);
+    *(--end) = '\0';
   }
-  return token_prev;
+  if (end == str_temp)
+  {
+    return NULL;
+  }
+  start = end;
+  while ((start > str_temp) && (NULL == strchr(PATH_DELIM, start[-1])))
+  {
+    start--;
+  }
+  return start;
 
 }
 
@@ -202,7 +214,7 @@ copy_file(char *target, char *source){
 }
 
 /** @brief  alternative version to strtok, where consecutive delimiters return
- *          "", instead of NULL
+ *          "", instead of NULL. the position is kept per thread
  *  @param  *str string to tokenize
  *  @param  *delim delimiters
  *  @return  pointer to token
@@ -245,4 +257,162 @@ cstrtok(char *str, char delim)
     n_tok--;
     return p_ret;
   }
-}
\ No newline at end of file
+}
+
+/** @brief  append formatted text to the end of a growable buffer, the buffer
+ *          is enlarged as required
+ *  @param  *buf buffer to append to, zero initialized before first use
+ *  @param  *fmt printf style format string
+ *  @return  0 on success
+ *           err_insufficient_buffer_size
+ */
+int 
+str_buffer_printf(strBuffer *buf, const char *fmt, ...)
+{
+  va_list args;
+  int n = 0;
+  size_t cap = 0;
+  char *p_data = NULL;
+
+  if ((NULL == buf) || (NULL == fmt))
+  {
+    return throw_err(err_null_string);
+  }
+  /* try to format into the remaining space first */
+  va_start(args, fmt);
+  n = vsnprintf(buf->data + buf->len, 
+                (buf->cap > buf->len) ? (buf->cap - buf->len) : 0, 
+                fmt, 
+                args);
+  va_end(args);
+  if (n < 0)
+  {
+    return throw_err(err_insufficient_buffer_size);
+  }
+  if (buf->len + n + 1 > buf->cap)
+  {
+    /* grow geometrically, so appending is amortized linear */
+    cap = (buf->cap > 0) ? buf->cap : STR_EXTRA;
+    while (cap < buf->len + n + 1)
+    {
+      cap *= 2;
+    }
+    p_data = (char *) realloc(buf->data, cap);
+    if (NULL == p_data)
+    {
+      return throw_err(err_insufficient_buffer_size);
+    }
+    buf->data = p_data;
+    buf->cap = cap;
+    va_start(args, fmt);
+    vsnprintf(buf->data + buf->len, buf->cap - buf->len, fmt, args);
+    va_end(args);
+  }
+  buf->len += n;
+  return 0;
+}
+
+/** @brief  release the memory held by a growable buffer and reset it
+ *  @param  *buf buffer to release
+ *  @return none
+ */
+void 
+str_buffer_free(strBuffer *buf)
+{
+  if (NULL == buf)
+  {
+    return;
+  }
+  free(buf->data);
+  buf->data = NULL;
+  buf->len = 0;
+  buf->cap = 0;
+}
+
+
+/** @brief  start writing at the beginning of a caller supplied buffer
+ *  @param  *cur   cursor to initialize
+ *  @param  *buf   destination buffer, may be NULL when size is 0
+ *  @param  size   destination buffer size in bytes
+ *  @return none
+ */
+void 
+str_cursor_init(strCursor *cur, char *buf, size_t size)
+{
+  cur->buf = buf;
+  cur->size = (NULL == buf) ? 0 : size;
+  cur->len = 0;
+  if (cur->size > 0)
+  {
+    cur->buf[0] = '\0';
+  }
+}
+
+/** @brief  append a string at the cursor, truncated to the buffer size
+ *  @param  *cur   cursor to write to
+ *  @param  *str   string to append, NULL is treated as ""
+ *  @return none
+ */
+void 
+str_cursor_puts(strCursor *cur, const char *str)
+{
+  size_t n = 0;
+  size_t room = 0;
+
+  if (NULL == str)
+  {
+    return;
+  }
+  n = strlen(str);
+  if (cur->len + 1 < cur->size)
+  {
+    /* copy what fits, keep room for the null terminator */
+    room = cur->size - cur->len - 1;
+    memcpy(cur->buf + cur->len, str, (n < room) ? n : room);
+    cur->buf[cur->len + ((n < room) ? n : room)] = '\0';
+  }
+  cur->len += n;
+}
+
+/** @brief  append a single character at the cursor
+ *  @param  *cur   cursor to write to
+ *  @param  c      character to append
+ *  @return none
+ */
+void 
+str_cursor_putc(strCursor *cur, char c)
+{
+  if (cur->len + 1 < cur->size)
+  {
+    cur->buf[cur->len] = c;
+    cur->buf[cur->len + 1] = '\0';
+  }
+  cur->len++;
+}
+
+/** @brief  append formatted text at the cursor, truncated to the buffer size
+ *  @param  *cur   cursor to write to
+ *  @param  *fmt   printf style format string
+ *  @return none
+ */
+void 
+str_cursor_printf(strCursor *cur, const char *fmt, ...)
+{
+  va_list args;
+  int n = 0;
+
+  va_start(args, fmt);
+  if (cur->len < cur->size)
+  {
+    n = vsnprintf(cur->buf + cur->len, cur->size - cur->len, fmt, args);
+  }
+  else
+  {
+    n = vsnprintf(NULL, 0, fmt, args);
+  }
+  va_end(args);
+  if (n > 0)
+  {
+    cur->len += n;
+  }
+}
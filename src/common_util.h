@@ -32,6 +32,7 @@
 #define ATC_SPEED_PROFILE_COMMON_H
 
 #include <stdio.h>
+#include <stddef.h>
 #include "errorhandler.h"
 
 /*
@@ -60,6 +61,23 @@ typedef enum stringLength{
 ** -----------------------------------------------------
 */
 
+/* growable character buffer, data is always null terminated */
+typedef struct str_buffer_t
+{
+  char *data;
+  size_t len;
+  size_t cap;
+} strBuffer;
+
+/* write cursor over a caller supplied character buffer, len keeps counting
+   past the end of the buffer so the required size can be reported */
+typedef struct str_cursor_t
+{
+  char *buf;
+  size_t size;
+  size_t len;
+} strCursor;
+
 
 /*
 ** Function Prototypes
@@ -96,7 +114,7 @@ integrate_trapezoidal(double x0, double y0, double x1, double y1);
 
 /** @brief  strip file path and return only file name
  *  @param  *str_path full path and filename string
- *  @return filename string
+ *  @return filename string, valid until the next call on the same thread
  */
 char *
 strip_path(char *str_path);
@@ -118,7 +136,7 @@ errorCode
 copy_file(char *target, char *source);
 
 /** @brief  alternative version to strtok, where consecutive delimiters return
- *          "", instead of NULL
+ *          "", instead of NULL. the position is kept per thread
  *  @param  *str string to tokenize
  *  @param  *delim delimiters
  *  @return  pointer to token
@@ -127,4 +145,54 @@ copy_file(char *target, char *source);
 char * 
 cstrtok(char *str, char delim);
 
+/** @brief  append formatted text to the end of a growable buffer, the buffer
+ *          is enlarged as required
+ *  @param  *buf buffer to append to, zero initialized before first use
+ *  @param  *fmt printf style format string
+ *  @return  0 on success
+ *           err_insufficient_buffer_size
+ */
+int 
+str_buffer_printf(strBuffer *buf, const char *fmt, ...);
+
+/** @brief  release the memory held by a growable buffer and reset it
+ *  @param  *buf buffer to release
+ *  @return none
+ */
+void 
+str_buffer_free(strBuffer *buf);
+
+/** @brief  start writing at the beginning of a caller supplied buffer
+ *  @param  *cur   cursor to initialize
+ *  @param  *buf   destination buffer, may be NULL when size is 0
+ *  @param  size   destination buffer size in bytes
+ *  @return none
+ */
+void 
+str_cursor_init(strCursor *cur, char *buf, size_t size);
+
+/** @brief  append a string at the cursor, truncated to the buffer size
+ *  @param  *cur   cursor to write to
+ *  @param  *str   string to append, NULL is treated as ""
+ *  @return none
+ */
+void 
+str_cursor_puts(strCursor *cur, const char *str);
+
+/** @brief  append a single character at the cursor
+ *  @param  *cur   cursor to write to
+ *  @param  c      character to append
+ *  @return none
+ */
+void 
+str_cursor_putc(strCursor *cur, char c);
+
+/** @brief  append formatted text at the cursor, truncated to the buffer size
+ *  @param  *cur   cursor to write to
+ *  @param  *fmt   printf style format string
+ *  @return none
+ */
+void 
+str_cursor_printf(strCursor *cur, const char *fmt, ...);
+
 #endif
\ No newline at end of file
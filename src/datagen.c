@@ -0,0 +1,710 @@
+/*------------------------------------------------------
+**
+** File:      datagen.c
+** Author:    Eric Lu
+** Created:   2026-10-19
+**
+** Copyright ©2012 Toronto Transit Commission
+**
+**
+** Function Description
+** -----------------------------------------------------
+**
+** deterministic synthetic network and train data generator for scale
+** testing atc_speed_profile_tool without production data. a line of N
+** stations is laid out in both directions, trains shuttle between the
+** terminals with accelerate, cruise, brake and dwell phases, and every
+** train is sampled at a fixed period.
+**
+** -----------------------------------------------------
+** Revision History
+**
+** 19 OCT 2026: Rev 1.0 - erilu
+**                      - Initial Design
+**
+** Inputs:
+** Generator configuration, seed
+**
+** Outputs:
+** Block lookup table csv, one train data csv per day
+**
+** ----------------------------------------------------
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "errorhandler.h"
+#include "common_util.h"
+#include "datagen.h"
+
+/*
+** Constants
+** -----------------------------------------------------
+*/
+
+/* number of directions, 0 - R northbound, 1 - L southbound */
+#define DATAGEN_DIR_CNT           2
+/* first block number, directions alternate odd and even */
+#define DATAGEN_FIRST_BLOCK       10
+#define DATAGEN_PLATFORM_LENGTH   150.0
+#define DATAGEN_BETWEEN_LENGTH_LO 250.0
+#define DATAGEN_BETWEEN_LENGTH_HI 700.0
+/* trains stop this far before the end of the platform block */
+#define DATAGEN_STOP_MARGIN       10.0
+/* seconds per simulation step */
+#define DATAGEN_STEP_S            1
+/* missing samples of one data gap */
+#define DATAGEN_GAP_LO            5
+#define DATAGEN_GAP_HI            20
+/* file write buffer */
+#define DATAGEN_FILE_BUFFER       (1 << 20)
+
+/* lookup table values per direction */
+static const char *k_dir_names[DATAGEN_DIR_CNT] = {"R", "L"};
+static const char *k_dir_codes[DATAGEN_DIR_CNT] = {"N", "S"};
+static const char *k_dir_platforms[DATAGEN_DIR_CNT] = {"N", "S"};
+
+/*
+** Structures
+** -----------------------------------------------------
+*/
+
+/* one block in travel order of a direction */
+typedef struct gen_block_t
+{
+  int number;
+  double start;
+  double length;
+  /* station the block belongs to, platform or departing from */
+  int station;
+  bool is_platform;
+} genBlock;
+
+struct data_gen_network_t
+{
+  dataGenConfig cfg;
+  /* blocks of each direction in travel order */
+  genBlock *blocks[DATAGEN_DIR_CNT];
+  int block_cnt;
+  /* stop position of the n-th station in travel order */
+  double *stop_pos[DATAGEN_DIR_CNT];
+  /* block index of the n-th station platform in travel order */
+  int *platform_block[DATAGEN_DIR_CNT];
+  /* estimated time of one round trip in seconds */
+  double cycle_s;
+};
+
+/* simulated train */
+typedef struct gen_train_t
+{
+  int cc_id;
+  int dir;
+  time_t start;
+  bool b_running;
+  /* last station served and next station to stop, travel order */
+  int station;
+  int target;
+  bool b_skip;
+  double pos;
+  double speed;
+  int block;
+  double dwell_left;
+  double dwell_elapsed;
+  int gap_left;
+} genTrain;
+
+/*
+** Source Code
+** -----------------------------------------------------
+*/
+
+/** @brief  splitmix64 step, identical sequence on every platform
+ *  @param  *state  generator state
+ *  @return next 64 bit value
+ */
+static uint64_t
+rng_next(uint64_t *state)
+{
+  uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+/** @brief  uniform value in [0, 1)
+ *  @param  *state  generator state
+ *  @return random value
+ */
+static double
+rng_uniform(uint64_t *state)
+{
+  return (double) (rng_next(state) >> 11) / (double) (1ULL << 53);
+}
+
+/** @brief  station code and name, codes run SAA, SAB, ... SZZ
+ *  @param  station  station index
+ *  @param  *code    station code output, STR_MIN
+ *  @param  *name    station name output, STR_SHORT, may be NULL
+ *  @return none
+ */
+static void
+station_code(int station, char *code, char *name)
+{
+  snprintf(code, STR_MIN, "S%c%c", 'A' + (station / 26) % 26, 'A' + station % 26);
+  if (NULL != name)
+  {
+    snprintf(name, STR_SHORT, "Station %c%c", 'A' + (station / 26) % 26, 'A' + station % 26);
+  }
+}
+
+/** @brief  fill a configuration with the defaults, a 20 station line,
+ *          20 trains, 18 service hours, 3 second samples, no faults
+ *  @param  *cfg  configuration
+ *  @return none
+ */
+void
+datagen_config_init(dataGenConfig *cfg)
+{
+  struct tm tm_start = {0};
+
+  memset(cfg, 0, sizeof(dataGenConfig));
+  cfg->seed = 20190329;
+  cfg->station_cnt = 20;
+  cfg->between_cnt = 1;
+  cfg->train_cnt = 20;
+  cfg->hours = 18;
+  cfg->day_cnt = 1;
+  /* 2019/03/29 05:30:00 */
+  tm_start.tm_year = 2019 - 1900;
+  tm_start.tm_mon = 2;
+  tm_start.tm_mday = 29;
+  tm_start.tm_hour = 5;
+  tm_start.tm_min = 30;
+  tm_start.tm_isdst = -1;
+  cfg->start_time = mktime(&tm_start);
+  cfg->sample_period_s = 3;
+  cfg->dwell_s = 30;
+  cfg->max_speed_km_h = 70;
+  cfg->accel_m_s2 = 1.0;
+  cfg->decel_m_s2 = 1.1;
+}
+
+/** @brief  lay out stations and blocks for both directions
+ *  @param  *cfg  configuration
+ *  @return NULL  configuration out of range or out of memory
+ *          pointer to the new network
+ */
+dataGenNetwork *
+datagen_network_create(const dataGenConfig *cfg)
+{
+  dataGenNetwork *net = NULL;
+  double *between_len = NULL;
+  uint64_t rng = 0;
+  genBlock *p_block = NULL;
+  double pos = 0;
+  double run_s = 0;
+  double v_max = 0;
+  int segment_cnt = 0;
+  int dir = 0;
+  int n = 0;
+  int station = 0;
+  int segment = 0;
+  int i = 0;
+  int b = 0;
+
+  if ((NULL == cfg) ||
+      (cfg->station_cnt < 2) || (cfg->station_cnt > DATAGEN_MAX_STATION_CNT) ||
+      (cfg->between_cnt < 1) || (cfg->between_cnt > DATAGEN_MAX_BETWEEN_CNT) ||
+      (cfg->train_cnt < 1) || (cfg->train_cnt > DATAGEN_MAX_TRAIN_CNT) ||
+      (cfg->hours <= 0) || (cfg->hours > 24) || (cfg->day_cnt < 1) ||
+      (cfg->sample_period_s < 1) || (cfg->dwell_s < 0) ||
+      (cfg->max_speed_km_h <= 0) || (cfg->accel_m_s2 <= 0) || (cfg->decel_m_s2 <= 0))
+  {
+    return NULL;
+  }
+
+  net = (dataGenNetwork *) calloc(1, sizeof(dataGenNetwork));
+  segment_cnt = (cfg->station_cnt - 1) * cfg->between_cnt;
+  between_len = (double *) calloc(segment_cnt, sizeof(double));
+  if ((NULL == net) || (NULL == between_len))
+  {
+    free(net);
+    free(between_len);
+    return NULL;
+  }
+  net->cfg = *cfg;
+  net->block_cnt = cfg->station_cnt + segment_cnt;
+
+  /* both directions share the physical block lengths */
+  rng = cfg->seed;
+  for (i = 0; i < segment_cnt; i++)
+  {
+    between_len[i] = DATAGEN_BETWEEN_LENGTH_LO +
+                     floor((DATAGEN_BETWEEN_LENGTH_HI - DATAGEN_BETWEEN_LENGTH_LO) * rng_uniform(&rng));
+  }
+
+  for (dir = 0; dir < DATAGEN_DIR_CNT; dir++)
+  {
+    net->blocks[dir] = (genBlock *) calloc(net->block_cnt, sizeof(genBlock));
+    net->stop_pos[dir] = (double *) calloc(cfg->station_cnt, sizeof(double));
+    net->platform_block[dir] = (int *) calloc(cfg->station_cnt, sizeof(int));
+    if ((NULL == net->blocks[dir]) || (NULL == net->stop_pos[dir]) ||
+        (NULL == net->platform_block[dir]))
+    {
+      free(between_len);
+      datagen_network_free(net);
+      return NULL;
+    }
+
+    pos = 0;
+    i = 0;
+    for (n = 0; n < cfg->station_cnt; n++)
+    {
+      station = (0 == dir) ? n : cfg->station_cnt - 1 - n;
+      p_block = &net->blocks[dir][i];
+      p_block->number = DATAGEN_FIRST_BLOCK + dir + 2 * i;
+      p_block->start = pos;
+      p_block->length = DATAGEN_PLATFORM_LENGTH;
+      p_block->station = station;
+      p_block->is_platform = true;
+      net->platform_block[dir][n] = i;
+      net->stop_pos[dir][n] = pos + DATAGEN_PLATFORM_LENGTH - DATAGEN_STOP_MARGIN;
+      pos += p_block->length;
+      i++;
+
+      if (n == cfg->station_cnt - 1)
+      {
+        break;
+      }
+      /* physical segment between this station and the next one */
+      segment = (0 == dir) ? n : cfg->station_cnt - 2 - n;
+      for (b = 0; b < cfg->between_cnt; b++)
+      {
+        p_block = &net->blocks[dir][i];
+        p_block->number = DATAGEN_FIRST_BLOCK + dir + 2 * i;
+        p_block->start = pos;
+        p_block->length = between_len[segment * cfg->between_cnt +
+                                      ((0 == dir) ? b : cfg->between_cnt - 1 - b)];
+        p_block->station = station;
+        p_block->is_platform = false;
+        pos += p_block->length;
+        i++;
+      }
+    }
+  }
+
+  /* round trip estimate used to space the trains evenly */
+  v_max = cfg->max_speed_km_h / 3.6;
+  run_s = (net->stop_pos[0][cfg->station_cnt - 1] - net->stop_pos[0][0]) / v_max +
+          (cfg->station_cnt - 1) * (v_max / cfg->accel_m_s2 / 2 + v_max / cfg->decel_m_s2 / 2);
+  net->cycle_s = 2 * (run_s + (cfg->station_cnt - 2) * cfg->dwell_s + 4 * cfg->dwell_s);
+
+  free(between_len);
+  return net;
+}
+
+/** @brief  release a network
+ *  @param  *net  network created by datagen_network_create
+ *  @return none
+ */
+void
+datagen_network_free(dataGenNetwork *net)
+{
+  int dir = 0;
+
+  if (NULL == net)
+  {
+    return;
+  }
+  for (dir = 0; dir < DATAGEN_DIR_CNT; dir++)
+  {
+    free(net->blocks[dir]);
+    free(net->stop_pos[dir]);
+    free(net->platform_block[dir]);
+  }
+  free(net);
+}
+
+/** @brief  write the block lookup table of the network
+ *  @param  *net       network
+ *  @param  *str_file  lookup table file path
+ *  @return 0
+ *          err_file_not_accessible
+ */
+int
+datagen_write_lut(const dataGenNetwork *net, const char *str_file)
+{
+  FILE *fp_out = NULL;
+  const genBlock *p_block = NULL;
+  char str_code[STR_MIN] = "";
+  char str_name[STR_SHORT] = "";
+  char str_from[STR_SHORT] = "";
+  char str_to[STR_SHORT] = "";
+  char str_to_code[STR_MIN] = "";
+  int next = 0;
+  int id = 1;
+  int dir = 0;
+  int i = 0;
+
+  if ((NULL == net) || (NULL == str_file) || (NULL == (fp_out = fopen(str_file, "w"))))
+  {
+    return throw_err(err_file_not_accessible);
+  }
+
+  fprintf(fp_out, "%s\n", DATAGEN_LUT_HEADER);
+  for (dir = 0; dir < DATAGEN_DIR_CNT; dir++)
+  {
+    for (i = 0; i < net->block_cnt; i++)
+    {
+      p_block = &net->blocks[dir][i];
+      station_code(p_block->station, str_code, str_name);
+      strcpy(str_from, str_name);
+      /* next station in travel order, terminals point to themselves */
+      next = p_block->station + ((0 == dir) ? 1 : -1);
+      if ((next < 0) || (next >= net->cfg.station_cnt))
+      {
+        next = p_block->station;
+      }
+      station_code(next, str_to_code, str_to);
+      fprintf
+      (
+        fp_out,
+        "%d,%s,IVB_%d,%s,%s,%d,%s,%s,%.1f,%s,%s\n",
+        id++,
+        (p_block->is_platform) ? str_name : "Between",
+        p_block->number,
+        k_dir_names[dir],
+        k_dir_codes[dir],
+        dir + 1,
+        (p_block->is_platform) ? k_dir_platforms[dir] : "",
+        str_code,
+        p_block->length,
+        str_from,
+        str_to
+      );
+    }
+  }
+
+  if (0 != fclose(fp_out))
+  {
+    return throw_err(err_file_not_accessible);
+  }
+  return 0;
+}
+
+/** @brief  pick the next station to stop at, intermediate stations may be
+ *          skipped, terminals never are
+ *  @param  *net    network
+ *  @param  *train  train departing its current station
+ *  @param  *rng    generator state
+ *  @return none
+ */
+static void
+train_depart(const dataGenNetwork *net, genTrain *train, uint64_t *rng)
+{
+  int last = net->cfg.station_cnt - 1;
+
+  if (train->station == last)
+  {
+    /* turn back at the terminal */
+    train->dir = 1 - train->dir;
+    train->station = 0;
+    train->pos = net->stop_pos[train->dir][0];
+    train->block = net->platform_block[train->dir][0];
+  }
+  train->target = train->station + 1;
+  while ((train->target < last) && (rng_uniform(rng) < net->cfg.skip_stop_rate))
+  {
+    train->target++;
+  }
+  train->b_skip = (train->target > train->station + 1);
+  train->dwell_left = 0;
+}
+
+/** @brief  advance a running or dwelling train by one simulation step
+ *  @param  *net    network
+ *  @param  *train  train
+ *  @param  *rng    generator state
+ *  @return none
+ */
+static void
+train_step(const dataGenNetwork *net, genTrain *train, uint64_t *rng)
+{
+  const dataGenConfig *cfg = &net->cfg;
+  double v_max = cfg->max_speed_km_h / 3.6;
+  double remaining = 0;
+  double brake_dist = 0;
+  double speed = 0;
+
+  if (train->dwell_left > 0)
+  {
+    train->dwell_left -= DATAGEN_STEP_S;
+    train->dwell_elapsed += DATAGEN_STEP_S;
+    if (train->dwell_left <= 0)
+    {
+      train_depart(net, train, rng);
+    }
+    return;
+  }
+
+  remaining = net->stop_pos[train->dir][train->target] - train->pos;
+  brake_dist = train->speed * train->speed / (2 * cfg->decel_m_s2);
+  if (remaining <= brake_dist + train->speed * DATAGEN_STEP_S)
+  {
+    /* brake to stop at the platform */
+    speed = train->speed - train->speed * train->speed / (2 * ((remaining > 0.1) ? remaining : 0.1));
+    if (speed < 0)
+    {
+      speed = 0;
+    }
+  }
+  else
+  {
+    speed = train->speed + cfg->accel_m_s2 * DATAGEN_STEP_S;
+    if (speed > v_max)
+    {
+      speed = v_max;
+    }
+  }
+  train->pos += (train->speed + speed) / 2 * DATAGEN_STEP_S;
+  train->speed = speed;
+
+  while ((train->block + 1 < net->block_cnt) &&
+         (train->pos >= net->blocks[train->dir][train->block + 1].start))
+  {
+    train->block++;
+  }
+
+  if ((net->stop_pos[train->dir][train->target] - train->pos < 1.0) && (train->speed < 1.0))
+  {
+    /* arrived */
+    train->pos = net->stop_pos[train->dir][train->target];
+    train->block = net->platform_block[train->dir][train->target];
+    train->speed = 0;
+    train->station = train->target;
+    train->b_skip = false;
+    train->dwell_elapsed = 0;
+    train->dwell_left = (train->station == cfg->station_cnt - 1) ? 4 * cfg->dwell_s : cfg->dwell_s;
+    if (train->dwell_left <= 0)
+    {
+      train_depart(net, train, rng);
+    }
+  }
+}
+
+/** @brief  write one sample row of a train, possibly malformed
+ *  @param  *net       network
+ *  @param  *fp_out    output file
+ *  @param  *str_time  sample time string
+ *  @param  *train     train
+ *  @param  *rng       generator state
+ *  @return -1  row is well formed
+ *          kind of the malformed row written
+ */
+static int
+train_write_row(const dataGenNetwork *net, FILE *fp_out, const char *str_time,
+                const genTrain *train, uint64_t *rng)
+{
+  const dataGenConfig *cfg = &net->cfg;
+  char str_cc[STR_MIN] = "";
+  char str_motion[STR_MIN] = "";
+  char str_speed[STR_MIN] = "";
+  const char *p_time = str_time;
+  bool b_doors_open = false;
+  int malformed = -1;
+
+  if ((cfg->malformed_rate > 0) && (rng_uniform(rng) < cfg->malformed_rate))
+  {
+    malformed = (int) (rng_next(rng) % k_malformed_cnt);
+  }
+
+  /* first and last sample of a dwell have the doors closed */
+  b_doors_open = (train->dwell_left > cfg->sample_period_s) &&
+                 (train->dwell_elapsed >= cfg->sample_period_s);
+  snprintf(str_cc, STR_MIN, "%d", train->cc_id);
+  snprintf(str_motion, STR_MIN, "%d", (train->speed > 0.1) ? 1 : 0);
+  snprintf(str_speed, STR_MIN, "%.0f", train->speed * 3.6);
+
+  switch (malformed)
+  {
+    case k_malformed_truncated:
+      fprintf(fp_out, "%s,X,IVB_%d,K%d\n", str_time,
+              net->blocks[train->dir][train->block].number, train->cc_id % 100);
+      return malformed;
+    case k_malformed_date:
+      p_time = "2019/13/32 25:61:61";
+      break;
+    case k_malformed_cc:
+      strcpy(str_cc, "0");
+      break;
+    case k_malformed_motion:
+      strcpy(str_motion, "X");
+      break;
+    case k_malformed_speed:
+      strcpy(str_speed, "?");
+      break;
+    default:
+      break;
+  }
+
+  fprintf
+  (
+    fp_out,
+    "%s,X,IVB_%d,K%d,%s,%s,%s,R,%s,A,A,1,%s,%d,%d,0,0,0,%s\n",
+    p_time,
+    net->blocks[train->dir][train->block].number,
+    train->cc_id % 100,
+    k_dir_names[train->dir],
+    (0 == train->dir) ? "K" : "H",
+    (0 == train->dir) ? "H" : "K",
+    str_cc,
+    str_motion,
+    (train->b_skip) ? 1 : 0,
+    (b_doors_open) ? 1 : 0,
+    str_speed
+  );
+  return malformed;
+}
+
+/** @brief  simulate one service day and write its train data, rows are
+ *          in time order. the same configuration, seed and day always
+ *          produce the same file.
+ *  @param  *net       network
+ *  @param  day        day index from the configured start time
+ *  @param  *str_file  train data file path
+ *  @param  *rows      number of rows written, may be NULL
+ *  @param  *malformed malformed rows written per kind, k_malformed_cnt
+ *                     entries, may be NULL
+ *  @return 0
+ *          err_file_not_accessible
+ */
+int
+datagen_write_traindata(const dataGenNetwork *net,
+                        int day,
+                        const char *str_file,
+                        uint64_t *rows,
+                        uint64_t *malformed)
+{
+  const dataGenConfig *cfg = NULL;
+  FILE *fp_out = NULL;
+  genTrain *trains = NULL;
+  genTrain *train = NULL;
+  uint64_t rng = 0;
+  uint64_t row_cnt = 0;
+  time_t day_start = 0;
+  time_t day_end = 0;
+  time_t t = 0;
+  double headway = 0;
+  char str_time[STR_SHORT] = "";
+  int pairs = 0;
+  int kind = 0;
+  int err = 0;
+  int j = 0;
+  int s = 0;
+
+  if ((NULL == net) || (NULL == str_file))
+  {
+    return throw_err(err_file_not_accessible);
+  }
+  cfg = &net->cfg;
+  trains = (genTrain *) calloc(cfg->train_cnt, sizeof(genTrain));
+  if ((NULL == trains) || (NULL == (fp_out = fopen(str_file, "w"))))
+  {
+    free(trains);
+    return throw_err(err_file_not_accessible);
+  }
+  setvbuf(fp_out, NULL, _IOFBF, DATAGEN_FILE_BUFFER);
+
+  /* every day has its own independent sequence */
+  rng = cfg->seed ^ (0xD1B54A32D192ED03ULL * (uint64_t) (day + 1));
+  day_start = cfg->start_time + (time_t) day * 86400;
+  day_end = day_start + (time_t) (cfg->hours * 3600);
+
+  /* trains leave both terminals in pairs, evenly spaced over one cycle */
+  pairs = (cfg->train_cnt + 1) / 2;
+  headway = net->cycle_s / pairs;
+  for (j = 0; j < cfg->train_cnt; j++)
+  {
+    train = &trains[j];
+    train->cc_id = j + 1;
+    train->dir = j % 2;
+    train->start = day_start + (time_t) ((j / 2) * headway);
+    train->station = 0;
+    train->pos = net->stop_pos[train->dir][0];
+    train->block = net->platform_block[train->dir][0];
+    train->dwell_left = cfg->dwell_s;
+  }
+
+  fprintf(fp_out, "%s\n", DATAGEN_DATA_HEADER);
+  for (t = day_start; (t < day_end) && ((0 == cfg->max_rows) || (row_cnt < cfg->max_rows));
+       t += cfg->sample_period_s)
+  {
+    strftime(str_time, STR_SHORT, "%Y/%m/%d %H:%M:%S", localtime(&t));
+    for (j = 0; (j < cfg->train_cnt) && ((0 == cfg->max_rows) || (row_cnt < cfg->max_rows)); j++)
+    {
+      train = &trains[j];
+      if (t < train->start)
+      {
+        continue;
+      }
+      if (train->b_running)
+      {
+        for (s = 0; s < cfg->sample_period_s; s += DATAGEN_STEP_S)
+        {
+          train_step(net, train, &rng);
+        }
+      }
+      train->b_running = true;
+
+      /* communication loss, several samples missing */
+      if (train->gap_left > 0)
+      {
+        train->gap_left--;
+        continue;
+      }
+      if ((cfg->gap_rate > 0) && (rng_uniform(&rng) < cfg->gap_rate))
+      {
+        train->gap_left = DATAGEN_GAP_LO + (int) (rng_next(&rng) % (DATAGEN_GAP_HI - DATAGEN_GAP_LO + 1)) - 1;
+        continue;
+      }
+
+      kind = train_write_row(net, fp_out, str_time, train, &rng);
+      if ((kind >= 0) && (NULL != malformed))
+      {
+        malformed[kind]++;
+      }
+      row_cnt++;
+    }
+  }
+
+  if (0 != fclose(fp_out))
+  {
+    err = throw_err(err_file_not_accessible);
+  }
+  free(trains);
+  if (NULL != rows)
+  {
+    *rows = row_cnt;
+  }
+  return err;
+}
+
+/** @brief  train data file name of a day, traindata_YYYYMMDD.csv
+ *  @param  *net   network
+ *  @param  day    day index from the configured start time
+ *  @param  *buf   file name output
+ *  @param  size   size of buf
+ *  @return none
+ */
+void
+datagen_traindata_name(const dataGenNetwork *net, int day, char *buf, size_t size)
+{
+  time_t t = net->cfg.start_time + (time_t) day * 86400;
+  char str_date[STR_SHORT] = "";
+
+  strftime(str_date, STR_SHORT, "%Y%m%d", localtime(&t));
+  snprintf(buf, size, "traindata_%s.csv", str_date);
+}
@@ -0,0 +1,180 @@
+/*------------------------------------------------------
+**
+** File:      datagen.h
+** Author:    Eric Lu
+** Created:   2026-10-19
+**
+** Copyright ©2012 Toronto Transit Commission
+**
+**
+** Function Description
+** -----------------------------------------------------
+**
+** deterministic synthetic network and train data generator for scale
+** testing atc_speed_profile_tool without production data. a line of N
+** stations is laid out in both directions, trains shuttle between the
+** terminals with accelerate, cruise, brake and dwell phases, and every
+** train is sampled at a fixed period.
+**
+** -----------------------------------------------------
+** Revision History
+**
+** 19 OCT 2026: Rev 1.0 - erilu
+**                      - Initial Design
+**
+** Inputs:
+** Generator configuration, seed
+**
+** Outputs:
+** Block lookup table csv, one train data csv per day
+**
+** ----------------------------------------------------
+*/
+
+#ifndef ATC_SPEED_PROFILE_DATAGEN_H
+#define ATC_SPEED_PROFILE_DATAGEN_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+/*
+** Constants
+** -----------------------------------------------------
+*/
+
+/* maximum number of stations, station codes are two letters */
+#define DATAGEN_MAX_STATION_CNT   676
+/* maximum number of trains, one cc id each */
+#define DATAGEN_MAX_TRAIN_CNT     999
+/* maximum number of blocks between two stations */
+#define DATAGEN_MAX_BETWEEN_CNT   8
+/* lookup table header */
+#define DATAGEN_LUT_HEADER        "ID,LOCATION,BLOCK,DIRECTION,DIRECTION CODE,DIRECTION NUM,PLATFORM,STATION CODE,BLOCK LENGTH,FROM STATION,TO STATION"
+/* train data header */
+#define DATAGEN_DATA_HEADER       "TIME,LOCATION,BLOCK,RUN NUMBER,DIRECTION,DESTINATION CODE,ORIGINATION CODE,SCHEDULE CLASS,CC ID,CURRENT DRIVING MODE,SELECTED DRIVING MODE,TALKATIVE,MOTION,SKIP STOP,DOORS OPEN,DOOR FAULT,ALARM,EMERGENCY BRAKE,SPEED"
+
+/* kinds of malformed rows, each is rejected with its own error code */
+enum datagen_malformed
+{
+  /* too few fields, err_file_format_not_valid */
+  k_malformed_truncated = 0,
+  /* impossible time, err_date_not_valid */
+  k_malformed_date,
+  /* cc id 0, err_cc_not_valid */
+  k_malformed_cc,
+  /* motion not a digit, err_motion_not_valid */
+  k_malformed_motion,
+  /* speed not a number, err_speed_not_valid */
+  k_malformed_speed,
+
+  k_malformed_cnt
+};
+
+/*
+** Structures
+** -----------------------------------------------------
+*/
+
+/* generator configuration, see datagen_config_init for defaults */
+typedef struct data_gen_config_t
+{
+  uint64_t seed;
+  int station_cnt;
+  /* blocks between two adjacent station platforms */
+  int between_cnt;
+  int train_cnt;
+  /* service hours per day and number of daily files */
+  double hours;
+  int day_cnt;
+  /* start of service on the first day, local time */
+  time_t start_time;
+  /* seconds between two samples of a train */
+  int sample_period_s;
+  /* doors closed to doors closed at a platform, terminals take 4 times */
+  int dwell_s;
+  double max_speed_km_h;
+  double accel_m_s2;
+  double decel_m_s2;
+  /* probability a train runs through an intermediate station */
+  double skip_stop_rate;
+  /* probability a sample starts a gap of several missing samples */
+  double gap_rate;
+  /* probability a sample is written as a malformed row. the tool counts
+     and skips these rows and processes the rest of the file */
+  double malformed_rate;
+  /* stop each daily file after this many rows, 0 - no limit */
+  uint64_t max_rows;
+} dataGenConfig;
+
+/* generated network, opaque to the callers */
+typedef struct data_gen_network_t dataGenNetwork;
+
+/*
+** Function Prototypes
+** -----------------------------------------------------
+*/
+
+/** @brief  fill a configuration with the defaults, a 20 station line,
+ *          20 trains, 18 service hours, 3 second samples, no faults
+ *  @param  *cfg  configuration
+ *  @return none
+ */
+void
+datagen_config_init(dataGenConfig *cfg);
+
+/** @brief  lay out stations and blocks for both directions
+ *  @param  *cfg  configuration
+ *  @return NULL  configuration out of range or out of memory
+ *          pointer to the new network
+ */
+dataGenNetwork *
+datagen_network_create(const dataGenConfig *cfg);
+
+/** @brief  release a network
+ *  @param  *net  network created by datagen_network_create
+ *  @return none
+ */
+void
+datagen_network_free(dataGenNetwork *net);
+
+/** @brief  write the block lookup table of the network
+ *  @param  *net       network
+ *  @param  *str_file  lookup table file path
+ *  @return 0
+ *          err_file_not_accessible
+ */
+int
+datagen_write_lut(const dataGenNetwork *net, const char *str_file);
+
+/** @brief  simulate one service day and write its train data, rows are
+ *          in time order. the same configuration, seed and day always
+ *          produce the same file.
+ *  @param  *net       network
+ *  @param  day        day index from the configured start time
+ *  @param  *str_file  train data file path
+ *  @param  *rows      number of rows written, may be NULL
+ *  @param  *malformed malformed rows written per kind, k_malformed_cnt
+ *                     entries, may be NULL
+ *  @return 0
+ *          err_file_not_accessible
+ */
+int
+datagen_write_traindata(const dataGenNetwork *net,
+                        int day,
+                        const char *str_file,
+                        uint64_t *rows,
+                        uint64_t *malformed);
+
+/** @brief  train data file name of a day, traindata_YYYYMMDD.csv
+ *  @param  *net   network
+ *  @param  day    day index from the configured start time
+ *  @param  *buf   file name output
+ *  @param  size   size of buf
+ *  @return none
+ */
+void
+datagen_traindata_name(const dataGenNetwork *net, int day, char *buf, size_t size);
+
+#endif
@@ -28,6 +28,14 @@
 ** ----------------------------------------------------
 */
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <pthread.h>
 #include "errorhandler.h"
 
 /*
@@ -46,11 +54,28 @@
 ** -----------------------------------------------------
 */
 
+/* error counts and example records of one file */
+typedef struct err_report_file_t
+{
+  char file[ERR_REPORT_EXEMPLAR_LEN];
+  atomic_uint_fast64_t count[err_no_max];
+  char exemplar[err_no_max][ERR_REPORT_EXEMPLAR_CNT][ERR_REPORT_EXEMPLAR_LEN];
+} errReportFile;
+
 /*
 ** Variables
 ** -----------------------------------------------------
 */
 
+/* last error raised on each thread */
+static THREAD_LOCAL errContext err_context = {0};
+
+/* files registered with the data quality report */
+static errReportFile *err_report_files[ERR_REPORT_MAX_FILE];
+static atomic_int err_report_file_cnt = 0;
+/* serializes file registration only, counting is lock free */
+static pthread_mutex_t err_report_lock = PTHREAD_MUTEX_INITIALIZER;
+
 /*
 ** Function Prototypes
 ** -----------------------------------------------------
@@ -80,16 +105,276 @@ get_err_description(int err)
 }
 
 /** @brief  make errorCode negative since the errorCode enum is 
- *          always non-negative
- *  @param  err error code enum as defined in errorCode
+ *          always non-negative, and record it as the last error of the
+ *          thread. a positive code is a fresh raise and always recorded,
+ *          an already negative code passed on unchanged keeps the 
+ *          location it was raised at
+ *  @param  err    error code enum as defined in errorCode
+ *  @param  *file  source file raising the error
+ *  @param  line   source line raising the error
  *  @return negative of err
  */
 int 
-throw_err(int err)
+throw_err_at(int err, const char *file, int line)
+{
+  bool b_raised = false;
+
+  if (err > 0)
+  {
+    err = 0 - err;
+    b_raised = true;
+  }
+  if ((b_raised) || ((err < 0) && (err != err_context.err)))
+  {
+    err_context.err = err;
+    err_context.sys_errno = errno;
+    err_context.file = file;
+    err_context.line = line;
+  }
+  return err;
+}
+
+/** @brief  get the last error raised on the calling thread
+ *  @return error context of the thread
+ */
+const errContext *
+err_last(void)
+{
+  return &err_context;
+}
+
+/** @brief  forget the last error raised on the calling thread
+ *  @return none
+ */
+void
+err_clear(void)
+{
+  memset(&err_context, 0, sizeof(errContext));
+}
+
+/** @brief  format the last error of the calling thread as
+ *          "DESCRIPTION (file:line, errno n)"
+ *  @param  *buf  destination buffer
+ *  @param  size  destination buffer size in bytes
+ *  @return buf
+ */
+char *
+err_last_format(char *buf, size_t size)
+{
+  snprintf
+  (
+    buf, 
+    size, 
+    "%s (%s:%d, errno %d)", 
+    get_err_description(err_context.err),
+    (NULL != err_context.file) ? err_context.file : "",
+    err_context.line,
+    err_context.sys_errno
+  );
+  return buf;
+}
+
+/** @brief  map an error code to the report column, -1 if not reportable
+ *  @param  err error code, positive or negative
+ *  @return column index
+ */
+static int
+err_report_column(int err)
 {
   if (err < 0)
   {
-    return err;
+    err = 0 - err;
+  }
+  if ((err <= err_no_error) || (err >= err_no_max))
+  {
+    return -1;
+  }
+  return err;
+}
+
+/** @brief  register a file with the data quality report
+ *  @param  *file  file name the errors are reported against
+ *  @return report file id, reused if the file is already registered
+ *          err_maximum_number_exceeded 
+ */
+int
+err_report_open(const char *file)
+{
+  errReportFile *p_file = NULL;
+  int id = 0;
+  int cnt = 0;
+
+  if (NULL == file)
+  {
+    file = "";
+  }
+
+  pthread_mutex_lock(&err_report_lock);
+  cnt = atomic_load(&err_report_file_cnt);
+  for (id = 0; id < cnt; id++)
+  {
+    if (0 == strncmp(err_report_files[id]->file, file, ERR_REPORT_EXEMPLAR_LEN - 1))
+    {
+      pthread_mutex_unlock(&err_report_lock);
+      return id;
+    }
+  }
+  if (cnt >= ERR_REPORT_MAX_FILE)
+  {
+    pthread_mutex_unlock(&err_report_lock);
+    return throw_err(err_maximum_number_exceeded);
+  }
+  p_file = (errReportFile *) calloc(1, sizeof(errReportFile));
+  if (NULL == p_file)
+  {
+    pthread_mutex_unlock(&err_report_lock);
+    return throw_err(err_insufficient_buffer_size);
+  }
+  strncpy(p_file->file, file, ERR_REPORT_EXEMPLAR_LEN - 1);
+  err_report_files[cnt] = p_file;
+  atomic_store(&err_report_file_cnt, cnt + 1);
+  pthread_mutex_unlock(&err_report_lock);
+
+  return cnt;
+}
+
+/** @brief  count one occurrence of an error against a file, lock free
+ *  @param  file_id  report file id from err_report_open
+ *  @param  err      error code, positive or negative
+ *  @return index of the example record slot for this occurrence
+ *          -1  enough examples are kept already, nothing else to do
+ */
+int
+err_report_count(int file_id, int err)
+{
+  int col = err_report_column(err);
+  uint64_t prev = 0;
+
+  if ((col < 0) || (file_id < 0) || (file_id >= atomic_load(&err_report_file_cnt)))
+  {
+    return -1;
+  }
+  prev = atomic_fetch_add(&err_report_files[file_id]->count[col], 1);
+  if (prev < ERR_REPORT_EXEMPLAR_CNT)
+  {
+    return (int) prev;
+  }
+  return -1;
+}
+
+/** @brief  keep an example record for an error occurrence
+ *  @param  file_id  report file id from err_report_open
+ *  @param  err      error code, positive or negative
+ *  @param  index    slot returned by err_report_count
+ *  @param  *text    example record, truncated to ERR_REPORT_EXEMPLAR_LEN
+ *  @return none
+ */
+void
+err_report_exemplar(int file_id, int err, int index, const char *text)
+{
+  int col = err_report_column(err);
+
+  if ((col < 0) || (NULL == text) || (index < 0) || 
+      (index >= ERR_REPORT_EXEMPLAR_CNT) || (file_id < 0) || 
+      (file_id >= atomic_load(&err_report_file_cnt)))
+  {
+    return;
+  }
+  /* each slot is handed out once, no other writer can touch it */
+  strncpy(err_report_files[file_id]->exemplar[col][index], 
+          text, 
+          ERR_REPORT_EXEMPLAR_LEN - 1);
+}
+
+/** @brief  total number of occurrences of an error over all files
+ *  @param  err      error code, positive or negative
+ *  @return number of occurrences
+ */
+uint64_t
+err_report_total(int err)
+{
+  int col = err_report_column(err);
+  int cnt = atomic_load(&err_report_file_cnt);
+  int id = 0;
+  uint64_t total = 0;
+
+  if (col < 0)
+  {
+    return 0;
+  }
+  for (id = 0; id < cnt; id++)
+  {
+    total += atomic_load(&err_report_files[id]->count[col]);
+  }
+  return total;
+}
+
+/** @brief  print the error counts and example records per file and error
+ *  @param  *fp  output stream
+ *  @return number of errors reported
+ */
+uint64_t
+err_report_print(FILE *fp)
+{
+  int cnt = atomic_load(&err_report_file_cnt);
+  int id = 0;
+  int col = 0;
+  int i = 0;
+  uint64_t count = 0;
+  uint64_t total = 0;
+
+  for (id = 0; id < cnt; id++)
+  {
+    for (col = err_no_error + 1; col < err_no_max; col++)
+    {
+      count = atomic_load(&err_report_files[id]->count[col]);
+      if (0 == count)
+      {
+        continue;
+      }
+      if (0 == total)
+      {
+        fprintf(fp, "[%6s][%s]\n", "INFO", "Data Quality Summary");
+        fprintf(fp, "[%6s][%-40s][%-28s][%12s]\n", "INFO", "FILE", "ERROR", "COUNT");
+      }
+      total += count;
+      fprintf
+      (
+        fp, 
+        "[%6s][%-40s][%-28s][%12" PRIu64 "]\n", 
+        "INFO", 
+        err_report_files[id]->file, 
+        kErrorDescription[col], 
+        count
+      );
+      for (i = 0; (i < ERR_REPORT_EXEMPLAR_CNT) && ((uint64_t) i < count); i++)
+      {
+        if ('\0' != err_report_files[id]->exemplar[col][i][0])
+        {
+          fprintf(fp, "[%6s][%s]\n", "", err_report_files[id]->exemplar[col][i]);
+        }
+      }
+    }
+  }
+  return total;
+}
+
+/** @brief  clear all counts and release the registered files
+ *  @return none
+ */
+void
+err_report_reset(void)
+{
+  int cnt = 0;
+  int id = 0;
+
+  pthread_mutex_lock(&err_report_lock);
+  cnt = atomic_load(&err_report_file_cnt);
+  atomic_store(&err_report_file_cnt, 0);
+  for (id = 0; id < cnt; id++)
+  {
+    free(err_report_files[id]);
+    err_report_files[id] = NULL;
   }
-  return (0 - err);
+  pthread_mutex_unlock(&err_report_lock);
 }
@@ -31,6 +31,8 @@
 #ifndef ERROR_HANDLER_H
 #define ERROR_HANDLER_H
 
+#include <stdio.h>
+#include <stdint.h>
 
 /*
 ** Type Definitions
@@ -42,12 +44,37 @@
 ** -----------------------------------------------------
 */
 
+/* maximum number of files tracked by the data quality report */
+#define ERR_REPORT_MAX_FILE       128
+/* storage kept per thread, the last error and parser state of a thread 
+** are not seen by the others */
+#if defined(_MSC_VER)
+#   define THREAD_LOCAL __declspec(thread)
+#else
+#   define THREAD_LOCAL _Thread_local
+#endif
+
+/* number of example records kept per file and error */
+#define ERR_REPORT_EXEMPLAR_CNT   3
+/* maximum length of an example record */
+#define ERR_REPORT_EXEMPLAR_LEN   512
 
 /*
 ** Structures
 ** -----------------------------------------------------
 */
 
+/* last error raised on a thread and where it was raised */
+typedef struct err_context_t
+{
+  /* negative error code, 0 if none since the last err_clear */
+  int err;
+  /* errno of the thread when the error was raised */
+  int sys_errno;
+  const char *file;
+  int line;
+} errContext;
+
 /* collection of possible error codes */
 typedef enum errorCode
 {
@@ -125,12 +152,89 @@ static const char *kErrorDescription[err_no_max+1] =
 const char *
 get_err_description(int err);
 
+/* raise an error, recording the caller location in the thread context */
+#define throw_err(err) throw_err_at((err), __FILE__, __LINE__)
+
 /** @brief  make errorCode negative since the errorCode enum is always not
- *  @param  err error code enum as defined in errorCode
+ *          negative, and record it as the last error of the thread. a 
+ *          positive code is a fresh raise and always recorded, an already
+ *          negative code passed on unchanged keeps the location it was 
+ *          raised at
+ *  @param  err    error code enum as defined in errorCode
+ *  @param  *file  source file raising the error
+ *  @param  line   source line raising the error
  *  @return negative of err
  */
 int 
-throw_err(int err);
+throw_err_at(int err, const char *file, int line);
+
+/** @brief  get the last error raised on the calling thread
+ *  @return error context of the thread
+ */
+const errContext *
+err_last(void);
+
+/** @brief  forget the last error raised on the calling thread
+ *  @return none
+ */
+void
+err_clear(void);
+
+/** @brief  format the last error of the calling thread as
+ *          "DESCRIPTION (file:line, errno n)"
+ *  @param  *buf  destination buffer
+ *  @param  size  destination buffer size in bytes
+ *  @return buf
+ */
+char *
+err_last_format(char *buf, size_t size);
+
+/** @brief  register a file with the data quality report
+ *  @param  *file  file name the errors are reported against
+ *  @return report file id, reused if the file is already registered
+ *          err_maximum_number_exceeded 
+ */
+int
+err_report_open(const char *file);
+
+/** @brief  count one occurrence of an error against a file, lock free
+ *  @param  file_id  report file id from err_report_open
+ *  @param  err      error code, positive or negative
+ *  @return index of the example record slot for this occurrence
+ *          -1  enough examples are kept already, nothing else to do
+ */
+int
+err_report_count(int file_id, int err);
+
+/** @brief  keep an example record for an error occurrence
+ *  @param  file_id  report file id from err_report_open
+ *  @param  err      error code, positive or negative
+ *  @param  index    slot returned by err_report_count
+ *  @param  *text    example record, truncated to ERR_REPORT_EXEMPLAR_LEN
+ *  @return none
+ */
+void
+err_report_exemplar(int file_id, int err, int index, const char *text);
+
+/** @brief  total number of occurrences of an error over all files
+ *  @param  err      error code, positive or negative
+ *  @return number of occurrences
+ */
+uint64_t
+err_report_total(int err);
+
+/** @brief  print the error counts and example records per file and error
+ *  @param  *fp  output stream
+ *  @return number of errors reported
+ */
+uint64_t
+err_report_print(FILE *fp);
+
+/** @brief  clear all counts and release the registered files
+ *  @return none
+ */
+void
+err_report_reset(void);
 
 
 #endif
\ No newline at end of file
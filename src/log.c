@@ -25,17 +25,36 @@
 #include <stdarg.h>
 #include <string.h>
 #include <time.h>
+#include <pthread.h>
 
 #include "log.h"
 
+/* Messages of one thread, written to the sinks as one block so the lines
+ * of different threads never interleave */
+typedef struct {
+  char *buf;
+  size_t buf_len;
+  char *fbuf;
+  size_t fbuf_len;
+  size_t size;
+} log_Buffer;
+
 static struct {
   void *udata;
   log_LockFn lock;
   FILE *fp;
   int level;
   int quiet;
+  /* size of the per thread buffers, 0 writes every message immediately */
+  size_t buf_size;
 } L;
 
+/* per thread buffer, flushed and freed when its thread exits */
+static pthread_key_t buf_key;
+static pthread_once_t buf_key_once = PTHREAD_ONCE_INIT;
+/* lock used by log_lock_mutex */
+static pthread_mutex_t sink_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 
 static const char *level_names[] = {
   "TRACE", "DEBUG", "INFO", "WARN", "ERROR", "FATAL"
@@ -62,6 +81,16 @@ static void unlock(void) {
 }
 
 
+void log_lock_mutex(void *udata, int lock) {
+  (void) udata;
+  if (lock) {
+    pthread_mutex_lock(&sink_mutex);
+  } else {
+    pthread_mutex_unlock(&sink_mutex);
+  }
+}
+
+
 void log_set_udata(void *udata) {
   L.udata = udata;
 }
@@ -82,53 +111,216 @@ void log_set_level(int level) {
 }
 
 
+int log_get_level(void) {
+  return L.level;
+}
+
+
+int log_level_from_string(const char *name) {
+  int i;
+  for (i = LOG_TRACE; i <= LOG_FATAL; i++) {
+    if (name && strcmp(name, level_names[i]) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+
 void log_set_quiet(int enable) {
   L.quiet = enable ? 1 : 0;
 }
 
 
-void log_log(int level, const char *file, int line, const char *fmt, ...) {
-  if (level < L.level) {
+/* Write out the messages of one thread as one block */
+static void flush_buffer(log_Buffer *b) {
+  if (b->buf_len == 0 && b->fbuf_len == 0) {
     return;
   }
+  lock();
+  if (b->buf_len > 0) {
+    fwrite(b->buf, 1, b->buf_len, stderr);
+    fflush(stderr);
+    b->buf_len = 0;
+  }
+  if (b->fbuf_len > 0) {
+    if (L.fp) {
+      fwrite(b->fbuf, 1, b->fbuf_len, L.fp);
+      fflush(L.fp);
+    }
+    b->fbuf_len = 0;
+  }
+  unlock();
+}
+
+
+static void free_buffer(void *udata) {
+  log_Buffer *b = udata;
+
+  if (b) {
+    flush_buffer(b);
+    free(b->buf);
+    free(b->fbuf);
+    free(b);
+  }
+}
+
+
+static void make_buf_key(void) {
+  pthread_key_create(&buf_key, free_buffer);
+}
+
+
+/* Buffer of the calling thread sized to the current setting, NULL when
+ * buffering is off or memory is short */
+static log_Buffer *get_buffer(void) {
+  log_Buffer *b;
+
+  pthread_once(&buf_key_once, make_buf_key);
+  b = pthread_getspecific(buf_key);
+  if (b && b->size != L.buf_size) {
+    pthread_setspecific(buf_key, NULL);
+    free_buffer(b);
+    b = NULL;
+  }
+  if (!b && L.buf_size > 0) {
+    b = calloc(1, sizeof(log_Buffer));
+    if (b) {
+      b->buf = malloc(L.buf_size);
+      b->fbuf = malloc(L.buf_size);
+      b->size = L.buf_size;
+    }
+    if (!b || !b->buf || !b->fbuf) {
+      free_buffer(b);
+      return NULL;
+    }
+    pthread_setspecific(buf_key, b);
+  }
+  return b;
+}
+
+
+/* Keep messages in a buffer per thread and write them in large blocks 
+ * instead of one unbuffered write per line. size 0 writes every message
+ * immediately. Buffers of other threads are resized on their next 
+ * message and flushed by log_flush on that thread or when it exits */
+int log_set_buffer(size_t size) {
+  log_Buffer *b;
+
+  pthread_once(&buf_key_once, make_buf_key);
+  b = pthread_getspecific(buf_key);
+  if (b) {
+    flush_buffer(b);
+  }
+  L.buf_size = size;
+  if (size > 0 && !get_buffer()) {
+    L.buf_size = 0;
+    return -1;
+  }
+  if (size == 0) {
+    get_buffer();
+  }
+  return 0;
+}
+
+
+void log_flush(void) {
+  log_Buffer *b;
+
+  pthread_once(&buf_key_once, make_buf_key);
+  b = pthread_getspecific(buf_key);
+  if (b) {
+    flush_buffer(b);
+  }
+}
+
 
-  /* Acquire lock */
+/* Append one formatted message to a sink buffer of the thread, or write 
+ * it straight to the stream if buffering is off or it does not fit */
+static void write_message(FILE *stream, log_Buffer *b, int file_sink,
+                          const char *prefix, const char *fmt, va_list args) {
+  char *buf = NULL;
+  size_t *len = NULL;
+  va_list copy;
+  int n;
+
+  if (b) {
+    buf = file_sink ? b->fbuf : b->buf;
+    len = file_sink ? &b->fbuf_len : &b->buf_len;
+    va_copy(copy, args);
+    n = snprintf(NULL, 0, "%s", prefix);
+    n += vsnprintf(NULL, 0, fmt, copy) + 1;
+    va_end(copy);
+    if (*len + n + 1 > b->size) {
+      flush_buffer(b);
+    }
+    if ((size_t) n + 1 <= b->size) {
+      *len += snprintf(buf + *len, b->size - *len, "%s", prefix);
+      *len += vsnprintf(buf + *len, b->size - *len, fmt, args);
+      buf[(*len)++] = '\n';
+      return;
+    }
+  }
   lock();
+  fputs(prefix, stream);
+  vfprintf(stream, fmt, args);
+  fputc('\n', stream);
+  unlock();
+}
+
+
+void log_log(int level, const char *file, int line, const char *fmt, ...) {
+  log_Buffer *b;
+  time_t t;
+  struct tm lt;
+
+  if (level < L.level) {
+    return;
+  }
+  b = get_buffer();
 
   /* Get current time */
-  time_t t = time(NULL);
-  struct tm *lt = localtime(&t);
+  t = time(NULL);
+#ifdef _WIN32
+  localtime_s(&lt, &t);
+#else
+  localtime_r(&t, &lt);
+#endif
 
   /* Log to stderr */
   if (!L.quiet) {
     va_list args;
     char buf[16];
-    buf[strftime(buf, sizeof(buf), "%H:%M:%S", lt)] = '\0';
+    char prefix[512];
+    buf[strftime(buf, sizeof(buf), "%H:%M:%S", &lt)] = '\0';
 #ifdef LOG_USE_COLOR
-    fprintf(
-      stderr, "%s %s%-5s\x1b[0m \x1b[90m%s:%d:\x1b[0m ",
+    snprintf(
+      prefix, sizeof(prefix), "%s %s%-5s\x1b[0m \x1b[90m%s:%d:\x1b[0m ",
       buf, level_colors[level], level_names[level], file, line);
 #else
-    fprintf(stderr, "%s %-5s %s:%d: ", buf, level_names[level], file, line);
+    snprintf(prefix, sizeof(prefix), "%s %-5s %s:%d: ",
+             buf, level_names[level], file, line);
 #endif
     va_start(args, fmt);
-    vfprintf(stderr, fmt, args);
+    write_message(stderr, b, 0, prefix, fmt, args);
     va_end(args);
-    fprintf(stderr, "\n");
   }
 
   /* Log to file */
   if (L.fp) {
     va_list args;
     char buf[32];
-    buf[strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", lt)] = '\0';
-    fprintf(L.fp, "%s %-5s %s:%d: ", buf, level_names[level], file, line);
+    char prefix[512];
+    buf[strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &lt)] = '\0';
+    snprintf(prefix, sizeof(prefix), "%s %-5s %s:%d: ",
+             buf, level_names[level], file, line);
     va_start(args, fmt);
-    vfprintf(L.fp, fmt, args);
+    write_message(L.fp, b, 1, prefix, fmt, args);
     va_end(args);
-    fprintf(L.fp, "\n");
   }
 
-  /* Release lock */
-  unlock();
+  /* Fatal messages are not held back in the buffer */
+  if (b && level >= LOG_FATAL) {
+    flush_buffer(b);
+  }
 }
@@ -17,18 +17,48 @@ typedef void (*log_LockFn)(void *udata, int lock);
 
 enum { LOG_TRACE, LOG_DEBUG, LOG_INFO, LOG_WARN, LOG_ERROR, LOG_FATAL };
 
+/* Lowest level compiled in, calls below it compile to nothing.
+ * Numeric so it can be tested by the preprocessor:
+ * 0 TRACE, 1 DEBUG, 2 INFO, 3 WARN, 4 ERROR, 5 FATAL */
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL 0
+#endif
+
+/* Default size of the buffered sink, see log_set_buffer() */
+#define LOG_BUFFER_DEFAULT 65536
+
+#if LOG_COMPILE_LEVEL <= 0
 #define log_trace(...) log_log(LOG_TRACE, __FILE__, __LINE__, __VA_ARGS__)
+#else
+#define log_trace(...) ((void)0)
+#endif
+#if LOG_COMPILE_LEVEL <= 1
 #define log_debug(...) log_log(LOG_DEBUG, __FILE__, __LINE__, __VA_ARGS__)
+#else
+#define log_debug(...) ((void)0)
+#endif
 #define log_info(...)  log_log(LOG_INFO,  __FILE__, __LINE__, __VA_ARGS__)
 #define log_warn(...)  log_log(LOG_WARN,  __FILE__, __LINE__, __VA_ARGS__)
 #define log_error(...) log_log(LOG_ERROR, __FILE__, __LINE__, __VA_ARGS__)
 #define log_fatal(...) log_log(LOG_FATAL, __FILE__, __LINE__, __VA_ARGS__)
 
+/* True if a message of this level would be written, use it to skip
+ * preparing expensive arguments */
+#define log_enabled(level) \
+  ((level) >= LOG_COMPILE_LEVEL && (level) >= log_get_level())
+
 void log_set_udata(void *udata);
 void log_set_lock(log_LockFn fn);
+/* Lock function backed by a mutex of the library, pass it to log_set_lock
+ * when several threads log */
+void log_lock_mutex(void *udata, int lock);
 void log_set_fp(FILE *fp);
 void log_set_level(int level);
+int log_get_level(void);
+int log_level_from_string(const char *name);
 void log_set_quiet(int enable);
+int log_set_buffer(size_t size);
+void log_flush(void);
 
 void log_log(int level, const char *file, int line, const char *fmt, ...);
 
@@ -0,0 +1,484 @@
+/*------------------------------------------------------
+**
+** File:      lut_cache.c
+** Author:    Eric Lu
+** Created:   2026-10-19
+**
+** Copyright ©2012 Toronto Transit Commission
+**
+**
+** Function Description
+** -----------------------------------------------------
+**
+** compiled lookup table image, see lut_cache.h
+**
+** -----------------------------------------------------
+** Revision History
+**
+** 19 OCT 2026: Rev 1.0 - erilu
+**                      - Initial Design
+**
+** Inputs:
+** Configuration Files:
+**  config\atc_block_lut.csv
+**  config\atc_block_lut.bin
+**
+** Outputs:
+** Configuration Files:
+**  config\atc_block_lut.bin
+**
+** ----------------------------------------------------
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/stat.h>
+#ifndef _WIN32
+#   include <fcntl.h>
+#   include <unistd.h>
+#   include <sys/mman.h>
+#else
+#   include <process.h>
+#endif
+#include "atc_speed_profile_tool.h"
+#include "lut_cache.h"
+
+/*
+** Constants
+** -----------------------------------------------------
+*/
+
+/* first bytes of an image */
+#define LUT_CACHE_MAGIC           "ATCLUT\0\0"
+/* suffix of the image while it is written, after the writer pid so
+** processes compiling the same table at once never share a file */
+#define LUT_CACHE_TMP_SUFFIX      ".tmp"
+/* read size while hashing the csv */
+#define LUT_CACHE_HASH_CHUNK      65536
+
+/* FNV-1a 64 bit */
+#define LUT_CACHE_FNV_OFFSET      14695981039346656037ULL
+#define LUT_CACHE_FNV_PRIME       1099511628211ULL
+
+/*
+** Structures
+** -----------------------------------------------------
+*/
+
+/* csv an image was compiled from */
+typedef struct lut_source_t
+{
+  uint64_t size;
+  int64_t mtime;
+  uint64_t hash;
+} lutSource;
+
+/* image header, followed by the records and the block index */
+typedef struct lut_cache_header_t
+{
+  char magic[8];
+  uint32_t version;
+  /* sizeof(lutData) of the build that wrote the image */
+  uint32_t record_size;
+  lutSource source;
+  uint32_t record_cnt;
+  uint32_t reserved;
+  uint64_t record_offset;
+  uint64_t block_index_offset;
+} lutCacheHeader;
+
+struct lut_cache_t
+{
+  /* whole image, mapped or read */
+  void *p_image;
+  size_t size;
+};
+
+/*
+** Source Code
+** -----------------------------------------------------
+*/
+
+/** @brief  get the size and modification time of a csv
+ *  @param  *str_lut_file  lookup table csv path
+ *  @param  *source        identity output, the hash is not touched
+ *  @return 0
+ *          err_file_not_accessible
+ */
+static int
+stat_lut_source(const char *str_lut_file, lutSource *source)
+{
+  struct stat st;
+
+  if (0 != stat(str_lut_file, &st))
+  {
+    return throw_err(err_file_not_accessible);
+  }
+  source->size = (uint64_t) st.st_size;
+  source->mtime = (int64_t) st.st_mtime;
+  return 0;
+}
+
+/** @brief  get the content hash of a csv
+ *  @param  *str_lut_file  lookup table csv path
+ *  @param  *source        identity output, only the hash is set
+ *  @return 0
+ *          err_file_not_accessible
+ */
+static int
+hash_lut_source(const char *str_lut_file, lutSource *source)
+{
+  unsigned char *buf = NULL;
+  FILE *fp = NULL;
+  uint64_t hash = LUT_CACHE_FNV_OFFSET;
+  size_t n = 0;
+  size_t i = 0;
+
+  if (NULL == (fp = fopen(str_lut_file, "rb")))
+  {
+    return throw_err(err_file_not_accessible);
+  }
+  if (NULL == (buf = malloc(LUT_CACHE_HASH_CHUNK)))
+  {
+    fclose(fp);
+    return throw_err(err_file_not_accessible);
+  }
+  while (0 < (n = fread(buf, 1, LUT_CACHE_HASH_CHUNK, fp)))
+  {
+    for (i = 0; i < n; i++)
+    {
+      hash = (hash ^ buf[i]) * LUT_CACHE_FNV_PRIME;
+    }
+  }
+  free(buf);
+  fclose(fp);
+  source->hash = hash;
+  return 0;
+}
+
+/** @brief  record a new modification time of an unchanged csv in its
+ *          image, so the csv is not hashed again on the next start
+ *  @param  *str_cache_file  image path
+ *  @param  mtime            modification time of the csv
+ *  @return none, the image is only hashed again if this fails
+ */
+static void
+touch_image_source(const char *str_cache_file, int64_t mtime)
+{
+  FILE *fp = NULL;
+
+  if (NULL == (fp = fopen(str_cache_file, "r+b")))
+  {
+    return;
+  }
+  if (0 == fseek(fp, (long) offsetof(lutCacheHeader, source.mtime), SEEK_SET))
+  {
+    fwrite(&mtime, sizeof(mtime), 1, fp);
+  }
+  fclose(fp);
+}
+
+/** @brief  get the path of the compiled image of a lookup table
+ *  @param  *str_lut_file    lookup table csv path
+ *  @param  *str_cache_file  image path output
+ *  @param  size             size of str_cache_file
+ *  @return 0
+ *          err_null_string
+ *          err_insufficient_buffer_size
+ */
+int
+lut_cache_path(const char *str_lut_file, char *str_cache_file, size_t size)
+{
+  size_t len = 0;
+
+  if ((NULL == str_lut_file) || (NULL == str_cache_file))
+  {
+    return throw_err(err_null_string);
+  }
+  len = strlen(str_lut_file);
+  if ((len > 4) && (0 == strcmp(str_lut_file + len - 4, ".csv")))
+  {
+    len -= 4;
+  }
+  if ((size_t) snprintf(str_cache_file, size, "%.*s%s",
+                        (int) len, str_lut_file, LUT_CACHE_EXTENSION) >= size)
+  {
+    return throw_err(err_insufficient_buffer_size);
+  }
+  return 0;
+}
+
+/** @brief  map a whole file read only
+ *  @param  *str_file  file path
+ *  @param  *cache     image output
+ *  @return 0
+ *          err_file_not_accessible
+ */
+static int
+map_image(const char *str_file, lutCache *cache)
+{
+#ifndef _WIN32
+  struct stat st;
+  int fd = -1;
+
+  if ((fd = open(str_file, O_RDONLY)) < 0)
+  {
+    return throw_err(err_file_not_accessible);
+  }
+  if ((0 != fstat(fd, &st)) || (st.st_size < (off_t) sizeof(lutCacheHeader)))
+  {
+    close(fd);
+    return throw_err(err_file_not_accessible);
+  }
+  cache->size = (size_t) st.st_size;
+  cache->p_image = mmap(NULL, cache->size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (MAP_FAILED == cache->p_image)
+  {
+    cache->p_image = NULL;
+    return throw_err(err_file_not_accessible);
+  }
+  return 0;
+#else
+  /* no mmap, the image is read in one piece */
+  FILE *fp = NULL;
+  long len = 0;
+
+  if (NULL == (fp = fopen(str_file, "rb")))
+  {
+    return throw_err(err_file_not_accessible);
+  }
+  len = file_length(fp);
+  if ((len < (long) sizeof(lutCacheHeader)) ||
+      (NULL == (cache->p_image = malloc((size_t) len))) ||
+      ((size_t) len != fread(cache->p_image, 1, (size_t) len, fp)))
+  {
+    free(cache->p_image);
+    cache->p_image = NULL;
+    fclose(fp);
+    return throw_err(err_file_not_accessible);
+  }
+  fclose(fp);
+  cache->size = (size_t) len;
+  return 0;
+#endif
+}
+
+/** @brief  map the compiled image of a lookup table. the csv is hashed
+ *          only when its modification time differs from the image, or
+ *          when asked to verify
+ *  @param  *str_lut_file  lookup table csv path
+ *  @param  b_verify       hash the csv even if size and time match
+ *  @return NULL           no image, or compiled from another csv content,
+ *                         version or build, or a damaged block index
+ *          pointer to the mapped image, released with lut_cache_close
+ */
+lutCache *
+lut_cache_open(const char *str_lut_file, bool b_verify)
+{
+  char str_cache_file[STR_MAX] = "";
+  const lutCacheHeader *p_header = NULL;
+  const unsigned int *p_block_index = NULL;
+  lutCache *cache = NULL;
+  lutSource source = {0};
+  uint64_t records_end = 0;
+  unsigned int i = 0;
+
+  if ((lut_cache_path(str_lut_file, str_cache_file, STR_MAX) < 0) ||
+      (stat_lut_source(str_lut_file, &source) < 0) ||
+      (NULL == (cache = calloc(1, sizeof(lutCache)))))
+  {
+    return NULL;
+  }
+  if (map_image(str_cache_file, cache) < 0)
+  {
+    free(cache);
+    return NULL;
+  }
+  p_header = (const lutCacheHeader *) cache->p_image;
+  records_end = p_header->record_offset + (uint64_t) p_header->record_cnt * sizeof(lutData);
+  if ((0 != memcmp(p_header->magic, LUT_CACHE_MAGIC, sizeof(p_header->magic))) ||
+      (LUT_CACHE_VERSION != p_header->version) ||
+      (sizeof(lutData) != p_header->record_size) ||
+      (source.size != p_header->source.size) ||
+      (0 == p_header->record_cnt) ||
+      (0 != p_header->record_offset % sizeof(uint64_t)) ||
+      (records_end > p_header->block_index_offset) ||
+      (p_header->block_index_offset +
+       (uint64_t) p_header->record_cnt * sizeof(unsigned int) > cache->size))
+  {
+    lut_cache_close(cache);
+    return NULL;
+  }
+
+  /* same size and time is taken as the same csv, a touched or copied
+  ** csv is hashed and its image kept if the content is unchanged */
+  if ((b_verify || (source.mtime != p_header->source.mtime)) &&
+      ((hash_lut_source(str_lut_file, &source) < 0) ||
+       (source.hash != p_header->source.hash)))
+  {
+    lut_cache_close(cache);
+    return NULL;
+  }
+  if (source.mtime != p_header->source.mtime)
+  {
+    touch_image_source(str_cache_file, source.mtime);
+  }
+
+  /* the index is used to address the records without further checks */
+  p_block_index = lut_cache_block_index(cache);
+  for (i = 0; i < p_header->record_cnt; i++)
+  {
+    if (p_block_index[i] >= p_header->record_cnt)
+    {
+      lut_cache_close(cache);
+      return NULL;
+    }
+  }
+  return cache;
+}
+
+/** @brief  get the records of a mapped image, in lookup table order
+ *  @param  *cache  mapped image
+ *  @param  *cnt    number of records output
+ *  @return pointer to the first record, read only
+ */
+const lutData *
+lut_cache_records(const lutCache *cache, unsigned int *cnt)
+{
+  const lutCacheHeader *p_header = (const lutCacheHeader *) cache->p_image;
+
+  *cnt = p_header->record_cnt;
+  return (const lutData *) ((const char *) cache->p_image + p_header->record_offset);
+}
+
+/** @brief  get the block index of a mapped image
+ *  @param  *cache  mapped image
+ *  @return record positions sorted by block, then position
+ */
+const unsigned int *
+lut_cache_block_index(const lutCache *cache)
+{
+  const lutCacheHeader *p_header = (const lutCacheHeader *) cache->p_image;
+
+  return (const unsigned int *) ((const char *) cache->p_image + p_header->block_index_offset);
+}
+
+/** @brief  get the size of a mapped image
+ *  @param  *cache  mapped image
+ *  @return bytes
+ */
+size_t
+lut_cache_size(const lutCache *cache)
+{
+  return cache->size;
+}
+
+/** @brief  unmap an image
+ *  @param  *cache  mapped image, NULL is ignored
+ *  @return none
+ */
+void
+lut_cache_close(lutCache *cache)
+{
+  if (NULL == cache)
+  {
+    return;
+  }
+#ifndef _WIN32
+  if (NULL != cache->p_image)
+  {
+    munmap(cache->p_image, cache->size);
+  }
+#else
+  free(cache->p_image);
+#endif
+  free(cache);
+}
+
+/** @brief  compile a parsed lookup table into its image
+ *  @param  *str_lut_file    lookup table csv path the records were read from
+ *  @param  **p_records      records in lookup table order
+ *  @param  *p_block_index   record positions sorted by block, then position
+ *  @param  cnt              number of records
+ *  @return 0
+ *          err_null_string
+ *          err_insufficient_buffer_size
+ *          err_file_not_accessible
+ */
+int
+lut_cache_write(const char *str_lut_file, lutData *const *p_records,
+                const unsigned int *p_block_index, unsigned int cnt)
+{
+  char str_cache_file[STR_MAX] = "";
+  char str_tmp_file[STR_MAX] = "";
+  lutCacheHeader header;
+  FILE *fp = NULL;
+  unsigned int i = 0;
+  bool b_ok = true;
+  int err = 0;
+
+  if ((NULL == p_records) || (NULL == p_block_index) || (0 == cnt))
+  {
+    return throw_err(err_null_string);
+  }
+  if ((err = lut_cache_path(str_lut_file, str_cache_file, STR_MAX)) < 0)
+  {
+    return err;
+  }
+#ifndef _WIN32
+  if ((size_t) snprintf(str_tmp_file, STR_MAX, "%s.%ld%s", str_cache_file,
+                        (long) getpid(), LUT_CACHE_TMP_SUFFIX) >= STR_MAX)
+#else
+  if ((size_t) snprintf(str_tmp_file, STR_MAX, "%s.%ld%s", str_cache_file,
+                        (long) _getpid(), LUT_CACHE_TMP_SUFFIX) >= STR_MAX)
+#endif
+  {
+    return throw_err(err_insufficient_buffer_size);
+  }
+
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, LUT_CACHE_MAGIC, sizeof(header.magic));
+  header.version = LUT_CACHE_VERSION;
+  header.record_size = (uint32_t) sizeof(lutData);
+  if (((err = stat_lut_source(str_lut_file, &header.source)) < 0) ||
+      ((err = hash_lut_source(str_lut_file, &header.source)) < 0))
+  {
+    return err;
+  }
+  header.record_cnt = cnt;
+  header.record_offset = sizeof(lutCacheHeader);
+  header.block_index_offset = header.record_offset + (uint64_t) cnt * sizeof(lutData);
+
+  if (NULL == (fp = fopen(str_tmp_file, "wb")))
+  {
+    return throw_err(err_file_not_accessible);
+  }
+  b_ok = (1 == fwrite(&header, sizeof(header), 1, fp));
+  for (i = 0; (i < cnt) && b_ok; i++)
+  {
+    b_ok = (1 == fwrite(p_records[i], sizeof(lutData), 1, fp));
+  }
+  if (b_ok)
+  {
+    b_ok = (cnt == fwrite(p_block_index, sizeof(unsigned int), cnt, fp));
+  }
+  if ((0 != fclose(fp)) || !b_ok)
+  {
+    remove(str_tmp_file);
+    return throw_err(err_file_not_accessible);
+  }
+#ifdef _WIN32
+  /* rename does not replace an existing file */
+  remove(str_cache_file);
+#endif
+  if (0 != rename(str_tmp_file, str_cache_file))
+  {
+    remove(str_tmp_file);
+    return throw_err(err_file_not_accessible);
+  }
+  return 0;
+}
@@ -0,0 +1,136 @@
+/*------------------------------------------------------
+**
+** File:      lut_cache.h
+** Author:    Eric Lu
+** Created:   2026-10-19
+**
+** Copyright ©2012 Toronto Transit Commission
+**
+**
+** Function Description
+** -----------------------------------------------------
+**
+** compiled lookup table image. the parsed lookup table records and the
+** block index are saved next to the csv lookup table and mapped into
+** memory on the next start instead of parsing the csv again. the image
+** records the size, modification time and content hash of the csv it was
+** compiled from and is rebuilt when the size or content changes. the csv
+** is only hashed when its modification time differs or on request.
+**
+** -----------------------------------------------------
+** Revision History
+**
+** 19 OCT 2026: Rev 1.0 - erilu
+**                      - Initial Design
+**
+** Inputs:
+** Configuration Files:
+**  config\atc_block_lut.csv
+**  config\atc_block_lut.bin
+**
+** Outputs:
+** Configuration Files:
+**  config\atc_block_lut.bin
+**
+** ----------------------------------------------------
+*/
+
+#ifndef ATC_SPEED_PROFILE_LUT_CACHE_H
+#define ATC_SPEED_PROFILE_LUT_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "atc_speed_profile_tool.h"
+
+/*
+** Constants
+** -----------------------------------------------------
+*/
+
+/* extension of the compiled image, replaces the .csv of the lookup table */
+#define LUT_CACHE_EXTENSION       ".bin"
+/* image layout version, images of another version are rebuilt */
+#define LUT_CACHE_VERSION         1
+
+/*
+** Structures
+** -----------------------------------------------------
+*/
+
+/* mapped image, opaque to the callers */
+typedef struct lut_cache_t lutCache;
+
+/*
+** Function Prototypes
+** -----------------------------------------------------
+*/
+
+/** @brief  get the path of the compiled image of a lookup table
+ *  @param  *str_lut_file    lookup table csv path
+ *  @param  *str_cache_file  image path output
+ *  @param  size             size of str_cache_file
+ *  @return 0
+ *          err_null_string
+ *          err_insufficient_buffer_size
+ */
+int
+lut_cache_path(const char *str_lut_file, char *str_cache_file, size_t size);
+
+/** @brief  map the compiled image of a lookup table. the csv is hashed
+ *          only when its modification time differs from the image, or
+ *          when asked to verify
+ *  @param  *str_lut_file  lookup table csv path
+ *  @param  b_verify       hash the csv even if size and time match
+ *  @return NULL           no image, or compiled from another csv content,
+ *                         version or build, or a damaged block index
+ *          pointer to the mapped image, released with lut_cache_close
+ */
+lutCache *
+lut_cache_open(const char *str_lut_file, bool b_verify);
+
+/** @brief  get the records of a mapped image, in lookup table order
+ *  @param  *cache  mapped image
+ *  @param  *cnt    number of records output
+ *  @return pointer to the first record, read only
+ */
+const lutData *
+lut_cache_records(const lutCache *cache, unsigned int *cnt);
+
+/** @brief  get the block index of a mapped image
+ *  @param  *cache  mapped image
+ *  @return record positions sorted by block, then position
+ */
+const unsigned int *
+lut_cache_block_index(const lutCache *cache);
+
+/** @brief  get the size of a mapped image
+ *  @param  *cache  mapped image
+ *  @return bytes
+ */
+size_t
+lut_cache_size(const lutCache *cache);
+
+/** @brief  unmap an image
+ *  @param  *cache  mapped image, NULL is ignored
+ *  @return none
+ */
+void
+lut_cache_close(lutCache *cache);
+
+/** @brief  compile a parsed lookup table into its image, the image is
+ *          written to a temporary file and renamed so a reader never maps
+ *          a partial image
+ *  @param  *str_lut_file    lookup table csv path the records were read from
+ *  @param  **p_records      records in lookup table order
+ *  @param  *p_block_index   record positions sorted by block, then position
+ *  @param  cnt              number of records
+ *  @return 0
+ *          err_null_string
+ *          err_insufficient_buffer_size
+ *          err_file_not_accessible
+ */
+int
+lut_cache_write(const char *str_lut_file, lutData *const *p_records,
+                const unsigned int *p_block_index, unsigned int cnt);
+
+#endif
@@ -0,0 +1,433 @@
+/*------------------------------------------------------
+**
+** File:      lut_embed.c
+** Author:    Eric Lu
+** Created:   2026-10-19
+**
+** Copyright ©2012 Toronto Transit Commission
+**
+**
+** Function Description
+** -----------------------------------------------------
+**
+** lookup table compiled into the binary, see lut_embed.h
+**
+** -----------------------------------------------------
+** Revision History
+**
+** 19 OCT 2026: Rev 1.0 - erilu
+**                      - Initial Design
+**
+** Inputs:
+** Configuration Files:
+**  config\atc_block_lut.csv
+**
+** Outputs:
+** Generated Source:
+**  atc_block_lut_embedded.c
+**
+** ----------------------------------------------------
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include "atc_speed_profile_tool.h"
+#include "lut_embed.h"
+
+/*
+** Constants
+** -----------------------------------------------------
+*/
+
+/* FNV-1a 32 bit */
+#define LUT_EMBED_FNV_OFFSET      0x811C9DC5u
+#define LUT_EMBED_FNV_PRIME       0x01000193u
+
+/*
+** Structures
+** -----------------------------------------------------
+*/
+
+/* hash bucket of the perfect hash while it is built */
+typedef struct lut_embed_bucket_t
+{
+  unsigned int id;
+  /* keys of the bucket, from first_key in keys_by_bucket */
+  unsigned int key_cnt;
+  unsigned int first_key;
+} lutEmbedBucket;
+
+/*
+** Source Code
+** -----------------------------------------------------
+*/
+
+/** @brief  hash of a block for the perfect hash
+ *  @param  *str_block  block
+ *  @param  seed        0 for the bucket, the bucket seed for the slot
+ *  @return hash
+ */
+uint32_t
+lut_embed_hash(const char *str_block, uint32_t seed)
+{
+  uint32_t hash = (0 == seed) ? LUT_EMBED_FNV_OFFSET : seed;
+  const unsigned char *p = (const unsigned char *) str_block;
+
+  while ('\0' != *p)
+  {
+    hash = (hash * LUT_EMBED_FNV_PRIME) ^ *p++;
+  }
+  return hash;
+}
+
+/** @brief  find the first record of a block in lookup table order
+ *  @param  *lut        generated table
+ *  @param  *str_block  block
+ *  @return NULL        block not in the table
+ *          lookup record
+ */
+const lutData *
+lut_embed_find(const lutEmbedded *lut, const char *str_block)
+{
+  const lutData *p_data = NULL;
+  int32_t seed = 0;
+  unsigned int slot = 0;
+
+  if ((NULL == lut) || (0 == lut->slot_cnt))
+  {
+    return NULL;
+  }
+  seed = lut->p_seeds[lut_embed_hash(str_block, 0) % lut->seed_cnt];
+  if (seed < 0)
+  {
+    slot = (unsigned int) (-seed - 1);
+  }
+  else
+  {
+    slot = lut_embed_hash(str_block, (uint32_t) seed) % lut->slot_cnt;
+  }
+  /* a block not in the table lands on the slot of another one */
+  p_data = &lut->p_records[lut->p_slots[slot]];
+  return (0 == strcmp(p_data->str_block, str_block)) ? p_data : NULL;
+}
+
+/** @brief  order buckets by descending number of keys
+ *  @param  *a  lutEmbedBucket
+ *  @param  *b  lutEmbedBucket
+ *  @return <0, 0, >0
+ */
+static int
+bucket_comparator(const void *a, const void *b)
+{
+  const lutEmbedBucket *p_a = (const lutEmbedBucket *) a;
+  const lutEmbedBucket *p_b = (const lutEmbedBucket *) b;
+
+  if (p_a->key_cnt != p_b->key_cnt)
+  {
+    return (p_a->key_cnt > p_b->key_cnt) ? -1 : 1;
+  }
+  return (p_a->id < p_b->id) ? -1 : (p_a->id > p_b->id);
+}
+
+/** @brief  build a minimal perfect hash (hash and displace) on the keys
+ *  @param  **p_keys      distinct blocks
+ *  @param  key_cnt       number of keys, also the number of seeds and slots
+ *  @param  *p_seeds      bucket seeds output, key_cnt entries
+ *  @param  *p_slot_keys  key of each slot output, key_cnt entries
+ *  @return 0
+ *          err_list_append_failed        not enough memory
+ *          err_maximum_number_exceeded   no seed found for a bucket
+ */
+static int
+build_perfect_hash(const char **p_keys, unsigned int key_cnt,
+                   int32_t *p_seeds, unsigned int *p_slot_keys)
+{
+  lutEmbedBucket *p_buckets = NULL;
+  unsigned int *p_keys_by_bucket = NULL;
+  unsigned int *p_try_slots = NULL;
+  unsigned int *p_fill = NULL;
+  bool *p_used = NULL;
+  lutEmbedBucket *p_bucket = NULL;
+  unsigned int free_slot = 0;
+  unsigned int b = 0;
+  unsigned int i = 0;
+  unsigned int j = 0;
+  uint32_t seed = 0;
+  bool b_placed = false;
+  int err = 0;
+
+  p_buckets = calloc(key_cnt, sizeof(lutEmbedBucket));
+  p_keys_by_bucket = malloc(key_cnt * sizeof(unsigned int));
+  p_try_slots = malloc(key_cnt * sizeof(unsigned int));
+  p_fill = calloc(key_cnt, sizeof(unsigned int));
+  p_used = calloc(key_cnt, sizeof(bool));
+  if ((NULL == p_buckets) || (NULL == p_keys_by_bucket) || (NULL == p_try_slots) ||
+      (NULL == p_fill) || (NULL == p_used))
+  {
+    err = throw_err(err_list_append_failed);
+  }
+
+  /* first level, keys grouped by bucket */
+  for (i = 0; (i < key_cnt) && (err >= 0); i++)
+  {
+    p_buckets[i].id = i;
+    p_buckets[lut_embed_hash(p_keys[i], 0) % key_cnt].key_cnt++;
+  }
+  for (b = 1; (b < key_cnt) && (err >= 0); b++)
+  {
+    p_buckets[b].first_key = p_buckets[b - 1].first_key + p_buckets[b - 1].key_cnt;
+  }
+  for (i = 0; (i < key_cnt) && (err >= 0); i++)
+  {
+    b = lut_embed_hash(p_keys[i], 0) % key_cnt;
+    p_keys_by_bucket[p_buckets[b].first_key + p_fill[b]++] = i;
+  }
+  if (err >= 0)
+  {
+    qsort(p_buckets, key_cnt, sizeof(lutEmbedBucket), bucket_comparator);
+  }
+
+  /* second level, the fullest buckets first look for a seed placing all
+  ** their keys in free slots */
+  for (b = 0; (b < key_cnt) && (err >= 0); b++)
+  {
+    p_bucket = &p_buckets[b];
+    if (p_bucket->key_cnt <= 1)
+    {
+      break;
+    }
+    b_placed = false;
+    for (seed = 1; (seed < LUT_EMBED_MAX_SEED) && !b_placed; seed++)
+    {
+      b_placed = true;
+      for (i = 0; (i < p_bucket->key_cnt) && b_placed; i++)
+      {
+        p_try_slots[i] = lut_embed_hash(p_keys[p_keys_by_bucket[p_bucket->first_key + i]], seed) % key_cnt;
+        b_placed = !p_used[p_try_slots[i]];
+        for (j = 0; (j < i) && b_placed; j++)
+        {
+          b_placed = (p_try_slots[i] != p_try_slots[j]);
+        }
+      }
+    }
+    if (!b_placed)
+    {
+      err = throw_err(err_maximum_number_exceeded);
+      break;
+    }
+    p_seeds[p_bucket->id] = (int32_t) (seed - 1);
+    for (i = 0; i < p_bucket->key_cnt; i++)
+    {
+      p_used[p_try_slots[i]] = true;
+      p_slot_keys[p_try_slots[i]] = p_keys_by_bucket[p_bucket->first_key + i];
+    }
+  }
+
+  /* buckets of one key take the remaining slots directly, empty buckets
+  ** keep seed 0 and never match */
+  for (; (b < key_cnt) && (err >= 0); b++)
+  {
+    p_bucket = &p_buckets[b];
+    if (0 == p_bucket->key_cnt)
+    {
+      p_seeds[p_bucket->id] = 0;
+      continue;
+    }
+    while (p_used[free_slot])
+    {
+      free_slot++;
+    }
+    p_used[free_slot] = true;
+    p_slot_keys[free_slot] = p_keys_by_bucket[p_bucket->first_key];
+    p_seeds[p_bucket->id] = -(int32_t) free_slot - 1;
+  }
+
+  free(p_buckets);
+  free(p_keys_by_bucket);
+  free(p_try_slots);
+  free(p_fill);
+  free(p_used);
+  return err;
+}
+
+/** @brief  write a string as a C string literal
+ *  @param  *fp   source output
+ *  @param  *str  string
+ *  @return none
+ */
+static void
+write_c_string(FILE *fp, const char *str)
+{
+  const unsigned char *p = (const unsigned char *) str;
+
+  fputc('"', fp);
+  for (; '\0' != *p; p++)
+  {
+    if (('"' == *p) || ('\\' == *p))
+    {
+      fprintf(fp, "\\%c", *p);
+    }
+    else if ((*p < 0x20) || (*p >= 0x7F))
+    {
+      fprintf(fp, "\\%03o", *p);
+    }
+    else
+    {
+      fputc(*p, fp);
+    }
+  }
+  fputc('"', fp);
+}
+
+/** @brief  write one string field of a record initializer
+ *  @param  *fp        source output
+ *  @param  *str_name  field name
+ *  @param  *str       field value
+ *  @return none
+ */
+static void
+write_string_field(FILE *fp, const char *str_name, const char *str)
+{
+  fprintf(fp, "    .%s = ", str_name);
+  write_c_string(fp, str);
+  fprintf(fp, ",\n");
+}
+
+/** @brief  write the C source of a lookup table
+ *  @param  *fp             source output
+ *  @param  *str_source     csv the records were read from
+ *  @param  **p_records     records in lookup table order
+ *  @param  *p_block_index  record positions sorted by block, then position
+ *  @param  cnt             number of records
+ *  @return 0
+ *          err_null_string
+ *          err_lut_is_empty
+ *          err_list_append_failed
+ *          err_maximum_number_exceeded
+ *          err_file_not_accessible
+ */
+int
+lut_embed_write_source(FILE *fp, const char *str_source, lutData *const *p_records,
+                       const unsigned int *p_block_index, unsigned int cnt)
+{
+  const char **p_keys = NULL;
+  unsigned int *p_key_records = NULL;
+  unsigned int *p_slot_keys = NULL;
+  int32_t *p_seeds = NULL;
+  const lutData *p_data = NULL;
+  unsigned int key_cnt = 0;
+  unsigned int i = 0;
+  int err = 0;
+
+  if ((NULL == fp) || (NULL == str_source) || (NULL == p_records) || (NULL == p_block_index))
+  {
+    return throw_err(err_null_string);
+  }
+  if (0 == cnt)
+  {
+    return throw_err(err_lut_is_empty);
+  }
+  p_keys = malloc(cnt * sizeof(const char *));
+  p_key_records = malloc(cnt * sizeof(unsigned int));
+  p_slot_keys = malloc(cnt * sizeof(unsigned int));
+  p_seeds = malloc(cnt * sizeof(int32_t));
+  if ((NULL == p_keys) || (NULL == p_key_records) || (NULL == p_slot_keys) || (NULL == p_seeds))
+  {
+    err = throw_err(err_list_append_failed);
+  }
+
+  /* one key per block, its first record in lookup table order */
+  for (i = 0; (i < cnt) && (err >= 0); i++)
+  {
+    p_data = p_records[p_block_index[i]];
+    if ((0 == key_cnt) || (0 != strcmp(p_keys[key_cnt - 1], p_data->str_block)))
+    {
+      p_keys[key_cnt] = p_data->str_block;
+      p_key_records[key_cnt++] = p_block_index[i];
+    }
+  }
+  if (err >= 0)
+  {
+    err = build_perfect_hash(p_keys, key_cnt, p_seeds, p_slot_keys);
+  }
+
+  if (err >= 0)
+  {
+    fprintf(fp, "/* generated by atc_speed_profile_lutgen from ");
+    write_c_string(fp, str_source);
+    fprintf(fp, ", do not edit */\n\n");
+    fprintf(fp, "#include \"lut_embed.h\"\n\n");
+
+    fprintf(fp, "static const lutData k_records[%u] =\n{\n", cnt);
+    for (i = 0; i < cnt; i++)
+    {
+      p_data = p_records[i];
+      fprintf(fp, "  {\n");
+      fprintf(fp, "    .id = %" PRIu64 "u,\n", p_data->id);
+      write_string_field(fp, "sorting_str", p_data->sorting_str);
+      write_string_field(fp, "str_id", p_data->str_id);
+      write_string_field(fp, "str_location", p_data->str_location);
+      write_string_field(fp, "str_block", p_data->str_block);
+      write_string_field(fp, "str_direction", p_data->str_direction);
+      write_string_field(fp, "str_direction_code", p_data->str_direction_code);
+      write_string_field(fp, "str_direction_num", p_data->str_direction_num);
+      write_string_field(fp, "str_platform", p_data->str_platform);
+      write_string_field(fp, "str_station_code", p_data->str_station_code);
+      write_string_field(fp, "str_block_length", p_data->str_block_length);
+      write_string_field(fp, "str_from_station", p_data->str_from_station);
+      write_string_field(fp, "str_to_station", p_data->str_to_station);
+      fprintf(fp, "    .direction = %d,\n", p_data->direction);
+      fprintf(fp, "    .block_length = %.17g,\n", p_data->block_length);
+      fprintf(fp, "    .is_platform = %s\n", p_data->is_platform ? "true" : "false");
+      fprintf(fp, "  }%s\n", (i + 1 < cnt) ? "," : "");
+    }
+    fprintf(fp, "};\n\n");
+
+    fprintf(fp, "static const unsigned int k_block_index[%u] =\n{", cnt);
+    for (i = 0; i < cnt; i++)
+    {
+      fprintf(fp, "%s%u%s", (0 == i % 12) ? "\n  " : " ", p_block_index[i], (i + 1 < cnt) ? "," : "");
+    }
+    fprintf(fp, "\n};\n\n");
+
+    fprintf(fp, "static const int32_t k_seeds[%u] =\n{", key_cnt);
+    for (i = 0; i < key_cnt; i++)
+    {
+      fprintf(fp, "%s%d%s", (0 == i % 12) ? "\n  " : " ", (int) p_seeds[i], (i + 1 < key_cnt) ? "," : "");
+    }
+    fprintf(fp, "\n};\n\n");
+
+    fprintf(fp, "static const unsigned int k_slots[%u] =\n{", key_cnt);
+    for (i = 0; i < key_cnt; i++)
+    {
+      fprintf(fp, "%s%u%s", (0 == i % 12) ? "\n  " : " ", p_key_records[p_slot_keys[i]], (i + 1 < key_cnt) ? "," : "");
+    }
+    fprintf(fp, "\n};\n\n");
+
+    fprintf(fp, "const lutEmbedded lut_embedded_table =\n{\n");
+    fprintf(fp, "  .str_source = ");
+    write_c_string(fp, str_source);
+    fprintf(fp, ",\n");
+    fprintf(fp, "  .p_records = k_records,\n");
+    fprintf(fp, "  .record_cnt = %u,\n", cnt);
+    fprintf(fp, "  .p_block_index = k_block_index,\n");
+    fprintf(fp, "  .p_seeds = k_seeds,\n");
+    fprintf(fp, "  .seed_cnt = %u,\n", key_cnt);
+    fprintf(fp, "  .p_slots = k_slots,\n");
+    fprintf(fp, "  .slot_cnt = %u\n", key_cnt);
+    fprintf(fp, "};\n");
+    if (ferror(fp))
+    {
+      err = throw_err(err_file_not_accessible);
+    }
+  }
+
+  free(p_keys);
+  free(p_key_records);
+  free(p_slot_keys);
+  free(p_seeds);
+  return err;
+}
@@ -0,0 +1,125 @@
+/*------------------------------------------------------
+**
+** File:      lut_embed.h
+** Author:    Eric Lu
+** Created:   2026-10-19
+**
+** Copyright ©2012 Toronto Transit Commission
+**
+**
+** Function Description
+** -----------------------------------------------------
+**
+** lookup table compiled into the binary for fixed deployments. the
+** generator atc_speed_profile_lutgen turns the csv lookup table into C
+** source holding the records, the block index and a minimal perfect hash
+** on the block. built with ATC_EMBEDDED_LUT defined and the generated
+** source added, the tool uses that table unless a lookup table csv is
+** given on the command line:
+**
+**   atc_speed_profile_lutgen --lut config\atc_block_lut.csv
+**   gcc -DATC_EMBEDDED_LUT ... atc_block_lut_embedded.c
+**
+** -----------------------------------------------------
+** Revision History
+**
+** 19 OCT 2026: Rev 1.0 - erilu
+**                      - Initial Design
+**
+** Inputs:
+** Configuration Files:
+**  config\atc_block_lut.csv
+**
+** Outputs:
+** Generated Source:
+**  atc_block_lut_embedded.c
+**
+** ----------------------------------------------------
+*/
+
+#ifndef ATC_SPEED_PROFILE_LUT_EMBED_H
+#define ATC_SPEED_PROFILE_LUT_EMBED_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "atc_speed_profile_tool.h"
+
+/*
+** Constants
+** -----------------------------------------------------
+*/
+
+/* generated source written by default */
+#define LUT_EMBED_SOURCE_FILE     "atc_block_lut_embedded.c"
+/* displacement seeds tried per hash bucket before giving up */
+#define LUT_EMBED_MAX_SEED        (1 << 24)
+
+/*
+** Structures
+** -----------------------------------------------------
+*/
+
+/* lookup table generated into C source, read only */
+typedef struct lut_embedded_t
+{
+  /* csv the table was generated from */
+  const char *str_source;
+  /* records in lookup table order */
+  const lutData *p_records;
+  unsigned int record_cnt;
+  /* record positions sorted by block, then position */
+  const unsigned int *p_block_index;
+  /* perfect hash on the block: a bucket seed picks the slot of each key,
+  ** a negative seed -s - 1 is the slot of a bucket holding one key */
+  const int32_t *p_seeds;
+  unsigned int seed_cnt;
+  /* position of the first record of each block, one slot per block */
+  const unsigned int *p_slots;
+  unsigned int slot_cnt;
+} lutEmbedded;
+
+#ifdef ATC_EMBEDDED_LUT
+/* table of the generated source */
+extern const lutEmbedded lut_embedded_table;
+#endif
+
+/*
+** Function Prototypes
+** -----------------------------------------------------
+*/
+
+/** @brief  hash of a block for the perfect hash
+ *  @param  *str_block  block
+ *  @param  seed        0 for the bucket, the bucket seed for the slot
+ *  @return hash
+ */
+uint32_t
+lut_embed_hash(const char *str_block, uint32_t seed);
+
+/** @brief  find the first record of a block in lookup table order
+ *  @param  *lut        generated table
+ *  @param  *str_block  block
+ *  @return NULL        block not in the table
+ *          lookup record
+ */
+const lutData *
+lut_embed_find(const lutEmbedded *lut, const char *str_block);
+
+/** @brief  write the C source of a lookup table
+ *  @param  *fp             source output
+ *  @param  *str_source     csv the records were read from
+ *  @param  **p_records     records in lookup table order
+ *  @param  *p_block_index  record positions sorted by block, then position
+ *  @param  cnt             number of records
+ *  @return 0
+ *          err_null_string
+ *          err_lut_is_empty
+ *          err_list_append_failed        not enough memory
+ *          err_maximum_number_exceeded   no perfect hash found
+ *          err_file_not_accessible       source cannot be written
+ */
+int
+lut_embed_write_source(FILE *fp, const char *str_source, lutData *const *p_records,
+                       const unsigned int *p_block_index, unsigned int cnt);
+
+#endif
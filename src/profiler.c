@@ -0,0 +1,378 @@
+/*------------------------------------------------------
+**
+** File:      profiler.c
+** Author:    Eric Lu
+** Created:   2026-10-19
+**
+** Copyright ©2012 Toronto Transit Commission
+**
+**
+** Function Description
+** -----------------------------------------------------
+**
+** per stage timing and throughput report for atc_speed_profile_tool,
+** enabled with --profile
+**
+** -----------------------------------------------------
+** Revision History
+**
+** 19 OCT 2026: Rev 1.0 - erilu
+**                      - Initial Design
+**
+** Inputs:
+** Stage begin/end events and row/byte counters from main()
+**
+** Outputs:
+** Summary table on the screen, optional json report file
+**
+** ----------------------------------------------------
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <time.h>
+#ifndef _WIN32
+#   include <sys/time.h>
+#   include <sys/resource.h>
+#else
+#   include <windows.h>
+#   include <psapi.h>
+#endif
+#include "errorhandler.h"
+#include "profiler.h"
+
+/*
+** Variables
+** -----------------------------------------------------
+*/
+
+/* stage names, in enum profile_stage order */
+static const char *k_stage_names[k_stage_cnt] =
+{
+  "lut_import",
+  "data_import",
+  "sort",
+  "preprocess",
+  "calculate",
+  "export"
+};
+
+/* measurements collected so far */
+static stageProfile stage_profiles[k_stage_cnt];
+static bool b_profile_enabled = false;
+
+/*
+** Source Code
+** -----------------------------------------------------
+*/
+
+/** @brief  monotonic wall clock
+ *  @return seconds since an arbitrary fixed point
+ */
+double
+profile_wall_time()
+{
+#ifndef _WIN32
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+#else
+  LARGE_INTEGER freq;
+  LARGE_INTEGER cnt;
+
+  QueryPerformanceFrequency(&freq);
+  QueryPerformanceCounter(&cnt);
+  return (double) cnt.QuadPart / (double) freq.QuadPart;
+#endif
+}
+
+/** @brief  cpu time consumed by the process, user and system
+ *  @return seconds
+ */
+double
+profile_cpu_time()
+{
+#ifndef _WIN32
+  struct rusage usage;
+
+  getrusage(RUSAGE_SELF, &usage);
+  return (double) usage.ru_utime.tv_sec + (double) usage.ru_utime.tv_usec / 1e6 +
+         (double) usage.ru_stime.tv_sec + (double) usage.ru_stime.tv_usec / 1e6;
+#else
+  FILETIME t_create, t_exit, t_kernel, t_user;
+  ULARGE_INTEGER kernel, user;
+
+  GetProcessTimes(GetCurrentProcess(), &t_create, &t_exit, &t_kernel, &t_user);
+  kernel.LowPart = t_kernel.dwLowDateTime;
+  kernel.HighPart = t_kernel.dwHighDateTime;
+  user.LowPart = t_user.dwLowDateTime;
+  user.HighPart = t_user.dwHighDateTime;
+  /* 100 ns units */
+  return (double) (kernel.QuadPart + user.QuadPart) / 1e7;
+#endif
+}
+
+/** @brief  peak resident set size of the process
+ *  @return kilobytes, 0 if not available
+ */
+uint64_t
+profile_peak_rss_kb()
+{
+#ifndef _WIN32
+  struct rusage usage;
+
+  getrusage(RUSAGE_SELF, &usage);
+#   ifdef __APPLE__
+  /* bytes on macOS */
+  return (uint64_t) usage.ru_maxrss / 1024;
+#   else
+  return (uint64_t) usage.ru_maxrss;
+#   endif
+#else
+  PROCESS_MEMORY_COUNTERS pmc;
+
+  if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+  {
+    return (uint64_t) pmc.PeakWorkingSetSize / 1024;
+  }
+  return 0;
+#endif
+}
+
+/** @brief  enable or disable stage measurements, clears the report
+ *  @param  b_enabled  true to measure
+ *  @return none
+ */
+void
+profile_enable(bool b_enabled)
+{
+  memset(stage_profiles, 0, sizeof(stage_profiles));
+  b_profile_enabled = b_enabled;
+}
+
+/** @brief  check if stage measurements are enabled
+ *  @return true if enabled
+ */
+bool
+profile_is_enabled()
+{
+  return b_profile_enabled;
+}
+
+/** @brief  mark the start of a stage
+ *  @param  stage  enum profile_stage
+ *  @return none
+ */
+void
+profile_stage_begin(int stage)
+{
+  if ((!b_profile_enabled) || (stage < 0) || (stage >= k_stage_cnt))
+  {
+    return;
+  }
+  stage_profiles[stage].wall_start_s = profile_wall_time();
+  stage_profiles[stage].cpu_start_s = profile_cpu_time();
+}
+
+/** @brief  mark the end of a stage and record its counters, repeated
+ *          begin/end pairs of the same stage accumulate
+ *  @param  stage          enum profile_stage
+ *  @param  rows_in        records consumed by the stage
+ *  @param  rows_out       records produced by the stage
+ *  @param  bytes_read     bytes read from files by the stage
+ *  @param  bytes_written  bytes written to files by the stage
+ *  @return none
+ */
+void
+profile_stage_end(int stage,
+                  uint64_t rows_in,
+                  uint64_t rows_out,
+                  uint64_t bytes_read,
+                  uint64_t bytes_written)
+{
+  stageProfile *p_stage = NULL;
+
+  if ((!b_profile_enabled) || (stage < 0) || (stage >= k_stage_cnt))
+  {
+    return;
+  }
+  p_stage = &stage_profiles[stage];
+  p_stage->wall_s += profile_wall_time() - p_stage->wall_start_s;
+  p_stage->cpu_s += profile_cpu_time() - p_stage->cpu_start_s;
+  p_stage->rows_in += rows_in;
+  p_stage->rows_out += rows_out;
+  p_stage->bytes_read += bytes_read;
+  p_stage->bytes_written += bytes_written;
+  p_stage->peak_rss_kb = profile_peak_rss_kb();
+  p_stage->b_measured = true;
+}
+
+/** @brief  get the measurements of a stage
+ *  @param  stage  enum profile_stage
+ *  @return NULL   stage is not valid
+ *          pointer to the stage measurements
+ */
+const stageProfile *
+profile_get_stage(int stage)
+{
+  if ((stage < 0) || (stage >= k_stage_cnt))
+  {
+    return NULL;
+  }
+  return &stage_profiles[stage];
+}
+
+/** @brief  get the name of a stage
+ *  @param  stage  enum profile_stage
+ *  @return stage name, "unknown" if the stage is not valid
+ */
+const char *
+profile_stage_name(int stage)
+{
+  if ((stage < 0) || (stage >= k_stage_cnt))
+  {
+    return "unknown";
+  }
+  return k_stage_names[stage];
+}
+
+/** @brief  rows per second of a stage, based on rows consumed
+ *  @param  *p_stage  stage measurements
+ *  @return rows per second, 0 if the stage took no measurable time
+ */
+static double
+stage_rows_per_s(const stageProfile *p_stage)
+{
+  if (p_stage->wall_s <= 0)
+  {
+    return 0;
+  }
+  return (double) p_stage->rows_in / p_stage->wall_s;
+}
+
+/** @brief  print the stage summary table
+ *  @param  *fp  output stream
+ *  @return none
+ */
+void
+profile_print(FILE *fp)
+{
+  const stageProfile *p_stage = NULL;
+  double wall_total = 0;
+  double cpu_total = 0;
+  int i = 0;
+
+  fprintf(fp, "[%6s][%s]\n", "INFO", "Stage Profile");
+  fprintf
+  (
+    fp,
+    "[%6s][%-11s][%10s][%10s][%12s][%12s][%12s][%14s][%14s][%12s]\n",
+    "INFO",
+    "STAGE",
+    "WALL_S",
+    "CPU_S",
+    "ROWS_IN",
+    "ROWS_OUT",
+    "ROWS/S",
+    "BYTES_READ",
+    "BYTES_WRITTEN",
+    "PEAK_RSS_KB"
+  );
+  for (i = 0; i < k_stage_cnt; i++)
+  {
+    p_stage = &stage_profiles[i];
+    if (!p_stage->b_measured)
+    {
+      continue;
+    }
+    wall_total += p_stage->wall_s;
+    cpu_total += p_stage->cpu_s;
+    fprintf
+    (
+      fp,
+      "[%6s][%-11s][%10.3f][%10.3f][%12" PRIu64 "][%12" PRIu64 "][%12.0f][%14" PRIu64 "][%14" PRIu64 "][%12" PRIu64 "]\n",
+      "INFO",
+      k_stage_names[i],
+      p_stage->wall_s,
+      p_stage->cpu_s,
+      p_stage->rows_in,
+      p_stage->rows_out,
+      stage_rows_per_s(p_stage),
+      p_stage->bytes_read,
+      p_stage->bytes_written,
+      p_stage->peak_rss_kb
+    );
+  }
+  fprintf
+  (
+    fp,
+    "[%6s][%-11s][%10.3f][%10.3f][%12s][%12s][%12s][%14s][%14s][%12" PRIu64 "]\n",
+    "INFO",
+    "total",
+    wall_total,
+    cpu_total,
+    "",
+    "",
+    "",
+    "",
+    "",
+    profile_peak_rss_kb()
+  );
+}
+
+/** @brief  write the stage measurements as json
+ *  @param  *str_file  json file path
+ *  @return 0
+ *          err_file_not_accessible
+ */
+int
+profile_write_json(const char *str_file)
+{
+  FILE *fp_out = NULL;
+  const stageProfile *p_stage = NULL;
+  bool b_first = true;
+  int i = 0;
+
+  if ((NULL == str_file) || (NULL == (fp_out = fopen(str_file, "w"))))
+  {
+    return throw_err(err_file_not_accessible);
+  }
+
+  fprintf(fp_out, "{\n  \"stages\": [\n");
+  for (i = 0; i < k_stage_cnt; i++)
+  {
+    p_stage = &stage_profiles[i];
+    if (!p_stage->b_measured)
+    {
+      continue;
+    }
+    fprintf
+    (
+      fp_out,
+      "%s    {\"stage\": \"%s\", \"wall_s\": %.6f, \"cpu_s\": %.6f, "
+      "\"rows_in\": %" PRIu64 ", \"rows_out\": %" PRIu64 ", "
+      "\"rows_per_s\": %.1f, \"bytes_read\": %" PRIu64 ", "
+      "\"bytes_written\": %" PRIu64 ", \"peak_rss_kb\": %" PRIu64 "}",
+      (b_first) ? "" : ",\n",
+      k_stage_names[i],
+      p_stage->wall_s,
+      p_stage->cpu_s,
+      p_stage->rows_in,
+      p_stage->rows_out,
+      stage_rows_per_s(p_stage),
+      p_stage->bytes_read,
+      p_stage->bytes_written,
+      p_stage->peak_rss_kb
+    );
+    b_first = false;
+  }
+  fprintf(fp_out, "\n  ],\n  \"peak_rss_kb\": %" PRIu64 "\n}\n", profile_peak_rss_kb());
+
+  if (0 != fclose(fp_out))
+  {
+    return throw_err(err_file_not_accessible);
+  }
+  return 0;
+}
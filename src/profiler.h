@@ -0,0 +1,171 @@
+/*------------------------------------------------------
+**
+** File:      profiler.h
+** Author:    Eric Lu
+** Created:   2026-10-19
+**
+** Copyright ©2012 Toronto Transit Commission
+**
+**
+** Function Description
+** -----------------------------------------------------
+**
+** per stage timing and throughput report for atc_speed_profile_tool,
+** enabled with --profile
+**
+** -----------------------------------------------------
+** Revision History
+**
+** 19 OCT 2026: Rev 1.0 - erilu
+**                      - Initial Design
+**
+** Inputs:
+** Stage begin/end events and row/byte counters from main()
+**
+** Outputs:
+** Summary table on the screen, optional json report file
+**
+** ----------------------------------------------------
+*/
+
+#ifndef ATC_SPEED_PROFILE_PROFILER_H
+#define ATC_SPEED_PROFILE_PROFILER_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+** Constants
+** -----------------------------------------------------
+*/
+
+/* processing stages of a run, in execution order */
+enum profile_stage
+{
+  k_stage_lut_import = 0,
+  k_stage_data_import,
+  k_stage_sort,
+  k_stage_preprocess,
+  k_stage_calculate,
+  k_stage_export,
+
+  /* number of stages */
+  k_stage_cnt
+};
+
+/*
+** Structures
+** -----------------------------------------------------
+*/
+
+/* measurements of one stage */
+typedef struct stage_profile_t
+{
+  bool b_measured;
+  /* monotonic wall clock time in seconds */
+  double wall_s;
+  /* user + system cpu time in seconds */
+  double cpu_s;
+  uint64_t rows_in;
+  uint64_t rows_out;
+  uint64_t bytes_read;
+  uint64_t bytes_written;
+  /* peak resident set size of the process at the end of the stage */
+  uint64_t peak_rss_kb;
+
+  /* start marks, valid between begin and end */
+  double wall_start_s;
+  double cpu_start_s;
+} stageProfile;
+
+/*
+** Function Prototypes
+** -----------------------------------------------------
+*/
+
+/** @brief  monotonic wall clock
+ *  @return seconds since an arbitrary fixed point
+ */
+double
+profile_wall_time();
+
+/** @brief  cpu time consumed by the process, user and system
+ *  @return seconds
+ */
+double
+profile_cpu_time();
+
+/** @brief  peak resident set size of the process
+ *  @return kilobytes, 0 if not available
+ */
+uint64_t
+profile_peak_rss_kb();
+
+/** @brief  enable or disable stage measurements, clears the report
+ *  @param  b_enabled  true to measure
+ *  @return none
+ */
+void
+profile_enable(bool b_enabled);
+
+/** @brief  check if stage measurements are enabled
+ *  @return true if enabled
+ */
+bool
+profile_is_enabled();
+
+/** @brief  mark the start of a stage
+ *  @param  stage  enum profile_stage
+ *  @return none
+ */
+void
+profile_stage_begin(int stage);
+
+/** @brief  mark the end of a stage and record its counters, repeated
+ *          begin/end pairs of the same stage accumulate
+ *  @param  stage          enum profile_stage
+ *  @param  rows_in        records consumed by the stage
+ *  @param  rows_out       records produced by the stage
+ *  @param  bytes_read     bytes read from files by the stage
+ *  @param  bytes_written  bytes written to files by the stage
+ *  @return none
+ */
+void
+profile_stage_end(int stage,
+                  uint64_t rows_in,
+                  uint64_t rows_out,
+                  uint64_t bytes_read,
+                  uint64_t bytes_written);
+
+/** @brief  get the measurements of a stage
+ *  @param  stage  enum profile_stage
+ *  @return NULL   stage is not valid
+ *          pointer to the stage measurements
+ */
+const stageProfile *
+profile_get_stage(int stage);
+
+/** @brief  get the name of a stage
+ *  @param  stage  enum profile_stage
+ *  @return stage name, "unknown" if the stage is not valid
+ */
+const char *
+profile_stage_name(int stage);
+
+/** @brief  print the stage summary table
+ *  @param  *fp  output stream
+ *  @return none
+ */
+void
+profile_print(FILE *fp);
+
+/** @brief  write the stage measurements as json
+ *  @param  *str_file  json file path
+ *  @return 0
+ *          err_file_not_accessible
+ */
+int
+profile_write_json(const char *str_file);
+
+#endif
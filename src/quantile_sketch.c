@@ -0,0 +1,415 @@
+/*------------------------------------------------------
+**
+** File:      quantile_sketch.c
+** Author:    Eric Lu
+** Created:   2026-10-19
+**
+** Copyright ©2012 Toronto Transit Commission
+**
+**
+** Function Description
+** -----------------------------------------------------
+**
+** mergeable streaming quantile sketch, see quantile_sketch.h
+**
+** -----------------------------------------------------
+** Revision History
+**
+** 19 OCT 2026: Rev 1.0 - erilu
+**                      - Initial Design
+**
+** Inputs:
+**  none
+**
+** Outputs:
+**  none
+**
+** ----------------------------------------------------
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <math.h>
+#include "errorhandler.h"
+#include "quantile_sketch.h"
+
+/*
+** Source Code
+** -----------------------------------------------------
+*/
+
+/** @brief  get the bin key of a value
+ *  @param  *sketch  sketch
+ *  @param  value    value, at least SKETCH_MIN_VALUE
+ *  @return key
+ */
+static int
+sketch_key(const quantileSketch *sketch, double value)
+{
+  return (int) ceil(log(value) / sketch->log_gamma);
+}
+
+/** @brief  get the value a bin stands for, within the accuracy of every
+ *          value counted in it
+ *  @param  *sketch  sketch
+ *  @param  key      bin key
+ *  @return value
+ */
+static double
+sketch_value(const quantileSketch *sketch, int key)
+{
+  return 2.0 * pow(sketch->gamma, key) / (sketch->gamma + 1.0);
+}
+
+/** @brief  get the bin of a key, the bins are extended to hold it. beyond
+ *          SKETCH_MAX_BINS the lowest bins are collapsed into one, which
+ *          keeps the accuracy of the higher quantiles
+ *  @param  *sketch  sketch
+ *  @param  key      bin key
+ *  @param  *index   position in p_bins output
+ *  @return 0
+ *          err_list_append_failed  not enough memory
+ */
+static int
+sketch_reserve(quantileSketch *sketch, int key, int *index)
+{
+  uint64_t *p_bins = NULL;
+  int new_min = key;
+  int new_max = key;
+  int i = 0;
+
+  if ((sketch->bin_cnt > 0) &&
+      (key >= sketch->min_key) && (key < sketch->min_key + sketch->bin_cnt))
+  {
+    *index = key - sketch->min_key;
+    return 0;
+  }
+  if (sketch->bin_cnt > 0)
+  {
+    new_min = (sketch->min_key < key) ? sketch->min_key : key;
+    new_max = (sketch->min_key + sketch->bin_cnt - 1 > key) ?
+              sketch->min_key + sketch->bin_cnt - 1 : key;
+  }
+  if (new_max - new_min + 1 > SKETCH_MAX_BINS)
+  {
+    new_min = new_max - SKETCH_MAX_BINS + 1;
+  }
+  if (NULL == (p_bins = calloc((size_t) (new_max - new_min + 1), sizeof(uint64_t))))
+  {
+    return throw_err(err_list_append_failed);
+  }
+  for (i = 0; i < sketch->bin_cnt; i++)
+  {
+    if (sketch->min_key + i < new_min)
+    {
+      p_bins[0] += sketch->p_bins[i];
+    }
+    else
+    {
+      p_bins[sketch->min_key + i - new_min] += sketch->p_bins[i];
+    }
+  }
+  free(sketch->p_bins);
+  sketch->p_bins = p_bins;
+  sketch->min_key = new_min;
+  sketch->bin_cnt = new_max - new_min + 1;
+  *index = (key < new_min) ? 0 : key - new_min;
+  return 0;
+}
+
+/** @brief  initialize an empty sketch
+ *  @param  *sketch    sketch
+ *  @param  accuracy   relative accuracy, in (0, 1)
+ *  @return 0
+ *          err_maximum_number_exceeded  accuracy not valid
+ */
+int
+sketch_init(quantileSketch *sketch, double accuracy)
+{
+  memset(sketch, 0, sizeof(quantileSketch));
+  if (!((accuracy > 0) && (accuracy < 1)))
+  {
+    return throw_err(err_maximum_number_exceeded);
+  }
+  sketch->accuracy = accuracy;
+  sketch->gamma = (1.0 + accuracy) / (1.0 - accuracy);
+  sketch->log_gamma = log(sketch->gamma);
+  sketch->min = INFINITY;
+  sketch->max = -INFINITY;
+  return 0;
+}
+
+/** @brief  release the bins of a sketch, the sketch is empty afterwards
+ *  @param  *sketch  sketch
+ *  @return none
+ */
+void
+sketch_free(quantileSketch *sketch)
+{
+  free(sketch->p_bins);
+  sketch->p_bins = NULL;
+  sketch->bin_cnt = 0;
+  sketch->zero_cnt = 0;
+  sketch->count = 0;
+  sketch->min = INFINITY;
+  sketch->max = -INFINITY;
+  sketch->sum = 0;
+}
+
+/** @brief  add a value to a sketch, negative values count as zero
+ *  @param  *sketch  sketch
+ *  @param  value    value
+ *  @return 0
+ *          err_list_append_failed  not enough memory
+ */
+int
+sketch_add(quantileSketch *sketch, double value)
+{
+  int index = 0;
+  int err = 0;
+
+  if (value < SKETCH_MIN_VALUE)
+  {
+    sketch->zero_cnt++;
+  }
+  else if ((err = sketch_reserve(sketch, sketch_key(sketch, value), &index)) < 0)
+  {
+    return err;
+  }
+  else
+  {
+    sketch->p_bins[index]++;
+  }
+  sketch->count++;
+  sketch->sum += value;
+  if (value < sketch->min)
+  {
+    sketch->min = value;
+  }
+  if (value > sketch->max)
+  {
+    sketch->max = value;
+  }
+  return 0;
+}
+
+/** @brief  add the values of a sketch to another one
+ *  @param  *dst  sketch merged into
+ *  @param  *src  sketch of the same accuracy
+ *  @return 0
+ *          err_file_format_not_valid  accuracies differ
+ *          err_list_append_failed     not enough memory
+ */
+int
+sketch_merge(quantileSketch *dst, const quantileSketch *src)
+{
+  int index = 0;
+  int err = 0;
+  int i = 0;
+
+  if (dst->accuracy != src->accuracy)
+  {
+    return throw_err(err_file_format_not_valid);
+  }
+  for (i = 0; i < src->bin_cnt; i++)
+  {
+    if (0 == src->p_bins[i])
+    {
+      continue;
+    }
+    if ((err = sketch_reserve(dst, src->min_key + i, &index)) < 0)
+    {
+      return err;
+    }
+    dst->p_bins[index] += src->p_bins[i];
+  }
+  dst->zero_cnt += src->zero_cnt;
+  dst->count += src->count;
+  dst->sum += src->sum;
+  if (src->min < dst->min)
+  {
+    dst->min = src->min;
+  }
+  if (src->max > dst->max)
+  {
+    dst->max = src->max;
+  }
+  return 0;
+}
+
+/** @brief  get a quantile of the values added
+ *  @param  *sketch  sketch
+ *  @param  q        quantile in [0, 1]
+ *  @param  *value   quantile output
+ *  @return 0
+ *          err_list_is_empty            no value added
+ *          err_maximum_number_exceeded  q not valid
+ */
+int
+sketch_quantile(const quantileSketch *sketch, double q, double *value)
+{
+  double rank = 0;
+  uint64_t cum = 0;
+  int i = 0;
+
+  if (0 == sketch->count)
+  {
+    return throw_err(err_list_is_empty);
+  }
+  if (!((q >= 0) && (q <= 1)))
+  {
+    return throw_err(err_maximum_number_exceeded);
+  }
+  rank = q * (double) (sketch->count - 1);
+  cum = sketch->zero_cnt;
+  *value = 0;
+  for (i = 0; ((double) cum <= rank) && (i < sketch->bin_cnt); i++)
+  {
+    cum += sketch->p_bins[i];
+    *value = sketch_value(sketch, sketch->min_key + i);
+  }
+  /* the extremes are known exactly */
+  if (*value < sketch->min)
+  {
+    *value = sketch->min;
+  }
+  if (*value > sketch->max)
+  {
+    *value = sketch->max;
+  }
+  return 0;
+}
+
+/** @brief  append the persisted form of a sketch to a buffer, no newline
+ *  @param  *sketch  sketch
+ *  @param  *buf     buffer
+ *  @return 0
+ *          err_insufficient_buffer_size  not enough memory
+ */
+int
+sketch_format(const quantileSketch *sketch, strBuffer *buf)
+{
+  bool b_first = true;
+  int err = 0;
+  int i = 0;
+
+  err = str_buffer_printf
+  (
+    buf,
+    "%.17g,%" PRIu64 ",%" PRIu64 ",%f,%f,%f,",
+    sketch->accuracy,
+    sketch->count,
+    sketch->zero_cnt,
+    (sketch->count > 0) ? sketch->min : 0,
+    (sketch->count > 0) ? sketch->max : 0,
+    sketch->sum
+  );
+  for (i = 0; (i < sketch->bin_cnt) && (err >= 0); i++)
+  {
+    if (0 != sketch->p_bins[i])
+    {
+      err = str_buffer_printf(buf, "%s%d:%" PRIu64, b_first ? "" : " ",
+                              sketch->min_key + i, sketch->p_bins[i]);
+      b_first = false;
+    }
+  }
+  return (err < 0) ? throw_err(err_insufficient_buffer_size) : 0;
+}
+
+/** @brief  read the persisted form of a sketch
+ *  @param  *sketch  sketch output, released with sketch_free
+ *  @param  *str     persisted form
+ *  @return 0
+ *          err_file_format_not_valid
+ *          err_list_append_failed     not enough memory
+ */
+int
+sketch_parse(quantileSketch *sketch, const char *str)
+{
+  double accuracy = 0;
+  double extremes[3] = {0};
+  uint64_t count[2] = {0};
+  char *p_end = NULL;
+  uint64_t bin_cnt = 0;
+  uint64_t total = 0;
+  int index = 0;
+  long key = 0;
+  int err = 0;
+  int i = 0;
+
+  memset(sketch, 0, sizeof(quantileSketch));
+  /* accuracy, count, zero_cnt, min, max, sum */
+  for (i = 0; i < 6; i++)
+  {
+    if (0 == i)
+    {
+      accuracy = strtod(str, &p_end);
+    }
+    else if (i < 3)
+    {
+      count[i - 1] = strtoull(str, &p_end, 10);
+    }
+    else
+    {
+      extremes[i - 3] = strtod(str, &p_end);
+    }
+    if ((p_end == str) || (',' != *p_end))
+    {
+      return throw_err(err_file_format_not_valid);
+    }
+    str = p_end + 1;
+  }
+  if (sketch_init(sketch, accuracy) < 0)
+  {
+    return throw_err(err_file_format_not_valid);
+  }
+  /* bins, key:count separated by spaces */
+  while ((' ' == *str) || ((*str >= '0') && (*str <= '9')) || ('-' == *str))
+  {
+    if (' ' == *str)
+    {
+      str++;
+      continue;
+    }
+    key = strtol(str, &p_end, 10);
+    if ((p_end == str) || (':' != *p_end) ||
+        (key < INT32_MIN / 2) || (key > INT32_MAX / 2))
+    {
+      sketch_free(sketch);
+      return throw_err(err_file_format_not_valid);
+    }
+    str = p_end + 1;
+    bin_cnt = strtoull(str, &p_end, 10);
+    if (p_end == str)
+    {
+      sketch_free(sketch);
+      return throw_err(err_file_format_not_valid);
+    }
+    str = p_end;
+    if ((err = sketch_reserve(sketch, (int) key, &index)) < 0)
+    {
+      sketch_free(sketch);
+      return err;
+    }
+    sketch->p_bins[index] += bin_cnt;
+    total += bin_cnt;
+  }
+  sketch->count = count[0];
+  sketch->zero_cnt = count[1];
+  if ((total + sketch->zero_cnt != sketch->count) ||
+      (('\0' != *str) && ('\r' != *str) && ('\n' != *str)))
+  {
+    sketch_free(sketch);
+    return throw_err(err_file_format_not_valid);
+  }
+  if (sketch->count > 0)
+  {
+    sketch->min = extremes[0];
+    sketch->max = extremes[1];
+  }
+  sketch->sum = extremes[2];
+  return 0;
+}
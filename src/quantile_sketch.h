@@ -0,0 +1,149 @@
+/*------------------------------------------------------
+**
+** File:      quantile_sketch.h
+** Author:    Eric Lu
+** Created:   2026-10-19
+**
+** Copyright ©2012 Toronto Transit Commission
+**
+**
+** Function Description
+** -----------------------------------------------------
+**
+** mergeable streaming quantile sketch (DDSketch). values are counted in
+** logarithmic bins, so any quantile is returned within a relative error
+** of the sketch accuracy. adding a value is one bin increment, and two
+** sketches of the same accuracy merge by adding their bins, which lets
+** daily sketches roll up into monthly ones without the runs behind them.
+**
+** a sketch is persisted as one line of text:
+**
+**   accuracy,count,zero_cnt,min,max,sum,key:count key:count ...
+**
+** -----------------------------------------------------
+** Revision History
+**
+** 19 OCT 2026: Rev 1.0 - erilu
+**                      - Initial Design
+**
+** Inputs:
+**  none
+**
+** Outputs:
+**  none
+**
+** ----------------------------------------------------
+*/
+
+#ifndef ATC_SPEED_PROFILE_QUANTILE_SKETCH_H
+#define ATC_SPEED_PROFILE_QUANTILE_SKETCH_H
+
+#include <stdint.h>
+#include "common_util.h"
+
+/*
+** Constants
+** -----------------------------------------------------
+*/
+
+/* relative accuracy of the quantiles returned by default */
+#define SKETCH_ACCURACY           0.01
+/* values below are counted as zero */
+#define SKETCH_MIN_VALUE          1.0e-9
+/* bins kept at most, the lowest bins are collapsed beyond */
+#define SKETCH_MAX_BINS           2048
+
+/*
+** Structures
+** -----------------------------------------------------
+*/
+
+/* logarithmic bins of the values added */
+typedef struct quantile_sketch_t
+{
+  double accuracy;
+  /* bin i holds the values in (gamma^(k-1), gamma^k], k = min_key + i */
+  double gamma;
+  double log_gamma;
+  uint64_t *p_bins;
+  int min_key;
+  int bin_cnt;
+  /* values below SKETCH_MIN_VALUE */
+  uint64_t zero_cnt;
+  uint64_t count;
+  double min;
+  double max;
+  double sum;
+} quantileSketch;
+
+/*
+** Function Prototypes
+** -----------------------------------------------------
+*/
+
+/** @brief  initialize an empty sketch
+ *  @param  *sketch    sketch
+ *  @param  accuracy   relative accuracy, in (0, 1)
+ *  @return 0
+ *          err_maximum_number_exceeded  accuracy not valid
+ */
+int
+sketch_init(quantileSketch *sketch, double accuracy);
+
+/** @brief  release the bins of a sketch, the sketch is empty afterwards
+ *  @param  *sketch  sketch
+ *  @return none
+ */
+void
+sketch_free(quantileSketch *sketch);
+
+/** @brief  add a value to a sketch, negative values count as zero
+ *  @param  *sketch  sketch
+ *  @param  value    value
+ *  @return 0
+ *          err_list_append_failed  not enough memory
+ */
+int
+sketch_add(quantileSketch *sketch, double value);
+
+/** @brief  add the values of a sketch to another one
+ *  @param  *dst  sketch merged into
+ *  @param  *src  sketch of the same accuracy
+ *  @return 0
+ *          err_file_format_not_valid  accuracies differ
+ *          err_list_append_failed     not enough memory
+ */
+int
+sketch_merge(quantileSketch *dst, const quantileSketch *src);
+
+/** @brief  get a quantile of the values added
+ *  @param  *sketch  sketch
+ *  @param  q        quantile in [0, 1]
+ *  @param  *value   quantile output
+ *  @return 0
+ *          err_list_is_empty            no value added
+ *          err_maximum_number_exceeded  q not valid
+ */
+int
+sketch_quantile(const quantileSketch *sketch, double q, double *value);
+
+/** @brief  append the persisted form of a sketch to a buffer, no newline
+ *  @param  *sketch  sketch
+ *  @param  *buf     buffer
+ *  @return 0
+ *          err_insufficient_buffer_size  not enough memory
+ */
+int
+sketch_format(const quantileSketch *sketch, strBuffer *buf);
+
+/** @brief  read the persisted form of a sketch
+ *  @param  *sketch  sketch output, released with sketch_free
+ *  @param  *str     persisted form
+ *  @return 0
+ *          err_file_format_not_valid
+ *          err_list_append_failed     not enough memory
+ */
+int
+sketch_parse(quantileSketch *sketch, const char *str);
+
+#endif
@@ -0,0 +1,469 @@
+/*------------------------------------------------------
+**
+** File:      run_index.c
+** Author:    Eric Lu
+** Created:   2026-10-19
+**
+** Copyright ©2012 Toronto Transit Commission
+**
+**
+** Function Description
+** -----------------------------------------------------
+**
+** sorted index over the run profile manifest, see run_index.h
+**
+** -----------------------------------------------------
+** Revision History
+**
+** 19 OCT 2026: Rev 1.0 - erilu
+**                      - Initial Design
+**
+** Inputs:
+** Run Profile Files:
+**  run_profiles\run_profile_manifest.csv
+**
+** Outputs:
+** Run Profile Files:
+**  run_profiles\run_profile_manifest.idx
+**
+** ----------------------------------------------------
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <sys/stat.h>
+#include "errorhandler.h"
+#include "run_index.h"
+
+/*
+** Constants
+** -----------------------------------------------------
+*/
+
+/* first bytes of an index */
+#define RUN_INDEX_MAGIC           "ATCIDX\0\0"
+/* suffix of the index while it is written */
+#define RUN_INDEX_TMP_SUFFIX      ".tmp"
+/* manifest columns read: Station_Code, Platform, Direction, CC_ID and
+** Start_Timestamp */
+#define RUN_INDEX_FIELD_STATION   2
+#define RUN_INDEX_FIELD_PLATFORM  3
+#define RUN_INDEX_FIELD_DIRECTION 4
+#define RUN_INDEX_FIELD_CC        7
+#define RUN_INDEX_FIELD_START     9
+
+/*
+** Structures
+** -----------------------------------------------------
+*/
+
+/* index header, followed by the records. the manifest is only appended
+** to, so its size and modification time tell if the index is current */
+typedef struct run_index_header_t
+{
+  char magic[8];
+  uint32_t version;
+  /* sizeof(runIndexRecord) of the build that wrote the index */
+  uint32_t record_size;
+  uint64_t manifest_size;
+  int64_t manifest_mtime;
+  uint64_t record_cnt;
+} runIndexHeader;
+
+struct run_index_t
+{
+  runIndexRecord *p_records;
+  size_t cnt;
+};
+
+/*
+** Source Code
+** -----------------------------------------------------
+*/
+
+/** @brief  get the path of the index of a manifest
+ *  @param  *str_manifest    manifest path
+ *  @param  *str_index_file  index path output
+ *  @param  size             size of str_index_file
+ *  @return 0
+ *          err_null_string
+ *          err_insufficient_buffer_size
+ */
+int
+run_index_path(const char *str_manifest, char *str_index_file, size_t size)
+{
+  size_t len = 0;
+
+  if ((NULL == str_manifest) || (NULL == str_index_file))
+  {
+    return throw_err(err_null_string);
+  }
+  len = strlen(str_manifest);
+  if ((len > 4) && (0 == strcmp(str_manifest + len - 4, ".csv")))
+  {
+    len -= 4;
+  }
+  if ((size_t) snprintf(str_index_file, size, "%.*s%s",
+                        (int) len, str_manifest, RUN_INDEX_EXTENSION) >= size)
+  {
+    return throw_err(err_insufficient_buffer_size);
+  }
+  return 0;
+}
+
+/** @brief  compare two records on the leading fields of the key
+ *  @param  *a           record
+ *  @param  *b           record
+ *  @param  key_fields   enum run_index_key, last field compared
+ *  @return negative, 0 or positive as a sorts before, with or after b
+ */
+int
+run_index_compare(const runIndexRecord *a, const runIndexRecord *b, int key_fields)
+{
+  int cmp = 0;
+
+  if ((key_fields >= k_key_station) &&
+      (0 != (cmp = strcmp(a->str_station_code, b->str_station_code))))
+  {
+    return cmp;
+  }
+  if ((key_fields >= k_key_platform) &&
+      (0 != (cmp = strcmp(a->str_platform, b->str_platform))))
+  {
+    return cmp;
+  }
+  if ((key_fields >= k_key_cc) && (a->cc_id != b->cc_id))
+  {
+    return (a->cc_id < b->cc_id) ? -1 : 1;
+  }
+  if ((key_fields >= k_key_start_time) && (a->start_time != b->start_time))
+  {
+    return (a->start_time < b->start_time) ? -1 : 1;
+  }
+  return 0;
+}
+
+/** @brief  qsort comparison of records, on the whole key then on the
+ *          manifest order
+ *  @param  *a  record
+ *  @param  *b  record
+ *  @return negative, 0 or positive
+ */
+static int
+compare_records(const void *a, const void *b)
+{
+  const runIndexRecord *p_a = (const runIndexRecord *) a;
+  const runIndexRecord *p_b = (const runIndexRecord *) b;
+  int cmp = run_index_compare(p_a, p_b, k_key_start_time);
+
+  if (0 != cmp)
+  {
+    return cmp;
+  }
+  return (p_a->manifest_offset < p_b->manifest_offset) ? -1 :
+         (p_a->manifest_offset > p_b->manifest_offset);
+}
+
+/** @brief  copy a manifest field into a record field
+ *  @param  *dst       record field
+ *  @param  size       size of the record field
+ *  @param  *str_field manifest field
+ *  @return 0
+ *          err_file_format_not_valid  field too long
+ */
+static int
+copy_field(char *dst, size_t size, const char *str_field)
+{
+  if (strlen(str_field) >= size)
+  {
+    return throw_err(err_file_format_not_valid);
+  }
+  memset(dst, 0, size);
+  strcpy(dst, str_field);
+  return 0;
+}
+
+/** @brief  read the runs of a manifest
+ *  @param  *fp          manifest, opened in binary so offsets are exact
+ *  @param  **p_records  records output, released with free
+ *  @param  *cnt         number of records output
+ *  @return 0
+ *          err_file_format_not_valid
+ *          err_list_append_failed     not enough memory
+ */
+static int
+read_manifest(FILE *fp, runIndexRecord **p_records, size_t *cnt)
+{
+  char str_line[STR_EXTRA] = "";
+  runIndexRecord *p_grown = NULL;
+  runIndexRecord *p_rec = NULL;
+  char *p_tok = NULL;
+  char *p_end = NULL;
+  long offset = 0;
+  size_t cap = 0;
+  int field = 0;
+  int err = 0;
+
+  *p_records = NULL;
+  *cnt = 0;
+  /* header */
+  if (NULL == fgets(str_line, STR_EXTRA, fp))
+  {
+    return 0;
+  }
+  while ((err >= 0) && (0 <= (offset = ftell(fp))) &&
+         (NULL != fgets(str_line, STR_EXTRA, fp)))
+  {
+    str_line[strcspn(str_line, "\r\n")] = '\0';
+    if ('\0' == str_line[0])
+    {
+      continue;
+    }
+    if (*cnt == cap)
+    {
+      cap = (0 == cap) ? 1024 : 2 * cap;
+      if (NULL == (p_grown = realloc(*p_records, cap * sizeof(runIndexRecord))))
+      {
+        err = throw_err(err_list_append_failed);
+        break;
+      }
+      *p_records = p_grown;
+    }
+    p_rec = &(*p_records)[*cnt];
+    memset(p_rec, 0, sizeof(runIndexRecord));
+    p_rec->manifest_offset = (uint64_t) offset;
+    p_rec->start_time = -1;
+    p_rec->cc_id = -1;
+    p_tok = cstrtok(str_line, ',');
+    for (field = 0; (NULL != p_tok) && (err >= 0); field++)
+    {
+      switch (field)
+      {
+        case RUN_INDEX_FIELD_STATION:
+          err = copy_field(p_rec->str_station_code, sizeof(p_rec->str_station_code), p_tok);
+          break;
+        case RUN_INDEX_FIELD_PLATFORM:
+          err = copy_field(p_rec->str_platform, sizeof(p_rec->str_platform), p_tok);
+          break;
+        case RUN_INDEX_FIELD_DIRECTION:
+          err = copy_field(p_rec->str_direction, sizeof(p_rec->str_direction), p_tok);
+          break;
+        case RUN_INDEX_FIELD_CC:
+          p_rec->cc_id = (int32_t) strtol(p_tok, &p_end, 10);
+          err = ((p_end == p_tok) || ('\0' != *p_end)) ?
+                throw_err(err_file_format_not_valid) : 0;
+          break;
+        case RUN_INDEX_FIELD_START:
+          p_rec->start_time = (int64_t) strtoll(p_tok, &p_end, 10);
+          err = ((p_end == p_tok) || ('\0' != *p_end)) ?
+                throw_err(err_file_format_not_valid) : 0;
+          break;
+        default:
+          break;
+      }
+      p_tok = cstrtok(NULL, ',');
+    }
+    if ((err >= 0) && (field <= RUN_INDEX_FIELD_START))
+    {
+      err = throw_err(err_file_format_not_valid);
+    }
+    (*cnt)++;
+  }
+  if (err < 0)
+  {
+    free(*p_records);
+    *p_records = NULL;
+    *cnt = 0;
+  }
+  return err;
+}
+
+/** @brief  build the index of a manifest, replacing the previous one
+ *  @param  *str_manifest  manifest path
+ *  @return 0
+ *          err_file_not_accessible
+ *          err_file_format_not_valid
+ *          err_list_append_failed     not enough memory
+ */
+int
+run_index_build(const char *str_manifest)
+{
+  char str_index_file[STR_MAX] = "";
+  char str_tmp_file[STR_MAX] = "";
+  runIndexRecord *p_records = NULL;
+  runIndexHeader header;
+  struct stat st;
+  FILE *fp = NULL;
+  size_t cnt = 0;
+  bool b_ok = true;
+  int err = 0;
+
+  if ((err = run_index_path(str_manifest, str_index_file, STR_MAX)) < 0)
+  {
+    return err;
+  }
+  if ((size_t) snprintf(str_tmp_file, STR_MAX, "%s%s",
+                        str_index_file, RUN_INDEX_TMP_SUFFIX) >= STR_MAX)
+  {
+    return throw_err(err_insufficient_buffer_size);
+  }
+  if (NULL == (fp = fopen(str_manifest, "rb")))
+  {
+    return throw_err(err_file_not_accessible);
+  }
+  /* identity taken before reading, an append racing the build leaves the
+  ** index stale rather than wrongly current */
+  if (0 != fstat(fileno(fp), &st))
+  {
+    fclose(fp);
+    return throw_err(err_file_not_accessible);
+  }
+  err = read_manifest(fp, &p_records, &cnt);
+  fclose(fp);
+  if (err < 0)
+  {
+    return err;
+  }
+  if (cnt > 1)
+  {
+    qsort(p_records, cnt, sizeof(runIndexRecord), compare_records);
+  }
+
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, RUN_INDEX_MAGIC, sizeof(header.magic));
+  header.version = RUN_INDEX_VERSION;
+  header.record_size = (uint32_t) sizeof(runIndexRecord);
+  header.manifest_size = (uint64_t) st.st_size;
+  header.manifest_mtime = (int64_t) st.st_mtime;
+  header.record_cnt = (uint64_t) cnt;
+
+  if (NULL == (fp = fopen(str_tmp_file, "wb")))
+  {
+    free(p_records);
+    return throw_err(err_file_not_accessible);
+  }
+  b_ok = (1 == fwrite(&header, sizeof(header), 1, fp));
+  if (b_ok && (cnt > 0))
+  {
+    b_ok = (cnt == fwrite(p_records, sizeof(runIndexRecord), cnt, fp));
+  }
+  free(p_records);
+  if ((0 != fclose(fp)) || !b_ok)
+  {
+    remove(str_tmp_file);
+    return throw_err(err_file_not_accessible);
+  }
+#ifdef _WIN32
+  /* rename does not replace an existing file */
+  remove(str_index_file);
+#endif
+  if (0 != rename(str_tmp_file, str_index_file))
+  {
+    remove(str_tmp_file);
+    return throw_err(err_file_not_accessible);
+  }
+  return 0;
+}
+
+/** @brief  load the index of a manifest
+ *  @param  *str_manifest  manifest path
+ *  @return NULL           no index, or built from another manifest content
+ *                         or version
+ *          index, released with run_index_close
+ */
+runIndex *
+run_index_open(const char *str_manifest)
+{
+  char str_index_file[STR_MAX] = "";
+  runIndexHeader header;
+  runIndex *idx = NULL;
+  struct stat st;
+  FILE *fp = NULL;
+
+  if ((run_index_path(str_manifest, str_index_file, STR_MAX) < 0) ||
+      (0 != stat(str_manifest, &st)) ||
+      (NULL == (fp = fopen(str_index_file, "rb"))))
+  {
+    err_clear();
+    return NULL;
+  }
+  if ((1 != fread(&header, sizeof(header), 1, fp)) ||
+      (0 != memcmp(header.magic, RUN_INDEX_MAGIC, sizeof(header.magic))) ||
+      (RUN_INDEX_VERSION != header.version) ||
+      (sizeof(runIndexRecord) != header.record_size) ||
+      ((uint64_t) st.st_size != header.manifest_size) ||
+      ((int64_t) st.st_mtime != header.manifest_mtime) ||
+      (header.record_cnt > SIZE_MAX / sizeof(runIndexRecord)) ||
+      (NULL == (idx = calloc(1, sizeof(runIndex)))))
+  {
+    fclose(fp);
+    return NULL;
+  }
+  idx->cnt = (size_t) header.record_cnt;
+  if ((idx->cnt > 0) &&
+      ((NULL == (idx->p_records = malloc(idx->cnt * sizeof(runIndexRecord)))) ||
+       (idx->cnt != fread(idx->p_records, sizeof(runIndexRecord), idx->cnt, fp))))
+  {
+    run_index_close(idx);
+    idx = NULL;
+  }
+  fclose(fp);
+  return idx;
+}
+
+/** @brief  release an index
+ *  @param  *idx  index, NULL is ignored
+ *  @return none
+ */
+void
+run_index_close(runIndex *idx)
+{
+  if (NULL == idx)
+  {
+    return;
+  }
+  free(idx->p_records);
+  free(idx);
+}
+
+/** @brief  get the records of an index, sorted on the key
+ *  @param  *idx  index
+ *  @param  *cnt  number of records output
+ *  @return first record
+ */
+const runIndexRecord *
+run_index_records(const runIndex *idx, size_t *cnt)
+{
+  *cnt = idx->cnt;
+  return idx->p_records;
+}
+
+/** @brief  find the first record not sorting before a key
+ *  @param  *idx         index
+ *  @param  *key         key
+ *  @param  key_fields   enum run_index_key, last field of key used
+ *  @return position of the record, the record count if none
+ */
+size_t
+run_index_lower_bound(const runIndex *idx, const runIndexRecord *key, int key_fields)
+{
+  size_t lo = 0;
+  size_t hi = idx->cnt;
+  size_t mid = 0;
+
+  while (lo < hi)
+  {
+    mid = lo + (hi - lo) / 2;
+    if (run_index_compare(&idx->p_records[mid], key, key_fields) < 0)
+    {
+      lo = mid + 1;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+  return lo;
+}
@@ -0,0 +1,155 @@
+/*------------------------------------------------------
+**
+** File:      run_index.h
+** Author:    Eric Lu
+** Created:   2026-10-19
+**
+** Copyright ©2012 Toronto Transit Commission
+**
+**
+** Function Description
+** -----------------------------------------------------
+**
+** sorted index over the run profile manifest, keyed on station,
+** platform, cc id and start time. each record points at its manifest
+** row, so a query is a binary search and a read of the rows matched.
+** the index is written next to the manifest and rebuilt once the
+** manifest has changed:
+**
+**   run_profiles\run_profile_manifest.csv
+**   run_profiles\run_profile_manifest.idx
+**
+** -----------------------------------------------------
+** Revision History
+**
+** 19 OCT 2026: Rev 1.0 - erilu
+**                      - Initial Design
+**
+** Inputs:
+** Run Profile Files:
+**  run_profiles\run_profile_manifest.csv
+**
+** Outputs:
+** Run Profile Files:
+**  run_profiles\run_profile_manifest.idx
+**
+** ----------------------------------------------------
+*/
+
+#ifndef ATC_SPEED_PROFILE_RUN_INDEX_H
+#define ATC_SPEED_PROFILE_RUN_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "common_util.h"
+
+/*
+** Constants
+** -----------------------------------------------------
+*/
+
+/* extension of the index, replaces the .csv of the manifest */
+#define RUN_INDEX_EXTENSION       ".idx"
+/* index layout version, indexes of another version are rebuilt */
+#define RUN_INDEX_VERSION         1
+
+/* key fields, in sort order */
+enum run_index_key
+{
+  k_key_station = 1,
+  k_key_platform,
+  k_key_cc,
+  k_key_start_time
+};
+
+/*
+** Structures
+** -----------------------------------------------------
+*/
+
+/* one run of the manifest */
+typedef struct run_index_record_t
+{
+  char str_station_code[8];
+  char str_platform[4];
+  char str_direction[4];
+  int32_t cc_id;
+  uint32_t reserved;
+  /* start of the run, seconds since the epoch */
+  int64_t start_time;
+  /* position of the run row in the manifest */
+  uint64_t manifest_offset;
+} runIndexRecord;
+
+/* index loaded in memory, opaque to the callers */
+typedef struct run_index_t runIndex;
+
+/*
+** Function Prototypes
+** -----------------------------------------------------
+*/
+
+/** @brief  get the path of the index of a manifest
+ *  @param  *str_manifest    manifest path
+ *  @param  *str_index_file  index path output
+ *  @param  size             size of str_index_file
+ *  @return 0
+ *          err_null_string
+ *          err_insufficient_buffer_size
+ */
+int
+run_index_path(const char *str_manifest, char *str_index_file, size_t size);
+
+/** @brief  build the index of a manifest, replacing the previous one
+ *  @param  *str_manifest  manifest path
+ *  @return 0
+ *          err_file_not_accessible
+ *          err_file_format_not_valid
+ *          err_list_append_failed     not enough memory
+ */
+int
+run_index_build(const char *str_manifest);
+
+/** @brief  load the index of a manifest
+ *  @param  *str_manifest  manifest path
+ *  @return NULL           no index, or built from another manifest content
+ *                         or version
+ *          index, released with run_index_close
+ */
+runIndex *
+run_index_open(const char *str_manifest);
+
+/** @brief  release an index
+ *  @param  *idx  index, NULL is ignored
+ *  @return none
+ */
+void
+run_index_close(runIndex *idx);
+
+/** @brief  get the records of an index, sorted on the key
+ *  @param  *idx  index
+ *  @param  *cnt  number of records output
+ *  @return first record
+ */
+const runIndexRecord *
+run_index_records(const runIndex *idx, size_t *cnt);
+
+/** @brief  compare two records on the leading fields of the key
+ *  @param  *a           record
+ *  @param  *b           record
+ *  @param  key_fields   enum run_index_key, last field compared
+ *  @return negative, 0 or positive as a sorts before, with or after b
+ */
+int
+run_index_compare(const runIndexRecord *a, const runIndexRecord *b, int key_fields);
+
+/** @brief  find the first record not sorting before a key
+ *  @param  *idx         index
+ *  @param  *key         key
+ *  @param  key_fields   enum run_index_key, last field of key used
+ *  @return position of the record, the record count if none
+ */
+size_t
+run_index_lower_bound(const runIndex *idx, const runIndexRecord *key, int key_fields);
+
+#endif
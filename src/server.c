@@ -0,0 +1,857 @@
+/*------------------------------------------------------
+**
+** File:      server.c
+** Author:    Eric Lu
+** Created:   2026-10-19
+**
+** Copyright ©2012 Toronto Transit Commission
+**
+**
+** Function Description
+** -----------------------------------------------------
+**
+** resident job server and its client request, see server.h
+**
+** -----------------------------------------------------
+** Revision History
+**
+** 19 OCT 2026: Rev 1.0 - erilu
+**                      - Initial Design
+**
+** Inputs:
+** Job requests from the socket
+**
+** Outputs:
+** Run Profile Files, job status replies
+**
+** ----------------------------------------------------
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#if defined(__unix__) || defined(__APPLE__)
+#   include <poll.h>
+#   include <unistd.h>
+#   include <sys/socket.h>
+#   include <sys/time.h>
+#   include <sys/un.h>
+#endif
+#include "atc_speed_profile_tool.h"
+#include "async_writer.h"
+#include "log.h"
+#include "profiler.h"
+#include "server.h"
+
+#if SERVER_SUPPORTED
+
+/*
+** Constants
+** -----------------------------------------------------
+*/
+
+/* wait of one accept poll, the stop request is checked in between, ms */
+#define SERVER_POLL_MS            500
+/* a client has this long to send its request, s */
+#define SERVER_RECV_TIMEOUT_S     5
+
+/* job life cycle */
+enum job_state
+{
+  k_job_queued = 0,
+  k_job_running,
+  k_job_done,
+  k_job_failed,
+
+  /* number of states */
+  k_job_state_cnt
+};
+
+/*
+** Structures
+** -----------------------------------------------------
+*/
+
+/* one submitted job */
+typedef struct server_job_t
+{
+  uint64_t id;
+  int state;
+  /* first error of the job, 0 if none */
+  int err;
+  /* run profile folder, empty for RUN_PROFILE_PATH */
+  char str_output_path[STR_MAX];
+  bool b_fsync;
+  bool b_async_export;
+  char (*str_files)[STR_MAX];
+  int file_cnt;
+  /* counters of the job context when it finished */
+  toolStats stats;
+  double submit_s;
+  double start_s;
+  double end_s;
+  /* next job in the queue */
+  struct server_job_t *p_next;
+} serverJob;
+
+/* server shared by the accept loop, the workers and the connections */
+typedef struct job_server_t
+{
+  atcContext *p_lut_ctx;
+  int async_queue_depth;
+  pthread_mutex_t lock;
+  /* a job was queued or the server is stopping */
+  pthread_cond_t cond_queue;
+  /* a job finished or a connection closed */
+  pthread_cond_t cond_done;
+  /* queued jobs, oldest first */
+  serverJob *p_head;
+  serverJob *p_tail;
+  /* submitted jobs by id modulo SERVER_MAX_JOBS */
+  serverJob *jobs[SERVER_MAX_JOBS];
+  uint64_t next_id;
+  /* workers leave once the queue is empty */
+  bool b_stopping;
+  /* SHUTDOWN received */
+  bool b_shutdown;
+  /* connections being served */
+  int conn_cnt;
+  /* jobs running on the workers */
+  int run_cnt;
+} jobServer;
+
+/* one accepted connection */
+typedef struct server_conn_t
+{
+  jobServer *p_server;
+  int fd;
+} serverConn;
+
+/*
+** Variables
+** -----------------------------------------------------
+*/
+
+/* job state names, in enum job_state order */
+static const char *k_job_state_names[k_job_state_cnt] =
+{
+  "QUEUED",
+  "RUNNING",
+  "DONE",
+  "FAILED"
+};
+
+/*
+** Source Code
+** -----------------------------------------------------
+*/
+
+/** @brief  free a job and its file list
+ *  @param  *job  job, may be NULL
+ *  @return none
+ */
+static void
+free_job(serverJob *job)
+{
+  if (NULL != job)
+  {
+    free(job->str_files);
+    free(job);
+  }
+}
+
+/** @brief  run the stages of one job in its own context sharing the
+ *          lookup table
+ *  @param  *srv    server
+ *  @param  *job    job
+ *  @param  *stats  counters of the job context output
+ *  @return 0
+ *          first error of the stages
+ */
+static int
+run_server_job(jobServer *srv, serverJob *job, toolStats *stats)
+{
+  atcContext *ctx = NULL;
+  int depth = srv->async_queue_depth;
+  int err = 0;
+  int i = 0;
+
+  if (NULL == (ctx = atc_context_create()))
+  {
+    return throw_err(err_list_append_failed);
+  }
+  if (job->b_async_export && (depth <= 0))
+  {
+    depth = ASYNC_WRITER_DEFAULT_DEPTH;
+  }
+  atc_set_async_export(ctx, depth, job->b_fsync);
+  if (((err = atc_context_share_lut(ctx, srv->p_lut_ctx)) >= 0) &&
+      ((err = atc_set_output_path(ctx, job->str_output_path)) >= 0))
+  {
+    for (i = 0; (i < job->file_cnt) && (err >= 0); i++)
+    {
+      err = atc_read_input_file(ctx, job->str_files[i]);
+    }
+  }
+  if (err >= 0)
+  {
+    err = atc_sort_input_data_list(ctx);
+  }
+  if (err >= 0)
+  {
+    err = atc_expand_data_list_use_lut(ctx);
+  }
+  if (err >= 0)
+  {
+    err = atc_calculate_output_data_list(ctx);
+  }
+  if (err >= 0)
+  {
+    err = atc_export_run_profile_file(ctx);
+  }
+  atc_get_tool_stats(ctx, stats);
+  atc_context_free(ctx);
+  return (err < 0) ? err : 0;
+}
+
+/** @brief  worker thread, runs queued jobs until the server stops and
+ *          the queue is empty. the data quality report is shared by all
+ *          jobs, it is printed and cleared whenever no job is running so
+ *          it never covers more than the jobs since the server was idle
+ *  @param  *arg  server
+ *  @return NULL
+ */
+static void *
+worker_main(void *arg)
+{
+  jobServer *srv = (jobServer *) arg;
+  serverJob *job = NULL;
+  toolStats stats = {0};
+  int err = 0;
+
+  pthread_mutex_lock(&srv->lock);
+  while (true)
+  {
+    while ((NULL == srv->p_head) && !srv->b_stopping)
+    {
+      pthread_cond_wait(&srv->cond_queue, &srv->lock);
+    }
+    if (NULL == (job = srv->p_head))
+    {
+      break;
+    }
+    srv->p_head = job->p_next;
+    if (NULL == srv->p_head)
+    {
+      srv->p_tail = NULL;
+    }
+    job->state = k_job_running;
+    job->start_s = profile_wall_time();
+    srv->run_cnt++;
+    pthread_mutex_unlock(&srv->lock);
+
+    memset(&stats, 0, sizeof(stats));
+    err = run_server_job(srv, job, &stats);
+    log_flush();
+
+    pthread_mutex_lock(&srv->lock);
+    srv->run_cnt--;
+    job->err = err;
+    job->stats = stats;
+    job->end_s = profile_wall_time();
+    job->state = (err < 0) ? k_job_failed : k_job_done;
+    fprintf
+    (
+      stdout,
+      "[%6s][%s][%" PRIu64 "][%s][%s][%" PRIu64 "]\n",
+      "INFO",
+      "Job Finished",
+      job->id,
+      k_job_state_names[job->state],
+      get_err_description(err),
+      stats.files_written
+    );
+    if (0 == srv->run_cnt)
+    {
+      err_report_print(stdout);
+      err_report_reset();
+    }
+    fflush(stdout);
+    pthread_cond_broadcast(&srv->cond_done);
+  }
+  pthread_mutex_unlock(&srv->lock);
+  return NULL;
+}
+
+/** @brief  find a job still remembered, the server lock is held
+ *  @param  *srv  server
+ *  @param  id    job id
+ *  @return NULL  job not known
+ *          job
+ */
+static serverJob *
+find_job(jobServer *srv, uint64_t id)
+{
+  serverJob *job = srv->jobs[id % SERVER_MAX_JOBS];
+
+  return ((NULL != job) && (id == job->id)) ? job : NULL;
+}
+
+/** @brief  format the status reply of a job, the server lock is held
+ *  @param  *job        job
+ *  @param  *str_reply  reply output
+ *  @param  size        size of str_reply
+ *  @return none
+ */
+static void
+format_job_status(const serverJob *job, char *str_reply, size_t size)
+{
+  double now_s = profile_wall_time();
+  double queued_s = ((k_job_queued == job->state) ? now_s : job->start_s) - job->submit_s;
+  double run_s = 0;
+
+  if (k_job_running == job->state)
+  {
+    run_s = now_s - job->start_s;
+  }
+  else if (k_job_queued != job->state)
+  {
+    run_s = job->end_s - job->start_s;
+  }
+  snprintf
+  (
+    str_reply,
+    size,
+    "JOB\t%" PRIu64 "\t%s\t%s\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\t%.3f\t%.3f",
+    job->id,
+    k_job_state_names[job->state],
+    get_err_description(job->err),
+    job->stats.input_lines_read,
+    job->stats.output_cnt,
+    job->stats.files_written,
+    job->stats.bytes_written,
+    queued_s,
+    run_s
+  );
+}
+
+/** @brief  queue a job from the fields of a SUBMIT request
+ *  @param  *srv        server, the request fields after SUBMIT are taken
+ *  @param  *str_reply  reply output
+ *  @param  size        size of str_reply
+ *  @return 0
+ *          err_null_string               no input file
+ *          err_insufficient_buffer_size  path too long
+ *          err_maximum_number_exceeded   too many files or jobs pending
+ *          err_list_append_failed        not enough memory
+ */
+static int
+submit_job(jobServer *srv, char *str_reply, size_t size)
+{
+  serverJob *job = NULL;
+  serverJob *p_old = NULL;
+  char *p_field = NULL;
+
+  if (NULL == (job = (serverJob *) calloc(1, sizeof(serverJob))) ||
+      NULL == (job->str_files = malloc(FILE_LIST_MAX_LENGTH * sizeof(*job->str_files))))
+  {
+    free_job(job);
+    return throw_err(err_list_append_failed);
+  }
+  if ((NULL == (p_field = cstrtok(NULL, SERVER_FIELD_DELIM))) ||
+      (strlen(p_field) >= STR_MAX))
+  {
+    free_job(job);
+    return throw_err(err_insufficient_buffer_size);
+  }
+  strcpy(job->str_output_path, p_field);
+  while (NULL != (p_field = cstrtok(NULL, SERVER_FIELD_DELIM)))
+  {
+    if (0 == strcmp(p_field, "--fsync"))
+    {
+      job->b_fsync = true;
+    }
+    else if (0 == strcmp(p_field, "--async-export"))
+    {
+      job->b_async_export = true;
+    }
+    else if ('\0' == p_field[0])
+    {
+      continue;
+    }
+    else if (job->file_cnt >= FILE_LIST_MAX_LENGTH)
+    {
+      free_job(job);
+      return throw_err(err_maximum_number_exceeded);
+    }
+    else if (strlen(p_field) >= STR_MAX)
+    {
+      free_job(job);
+      return throw_err(err_insufficient_buffer_size);
+    }
+    else
+    {
+      strcpy(job->str_files[job->file_cnt++], p_field);
+    }
+  }
+  if (0 == job->file_cnt)
+  {
+    free_job(job);
+    return throw_err(err_null_string);
+  }
+
+  pthread_mutex_lock(&srv->lock);
+  p_old = srv->jobs[srv->next_id % SERVER_MAX_JOBS];
+  if ((NULL != p_old) &&
+      ((k_job_queued == p_old->state) || (k_job_running == p_old->state)))
+  {
+    pthread_mutex_unlock(&srv->lock);
+    free_job(job);
+    return throw_err(err_maximum_number_exceeded);
+  }
+  free_job(p_old);
+  job->id = srv->next_id++;
+  job->state = k_job_queued;
+  job->submit_s = profile_wall_time();
+  srv->jobs[job->id % SERVER_MAX_JOBS] = job;
+  if (NULL == srv->p_tail)
+  {
+    srv->p_head = job;
+  }
+  else
+  {
+    srv->p_tail->p_next = job;
+  }
+  srv->p_tail = job;
+  pthread_cond_signal(&srv->cond_queue);
+  snprintf(str_reply, size, "OK\t%" PRIu64, job->id);
+  pthread_mutex_unlock(&srv->lock);
+  return 0;
+}
+
+/** @brief  answer one request line
+ *  @param  *srv          server
+ *  @param  *str_request  request line, modified
+ *  @param  *str_reply    reply output
+ *  @param  size          size of str_reply
+ *  @return none
+ */
+static void
+handle_request(jobServer *srv, char *str_request, char *str_reply, size_t size)
+{
+  char *p_cmd = cstrtok(str_request, SERVER_FIELD_DELIM);
+  char *p_id = NULL;
+  serverJob *job = NULL;
+  uint64_t id = 0;
+  int err = 0;
+
+  if (0 == strcmp(p_cmd, "SUBMIT"))
+  {
+    err = submit_job(srv, str_reply, size);
+  }
+  else if ((0 == strcmp(p_cmd, "STATUS")) || (0 == strcmp(p_cmd, "WAIT")))
+  {
+    p_id = cstrtok(NULL, SERVER_FIELD_DELIM);
+    id = (NULL != p_id) ? strtoull(p_id, NULL, 10) : 0;
+    pthread_mutex_lock(&srv->lock);
+    job = find_job(srv, id);
+    while ((NULL != job) &&
+           ('W' == p_cmd[0]) &&
+           ((k_job_queued == job->state) || (k_job_running == job->state)))
+    {
+      pthread_cond_wait(&srv->cond_done, &srv->lock);
+      job = find_job(srv, id);
+    }
+    if (NULL == job)
+    {
+      err = throw_err(err_list_retrieval_failed);
+    }
+    else
+    {
+      format_job_status(job, str_reply, size);
+    }
+    pthread_mutex_unlock(&srv->lock);
+  }
+  else if (0 == strcmp(p_cmd, "SHUTDOWN"))
+  {
+    pthread_mutex_lock(&srv->lock);
+    srv->b_shutdown = true;
+    pthread_mutex_unlock(&srv->lock);
+    snprintf(str_reply, size, "OK\t0");
+  }
+  else
+  {
+    err = throw_err(err_file_format_not_valid);
+  }
+  if (err < 0)
+  {
+    snprintf(str_reply, size, "ERROR\t%s", get_err_description(err));
+  }
+}
+
+/** @brief  read one line terminated by a newline from a socket
+ *  @param  fd        socket
+ *  @param  *str_line line output, terminator removed
+ *  @param  size      size of str_line
+ *  @return 0
+ *          err_insufficient_buffer_size
+ *          err_end_of_file_reached      closed or timed out before a line
+ */
+static int
+read_line(int fd, char *str_line, size_t size)
+{
+  size_t len = 0;
+  ssize_t n = 0;
+  char *p_end = NULL;
+
+  while (len + 1 < size)
+  {
+    n = recv(fd, str_line + len, size - len - 1, 0);
+    if ((n < 0) && (EINTR == errno))
+    {
+      continue;
+    }
+    if (n <= 0)
+    {
+      return throw_err(err_end_of_file_reached);
+    }
+    len += (size_t) n;
+    str_line[len] = '\0';
+    if (NULL != (p_end = strchr(str_line, '\n')))
+    {
+      *p_end = '\0';
+      if ((p_end > str_line) && ('\r' == p_end[-1]))
+      {
+        p_end[-1] = '\0';
+      }
+      return 0;
+    }
+  }
+  return throw_err(err_insufficient_buffer_size);
+}
+
+/** @brief  write a whole buffer to a socket
+ *  @param  fd    socket
+ *  @param  *buf  data
+ *  @param  len   data length
+ *  @return 0
+ *          err_file_not_accessible
+ */
+static int
+write_all(int fd, const char *buf, size_t len)
+{
+  ssize_t n = 0;
+
+  while (len > 0)
+  {
+    n = send(fd, buf, len, MSG_NOSIGNAL);
+    if ((n < 0) && (EINTR == errno))
+    {
+      continue;
+    }
+    if (n <= 0)
+    {
+      return throw_err(err_file_not_accessible);
+    }
+    buf += n;
+    len -= (size_t) n;
+  }
+  return 0;
+}
+
+/** @brief  connection thread, answers the request of one client
+ *  @param  *arg  connection
+ *  @return NULL
+ */
+static void *
+connection_main(void *arg)
+{
+  serverConn *conn = (serverConn *) arg;
+  jobServer *srv = conn->p_server;
+  char *str_request = malloc(SERVER_LINE_MAX);
+  char str_reply[STR_EXTRA] = "";
+  int err = 0;
+
+  if (NULL == str_request)
+  {
+    snprintf(str_reply, STR_EXTRA, "ERROR\t%s", get_err_description(err_list_append_failed));
+  }
+  else if ((err = read_line(conn->fd, str_request, SERVER_LINE_MAX)) < 0)
+  {
+    snprintf(str_reply, STR_EXTRA, "ERROR\t%s", get_err_description(err));
+  }
+  else
+  {
+    handle_request(srv, str_request, str_reply, STR_EXTRA);
+  }
+  strcat(str_reply, "\n");
+  write_all(conn->fd, str_reply, strlen(str_reply));
+  close(conn->fd);
+  free(str_request);
+  free(conn);
+
+  pthread_mutex_lock(&srv->lock);
+  srv->conn_cnt--;
+  pthread_cond_broadcast(&srv->cond_done);
+  pthread_mutex_unlock(&srv->lock);
+  return NULL;
+}
+
+/** @brief  start a thread for an accepted connection
+ *  @param  *srv  server
+ *  @param  fd    accepted socket
+ *  @return none
+ */
+static void
+serve_connection(jobServer *srv, int fd)
+{
+  struct timeval tv = {SERVER_RECV_TIMEOUT_S, 0};
+  serverConn *conn = NULL;
+  pthread_attr_t attr;
+  pthread_t tid;
+
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  if (NULL == (conn = (serverConn *) malloc(sizeof(serverConn))))
+  {
+    close(fd);
+    return;
+  }
+  conn->p_server = srv;
+  conn->fd = fd;
+
+  pthread_mutex_lock(&srv->lock);
+  srv->conn_cnt++;
+  pthread_mutex_unlock(&srv->lock);
+
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+  if (0 != pthread_create(&tid, &attr, connection_main, conn))
+  {
+    close(fd);
+    free(conn);
+    pthread_mutex_lock(&srv->lock);
+    srv->conn_cnt--;
+    pthread_mutex_unlock(&srv->lock);
+  }
+  pthread_attr_destroy(&attr);
+}
+
+/** @brief  fill a UNIX socket address
+ *  @param  *addr        address output
+ *  @param  *str_socket  socket path
+ *  @return 0
+ *          err_null_string
+ *          err_insufficient_buffer_size
+ */
+static int
+socket_address(struct sockaddr_un *addr, const char *str_socket)
+{
+  if (NULL == str_socket)
+  {
+    return throw_err(err_null_string);
+  }
+  memset(addr, 0, sizeof(*addr));
+  addr->sun_family = AF_UNIX;
+  if (strlen(str_socket) >= sizeof(addr->sun_path))
+  {
+    return throw_err(err_insufficient_buffer_size);
+  }
+  strcpy(addr->sun_path, str_socket);
+  return 0;
+}
+
+/** @brief  serve job requests until SHUTDOWN or *p_stop
+ *  @param  *ctx                context holding the loaded lookup table
+ *  @param  *str_socket         socket path, replaced if it exists
+ *  @param  worker_cnt          jobs run at once
+ *  @param  async_queue_depth   background export queue depth of each job
+ *  @param  *p_stop             set by a signal handler to stop serving
+ *  @return 0
+ *          err_null_string
+ *          err_maximum_number_exceeded
+ *          err_file_not_accessible
+ */
+int
+server_run(atcContext *ctx, const char *str_socket, int worker_cnt,
+           int async_queue_depth, volatile sig_atomic_t *p_stop)
+{
+  jobServer *srv = NULL;
+  pthread_t workers[SERVER_MAX_WORKERS];
+  struct sockaddr_un addr;
+  struct pollfd pfd;
+  bool b_shutdown = false;
+  int started_cnt = 0;
+  int fd = -1;
+  int cfd = -1;
+  int err = 0;
+  int i = 0;
+
+  if ((NULL == ctx) || (NULL == p_stop))
+  {
+    return throw_err(err_null_string);
+  }
+  if ((worker_cnt < 1) || (worker_cnt > SERVER_MAX_WORKERS))
+  {
+    return throw_err(err_maximum_number_exceeded);
+  }
+  if ((err = socket_address(&addr, str_socket)) < 0)
+  {
+    return err;
+  }
+  if (NULL == (srv = (jobServer *) calloc(1, sizeof(jobServer))))
+  {
+    return throw_err(err_list_append_failed);
+  }
+  srv->p_lut_ctx = ctx;
+  srv->async_queue_depth = async_queue_depth;
+  srv->next_id = 1;
+  pthread_mutex_init(&srv->lock, NULL);
+  pthread_cond_init(&srv->cond_queue, NULL);
+  pthread_cond_init(&srv->cond_done, NULL);
+
+  unlink(str_socket);
+  if (((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) ||
+      (0 != bind(fd, (struct sockaddr *) &addr, sizeof(addr))) ||
+      (0 != listen(fd, SOMAXCONN)))
+  {
+    err = throw_err(err_file_not_accessible);
+  }
+  for (i = 0; (i < worker_cnt) && (err >= 0); i++)
+  {
+    if (0 != pthread_create(&workers[i], NULL, worker_main, srv))
+    {
+      err = throw_err(err_maximum_number_exceeded);
+    }
+    else
+    {
+      started_cnt++;
+    }
+  }
+
+  while ((err >= 0) && !*p_stop && !b_shutdown)
+  {
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    if ((poll(&pfd, 1, SERVER_POLL_MS) > 0) &&
+        ((cfd = accept(fd, NULL, NULL)) >= 0))
+    {
+      serve_connection(srv, cfd);
+    }
+    pthread_mutex_lock(&srv->lock);
+    b_shutdown = srv->b_shutdown;
+    pthread_mutex_unlock(&srv->lock);
+  }
+  if (fd >= 0)
+  {
+    close(fd);
+    unlink(str_socket);
+  }
+
+  /* complete the queued jobs, then wait for the clients still waiting */
+  pthread_mutex_lock(&srv->lock);
+  srv->b_stopping = true;
+  pthread_cond_broadcast(&srv->cond_queue);
+  pthread_mutex_unlock(&srv->lock);
+  for (i = 0; i < started_cnt; i++)
+  {
+    pthread_join(workers[i], NULL);
+  }
+  pthread_mutex_lock(&srv->lock);
+  while (srv->conn_cnt > 0)
+  {
+    pthread_cond_wait(&srv->cond_done, &srv->lock);
+  }
+  pthread_mutex_unlock(&srv->lock);
+
+  for (i = 0; i < SERVER_MAX_JOBS; i++)
+  {
+    free_job(srv->jobs[i]);
+  }
+  pthread_cond_destroy(&srv->cond_done);
+  pthread_cond_destroy(&srv->cond_queue);
+  pthread_mutex_destroy(&srv->lock);
+  free(srv);
+  return err;
+}
+
+/** @brief  send one request line to a server and wait for its reply
+ *  @param  *str_socket   socket path
+ *  @param  *str_request  request line without line terminator
+ *  @param  *str_reply    reply line output, terminator removed
+ *  @param  size          size of str_reply
+ *  @return 0
+ *          err_null_string
+ *          err_insufficient_buffer_size
+ *          err_file_not_accessible
+ *          err_end_of_file_reached
+ */
+int
+server_request(const char *str_socket, const char *str_request,
+               char *str_reply, size_t size)
+{
+  struct sockaddr_un addr;
+  int fd = -1;
+  int err = 0;
+
+  if ((NULL == str_request) || (NULL == str_reply))
+  {
+    return throw_err(err_null_string);
+  }
+  if ((err = socket_address(&addr, str_socket)) < 0)
+  {
+    return err;
+  }
+  if (((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) ||
+      (0 != connect(fd, (struct sockaddr *) &addr, sizeof(addr))))
+  {
+    err = throw_err(err_file_not_accessible);
+  }
+  if (err >= 0)
+  {
+    err = write_all(fd, str_request, strlen(str_request));
+  }
+  if (err >= 0)
+  {
+    err = write_all(fd, "\n", 1);
+  }
+  if (err >= 0)
+  {
+    err = read_line(fd, str_reply, size);
+  }
+  if (fd >= 0)
+  {
+    close(fd);
+  }
+  return err;
+}
+
+#else
+
+int
+server_run(atcContext *ctx, const char *str_socket, int worker_cnt,
+           int async_queue_depth, volatile sig_atomic_t *p_stop)
+{
+  (void) ctx;
+  (void) str_socket;
+  (void) worker_cnt;
+  (void) async_queue_depth;
+  (void) p_stop;
+  return throw_err(err_file_not_accessible);
+}
+
+int
+server_request(const char *str_socket, const char *str_request,
+               char *str_reply, size_t size)
+{
+  (void) str_socket;
+  (void) str_request;
+  (void) str_reply;
+  (void) size;
+  return throw_err(err_file_not_accessible);
+}
+
+#endif
@@ -0,0 +1,117 @@
+/*------------------------------------------------------
+**
+** File:      server.h
+** Author:    Eric Lu
+** Created:   2026-10-19
+**
+** Copyright ©2012 Toronto Transit Commission
+**
+**
+** Function Description
+** -----------------------------------------------------
+**
+** resident job server. the lookup table is loaded once, jobs submitted
+** over a local UNIX domain socket run on a pool of worker threads, each
+** in its own context sharing the table. every request and reply is one
+** line of tab separated fields:
+**
+**   SUBMIT  <output dir> [--fsync] [--async-export] <file>...
+**           OK <job id>
+**   STATUS  <job id>
+**   WAIT    <job id>
+**           JOB <job id> <state> <error> <rows read> <rows calculated>
+**               <files written> <bytes written> <queued s> <run s>
+**   SHUTDOWN
+**           OK 0
+**
+** an empty output dir writes to RUN_PROFILE_PATH, a failed request is
+** answered with ERROR <error description>.
+**
+** -----------------------------------------------------
+** Revision History
+**
+** 19 OCT 2026: Rev 1.0 - erilu
+**                      - Initial Design
+**
+** Inputs:
+** Job requests from the socket
+**
+** Outputs:
+** Run Profile Files, job status replies
+**
+** ----------------------------------------------------
+*/
+
+#ifndef ATC_SPEED_PROFILE_SERVER_H
+#define ATC_SPEED_PROFILE_SERVER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <signal.h>
+#include "atc_speed_profile_tool.h"
+
+/*
+** Constants
+** -----------------------------------------------------
+*/
+
+/* UNIX domain sockets are used where the platform has them */
+#if defined(__unix__) || defined(__APPLE__)
+#   define SERVER_SUPPORTED 1
+#else
+#   define SERVER_SUPPORTED 0
+#endif
+
+/* socket created in the working directory of the server by default */
+#define SERVER_DEFAULT_SOCKET     "atc_speed_profile.sock"
+/* default number of jobs run at once */
+#define SERVER_DEFAULT_WORKERS    2
+/* maximum number of worker threads */
+#define SERVER_MAX_WORKERS        64
+/* jobs remembered for STATUS and WAIT, finished ones are forgotten
+** oldest first */
+#define SERVER_MAX_JOBS           1024
+/* maximum length of one request or reply line, room for the output
+** dir and FILE_LIST_MAX_LENGTH files */
+#define SERVER_LINE_MAX           (STR_MAX * (FILE_LIST_MAX_LENGTH + 2))
+
+/* field delimiter of a request or reply */
+#define SERVER_FIELD_DELIM        '\t'
+
+/*
+** Function Prototypes
+** -----------------------------------------------------
+*/
+
+/** @brief  serve job requests until SHUTDOWN is requested or *p_stop is
+ *          set, queued jobs are completed before returning
+ *  @param  *ctx                context holding the loaded lookup table
+ *  @param  *str_socket         socket path, replaced if it exists
+ *  @param  worker_cnt          jobs run at once, 1 to SERVER_MAX_WORKERS
+ *  @param  async_queue_depth   background export queue depth of each job
+ *  @param  *p_stop             set by a signal handler to stop serving
+ *  @return 0
+ *          err_null_string
+ *          err_maximum_number_exceeded   worker count not valid
+ *          err_file_not_accessible       socket cannot be created
+ */
+int
+server_run(atcContext *ctx, const char *str_socket, int worker_cnt,
+           int async_queue_depth, volatile sig_atomic_t *p_stop);
+
+/** @brief  send one request line to a server and wait for its reply
+ *  @param  *str_socket   socket path
+ *  @param  *str_request  request line without line terminator
+ *  @param  *str_reply    reply line output, terminator removed
+ *  @param  size          size of str_reply
+ *  @return 0
+ *          err_null_string
+ *          err_insufficient_buffer_size
+ *          err_file_not_accessible       server not reachable
+ *          err_end_of_file_reached       connection closed without reply
+ */
+int
+server_request(const char *str_socket, const char *str_request,
+               char *str_reply, size_t size);
+
+#endif
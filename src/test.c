@@ -7,6 +7,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include "atc_speed_profile_tool.h"
+#include "quantile_sketch.h"
+#include "run_index.h"
 
 
 void 
@@ -170,8 +172,45 @@ test_parse_input_data()
   err = parse_input_data(&data, str_data_line, str_data_file);
   printf("[parse_input_data][err = %d][%s]\n", err, get_err_description(err));
   printf("[parse_input_data][%s]\n", input_data_to_string(&data));
-  
 
+  /* outside the time window */
+  set_time_window(str_to_seconds("2018/08/27 20:00:00"), str_to_seconds("2018/08/27 20:30:00"), false);
+  strcpy(str_data_line, "2018/08/27 20:59:28,Highway 407,IVB_483,H131,L,H,K,R,64,A,A,1,1,0,0,0,1,0,5");
+  err = parse_input_data(&data, str_data_line, str_data_file);
+  printf("[parse_input_data][window][err = %d][%s]\n", err, (INPUT_ROW_FILTERED == err) ? "FILTERED" : "KEPT");
+  strcpy(str_data_line, "2018/08/27 20:00:00,Sheppard West,IVB_504,K171,R,K,H,R,20,A,A,1,1,0,0,0,1,0,4");
+  err = parse_input_data(&data, str_data_line, str_data_file);
+  printf("[parse_input_data][window][err = %d][%s]\n", err, (INPUT_ROW_FILTERED == err) ? "FILTERED" : "KEPT");
+  set_time_window(-1, -1, false);
+
+  /* filters not valid, nothing is filtered */
+  err = add_cc_filter(CC_ID_MAX + 1);
+  printf("[add_cc_filter][err = %d][%s]\n", err, get_err_description(err));
+  err = add_station_filter("", "N");
+  printf("[add_station_filter][err = %d][%s]\n", err, get_err_description(err));
+}
+
+void 
+test_input_data_format()
+{
+  inputData data = {0};
+  char str_data_line[STR_MAX] = "";
+  char str_data_file[STR_MAX] = "1234.csv";
+  char buf_small[STR_SHORT] = "";
+  char buf[STR_EXTRA] = "";
+  size_t len = 0;
+
+  strcpy(str_data_line, "2018/08/27 20:00:00,Sheppard West,IVB_504,K171,R,K,H,R,20,A,A,1,1,0,0,0,1,0,4");
+  parse_input_data(&data, str_data_line, str_data_file);
+  /* full record */
+  len = input_data_format(buf, STR_EXTRA, &data);
+  printf("[input_data_format][len = %zu][%s]\n", len, buf);
+  /* truncated record reports the same length */
+  len = input_data_format(buf_small, STR_SHORT, &data);
+  printf("[input_data_format][len = %zu][%s]\n", len, buf_small);
+  /* length query only */
+  len = input_data_format(NULL, 0, &data);
+  printf("[input_data_format][len = %zu]\n", len);
 }
 
 void 
@@ -301,6 +340,63 @@ test_read_input_file()
 
 }
 
+void
+test_read_input_file_dirty()
+{
+  atcContext *ctx = atc_context_create();
+  toolStats stats = {0};
+  FILE *fp = NULL;
+  const char *str_file = "test_traindata_dirty.csv";
+  int err = 0;
+  int i = 0;
+  /* error code and rows expected in the report */
+  struct { int err; uint64_t cnt; } expected[] = 
+  {
+    {err_file_format_not_valid, 1},
+    {err_date_not_valid, 2},
+    {err_cc_not_valid, 1},
+    {err_motion_not_valid, 1}
+  };
+
+  fp = fopen(str_file, "w");
+  fprintf(fp, "TIME,LOCATION,BLOCK,RUN NUMBER,DIRECTION,DESTINATION CODE,ORIGINATION CODE, SCHEDULE CLASS,CC ID, CURRENT DRIVING MODE, SELECTED DRIVING MODE,TALKATIVE, MOTION, SKIP STOP, DOORS OPEN,DOOR FAULT, ALARM, EMERGENCY BRAKE, SPEED\n");
+  fprintf(fp, "2018/08/27 20:00:00,Sheppard West,IVB_504,K171,R,K,H,R,20,A,A,1,1,0,0,0,1,0,4\n");
+  fprintf(fp, "not a train data row\n");
+  fprintf(fp, "2018/13/27 20:00:01,Sheppard West,IVB_504,K171,R,K,H,R,20,A,A,1,1,0,0,0,1,0,4\n");
+  fprintf(fp, "2018/08/27 20:00:02,Sheppard West,IVB_504,K171,R,K,H,R,20,A,A,1,1,0,0,0,1,0,4\n");
+  fprintf(fp, "2018/08/00 20:00:03,Sheppard West,IVB_504,K171,R,K,H,R,20,A,A,1,1,0,0,0,1,0,4\n");
+  fprintf(fp, "2018/08/27 20:00:04,Sheppard West,IVB_504,K171,R,K,H,R,1200,A,A,1,1,0,0,0,1,0,4\n");
+  fprintf(fp, "2018/08/27 20:00:05,Sheppard West,IVB_504,K171,R,K,H,R,20,A,A,1,2,0,0,0,1,0,4\n");
+  fprintf(fp, "2018/08/27 20:00:06,Sheppard West,IVB_504,K171,R,K,H,R,20,A,A,1,1,0,0,0,1,0,4\n");
+  fclose(fp);
+
+  /* bad rows are counted and skipped, the good rows after them are read */
+  err_report_reset();
+  err = atc_read_input_file(ctx, (char *) str_file);
+  atc_get_tool_stats(ctx, &stats);
+  printf("[read_input_file][dirty][err = %d][%s]\n", err, get_err_description(err));
+  printf
+  (
+    "[read_input_file][dirty][rows kept %llu][expected 3][%s]\n", 
+    (unsigned long long) stats.input_cnt, 
+    (3 == stats.input_cnt) ? "PASSED" : "FAILED"
+  );
+  for (i = 0; i < (int) (sizeof(expected) / sizeof(expected[0])); i++)
+  {
+    printf
+    (
+      "[read_input_file][dirty][%s][%llu][expected %llu][%s]\n", 
+      get_err_description(expected[i].err), 
+      (unsigned long long) err_report_total(expected[i].err), 
+      (unsigned long long) expected[i].cnt,
+      (expected[i].cnt == err_report_total(expected[i].err)) ? "PASSED" : "FAILED"
+    );
+  }
+  err_report_reset();
+  atc_context_free(ctx);
+  remove(str_file);
+}
+
 void
 test_expand_data_use_lut()
 {
@@ -329,6 +425,272 @@ test_export_run_profile_file()
   printf("[export_run_profile_file][%d][err = %d][%s]\n", __LINE__, err, get_err_description(err));
 }
 
+void
+test_export_run_profile_file_async()
+{
+  int err = 0;
+  /* same output list again, names must not collide with queued files */
+  set_async_export(2, false);
+  err = export_run_profile_file();
+  printf("[export_run_profile_file][async][%d][err = %d][%s]\n", __LINE__, err, get_err_description(err));
+  set_async_export(0, false);
+}
+
+void
+test_update_block_stats()
+{
+  int err = 0;
+  /* saved statistics are added to, not replaced */
+  err = update_block_stats("test_block_stats.csv");
+  printf("[update_block_stats][%d][err = %d][%s]\n", __LINE__, err, get_err_description(err));
+  err = update_block_stats("test_block_stats.csv");
+  printf("[update_block_stats][again][%d][err = %d][%s]\n", __LINE__, err, get_err_description(err));
+  remove("test_block_stats.csv");
+}
+
+/* deterministic speeds in (0, 100] km/h for the sketch tests */
+static double
+test_sketch_value(int i)
+{
+  return (double) ((i * 7919) % 1000 + 1) / 10.0;
+}
+
+static int
+test_compare_double(const void *a, const void *b)
+{
+  double x = *(const double *) a;
+  double y = *(const double *) b;
+
+  return (x > y) - (x < y);
+}
+
+void
+test_quantile_sketch_accuracy()
+{
+  quantileSketch sketch;
+  double values[1000];
+  double q[3] = {0.5, 0.9, 0.99};
+  double estimate = 0;
+  double exact = 0;
+  int cnt = (int) (sizeof(values) / sizeof(values[0]));
+  int err = 0;
+  int i = 0;
+
+  sketch_init(&sketch, SKETCH_ACCURACY);
+  for (i = 0; i < cnt; i++)
+  {
+    values[i] = test_sketch_value(i);
+    sketch_add(&sketch, values[i]);
+  }
+  qsort(values, cnt, sizeof(double), test_compare_double);
+  /* the sketch returns the value at rank q * (count - 1) within its 
+  ** relative accuracy */
+  for (i = 0; i < 3; i++)
+  {
+    err = sketch_quantile(&sketch, q[i], &estimate);
+    exact = values[(int) (q[i] * (cnt - 1))];
+    printf
+    (
+      "[quantile_sketch][p%g][%f][exact %f][err = %d][%s]\n", 
+      q[i] * 100, 
+      estimate, 
+      exact, 
+      err,
+      ((err >= 0) && (estimate >= exact * (1 - SKETCH_ACCURACY)) && 
+       (estimate <= exact * (1 + SKETCH_ACCURACY))) ? "PASSED" : "FAILED"
+    );
+  }
+  sketch_free(&sketch);
+}
+
+void
+test_quantile_sketch_merge()
+{
+  quantileSketch first;
+  quantileSketch second;
+  quantileSketch combined;
+  strBuffer str_merged = {0};
+  strBuffer str_combined = {0};
+  int err = 0;
+  int i = 0;
+
+  sketch_init(&first, SKETCH_ACCURACY);
+  sketch_init(&second, SKETCH_ACCURACY);
+  sketch_init(&combined, SKETCH_ACCURACY);
+  /* the halves cover different ranges so merging adds bins on both ends */
+  for (i = 0; i < 1000; i++)
+  {
+    sketch_add((i < 500) ? &first : &second, test_sketch_value(i) * ((i < 500) ? 1 : 40));
+    sketch_add(&combined, test_sketch_value(i) * ((i < 500) ? 1 : 40));
+  }
+  err = sketch_merge(&first, &second);
+  sketch_format(&first, &str_merged);
+  sketch_format(&combined, &str_combined);
+  printf
+  (
+    "[quantile_sketch][merge][err = %d][%s]\n", 
+    err, 
+    ((err >= 0) && (0 == strcmp(str_merged.data, str_combined.data))) ? "PASSED" : "FAILED"
+  );
+  str_buffer_free(&str_merged);
+  str_buffer_free(&str_combined);
+  sketch_free(&first);
+  sketch_free(&second);
+  sketch_free(&combined);
+}
+
+void
+test_quantile_sketch_format()
+{
+  quantileSketch sketch;
+  quantileSketch parsed;
+  strBuffer str_sketch = {0};
+  strBuffer str_parsed = {0};
+  double value = 0;
+  double value_parsed = 0;
+  int err = 0;
+  int i = 0;
+
+  sketch_init(&sketch, SKETCH_ACCURACY);
+  sketch_add(&sketch, 0);
+  for (i = 0; i < 1000; i++)
+  {
+    sketch_add(&sketch, test_sketch_value(i));
+  }
+  sketch_format(&sketch, &str_sketch);
+  err = sketch_parse(&parsed, str_sketch.data);
+  if (err >= 0)
+  {
+    sketch_format(&parsed, &str_parsed);
+    sketch_quantile(&sketch, 0.9, &value);
+    sketch_quantile(&parsed, 0.9, &value_parsed);
+  }
+  printf
+  (
+    "[quantile_sketch][format][err = %d][%s]\n", 
+    err, 
+    ((err >= 0) && (0 == strcmp(str_sketch.data, str_parsed.data)) && 
+     (value == value_parsed) && (sketch.count == parsed.count)) ? "PASSED" : "FAILED"
+  );
+  /* a damaged record is refused */
+  sketch_free(&parsed);
+  err = sketch_parse(&parsed, "0.01,3,x");
+  printf("[quantile_sketch][format][damaged][err = %d][%s]\n", err, (err < 0) ? "PASSED" : "FAILED");
+  str_buffer_free(&str_sketch);
+  str_buffer_free(&str_parsed);
+  sketch_free(&sketch);
+}
+
+
+/* runs of the index matching a key and starting in [from, to), searched
+** the way atc_speed_profile_query does */
+static size_t
+test_run_index_count(const runIndex *idx, const char *str_station, const char *str_platform,
+                     int cc_id, int key_fields, int64_t from, int64_t to)
+{
+  runIndexRecord key = {0};
+  const runIndexRecord *p_records = NULL;
+  size_t cnt = 0;
+  size_t match_cnt = 0;
+  size_t i = 0;
+
+  strcpy(key.str_station_code, str_station);
+  strcpy(key.str_platform, str_platform);
+  key.cc_id = cc_id;
+  p_records = run_index_records(idx, &cnt);
+  if (k_key_cc == key_fields)
+  {
+    /* runs of one train from one platform are in start time order */
+    key.start_time = from;
+    i = run_index_lower_bound(idx, &key, k_key_start_time);
+  }
+  else
+  {
+    i = run_index_lower_bound(idx, &key, key_fields);
+  }
+  for (; i < cnt; i++)
+  {
+    if ((0 != run_index_compare(&p_records[i], &key, key_fields)) ||
+        ((k_key_cc == key_fields) && (p_records[i].start_time >= to)))
+    {
+      break;
+    }
+    if ((p_records[i].start_time >= from) && (p_records[i].start_time < to))
+    {
+      match_cnt++;
+    }
+  }
+  return match_cnt;
+}
+
+void
+test_run_index()
+{
+  const char *str_manifest = "test_run_profile_manifest.csv";
+  char str_index_file[STR_MAX] = "";
+  runIndex *idx = NULL;
+  FILE *fp = NULL;
+  size_t match_cnt = 0;
+  int err = 0;
+  int i = 0;
+  /* query and runs expected */
+  struct 
+  { 
+    const char *str_name; 
+    const char *str_station; 
+    const char *str_platform; 
+    int cc_id; 
+    int key_fields; 
+    int64_t from; 
+    int64_t to; 
+    size_t cnt; 
+  } queries[] = 
+  {
+    {"station", "SAA", "", 0, k_key_station, INT64_MIN, INT64_MAX, 5},
+    {"platform", "SAA", "N", 0, k_key_platform, INT64_MIN, INT64_MAX, 4},
+    {"cc", "SAA", "N", 1, k_key_cc, INT64_MIN, INT64_MAX, 3},
+    {"cc from to", "SAA", "N", 1, k_key_cc, 2000, 5000, 1},
+    {"station from to", "SAA", "", 0, k_key_station, 1200, 3000, 2},
+    {"cc after last run", "SAA", "N", 1, k_key_cc, 6000, INT64_MAX, 0},
+    {"station between", "SAAB", "", 0, k_key_station, INT64_MIN, INT64_MAX, 0},
+    {"station after last", "ZZZ", "", 0, k_key_station, INT64_MIN, INT64_MAX, 0}
+  };
+
+  /* rows out of key order, the index sorts them */
+  fp = fopen(str_manifest, "wb");
+  fprintf(fp, "Run_ID,Output_File,Station_Code,Platform,Direction,From_Station,To_Station,CC_ID,File_Cnt,Start_Timestamp,Row_Cnt,Travel_Time_[s],Distance_Travelled_[ft],Max_Speed_[km/h]\n");
+  fprintf(fp, "R1,R1.csv,SAA,N,N,Station AA,Station AB,001,00,1000,41,90.000000,4543.963400,70.000000\n");
+  fprintf(fp, "R2,R2.csv,SAB,N,N,Station AB,Station AC,001,00,2000,37,81.000000,3931.539933,70.000000\n");
+  fprintf(fp, "R3,R3.csv,SAA,S,S,Station AA,Station AZ,002,00,1500,41,90.000000,4543.963400,70.000000\n");
+  fprintf(fp, "R4,R4.csv,SAA,N,N,Station AA,Station AB,002,00,1200,41,90.000000,4543.963400,70.000000\n");
+  fprintf(fp, "R5,R5.csv,SAA,N,N,Station AA,Station AB,001,00,3000,41,90.000000,4543.963400,70.000000\n");
+  fprintf(fp, "R6,R6.csv,SAB,S,S,Station AB,Station AA,003,00,2500,37,81.000000,3931.539933,70.000000\n");
+  fprintf(fp, "R7,R7.csv,SAA,N,N,Station AA,Station AB,001,00,5000,41,90.000000,4543.963400,70.000000\n");
+  fclose(fp);
+
+  err = run_index_build(str_manifest);
+  idx = run_index_open(str_manifest);
+  printf("[run_index][build][err = %d][%s]\n", err, ((err >= 0) && (NULL != idx)) ? "PASSED" : "FAILED");
+  for (i = 0; (NULL != idx) && (i < (int) (sizeof(queries) / sizeof(queries[0]))); i++)
+  {
+    match_cnt = test_run_index_count(idx, queries[i].str_station, queries[i].str_platform, 
+                                     queries[i].cc_id, queries[i].key_fields, 
+                                     queries[i].from, queries[i].to);
+    printf
+    (
+      "[run_index][%s][%llu][expected %llu][%s]\n", 
+      queries[i].str_name, 
+      (unsigned long long) match_cnt, 
+      (unsigned long long) queries[i].cnt,
+      (queries[i].cnt == match_cnt) ? "PASSED" : "FAILED"
+    );
+  }
+  run_index_close(idx);
+  run_index_path(str_manifest, str_index_file, STR_MAX);
+  remove(str_index_file);
+  remove(str_manifest);
+}
+
 
 int 
 main(int argc, char *argv[])
@@ -342,6 +704,7 @@ main(int argc, char *argv[])
   test_is_csv_line();
   test_parse_input_header();
   test_parse_input_data();
+  test_input_data_format();
   test_parse_lut_data();
   test_get_output_file();
 
@@ -354,6 +717,7 @@ main(int argc, char *argv[])
   
   test_read_lut_file();
   test_read_input_file();
+  test_read_input_file_dirty();
 
   /* sort input data list */
   err = sort_input_data_list();
@@ -371,6 +735,12 @@ main(int argc, char *argv[])
   display_output_data_list(); 
 
   test_export_run_profile_file();
+  test_export_run_profile_file_async();
+  test_update_block_stats();
+  test_quantile_sketch_accuracy();
+  test_quantile_sketch_merge();
+  test_quantile_sketch_format();
+  test_run_index();
 
   printf("[  INFO] TEST DONE\n");
   printf("[  INFO] Clean up ...");
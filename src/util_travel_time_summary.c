@@ -1,15 +1,31 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <windows.h>
+#include <string.h>
 #include <inttypes.h>
 #include <stdbool.h>
 #include <limits.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/stat.h>
 #include "common_util.h"
 #include "simclist.h"
+#include "quantile_sketch.h"
 
 #define LIST_MAX_SIZE     UINT_MAX
 #define RUN_PROFILES      "."
 #define SUMMARY_FILE_NAME "output//travel_time_summary.csv"
+#define PERCENTILE_FILE_NAME "output//travel_time_percentiles.csv"
+/* bytes read back from the end of a run profile to find its last line */
+#define TAIL_BLOCK_SIZE   (2 * STR_MAX)
+/* run profile file extension */
+#define RUN_PROFILE_EXT   ".csv"
+/* run profile index the tool writes next to the run profiles */
+#define RUN_PROFILE_MANIFEST "run_profile_manifest.csv"
+/* manifest columns, Run_ID through Max_Speed_[km/h] */
+#define MANIFEST_FIELD_CNT   14
+/* threads reading run profiles by default, and at most */
+#define SCAN_WORKERS      4
+#define SCAN_WORKERS_MAX  64
 
 /*
 ** Structures
@@ -30,6 +46,7 @@ typedef struct station_travel_time_t
   char filename[STR_MAX];
   char str_station_code[STR_MIN];
   char str_platform[STR_MIN];
+  char str_direction[STR_MIN];
   char str_cc_id[STR_MIN];
   char str_file_cnt[STR_MIN];
   char str_travel_time[STR_MIN];
@@ -40,6 +57,30 @@ typedef struct station_travel_time_t
 
 } station_travel_time;
 
+/* run profiles found under the scanned directory */
+typedef struct run_profile_scan_t
+{
+  /* paths, sorted */
+  char **p_paths;
+  size_t cnt;
+  size_t cap;
+  /* parsed run profile and read error of each path */
+  station_travel_time *p_results;
+  int *p_errs;
+  /* next path to read, shared by the workers */
+  size_t next;
+  pthread_mutex_t lock;
+} runProfileScan;
+
+/* travel time distribution of the runs departing one platform */
+typedef struct travel_time_group_t
+{
+  char str_station_code[STR_MIN];
+  char str_platform[STR_MIN];
+  char str_direction[STR_MIN];
+  quantileSketch sketch;
+} travelTimeGroup;
+
 /*
 ** Variables
 ** -----------------------------------------------------
@@ -52,6 +93,12 @@ static list_t station_travel_time_list;
 static uint64_t list_id = 0;
 /* static string to support _to_string function */
 static char str_static_data[STR_EXTRA];
+/* runs go to the sketch of their group instead of the list */
+static bool b_percentiles = false;
+/* groups sorted by station, platform and direction */
+static travelTimeGroup *p_groups = NULL;
+static size_t group_cnt = 0;
+static size_t group_cap = 0;
 
 /* 
 ** Supporting Functions (If any)
@@ -138,6 +185,51 @@ add_to_station_travel_time_list(station_travel_time *data)
   return 0;
 }
 
+/** @brief  format station_travel_time as a csv record into a caller 
+ *      supplied buffer in a single pass, the output is truncated if the 
+ *      buffer is too small
+ *  @param  *buf   destination buffer 
+ *  @param  size   destination buffer size in bytes
+ *  @param  *data  station_travel_time to be converted 
+ *  @return number of characters needed, excluding the null terminator
+ *             
+ */
+size_t
+station_travel_time_format(char *buf, size_t size, const station_travel_time *data)
+{
+  strCursor cur;
+
+  str_cursor_init(&cur, buf, size);
+  if (NULL == data)
+  {
+    return 0;
+  }
+
+  str_cursor_printf(&cur, "%010" PRIu64 ",", data->id);
+  str_cursor_puts(&cur, data->sorting_str);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->filename);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_timestamp);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_station_code);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_platform);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_cc_id);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_file_cnt);
+  str_cursor_putc(&cur, ',');
+  str_cursor_puts(&cur, data->str_travel_time);
+  str_cursor_putc(&cur, ',');
+  str_cursor_printf(&cur, "%03d,%02d,% .1f", 
+                    data->cc_id, 
+                    data->file_cnt, 
+                    data->travel_time_s);
+
+  return cur.len;
+}
+
 /** @brief  convert inputData and format into string 
  *  @param  *data  inputData to be converted 
  *  @return NULL      input is not valid
@@ -147,209 +239,428 @@ add_to_station_travel_time_list(station_travel_time *data)
 char *
 station_travel_time_to_string(station_travel_time *data)
 {
-  char tmp[STR_EXTRA] = "";
-
   if (NULL == data)
   {
     return NULL;
   }  
-  snprintf(tmp, STR_EXTRA, "%010" PRIu64 ",", data->id);
-  strcpy(str_static_data, tmp);
-  if (NULL != data->sorting_str)
-  {    
-    strcat(str_static_data, data->sorting_str);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->filename)
-  {    
-    strcat(str_static_data, data->filename);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_timestamp)
-  {    
-    strcat(str_static_data, data->str_timestamp);
-  } 
-  strcat(str_static_data, ",");
-  if (NULL != data->str_station_code)
-  {    
-    strcat(str_static_data, data->str_station_code);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_platform)
-  {    
-    strcat(str_static_data, data->str_platform);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_cc_id)
-  {    
-    strcat(str_static_data, data->str_cc_id);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_file_cnt)
-  {    
-    strcat(str_static_data, data->str_file_cnt);
-  }
-  strcat(str_static_data, ",");
-  if (NULL != data->str_travel_time)
-  {    
-    strcat(str_static_data, data->str_travel_time);
-  }
-  strcat(str_static_data, ",");
-
-  snprintf(tmp, STR_EXTRA, "%03d,%02d,% .1f", 
-           data->cc_id, 
-           data->file_cnt, 
-           data->travel_time_s);
-  strcat(str_static_data, tmp);
-
+  station_travel_time_format(str_static_data, STR_EXTRA, data);
   return str_static_data;
 }
 
-/** @brief  read input data file and add to input data list 
- *  @param  *str_lut_file  input data file path 
- *  @return err_list_append_failed 
+/** @brief  read the last line of a file from its final block, as the last
+ *          fgets of a forward read in text mode would return it
+ *  @param  *p_data_file  file opened in binary mode
+ *  @param  *str_line     last line output, line terminator included
+ *  @param  size          size of str_line, the fgets buffer size
+ *  @return true          last line read
+ *          false         not found in the final block, or longer than a 
+ *                        forward read takes in one fgets, read forward
+ */
+static bool
+read_last_line(FILE *p_data_file, char *str_line, size_t size)
+{
+  char buf[TAIL_BLOCK_SIZE];
+  long len = 0;
+  long start = 0;
+  size_t n = 0;
+  size_t end = 0;
+  size_t line_start = 0;
+  bool b_newline = false;
+
+  if ((0 != fseek(p_data_file, 0, SEEK_END)) || ((len = ftell(p_data_file)) < 0))
+  {
+    return false;
+  }
+  start = (len > TAIL_BLOCK_SIZE) ? len - TAIL_BLOCK_SIZE : 0;
+  if ((0 != fseek(p_data_file, start, SEEK_SET)) ||
+      ((size_t) (len - start) != (n = fread(buf, 1, (size_t) (len - start), p_data_file))))
+  {
+    return false;
+  }
+
+  /* line terminator of the last line, CRLF read as in text mode */
+  end = n;
+  if ((end > 0) && ('\n' == buf[end - 1]))
+  {
+    b_newline = true;
+    end--;
+    if ((end > 0) && ('\r' == buf[end - 1]))
+    {
+      end--;
+    }
+  }
+  line_start = end;
+  while ((line_start > 0) && ('\n' != buf[line_start - 1]))
+  {
+    line_start--;
+  }
+  if ((0 == line_start) && (start > 0))
+  {
+    /* the last line starts before the final block */
+    return false;
+  }
+  if (end - line_start + (b_newline ? 1 : 0) > size - 1)
+  {
+    /* a forward read splits the line over several fgets */
+    return false;
+  }
+  memcpy(str_line, buf + line_start, end - line_start);
+  str_line[end - line_start] = '\0';
+  if (b_newline)
+  {
+    strcat(str_line, "\n");
+  }
+  return true;
+}
+
+/** @brief  get the file name of a path, either path delimiter accepted
+ *  @param  *str_path  path
+ *  @return file name within str_path
+ */
+static const char *
+base_name(const char *str_path)
+{
+  const char *p_name = str_path;
+  const char *p = str_path;
+
+  for (; '\0' != *p; p++)
+  {
+    if (('/' == *p) || ('\\' == *p))
+    {
+      p_name = p + 1;
+    }
+  }
+  return p_name;
+}
+
+/** @brief  read the travel time from the last line of a run profile, and
+ *          the station, platform, train and file count from its name.
+ *          uses no shared state, run profiles are read by several threads
+ *  @param  *str_data_file  run profile path
+ *  @param  *input_data     travel time output, id and sorting_str are left
+ *                          to the caller
+ *  @return 0
+ *          err_null_string
  *          err_file_not_accessible 
+ *          err_file_format_not_valid  fields missing
  */
-int 
-read_input_file(char *str_data_file)
+static int
+parse_run_profile(const char *str_data_file, station_travel_time *input_data)
 {
-  
-  int err = 0; 
   int i = 0;
   
   char str_data_line[STR_MAX] = "";
   char tmp_line[STR_MAX] = "";
+  char str_name[STR_MAX] = "";
   char *str_tmp = NULL;
   char *p_tmp = NULL;
-  station_travel_time input_data = {0};
+  char *p_save = NULL;
   FILE * p_data_file = NULL; 
 
   if (NULL == str_data_file)
   {
-    fprintf
-    (
-      stdout, 
-      "[%6s][%s][%s]\n", 
-      "ERROR", 
-      "Data Files Not Defined!", 
-      str_data_file
-    );
-    err = throw_err(err_file_not_accessible);
-    return err; 
+    return throw_err(err_null_string);
+  }
+  if (strlen(str_data_file) >= STR_MAX)
+  {
+    return throw_err(err_insufficient_buffer_size);
   }
 
-  if (NULL != (p_data_file = fopen(str_data_file, "r")))
+  /* only the last line is used, it is read from the end of the file */
+  if ((NULL != (p_data_file = fopen(str_data_file, "rb"))) &&
+      (!read_last_line(p_data_file, tmp_line, STR_MAX)))
   {
-    /* skip through to last line */
-    while (NULL != (fgets(str_data_line, STR_MAX, p_data_file)) && (0 == err))
+    fclose(p_data_file);
+    if (NULL != (p_data_file = fopen(str_data_file, "r")))
     {
-      strncpy(tmp_line, str_data_line, STR_MAX);
+      /* skip through to last line */
+      while (NULL != (fgets(str_data_line, STR_MAX, p_data_file)))
+      {
+        strncpy(tmp_line, str_data_line, STR_MAX);
+      }
     }
-    /* tmp_line is the last line */
-    fclose(p_data_file);
+  }
+  if (NULL == p_data_file)
+  {
+    return throw_err(err_file_not_accessible);
+  }
+  /* tmp_line is the last line */
+  fclose(p_data_file);
 
-    str_tmp = strtok(tmp_line, ",");
-    while (i < 12)
+  memset(input_data, 0, sizeof(station_travel_time));
+  /* direction is only known from the manifest */
+  strncpy(input_data->str_direction, "_", STR_MIN);
+  str_tmp = strtok_r(tmp_line, ",", &p_save);
+  while ((i < 12) && (NULL != str_tmp))
+  {
+    str_tmp = strtok_r(NULL, ",", &p_save);
+    i++;
+  }
+  if (NULL == str_tmp)
+  {
+    return throw_err(err_file_format_not_valid);
+  }
+  strncpy(input_data->str_travel_time, trim(str_tmp), STR_MIN - 1);
+  input_data->travel_time_s = (double) (strtol(str_tmp, &p_tmp, 10));
+  
+  strncpy(input_data->filename, str_data_file, STR_MAX - 1);
+  /* fields of the name, directories excluded */
+  strcpy(str_name, base_name(str_data_file));
+  str_tmp = strtok_r(str_name, "_", &p_save);
+  i=0;
+  while (i <= 6)
+  {
+    str_tmp = strtok_r(NULL, "_", &p_save);
+    if (NULL == str_tmp)
     {
-      str_tmp = strtok(NULL, ",");
-      i++;
+      return throw_err(err_file_format_not_valid);
     }
-    strncpy(input_data.str_travel_time, trim(str_tmp), STR_MIN);
-    input_data.travel_time_s = (double) (strtol(str_tmp, &p_tmp, 10));
-    
-    strncpy(input_data.filename, str_data_file, STR_MAX);
-    str_tmp = strtok(str_data_file, "_");
-    i=0;
-    while (i <= 6)
+    if (2==i)
     {
-      str_tmp = strtok(NULL, "_");
-      if (2==i)
+      if (str_tmp[0] >= '0' && str_tmp[0] <= '9')
       {
-        if (str_tmp[0] >= '0' && str_tmp[0] <= '9')
-        {
-          /* station not known */
-          strncpy(input_data.str_station_code, "___", STR_MIN);
-          strncpy(input_data.str_platform, "_", STR_MIN);
+        /* station not known */
+        strncpy(input_data->str_station_code, "___", STR_MIN);
+        strncpy(input_data->str_platform, "_", STR_MIN);
 
-          /* token is file cnt */
-          strncpy(input_data.str_file_cnt, str_tmp, STR_MIN);
-          input_data.file_cnt = (int) strtol(str_tmp, (char **)NULL, 10);
+        /* token is file cnt */
+        strncpy(input_data->str_file_cnt, str_tmp, STR_MIN - 1);
+        input_data->file_cnt = (int) strtol(str_tmp, (char **)NULL, 10);
 
-          /* skip next iteration */
-          i++;
-        }
-        else if (str_tmp[0] >= 'A' && str_tmp[0] <= 'Z')
-        {
-          strncpy(input_data.str_station_code, str_tmp, STR_MIN);
-          input_data.str_station_code[3] = '\0';
-          input_data.str_platform[0] = str_tmp[3];
-          input_data.str_platform[1] = '\0';
-        }        
+        /* skip next iteration */
+        i++;
       }
+      else if (str_tmp[0] >= 'A' && str_tmp[0] <= 'Z')
+      {
+        strncpy(input_data->str_station_code, str_tmp, STR_MIN - 1);
+        input_data->str_station_code[3] = '\0';
+        input_data->str_platform[0] = str_tmp[3];
+        input_data->str_platform[1] = '\0';
+      }        
+    }
 
-      else if (3==i)
+    else if (3==i)
+    {
+      strncpy(input_data->str_file_cnt, str_tmp, STR_MIN - 1);
+      input_data->file_cnt = (int) strtol(str_tmp, (char **)NULL, 10);
+    }
+    else if (4==i)
+    {
+      if (strlen(str_tmp) < 5)
       {
-        strncpy(input_data.str_file_cnt, str_tmp, STR_MIN);
-        input_data.file_cnt = (int) strtol(str_tmp, (char **)NULL, 10);
+        return throw_err(err_file_format_not_valid);
       }
-      else if (4==i)
-      {
-        input_data.str_cc_id[0] = str_tmp[2];
-        input_data.str_cc_id[1] = str_tmp[3];
-        input_data.str_cc_id[2] = str_tmp[4];
-        input_data.str_cc_id[3] = '\0';
+      input_data->str_cc_id[0] = str_tmp[2];
+      input_data->str_cc_id[1] = str_tmp[3];
+      input_data->str_cc_id[2] = str_tmp[4];
+      input_data->str_cc_id[3] = '\0';
 
-        input_data.cc_id = (int) strtol(input_data.str_cc_id, (char **)NULL, 10);
-      }
+      input_data->cc_id = (int) strtol(input_data->str_cc_id, (char **)NULL, 10);
+    }
 
-      i++;
+    i++;
+  }
+  return 0;
+}
+
+/** @brief  find the group of a station, platform and direction
+ *  @param  *str_station_code  station
+ *  @param  *str_platform      platform
+ *  @param  *str_direction     direction
+ *  @param  *p_group           group output, NULL if not found
+ *  @return position of the group, or where it would be inserted
+ */
+static size_t
+find_group(const char *str_station_code, const char *str_platform, 
+           const char *str_direction, travelTimeGroup **p_group)
+{
+  size_t lo = 0;
+  size_t hi = group_cnt;
+  size_t mid = 0;
+  int cmp = 0;
+
+  *p_group = NULL;
+  while (lo < hi)
+  {
+    mid = lo + (hi - lo) / 2;
+    if (0 == (cmp = strcmp(p_groups[mid].str_station_code, str_station_code)) &&
+        0 == (cmp = strcmp(p_groups[mid].str_platform, str_platform)))
+    {
+      cmp = strcmp(p_groups[mid].str_direction, str_direction);
     }
-    if (LIST_MAX_SIZE == list_id)
+    if (0 == cmp)
     {
-      /* reach the maximum number of input list id */
-      return throw_err(err_maximum_number_exceeded);
+      *p_group = &p_groups[mid];
+      return mid;
+    }
+    else if (cmp < 0)
+    {
+      lo = mid + 1;
     }
     else
     {
-      input_data.id = list_id;
-      list_id++;
+      hi = mid;
+    }
+  }
+  return lo;
+}
 
-      snprintf
-      (
-        input_data.sorting_str, 
-        STR_MEDIUM,
-        "%s%s%s%s", 
-        input_data.str_station_code, 
-        input_data.str_platform, 
-        input_data.str_cc_id, 
-        input_data.str_file_cnt
-      );
+/** @brief  get the group of a station, platform and direction, a new
+ *          group is added with an empty sketch
+ *  @param  *str_station_code  station
+ *  @param  *str_platform      platform
+ *  @param  *str_direction     direction
+ *  @param  accuracy           accuracy of the sketch of a new group
+ *  @param  **p_group          group output
+ *  @return 0
+ *          err_list_append_failed   not enough memory
+ */
+static int
+get_group(const char *str_station_code, const char *str_platform, 
+          const char *str_direction, double accuracy, travelTimeGroup **p_group)
+{
+  travelTimeGroup *p_tmp = NULL;
+  size_t pos = find_group(str_station_code, str_platform, str_direction, p_group);
+  size_t cap = 0;
+  int err = 0;
 
-      /* add input data to input data list */
-      err = add_to_station_travel_time_list(&input_data);
-      /* check err */
-      if (err < 0)
-      {
-        fprintf
-        (
-          stdout, 
-          "[%6s][%s][%s][%s][%s]\n", 
-          "ERROR", 
-          "line is not appended correctly",
-          get_err_description(err),
-          str_data_file, 
-          str_data_line
-        );
-        
-      }
+  if (NULL != *p_group)
+  {
+    return 0;
+  }
+  if (group_cnt == group_cap)
+  {
+    cap = (0 == group_cap) ? 64 : 2 * group_cap;
+    if (NULL == (p_tmp = realloc(p_groups, cap * sizeof(travelTimeGroup))))
+    {
+      return throw_err(err_list_append_failed);
     }
+    p_groups = p_tmp;
+    group_cap = cap;
   }
-  else
+  memmove(&p_groups[pos + 1], &p_groups[pos], (group_cnt - pos) * sizeof(travelTimeGroup));
+  group_cnt++;
+  *p_group = &p_groups[pos];
+  memset(*p_group, 0, sizeof(travelTimeGroup));
+  strncpy((*p_group)->str_station_code, str_station_code, STR_MIN - 1);
+  strncpy((*p_group)->str_platform, str_platform, STR_MIN - 1);
+  strncpy((*p_group)->str_direction, str_direction, STR_MIN - 1);
+  if ((err = sketch_init(&(*p_group)->sketch, accuracy)) < 0)
   {
-    fprintf(stdout, "[%6s][%s][%s]\n", "ERROR", "Data Files Not Found!", str_data_file);
-    err = throw_err(err_file_not_accessible);
+    memmove(&p_groups[pos], &p_groups[pos + 1], (group_cnt - pos - 1) * sizeof(travelTimeGroup));
+    group_cnt--;
+    *p_group = NULL;
+  }
+  return err;
+}
+
+/** @brief  release the groups and their sketches
+ *  @return none
+ */
+static void
+free_groups()
+{
+  size_t i = 0;
+
+  for (i = 0; i < group_cnt; i++)
+  {
+    sketch_free(&p_groups[i].sketch);
+  }
+  free(p_groups);
+  p_groups = NULL;
+  group_cnt = 0;
+  group_cap = 0;
+}
+
+/** @brief  number a parsed run profile and add it to the input data list
+ *          or, for percentiles, to the sketch of its group
+ *  @param  *input_data  parsed run profile
+ *  @return err_list_append_failed 
+ *          err_maximum_number_exceeded
+ */
+static int
+add_run_profile(station_travel_time *input_data)
+{
+  travelTimeGroup *p_group = NULL;
+  int err = 0;
+
+  if (b_percentiles)
+  {
+    /* one bin increment, the run itself is not kept */
+    if ((err = get_group(input_data->str_station_code, input_data->str_platform,
+                         input_data->str_direction, SKETCH_ACCURACY, &p_group)) < 0)
+    {
+      return err;
+    }
+    return sketch_add(&p_group->sketch, input_data->travel_time_s);
+  }
+  if (LIST_MAX_SIZE == list_id)
+  {
+    /* reach the maximum number of input list id */
+    return throw_err(err_maximum_number_exceeded);
   }
+  input_data->id = list_id;
+  list_id++;
 
+  snprintf
+  (
+    input_data->sorting_str, 
+    STR_MEDIUM,
+    "%s%s%s%s", 
+    input_data->str_station_code, 
+    input_data->str_platform, 
+    input_data->str_cc_id, 
+    input_data->str_file_cnt
+  );
+
+  /* add input data to input data list */
+  return add_to_station_travel_time_list(input_data);
+}
+
+/** @brief  read input data file and add to input data list 
+ *  @param  *str_data_file  input data file path 
+ *  @return err_list_append_failed 
+ *          err_file_not_accessible 
+ *          err_file_format_not_valid
+ */
+int 
+read_input_file(char *str_data_file)
+{
+  station_travel_time input_data = {0};
+  int err = 0; 
+
+  if (NULL == str_data_file)
+  {
+    fprintf
+    (
+      stdout, 
+      "[%6s][%s][%s]\n", 
+      "ERROR", 
+      "Data Files Not Defined!", 
+      str_data_file
+    );
+    return throw_err(err_file_not_accessible);
+  }
+  if ((err = parse_run_profile(str_data_file, &input_data)) < 0)
+  {
+    if (err_file_not_accessible == -err)
+    {
+      fprintf(stdout, "[%6s][%s][%s]\n", "ERROR", "Data Files Not Found!", str_data_file);
+    }
+    return err;
+  }
+  if ((err = add_run_profile(&input_data)) < 0)
+  {
+    fprintf
+    (
+      stdout, 
+      "[%6s][%s][%s][%s]\n", 
+      "ERROR", 
+      "line is not appended correctly",
+      get_err_description(err),
+      str_data_file
+    );
+  }
   return err;
 }
 
@@ -366,6 +677,7 @@ export_summary_file()
   FILE *fp_out = NULL;
 
   char output_file_full_path[STR_MAX] = "";
+  char str_record[STR_EXTRA] = "";
   
   int err = 0;
   station_travel_time *p_data = NULL;
@@ -470,11 +782,12 @@ export_summary_file()
         else
         {
           /* write the current output data to the output file */
+          station_travel_time_format(str_record, STR_EXTRA, p_data);
           fprintf
           (
             fp_out, 
             "%s\n", 
-            station_travel_time_to_string(p_data)
+            str_record
           );
 
         }
@@ -509,80 +822,311 @@ export_summary_file()
   }
 }
 
-int main()
-{	
-	
-	char current_dir[STR_MAX]; //Variable to store current working directory
-  char temp_csv_file[STR_MAX]; //Temp variable to store csv name (to be broken into tokens)
-	char csv_file[STR_MAX]; //Variable to store csv name
+/** @brief  add a path to the scanned run profiles
+ *  @param  *scan      scanned run profiles
+ *  @param  *str_path  path
+ *  @return 0
+ *          err_list_append_failed         not enough memory
+ *          err_maximum_number_exceeded
+ */
+static int
+add_scan_path(runProfileScan *scan, const char *str_path)
+{
+  char **p_paths = NULL;
+  size_t cap = 0;
 
+  if (scan->cnt == scan->cap)
+  {
+    if (LIST_MAX_SIZE == scan->cnt)
+    {
+      return throw_err(err_maximum_number_exceeded);
+    }
+    cap = (0 == scan->cap) ? 1024 : 2 * scan->cap;
+    if (NULL == (p_paths = realloc(scan->p_paths, cap * sizeof(char *))))
+    {
+      return throw_err(err_list_append_failed);
+    }
+    scan->p_paths = p_paths;
+    scan->cap = cap;
+  }
+  if (NULL == (scan->p_paths[scan->cnt] = strdup(str_path)))
+  {
+    return throw_err(err_list_append_failed);
+  }
+  scan->cnt++;
+  return 0;
+}
+
+/** @brief  collect the run profiles of a directory
+ *  @param  *scan       scanned run profiles
+ *  @param  *str_dir    directory
+ *  @param  b_recursive descend into sub directories
+ *  @return 0
+ *          err_file_not_accessible   directory cannot be opened
+ *          err_list_append_failed
+ *          err_maximum_number_exceeded
+ */
+static int
+scan_directory(runProfileScan *scan, const char *str_dir, bool b_recursive)
+{
+  char str_path[STR_MAX] = "";
+  struct dirent *p_entry = NULL;
+  struct stat st;
+  DIR *p_dir = NULL;
+  size_t len = 0;
   int err = 0;
 
-	WIN32_FIND_DATA fdFile; //WIN32_FIND_DATA is a struct that contains many file attributes.
-	HANDLE hfile = NULL; //Pointer to a struct for windows.
+  if (NULL == (p_dir = opendir(str_dir)))
+  {
+    return throw_err(err_file_not_accessible);
+  }
+  while ((err >= 0) && (NULL != (p_entry = readdir(p_dir))))
+  {
+    if ((0 == strcmp(p_entry->d_name, ".")) || 
+        (0 == strcmp(p_entry->d_name, "..")) ||
+        (0 == strcmp(p_entry->d_name, RUN_PROFILE_MANIFEST)))
+    {
+      continue;
+    }
+    /* files of the working directory keep their bare name */
+    if (0 == strcmp(str_dir, RUN_PROFILES))
+    {
+      len = (size_t) snprintf(str_path, STR_MAX, "%s", p_entry->d_name);
+    }
+    else
+    {
+      len = (size_t) snprintf(str_path, STR_MAX, "%s/%s", str_dir, p_entry->d_name);
+    }
+    if ((len >= STR_MAX) || (0 != stat(str_path, &st)))
+    {
+      fprintf(stdout, "[%6s][%s][%s]\n", "INFO", "Path Skipped!", p_entry->d_name);
+      continue;
+    }
+    if (S_ISDIR(st.st_mode))
+    {
+      if (b_recursive && (scan_directory(scan, str_path, true) < 0))
+      {
+        fprintf(stdout, "[%6s][%s][%s]\n", "INFO", "Directory Not Scanned!", str_path);
+        err_clear();
+      }
+    }
+    else if ((len > strlen(RUN_PROFILE_EXT)) && 
+             (0 == strcasecmp(str_path + len - strlen(RUN_PROFILE_EXT), RUN_PROFILE_EXT)))
+    {
+      err = add_scan_path(scan, str_path);
+    }
+  }
+  closedir(p_dir);
+  return err;
+}
 
-  strcpy(current_dir, RUN_PROFILES); //Retrieve the current working directory.
-	strcat(current_dir, "\\*.csv"); //Concatenate "\*.csv" to indicate extension to look for.		
-	
-	hfile = FindFirstFile(current_dir, &fdFile); //Find the first .csv file and save its info to data
-	
-  /* initiate the list */
+/** @brief  compare two run profiles by file name for qsort
+ *  @return strcmp of the file names
+ */
+static int
+compare_run_profile_name(const void *a, const void *b)
+{
+  return strcmp(((const station_travel_time *) a)->filename, 
+                ((const station_travel_time *) b)->filename);
+}
 
+/** @brief  add the run profiles listed in a manifest to the input data
+ *          list, instead of reading each run profile. they are added in
+ *          file name order, as a scan of the directory would
+ *  @param  *fp       manifest
+ *  @param  *str_dir  directory of the manifest
+ *  @return 0
+ *          err_file_format_not_valid   header missing
+ *          err_list_append_failed      not enough memory
+ */
+static int
+read_manifest(FILE *fp, const char *str_dir)
+{
+  station_travel_time *p_rows = NULL;
+  station_travel_time *p_tmp = NULL;
+  station_travel_time *p_data = NULL;
+  size_t row_cnt = 0;
+  size_t row_cap = 0;
+  size_t i = 0;
+  char str_line[STR_EXTRA] = "";
+  char *p_fields[MANIFEST_FIELD_CNT];
+  char *p_tok = NULL;
+  int field_cnt = 0;
+  int err = 0;
 
-	/*
-	** If hfile returns an INVALID_HANDLE_VALUE, print the appropriate error message
-	** and terminate the program.
-	*/
-	if (hfile == INVALID_HANDLE_VALUE) 
+  /* header */
+  if (NULL == fgets(str_line, STR_EXTRA, fp))
   {
-    printf ("Unable to find any *.csv files. Terminating.\n");
-
-    return 0;
+    return throw_err(err_file_format_not_valid);
   }
-	else
-	{
-		printf("Searching for proper .csv files...\n");	
+  while (NULL != fgets(str_line, STR_EXTRA, fp))
+  {
+    str_line[strcspn(str_line, "\r\n")] = '\0';
+    field_cnt = 0;
+    p_tok = cstrtok(str_line, ',');
+    while ((NULL != p_tok) && (field_cnt < MANIFEST_FIELD_CNT))
+    {
+      p_fields[field_cnt++] = p_tok;
+      p_tok = cstrtok(NULL, ',');
+    }
+    if (MANIFEST_FIELD_CNT != field_cnt)
+    {
+      fprintf(stdout, "[%6s][%s][%s]\n", "INFO", "Manifest Row Not Valid!", str_line);
+      continue;
+    }
 
-    init_station_travel_time_list();
+    if (row_cnt == row_cap)
+    {
+      row_cap = (0 == row_cap) ? 1024 : 2 * row_cap;
+      if (NULL == (p_tmp = realloc(p_rows, row_cap * sizeof(station_travel_time))))
+      {
+        free(p_rows);
+        return throw_err(err_list_append_failed);
+      }
+      p_rows = p_tmp;
+    }
+    p_data = &p_rows[row_cnt++];
+    memset(p_data, 0, sizeof(station_travel_time));
+    /* same name as a scan of the directory would give */
+    if (0 == strcmp(str_dir, RUN_PROFILES))
+    {
+      snprintf(p_data->filename, STR_MAX, "%s%s", p_fields[0], RUN_PROFILE_EXT);
+    }
+    else
+    {
+      snprintf(p_data->filename, STR_MAX, "%s/%s%s", str_dir, p_fields[0], RUN_PROFILE_EXT);
+    }
+    strncpy(p_data->str_direction, ('\0' != p_fields[4][0]) ? p_fields[4] : "_", STR_MIN - 1);
+    if ('\0' != p_fields[2][0])
+    {
+      strncpy(p_data->str_station_code, p_fields[2], STR_MIN - 1);
+      strncpy(p_data->str_platform, p_fields[3], STR_MIN - 1);
+    }
+    else
+    {
+      /* station not known */
+      strncpy(p_data->str_station_code, "___", STR_MIN);
+      strncpy(p_data->str_platform, "_", STR_MIN);
+    }
+    strncpy(p_data->str_cc_id, p_fields[7], STR_MIN - 1);
+    p_data->cc_id = (int) strtol(p_fields[7], (char **)NULL, 10);
+    strncpy(p_data->str_file_cnt, p_fields[8], STR_MIN - 1);
+    p_data->file_cnt = (int) strtol(p_fields[8], (char **)NULL, 10);
+    strncpy(p_data->str_travel_time, p_fields[11], STR_MIN - 1);
+    p_data->travel_time_s = (double) strtol(p_fields[11], (char **)NULL, 10);
+  }
 
-    do
+  if (row_cnt > 0)
+  {
+    qsort(p_rows, row_cnt, sizeof(station_travel_time), compare_run_profile_name);
+  }
+  for (i = 0; i < row_cnt; i++)
+  {
+    if ((err = add_run_profile(&p_rows[i])) < 0)
     {
-      //Find first file will always return "."
-      //    and ".." as the first two directories.
-      if
+      fprintf
       (
-        strcmp(fdFile.cFileName, ".") != 0 && 
-        strcmp(fdFile.cFileName, "..") != 0 &&
-        !(fdFile.dwFileAttributes &FILE_ATTRIBUTE_DIRECTORY)
-      )
-      {
-        /* file found */
-        strcpy(temp_csv_file, fdFile.cFileName);
-        strcpy(csv_file, fdFile.cFileName);
+        stdout, 
+        "[%6s][%s][%s][%s]\n", 
+        "INFO", 
+        "Data Files Import Failed!", 
+        get_err_description(err), 
+        p_rows[i].filename
+      );
+    }
+  }
+  free(p_rows);
+  return 0;
+}
 
-        /* create a new node */
-        err = read_input_file(csv_file);
-        if (err < 0)
-        {
-          fprintf
-          (
-            stdout, 
-            "[%6s][%s][%s][%s]\n", 
-            "INFO", 
-            "Data Files Import Failed!", 
-            get_err_description(err), 
-            csv_file
-          );
-        }
-      
-      }
+/** @brief  compare two paths for qsort
+ *  @return strcmp of the paths
+ */
+static int
+compare_scan_path(const void *a, const void *b)
+{
+  return strcmp(*(char *const *) a, *(char *const *) b);
+}
+
+/** @brief  worker reading run profiles until none is left
+ *  @param  *arg  scanned run profiles
+ *  @return NULL
+ */
+static void *
+scan_worker(void *arg)
+{
+  runProfileScan *scan = (runProfileScan *) arg;
+  size_t i = 0;
+
+  for (;;)
+  {
+    pthread_mutex_lock(&scan->lock);
+    i = scan->next++;
+    pthread_mutex_unlock(&scan->lock);
+    if (i >= scan->cnt)
+    {
+      break;
     }
-    while(FindNextFile(hfile, &fdFile)); //Find the next file.
+    scan->p_errs[i] = parse_run_profile(scan->p_paths[i], &scan->p_results[i]);
+  }
+  return NULL;
+}
 
-    FindClose(hfile); //Always, Always, clean things up!
+/** @brief  read the scanned run profiles with a pool of workers, then add
+ *          them to the input data list in path order, so ids and output
+ *          do not depend on the number of workers
+ *  @param  *scan        scanned run profiles
+ *  @param  worker_cnt   number of workers
+ *  @return 0
+ *          err_list_append_failed   not enough memory
+ */
+static int
+read_run_profiles(runProfileScan *scan, int worker_cnt)
+{
+  pthread_t threads[SCAN_WORKERS_MAX];
+  int started = 0;
+  int err = 0;
+  size_t i = 0;
 
-    /* output the list to file */
-    err = export_summary_file();
+  if (0 == scan->cnt)
+  {
+    return 0;
+  }
+  if ((NULL == (scan->p_results = malloc(scan->cnt * sizeof(station_travel_time)))) ||
+      (NULL == (scan->p_errs = calloc(scan->cnt, sizeof(int)))))
+  {
+    return throw_err(err_list_append_failed);
+  }
+  scan->next = 0;
+  pthread_mutex_init(&scan->lock, NULL);
+  if ((size_t) worker_cnt > scan->cnt)
+  {
+    worker_cnt = (int) scan->cnt;
+  }
+  for (started = 0; started < worker_cnt; started++)
+  {
+    if (0 != pthread_create(&threads[started], NULL, scan_worker, scan))
+    {
+      break;
+    }
+  }
+  if (0 == started)
+  {
+    /* no thread available, read them here */
+    scan_worker(scan);
+  }
+  while (started > 0)
+  {
+    pthread_join(threads[--started], NULL);
+  }
+  pthread_mutex_destroy(&scan->lock);
+
+  for (i = 0; i < scan->cnt; i++)
+  {
+    if ((err = scan->p_errs[i]) >= 0)
+    {
+      err = add_run_profile(&scan->p_results[i]);
+    }
     if (err < 0)
     {
       fprintf
@@ -590,20 +1134,462 @@ int main()
         stdout, 
         "[%6s][%s][%s][%s]\n", 
         "INFO", 
-        "Summary File Export Failed!", 
+        "Data Files Import Failed!", 
         get_err_description(err), 
-        "Terminating..."
+        scan->p_paths[i]
       );
     }
+  }
+  return 0;
+}
+
+/** @brief  release the scanned run profiles
+ *  @param  *scan  scanned run profiles
+ *  @return none
+ */
+static void
+free_run_profile_scan(runProfileScan *scan)
+{
+  size_t i = 0;
+
+  for (i = 0; i < scan->cnt; i++)
+  {
+    free(scan->p_paths[i]);
+  }
+  free(scan->p_paths);
+  free(scan->p_results);
+  free(scan->p_errs);
+  memset(scan, 0, sizeof(runProfileScan));
+}
+
+/** @brief  merge the sketches saved by export_sketch_file into the groups
+ *  @param  *str_sketch_file  saved sketches
+ *  @return 0
+ *          err_file_not_accessible
+ *          err_file_format_not_valid   a row is not valid, or its accuracy
+ *                                      differs from the group
+ *          err_list_append_failed      not enough memory
+ */
+static int
+read_sketch_file(const char *str_sketch_file)
+{
+  travelTimeGroup *p_group = NULL;
+  quantileSketch sketch;
+  char str_chunk[STR_EXTRA] = "";
+  char *p_fields[3];
+  char *p_tok = NULL;
+  strBuffer line = {0};
+  FILE *fp = NULL;
+  size_t len = 0;
+  int field_cnt = 0;
+  int line_cnt = 0;
+  int err = 0;
+
+  if (NULL == (fp = fopen(str_sketch_file, "r")))
+  {
+    return throw_err(err_file_not_accessible);
+  }
+  /* a sketch row is longer than a line buffer, it is read in chunks */
+  while ((err >= 0) && (NULL != fgets(str_chunk, STR_EXTRA, fp)))
+  {
+    if (str_buffer_printf(&line, "%s", str_chunk) < 0)
+    {
+      err = throw_err(err_list_append_failed);
+      break;
+    }
+    len = strlen(str_chunk);
+    if ((len > 0) && ('\n' != str_chunk[len - 1]) && !feof(fp))
+    {
+      continue;
+    }
+    line.data[strcspn(line.data, "\r\n")] = '\0';
+    if ((0 == line_cnt++) || ('\0' == line.data[0]))
+    {
+      /* header */
+      line.len = 0;
+      continue;
+    }
+    field_cnt = 0;
+    p_tok = line.data;
+    while ((field_cnt < 3) && (NULL != p_tok))
+    {
+      p_fields[field_cnt++] = p_tok;
+      if (NULL != (p_tok = strchr(p_tok, ',')))
+      {
+        *p_tok++ = '\0';
+      }
+    }
+    if ((NULL == p_tok) || (sketch_parse(&sketch, p_tok) < 0))
+    {
+      err = throw_err(err_file_format_not_valid);
+    }
+    else
+    {
+      if ((err = get_group(p_fields[0], p_fields[1], p_fields[2], sketch.accuracy, &p_group)) >= 0)
+      {
+        err = sketch_merge(&p_group->sketch, &sketch);
+      }
+      sketch_free(&sketch);
+    }
+    line.len = 0;
+  }
+  str_buffer_free(&line);
+  fclose(fp);
+  return err;
+}
+
+/** @brief  open a new output file
+ *  @param  *str_file  output file
+ *  @param  **fp_out   opened file output
+ *  @return 0
+ *          err_file_already_exist
+ *          err_file_not_accessible
+ */
+static int
+create_output_file(const char *str_file, FILE **fp_out)
+{
+  int err = 0;
 
+  /* check if file already exist */
+  if (NULL != (*fp_out = fopen(str_file, "r")))
+  {
+    fclose(*fp_out);
+    *fp_out = NULL;
+    err = throw_err(err_file_already_exist);
+    fprintf
+    (
+      stdout, 
+      "[%6s][%s][%s][%s]\n", 
+      "ERROR", 
+      "Output File Already Exists!",
+      get_err_description(err),
+      str_file
+    );
   }
+  else if (NULL == (*fp_out = fopen(str_file, "w")))
+  {
+    err = throw_err(err_file_not_accessible);
+    fprintf
+    (
+      stdout, 
+      "[%6s][%d][%s][%s][%s]\n", 
+      "ERROR", 
+      errno,
+      "Output File Cannot Be Created!",
+      get_err_description(err),
+      str_file
+    );
+  }
+  return err;
+}
 
+/** @brief  generate the travel time percentiles of each group
+ *  @return 0
+ *          err_list_is_empty        no run
+ *          err_file_already_exist
+ *          err_file_not_accessible
+ */
+int
+export_percentile_file()
+{
+  FILE *fp_out = NULL;
+  const quantileSketch *p_sketch = NULL;
+  double p50 = 0;
+  double p90 = 0;
+  double p99 = 0;
+  size_t i = 0;
+  int err = 0;
+
+  if (0 == group_cnt)
+  {
+    return throw_err(err_list_is_empty);
+  }
+  if ((err = create_output_file(PERCENTILE_FILE_NAME, &fp_out)) < 0)
+  {
+    return err;
+  }
+  fprintf
+  (
+    fp_out, 
+    "%s,%s,%s,%s,%s,%s,%s,%s,%s,%s\n", 
+    "str_station_code",
+    "str_platform",
+    "str_direction",
+    "count",
+    "min_s",
+    "p50_s",
+    "p90_s",
+    "p99_s",
+    "max_s",
+    "mean_s"
+  );
+  for (i = 0; i < group_cnt; i++)
+  {
+    p_sketch = &p_groups[i].sketch;
+    if ((sketch_quantile(p_sketch, 0.50, &p50) < 0) ||
+        (sketch_quantile(p_sketch, 0.90, &p90) < 0) ||
+        (sketch_quantile(p_sketch, 0.99, &p99) < 0))
+    {
+      /* group without runs */
+      err_clear();
+      continue;
+    }
+    fprintf
+    (
+      fp_out, 
+      "%s,%s,%s,%" PRIu64 ",%5.1f,%5.1f,%5.1f,%5.1f,%5.1f,%5.1f\n", 
+      p_groups[i].str_station_code,
+      p_groups[i].str_platform,
+      p_groups[i].str_direction,
+      p_sketch->count,
+      p_sketch->min,
+      p50,
+      p90,
+      p99,
+      p_sketch->max,
+      p_sketch->sum / (double) p_sketch->count
+    );
+  }
+  if (0 != fclose(fp_out))
+  {
+    return throw_err(err_file_not_accessible);
+  }
+  return 0;
+}
+
+/** @brief  save the sketch of each group, merged later by --merge
+ *  @param  *str_sketch_file  output file
+ *  @return 0
+ *          err_file_already_exist
+ *          err_file_not_accessible
+ */
+int
+export_sketch_file(const char *str_sketch_file)
+{
+  FILE *fp_out = NULL;
+  strBuffer buf = {0};
+  size_t i = 0;
+  int err = 0;
+
+  if ((err = create_output_file(str_sketch_file, &fp_out)) < 0)
+  {
+    return err;
+  }
+  fprintf
+  (
+    fp_out, 
+    "%s,%s,%s,%s,%s,%s,%s,%s,%s,%s\n", 
+    "str_station_code",
+    "str_platform",
+    "str_direction",
+    "accuracy",
+    "count",
+    "zero_cnt",
+    "min_s",
+    "max_s",
+    "sum_s",
+    "bins"
+  );
+  for (i = 0; (i < group_cnt) && (err >= 0); i++)
+  {
+    buf.len = 0;
+    if ((err = sketch_format(&p_groups[i].sketch, &buf)) >= 0)
+    {
+      fprintf
+      (
+        fp_out, 
+        "%s,%s,%s,%s\n", 
+        p_groups[i].str_station_code,
+        p_groups[i].str_platform,
+        p_groups[i].str_direction,
+        buf.data
+      );
+    }
+  }
+  str_buffer_free(&buf);
+  if ((0 != fclose(fp_out)) && (err >= 0))
+  {
+    err = throw_err(err_file_not_accessible);
+  }
+  return err;
+}
+
+/** @brief  display utility usage
+ *  @return none
+ */
+static void
+display_summary_usage(char **argv)
+{
+  printf("USAGE: %s [OPTION]... [DIR]\n", strip_path(argv[0]));
+  printf("summarize the travel time of the run profiles in DIR (default current directory)\n");
+  printf("\n");
+  printf("OPTIONS:\n");
+  printf("  %-22s %s\n", "-r, --recursive", "include run profiles of sub directories");
+  printf("  %-22s %s\n", "--workers N", "threads reading run profiles (default 4)");
+  printf("  %-22s %s\n", "--scan", "read every run profile, even if DIR has a manifest");
+  printf("  %-22s %s\n", "--percentiles", "travel time p50/p90/p99 per station, platform and direction");
+  printf("  %-22s %s\n", "--sketch-out FILE", "also save the percentile sketches (implies --percentiles)");
+  printf("  %-22s %s\n", "--merge FILE", "merge saved sketches, repeatable (implies --percentiles),");
+  printf("  %-22s %s\n", "", "run profiles are only read when DIR is given");
+  printf("\n");
+}
+
+int main(int argc, char *argv[])
+{	
+  const char *str_dir = RUN_PROFILES;
+  runProfileScan scan;
+  char str_manifest[STR_MAX] = "";
+  FILE *fp_manifest = NULL;
+  const char *str_sketch_file = NULL;
+  const char **p_merge_files = NULL;
+  int merge_cnt = 0;
+  bool b_dir = false;
+  bool b_recursive = false;
+  bool b_scan = false;
+  int worker_cnt = SCAN_WORKERS;
+  char *p_end = NULL;
+  int err = 0;
+  int i = 0;
+
+  memset(&scan, 0, sizeof(runProfileScan));
+  if (NULL == (p_merge_files = calloc((size_t) argc, sizeof(char *))))
+  {
+    return EXIT_FAILURE;
+  }
+
+  for (i = 1; i < argc; i++)
+  {
+    if ((0 == strcmp(argv[i], "-r")) || (0 == strcmp(argv[i], "--recursive")))
+    {
+      b_recursive = true;
+    }
+    else if (0 == strcmp(argv[i], "--scan"))
+    {
+      b_scan = true;
+    }
+    else if (0 == strcmp(argv[i], "--percentiles"))
+    {
+      b_percentiles = true;
+    }
+    else if ((0 == strcmp(argv[i], "--sketch-out")) && (i + 1 < argc))
+    {
+      b_percentiles = true;
+      str_sketch_file = argv[++i];
+    }
+    else if ((0 == strcmp(argv[i], "--merge")) && (i + 1 < argc))
+    {
+      b_percentiles = true;
+      p_merge_files[merge_cnt++] = argv[++i];
+    }
+    else if ((0 == strcmp(argv[i], "--workers")) && (i + 1 < argc))
+    {
+      worker_cnt = (int) strtol(argv[++i], &p_end, 10);
+      if (('\0' != *p_end) || (worker_cnt < 1) || (worker_cnt > SCAN_WORKERS_MAX))
+      {
+        display_summary_usage(argv);
+        free(p_merge_files);
+        return EXIT_FAILURE;
+      }
+    }
+    else if (('-' != argv[i][0]) && !b_dir)
+    {
+      str_dir = argv[i];
+      b_dir = true;
+    }
+    else
+    {
+      display_summary_usage(argv);
+      free(p_merge_files);
+      return EXIT_FAILURE;
+    }
+  }
+
+  /* a manifest written by the tool lists every run profile of DIR, sub
+  ** directories have their own */
+  snprintf(str_manifest, STR_MAX, "%s/%s", str_dir, RUN_PROFILE_MANIFEST);
+  if ((merge_cnt > 0) && !b_dir)
+  {
+    /* roll up saved sketches only */
+    init_station_travel_time_list();
+  }
+  else if (!b_scan && !b_recursive && (NULL != (fp_manifest = fopen(str_manifest, "r"))))
+  {
+    printf("Reading run profile manifest...\n");
+
+    init_station_travel_time_list();
+
+    err = read_manifest(fp_manifest, str_dir);
+    fclose(fp_manifest);
+  }
+  else
+  {
+    printf("Searching for proper .csv files...\n");	
+
+    err = scan_directory(&scan, str_dir, b_recursive);
+    if ((err < 0) || (0 == scan.cnt))
+    {
+      printf ("Unable to find any *.csv files. Terminating.\n");
+      free_run_profile_scan(&scan);
+      free(p_merge_files);
+      return 0;
+    }
+    /* directory order differs between file systems */
+    qsort(scan.p_paths, scan.cnt, sizeof(char *), compare_scan_path);
+
+    init_station_travel_time_list();
+
+    err = read_run_profiles(&scan, worker_cnt);
+  }
+  for (i = 0; (i < merge_cnt) && (err >= 0); i++)
+  {
+    if ((err = read_sketch_file(p_merge_files[i])) < 0)
+    {
+      fprintf
+      (
+        stdout, 
+        "[%6s][%s][%s][%s]\n", 
+        "ERROR", 
+        "Sketch File Not Merged!", 
+        get_err_description(err), 
+        p_merge_files[i]
+      );
+    }
+  }
+  if ((err >= 0) && b_percentiles)
+  {
+    err = export_percentile_file();
+    if ((err >= 0) && (NULL != str_sketch_file))
+    {
+      err = export_sketch_file(str_sketch_file);
+    }
+  }
+  else if (err >= 0)
+  {
+    /* output the list to file */
+    err = export_summary_file();
+  }
+  if (err < 0)
+  {
+    fprintf
+    (
+      stdout, 
+      "[%6s][%s][%s][%s]\n", 
+      "INFO", 
+      "Summary File Export Failed!", 
+      get_err_description(err), 
+      "Terminating..."
+    );
+  }
+
+  free_run_profile_scan(&scan);
   free_station_travel_time_list();
+  free_groups();
+  free(p_merge_files);
 
+#ifdef _WIN32
   system("PAUSE");
-  
+#endif
   
   return EXIT_SUCCESS;
 
 }
-
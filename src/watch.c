@@ -0,0 +1,439 @@
+/*------------------------------------------------------
+**
+** File:      watch.c
+** Author:    Eric Lu
+** Created:   2026-10-19
+**
+** Copyright ©2012 Toronto Transit Commission
+**
+**
+** Function Description
+** -----------------------------------------------------
+**
+** directory watcher for the resident mode, see watch.h
+**
+** -----------------------------------------------------
+** Revision History
+**
+** 19 OCT 2026: Rev 1.0 - erilu
+**                      - Initial Design
+**
+** Inputs:
+** Directory to watch
+**
+** Outputs:
+** Paths of train data files ready to be processed
+**
+** ----------------------------------------------------
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#if defined(__linux__)
+#   include <poll.h>
+#   include <unistd.h>
+#   include <dirent.h>
+#   include <sys/stat.h>
+#   include <sys/inotify.h>
+#endif
+#include "atc_speed_profile_tool.h"
+#include "profiler.h"
+#include "watch.h"
+
+#if WATCH_SUPPORTED
+
+/*
+** Constants
+** -----------------------------------------------------
+*/
+
+/* inotify read buffer, holds several events with their names */
+#define WATCH_EVENT_BUF_SIZE      4096
+/* initial number of tracked files */
+#define WATCH_INIT_FILE_CNT       64
+
+/*
+** Structures
+** -----------------------------------------------------
+*/
+
+/* one train data file seen in the directory */
+typedef struct watch_file_t
+{
+  char name[STR_MAX];
+  /* waiting to settle before it is reported */
+  bool b_pending;
+  /* time of the last write notification, seconds */
+  double last_event_s;
+  /* size and modification time when last reported */
+  long long size;
+  long long mtime;
+} watchFile;
+
+struct watch_dir_t
+{
+  char dir[STR_MAX];
+  int fd;
+  int wd;
+  watchFile *files;
+  int file_cnt;
+  int file_size;
+};
+
+/*
+** Source Code
+** -----------------------------------------------------
+*/
+
+/** @brief  check if a file name is train data, run profiles written to the
+ *          same directory are ignored
+ *  @param  *name  file name without directory
+ *  @return true   train data file
+ *          false  any other file
+ */
+static bool
+is_train_data_name(const char *name)
+{
+  size_t len = strlen(name);
+
+  return (len > 4) &&
+         ('.' != name[0]) &&
+         (0 == strcmp(name + len - 4, ".csv")) &&
+         (NULL != strstr(name, WATCH_FILE_PATTERN)) &&
+         (NULL == strstr(name, RUN_PROFILE_PREFIX));
+}
+
+/** @brief  find a tracked file by name, adding it if not tracked yet
+ *  @param  *watch  watcher
+ *  @param  *name   file name without directory
+ *  @return NULL    not enough memory or name too long
+ *          pointer to the tracked file
+ */
+static watchFile *
+get_watch_file(watchDir *watch, const char *name)
+{
+  watchFile *p_files = NULL;
+  int i = 0;
+
+  for (i = 0; i < watch->file_cnt; i++)
+  {
+    if (0 == strcmp(watch->files[i].name, name))
+    {
+      return &watch->files[i];
+    }
+  }
+  if (strlen(name) >= STR_MAX)
+  {
+    return NULL;
+  }
+  if (watch->file_cnt >= watch->file_size)
+  {
+    p_files = realloc(watch->files, 2 * watch->file_size * sizeof(watchFile));
+    if (NULL == p_files)
+    {
+      return NULL;
+    }
+    watch->files = p_files;
+    watch->file_size *= 2;
+  }
+  p_files = &watch->files[watch->file_cnt++];
+  memset(p_files, 0, sizeof(watchFile));
+  strcpy(p_files->name, name);
+  p_files->size = -1;
+  p_files->mtime = -1;
+  return p_files;
+}
+
+/** @brief  mark every train data file in the directory pending, files
+ *          unchanged since they were last reported are skipped once they
+ *          settle
+ *  @param  *watch  watcher
+ *  @return 0
+ *          err_file_not_accessible
+ *          err_list_append_failed
+ */
+static int
+scan_dir(watchDir *watch)
+{
+  DIR *p_dir = NULL;
+  struct dirent *p_entry = NULL;
+  watchFile *p_file = NULL;
+  double now_s = profile_wall_time();
+  int err = 0;
+
+  if (NULL == (p_dir = opendir(watch->dir)))
+  {
+    return throw_err(err_file_not_accessible);
+  }
+  while ((0 == err) && (NULL != (p_entry = readdir(p_dir))))
+  {
+    if (!is_train_data_name(p_entry->d_name))
+    {
+      continue;
+    }
+    if (NULL == (p_file = get_watch_file(watch, p_entry->d_name)))
+    {
+      err = throw_err(err_list_append_failed);
+      break;
+    }
+    p_file->b_pending = true;
+    p_file->last_event_s = now_s;
+  }
+  closedir(p_dir);
+  return err;
+}
+
+/** @brief  read the pending notifications and mark the files written
+ *  @param  *watch  watcher
+ *  @return 0
+ *          err_file_not_accessible
+ *          err_list_append_failed
+ */
+static int
+read_events(watchDir *watch)
+{
+  char buf[WATCH_EVENT_BUF_SIZE]
+    __attribute__ ((aligned(__alignof__(struct inotify_event))));
+  const struct inotify_event *event = NULL;
+  watchFile *p_file = NULL;
+  ssize_t len = 0;
+  char *p = NULL;
+  int err = 0;
+
+  len = read(watch->fd, buf, sizeof(buf));
+  if (len < 0)
+  {
+    return ((EAGAIN == errno) || (EINTR == errno)) ?
+           0 : throw_err(err_file_not_accessible);
+  }
+  for (p = buf; p < buf + len; p += sizeof(struct inotify_event) + event->len)
+  {
+    event = (const struct inotify_event *) p;
+    if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED))
+    {
+      return throw_err(err_file_not_accessible);
+    }
+    if (event->mask & IN_Q_OVERFLOW)
+    {
+      /* notifications were dropped, look at the directory itself */
+      if ((err = scan_dir(watch)) < 0)
+      {
+        return err;
+      }
+      continue;
+    }
+    if ((0 == event->len) || !is_train_data_name(event->name))
+    {
+      continue;
+    }
+    if (NULL == (p_file = get_watch_file(watch, event->name)))
+    {
+      return throw_err(err_list_append_failed);
+    }
+    p_file->b_pending = true;
+    p_file->last_event_s = profile_wall_time();
+  }
+  return 0;
+}
+
+/** @brief  report the first settled file that changed since last reported
+ *  @param  *watch     watcher
+ *  @param  *str_file  path output
+ *  @param  size       size of str_file
+ *  @param  *wait_ms   time until the next pending file settles, output,
+ *                     -1 if nothing is pending
+ *  @return 1          file reported
+ *          0          nothing settled
+ *          err_insufficient_buffer_size
+ */
+static int
+take_settled_file(watchDir *watch, char *str_file, size_t size, int *wait_ms)
+{
+  watchFile *p_file = NULL;
+  struct stat st;
+  double now_s = profile_wall_time();
+  double left_ms = 0;
+  int i = 0;
+
+  *wait_ms = -1;
+  for (i = 0; i < watch->file_cnt; i++)
+  {
+    p_file = &watch->files[i];
+    if (!p_file->b_pending)
+    {
+      continue;
+    }
+    left_ms = WATCH_SETTLE_MS - (now_s - p_file->last_event_s) * 1000.0;
+    if (left_ms > 0)
+    {
+      if ((*wait_ms < 0) || ((int) left_ms + 1 < *wait_ms))
+      {
+        *wait_ms = (int) left_ms + 1;
+      }
+      continue;
+    }
+    p_file->b_pending = false;
+    if ((size_t) snprintf(str_file, size, "%s%s%s",
+                          watch->dir, PATH_DELIM, p_file->name) >= size)
+    {
+      return throw_err(err_insufficient_buffer_size);
+    }
+    /* removed again, or unchanged since it was last processed */
+    if ((0 != stat(str_file, &st)) ||
+        ((p_file->size == (long long) st.st_size) &&
+         (p_file->mtime == (long long) st.st_mtime)))
+    {
+      continue;
+    }
+    p_file->size = (long long) st.st_size;
+    p_file->mtime = (long long) st.st_mtime;
+    return 1;
+  }
+  return 0;
+}
+
+/** @brief  start watching a directory for train data files, files already
+ *          in the directory are reported once they settle
+ *  @param  *str_dir          directory to watch
+ *  @param  b_follow_writes   also report files still open for writing
+ *  @return NULL              directory cannot be watched or platform not 
+ *                            supported
+ *          pointer to the new watcher
+ */
+watchDir *
+watch_open(const char *str_dir, bool b_follow_writes)
+{
+  watchDir *watch = NULL;
+  uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF;
+
+  if ((NULL == str_dir) || (strlen(str_dir) >= STR_MAX))
+  {
+    return NULL;
+  }
+  if (NULL == (watch = calloc(1, sizeof(watchDir))))
+  {
+    return NULL;
+  }
+  strcpy(watch->dir, str_dir);
+  watch->fd = -1;
+  watch->files = malloc(WATCH_INIT_FILE_CNT * sizeof(watchFile));
+  watch->file_size = WATCH_INIT_FILE_CNT;
+  if (b_follow_writes)
+  {
+    mask |= IN_MODIFY;
+  }
+  if ((NULL == watch->files) ||
+      ((watch->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) < 0) ||
+      ((watch->wd = inotify_add_watch(watch->fd, str_dir, mask)) < 0) ||
+      (scan_dir(watch) < 0))
+  {
+    watch_close(watch);
+    return NULL;
+  }
+  return watch;
+}
+
+/** @brief  wait for the next train data file ready to be processed
+ *  @param  *watch       watcher created by watch_open
+ *  @param  *str_file    path of the file output, directory included
+ *  @param  size         size of str_file
+ *  @param  timeout_ms   maximum wait, a signal also ends the wait early
+ *  @return 1            file reported
+ *          0            timeout or interrupted, nothing reported
+ *          err_null_string
+ *          err_insufficient_buffer_size
+ *          err_file_not_accessible
+ *          err_list_append_failed
+ */
+int
+watch_next(watchDir *watch, char *str_file, size_t size, int timeout_ms)
+{
+  struct pollfd pfd;
+  double end_s = 0;
+  int wait_ms = 0;
+  int left_ms = 0;
+  int err = 0;
+
+  if ((NULL == watch) || (NULL == str_file))
+  {
+    return throw_err(err_null_string);
+  }
+  end_s = profile_wall_time() + timeout_ms / 1000.0;
+  while (true)
+  {
+    if (0 != (err = take_settled_file(watch, str_file, size, &wait_ms)))
+    {
+      return err;
+    }
+    left_ms = (int) ((end_s - profile_wall_time()) * 1000.0);
+    if (left_ms <= 0)
+    {
+      return 0;
+    }
+    if ((wait_ms < 0) || (wait_ms > left_ms))
+    {
+      wait_ms = left_ms;
+    }
+    pfd.fd = watch->fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    err = poll(&pfd, 1, wait_ms);
+    if (err < 0)
+    {
+      return (EINTR == errno) ? 0 : throw_err(err_file_not_accessible);
+    }
+    if ((err > 0) && ((err = read_events(watch)) < 0))
+    {
+      return err;
+    }
+  }
+}
+
+/** @brief  stop watching and release the watcher
+ *  @param  *watch  watcher created by watch_open, NULL is ignored
+ *  @return none
+ */
+void
+watch_close(watchDir *watch)
+{
+  if (NULL == watch)
+  {
+    return;
+  }
+  if (watch->fd >= 0)
+  {
+    close(watch->fd);
+  }
+  free(watch->files);
+  free(watch);
+}
+
+#else
+
+watchDir *
+watch_open(const char *str_dir, bool b_follow_writes)
+{
+  (void) str_dir;
+  (void) b_follow_writes;
+  return NULL;
+}
+
+int
+watch_next(watchDir *watch, char *str_file, size_t size, int timeout_ms)
+{
+  (void) watch;
+  (void) str_file;
+  (void) size;
+  (void) timeout_ms;
+  return throw_err(err_file_not_accessible);
+}
+
+void
+watch_close(watchDir *watch)
+{
+  (void) watch;
+}
+
+#endif
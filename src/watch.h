@@ -0,0 +1,107 @@
+/*------------------------------------------------------
+**
+** File:      watch.h
+** Author:    Eric Lu
+** Created:   2026-10-19
+**
+** Copyright ©2012 Toronto Transit Commission
+**
+**
+** Function Description
+** -----------------------------------------------------
+**
+** directory watcher for the resident mode. train data files written or
+** moved into the watched directory are reported once they have settled,
+** files already processed with the same size and modification time are
+** not reported again.
+**
+** -----------------------------------------------------
+** Revision History
+**
+** 19 OCT 2026: Rev 1.0 - erilu
+**                      - Initial Design
+**
+** Inputs:
+** Directory to watch
+**
+** Outputs:
+** Paths of train data files ready to be processed
+**
+** ----------------------------------------------------
+*/
+
+#ifndef ATC_SPEED_PROFILE_WATCH_H
+#define ATC_SPEED_PROFILE_WATCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "common_util.h"
+
+/*
+** Constants
+** -----------------------------------------------------
+*/
+
+/* directory notifications are only available on linux (inotify) */
+#if defined(__linux__)
+#   define WATCH_SUPPORTED 1
+#else
+#   define WATCH_SUPPORTED 0
+#endif
+
+/* a file name must contain this to be taken as train data */
+#define WATCH_FILE_PATTERN        "traindata"
+/* quiet time after the last write before a file is reported, ms */
+#define WATCH_SETTLE_MS           1000
+
+/*
+** Structures
+** -----------------------------------------------------
+*/
+
+/* directory watcher, opaque to the callers */
+typedef struct watch_dir_t watchDir;
+
+/*
+** Function Prototypes
+** -----------------------------------------------------
+*/
+
+/** @brief  start watching a directory for train data files, files already
+ *          in the directory are reported once they settle
+ *  @param  *str_dir          directory to watch
+ *  @param  b_follow_writes   also report files still open for writing,
+ *                            once their writes pause for WATCH_SETTLE_MS
+ *  @return NULL              directory cannot be watched or platform not 
+ *                            supported
+ *          pointer to the new watcher
+ */
+watchDir *
+watch_open(const char *str_dir, bool b_follow_writes);
+
+/** @brief  wait for the next train data file that was closed after writing
+ *          (or written to, when following writes) or moved into the 
+ *          directory and has not changed for WATCH_SETTLE_MS. a file is
+ *          reported again only after its size or modification time changes.
+ *  @param  *watch       watcher created by watch_open
+ *  @param  *str_file    path of the file output, directory included
+ *  @param  size         size of str_file
+ *  @param  timeout_ms   maximum wait, a signal also ends the wait early
+ *  @return 1            file reported
+ *          0            timeout or interrupted, nothing reported
+ *          err_null_string
+ *          err_insufficient_buffer_size
+ *          err_file_not_accessible     directory removed or not readable
+ *          err_list_append_failed
+ */
+int
+watch_next(watchDir *watch, char *str_file, size_t size, int timeout_ms);
+
+/** @brief  stop watching and release the watcher
+ *  @param  *watch  watcher created by watch_open, NULL is ignored
+ *  @return none
+ */
+void
+watch_close(watchDir *watch);
+
+#endif